@@ -270,6 +270,7 @@ namespace LeechCraft
 				("no-resource-caching", "disable caching of dynamic loadable resources (useful for stuff like Azoth themes development)")
 				("autorestart", "automatically restart LC if it's closed (not guaranteed to work everywhere, especially on Windows and Mac OS X)")
 				("minimized", "start LC minimized to tray")
+				("startup-trace", bpo::value<std::string> (), "write the plugins initialization trace in the Chrome trace event format to the given file")
 				("restart", "restart the LC");
 		bpo::positional_options_description pdesc;
 		pdesc.add ("entity", -1);
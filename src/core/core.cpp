@@ -148,6 +148,7 @@ namespace LeechCraft
 
 		IsShuttingDown_ = true;
 		LocalSocketHandler_.reset ();
+		EntityManager::DumpDispatchStats ();
 		XmlSettingsManager::Instance ()->setProperty ("FirstStart", "false");
 
 		PluginManager_->Release ();
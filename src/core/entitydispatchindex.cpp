@@ -0,0 +1,157 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "entitydispatchindex.h"
+#include <algorithm>
+#include <QUrl>
+#include "interfaces/structures.h"
+#include "interfaces/ihaveentityroutingkeys.h"
+
+namespace LeechCraft
+{
+	namespace
+	{
+		QString GetScheme (const Entity& e)
+		{
+			switch (e.Entity_.type ())
+			{
+			case QVariant::Url:
+				return e.Entity_.toUrl ().scheme ().toLower ();
+			case QVariant::String:
+				return QUrl { e.Entity_.toString () }.scheme ().toLower ();
+			default:
+				return {};
+			}
+		}
+	}
+
+	EntityDispatchIndex::EntityDispatchIndex (const QObjectList& plugins)
+	: Plugins_ (plugins)
+	{
+		QHash<QString, Positions_t> byMimePrefix;
+
+		for (int i = 0; i < plugins.size (); ++i)
+		{
+			const auto ihrk = qobject_cast<IHaveEntityRoutingKeys*> (plugins.at (i));
+			if (!ihrk)
+			{
+				Unrouted_ << i;
+				continue;
+			}
+
+			const auto& keys = ihrk->GetEntityRoutingKeys ();
+			for (const auto& mime : keys.Mimes_)
+				if (mime.endsWith ('*'))
+					byMimePrefix [mime.left (mime.size () - 1)] << i;
+				else
+					ByMime_ [mime] << i;
+			for (const auto& scheme : keys.Schemes_)
+				ByScheme_ [scheme.toLower ()] << i;
+			for (const auto& key : keys.AdditionalKeys_)
+				ByAdditional_ [key] << i;
+			for (const auto& type : keys.Types_)
+				ByType_ [type] << i;
+		}
+
+		for (auto i = byMimePrefix.begin (), end = byMimePrefix.end (); i != end; ++i)
+			ByMimePrefix_.append ({ i.key (), i.value () });
+	}
+
+	QObjectList EntityDispatchIndex::GetCandidates (const Entity& e) const
+	{
+		if (Unrouted_.size () == Plugins_.size ())
+			return Plugins_;
+
+		auto positions = Unrouted_;
+
+		if (!e.Mime_.isEmpty ())
+		{
+			positions += ByMime_.value (e.Mime_);
+			for (const auto& pair : ByMimePrefix_)
+				if (e.Mime_.startsWith (pair.first))
+					positions += pair.second;
+		}
+
+		if (!ByScheme_.isEmpty ())
+		{
+			const auto& scheme = GetScheme (e);
+			if (!scheme.isEmpty ())
+				positions += ByScheme_.value (scheme);
+		}
+
+		if (!ByAdditional_.isEmpty ())
+			for (auto i = e.Additional_.begin (), end = e.Additional_.end (); i != end; ++i)
+				positions += ByAdditional_.value (i.key ());
+
+		if (!ByType_.isEmpty () && e.Entity_.isValid ())
+			positions += ByType_.value (e.Entity_.typeName ());
+
+		std::sort (positions.begin (), positions.end ());
+		positions.erase (std::unique (positions.begin (), positions.end ()), positions.end ());
+
+		QObjectList result;
+		result.reserve (positions.size ());
+		for (auto pos : positions)
+			result << Plugins_.at (pos);
+		return result;
+	}
+
+	int EntityDispatchIndex::GetPluginsCount () const
+	{
+		return Plugins_.size ();
+	}
+
+	bool EntityDispatchIndex::Matches (const EntityRoutingKeys& keys, const Entity& e)
+	{
+		if (!e.Mime_.isEmpty ())
+			for (const auto& mime : keys.Mimes_)
+				if (mime.endsWith ('*') ?
+						e.Mime_.startsWith (mime.left (mime.size () - 1)) :
+						e.Mime_ == mime)
+					return true;
+
+		if (!keys.Schemes_.isEmpty ())
+		{
+			const auto& scheme = GetScheme (e);
+			if (!scheme.isEmpty ())
+				for (const auto& key : keys.Schemes_)
+					if (!key.compare (scheme, Qt::CaseInsensitive))
+						return true;
+		}
+
+		for (const auto& key : keys.AdditionalKeys_)
+			if (e.Additional_.contains (key))
+				return true;
+
+		if (e.Entity_.isValid () && keys.Types_.contains (e.Entity_.typeName ()))
+			return true;
+
+		return false;
+	}
+}
@@ -0,0 +1,73 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+struct EntityRoutingKeys;
+
+namespace LeechCraft
+{
+	struct Entity;
+
+	/** Precomputed entity dispatching candidates.
+	 *
+	 * Plugins implementing IHaveEntityRoutingKeys are considered only
+	 * for the entities matching their keys, other plugins are always
+	 * considered. The candidates are returned in the same order they
+	 * have in the list passed to the constructor.
+	 */
+	class EntityDispatchIndex
+	{
+		QObjectList Plugins_;
+
+		typedef QVector<int> Positions_t;
+
+		Positions_t Unrouted_;
+		QHash<QString, Positions_t> ByMime_;
+		QList<QPair<QString, Positions_t>> ByMimePrefix_;
+		QHash<QString, Positions_t> ByScheme_;
+		QHash<QString, Positions_t> ByAdditional_;
+		QHash<QString, Positions_t> ByType_;
+	public:
+		EntityDispatchIndex () = default;
+		explicit EntityDispatchIndex (const QObjectList& plugins);
+
+		QObjectList GetCandidates (const Entity&) const;
+		int GetPluginsCount () const;
+
+		/** Checks whether the entity matches the given routing keys.
+		 */
+		static bool Matches (const EntityRoutingKeys&, const Entity&);
+	};
+}
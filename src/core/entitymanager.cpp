@@ -31,6 +31,9 @@
 #include <functional>
 #include <algorithm>
 #include <QDesktopServices>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QReadWriteLock>
 #include <QUrl>
 #include "util/util.h"
 #include "util/sll/prelude.h"
@@ -42,6 +45,7 @@
 #include "pluginmanager.h"
 #include "xmlsettingsmanager.h"
 #include "handlerchoicedialog.h"
+#include "entitydispatchindex.h"
 
 namespace LeechCraft
 {
@@ -52,13 +56,70 @@ namespace LeechCraft
 
 	namespace
 	{
+		struct DispatchStats
+		{
+			quint64 Count_ = 0;
+			quint64 Queried_ = 0;
+			quint64 Skipped_ = 0;
+			qint64 TotalUs_ = 0;
+			qint64 MaxUs_ = 0;
+		};
+
+		/* Entities may be handled from any thread, so the stats are
+		 * only accessed with this mutex locked.
+		 */
+		QMutex DispatchStatsMutex;
+
+		QHash<QString, DispatchStats>& GetDispatchStats ()
+		{
+			static QHash<QString, DispatchStats> stats;
+			return stats;
+		}
+
+		QString GetEntityType (const Entity& e)
+		{
+			if (!e.Mime_.isEmpty ())
+				return e.Mime_;
+
+			if (e.Entity_.type () == QVariant::Url)
+				return "url:" + e.Entity_.toUrl ().scheme ();
+
+			return e.Entity_.typeName ();
+		}
+
+		/* The indices are rebuilt by RebuildDispatchIndex() in the main
+		 * thread whenever the plugins list changes, and the dispatching
+		 * threads only copy them out under the read lock. The index is
+		 * implicitly shared, so the copy is cheap and stays valid even if
+		 * the index is rebuilt meanwhile.
+		 */
+		QReadWriteLock DispatchIndexLock;
+
+		template<typename T>
+		EntityDispatchIndex& DispatchIndex ()
+		{
+			static EntityDispatchIndex index;
+			return index;
+		}
+
+		template<typename T>
+		EntityDispatchIndex GetDispatchIndex ()
+		{
+			QReadLocker locker { &DispatchIndexLock };
+			return DispatchIndex<T> ();
+		}
+
 		template<typename T, typename F>
-		QObjectList GetSubtype (const Entity& e, bool fullScan, const F& queryFunc)
+		QObjectList GetSubtype (const Entity& e, bool fullScan, const F& queryFunc, DispatchStats& stats)
 		{
-			auto pm = Core::Instance ().GetPluginManager ();
+			const auto index = GetDispatchIndex<T> ();
+			const auto& candidates = index.GetCandidates (e);
+			stats.Queried_ += candidates.size ();
+			stats.Skipped_ += index.GetPluginsCount () - candidates.size ();
+
 			QMap<int, QObjectList> result;
 			int cutoffPriority = 0;
-			for (const auto& plugin : pm->GetAllCastableRoots<T> ())
+			for (const auto& plugin : candidates)
 			{
 				EntityTestHandleResult r;
 				try
@@ -114,6 +175,8 @@ namespace LeechCraft
 			if (Core::Instance ().IsShuttingDown ())
 				return {};
 
+			Core::Instance ().GetPluginManager ()->InstantiateDeferred (e);
+
 			const auto& unwanted = e.Additional_ ["IgnorePlugins"].toStringList ();
 			auto removeUnwanted = [&unwanted] (QObjectList& handlers)
 			{
@@ -123,11 +186,20 @@ namespace LeechCraft
 				handlers.erase (remBegin, handlers.end ());
 			};
 
+			QElapsedTimer timer;
+			timer.start ();
+
+			/* Handlers might emit entities from their CouldHandle(),
+			 * so the global stats are updated only after querying them.
+			 */
+			DispatchStats callStats;
+
 			QObjectList result;
 			if (!(e.Parameters_ & TaskParameter::OnlyHandle))
 			{
 				auto sub = GetSubtype<IDownload*> (e, true,
-						[] (Entity e, IDownload *dl) { return dl->CouldDownload (e); });
+						[] (Entity e, IDownload *dl) { return dl->CouldDownload (e); },
+						callStats);
 				removeUnwanted (sub);
 				if (downloaders)
 					*downloaders = sub.size ();
@@ -136,12 +208,23 @@ namespace LeechCraft
 			if (!(e.Parameters_ & TaskParameter::OnlyDownload))
 			{
 				auto sub = GetSubtype<IEntityHandler*> (e, true,
-						[] (Entity e, IEntityHandler *eh) { return eh->CouldHandle (e); });
+						[] (Entity e, IEntityHandler *eh) { return eh->CouldHandle (e); },
+						callStats);
 				removeUnwanted (sub);
 				if (handlers)
 					*handlers = sub.size ();
 				result += sub;
 			}
+
+			const auto elapsed = timer.nsecsElapsed () / 1000;
+			QMutexLocker locker { &DispatchStatsMutex };
+			auto& stats = GetDispatchStats () [GetEntityType (e)];
+			++stats.Count_;
+			stats.Queried_ += callStats.Queried_;
+			stats.Skipped_ += callStats.Skipped_;
+			stats.TotalUs_ += elapsed;
+			stats.MaxUs_ = std::max (stats.MaxUs_, elapsed);
+
 			return result;
 		}
 
@@ -284,4 +367,42 @@ namespace LeechCraft
 	{
 		return GetObjects (e);
 	}
+
+	void EntityManager::RebuildDispatchIndex ()
+	{
+		const auto pm = Core::Instance ().GetPluginManager ();
+		const auto& plugins = pm->GetAllPlugins ();
+		const EntityDispatchIndex downloaders { pm->Filter<IDownload*> (plugins) };
+		const EntityDispatchIndex handlers { pm->Filter<IEntityHandler*> (plugins) };
+
+		QWriteLocker locker { &DispatchIndexLock };
+		DispatchIndex<IDownload*> () = downloaders;
+		DispatchIndex<IEntityHandler*> () = handlers;
+	}
+
+	void EntityManager::DumpDispatchStats ()
+	{
+		QMutexLocker locker { &DispatchStatsMutex };
+		const auto& stats = GetDispatchStats ();
+
+		auto types = stats.keys ();
+		std::sort (types.begin (), types.end (),
+				[&stats] (const QString& left, const QString& right)
+					{ return stats [left].TotalUs_ > stats [right].TotalUs_; });
+
+		qDebug () << Q_FUNC_INFO
+				<< "entity dispatching statistics (type, count, total us, avg us, max us, queried, skipped):";
+		for (const auto& type : types)
+		{
+			const auto& s = stats [type];
+			qDebug () << "\t"
+					<< type
+					<< s.Count_
+					<< s.TotalUs_
+					<< s.TotalUs_ / std::max<quint64> (s.Count_, 1)
+					<< s.MaxUs_
+					<< s.Queried_
+					<< s.Skipped_;
+		}
+	}
 }
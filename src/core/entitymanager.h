@@ -46,5 +46,18 @@ namespace LeechCraft
 		bool HandleEntity (Entity, QObject* = 0);
 		bool CouldHandle (const Entity&);
 		QList<QObject*> GetPossibleHandlers (const Entity&);
+
+		/** Rebuilds the index of entity handlers and downloaders from
+		 * the current list of plugins.
+		 *
+		 * Should be called from the main thread each time the list of
+		 * plugins changes.
+		 */
+		static void RebuildDispatchIndex ();
+
+		/** Logs the per entity type dispatching latency counters
+		 * collected so far.
+		 */
+		static void DumpDispatchStats ();
 	};
 }
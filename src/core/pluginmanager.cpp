@@ -36,8 +36,12 @@
 #include <QStringList>
 #include <QtDebug>
 #include <QtConcurrentMap>
+#include <QtConcurrentRun>
+#include <QFile>
 #include <QMessageBox>
 #include <QMainWindow>
+#include <QSet>
+#include <QThread>
 #include <util/util.h>
 #include <util/exceptions.h>
 #include <util/sll/prelude.h>
@@ -46,6 +50,7 @@
 #include <interfaces/ipluginready.h>
 #include <interfaces/ipluginadaptor.h>
 #include <interfaces/ihaveshortcuts.h>
+#include <interfaces/ihavebackgroundinit.h>
 #include "core.h"
 #include "pluginmanager.h"
 #include "mainwindow.h"
@@ -57,6 +62,8 @@
 #include "shortcutmanager.h"
 #include "application.h"
 #include "loaders/sopluginloader.h"
+#include "entitydispatchindex.h"
+#include "entitymanager.h"
 
 #ifdef WITH_DBUS_LOADERS
 #include "loaders/dbuspluginloader.h"
@@ -171,7 +178,8 @@ namespace LeechCraft
 				}
 			case Qt::ForegroundRole:
 				return QApplication::palette ()
-					.brush (AvailablePlugins_.at (index.row ())->IsLoaded () ?
+					.brush (AvailablePlugins_.at (index.row ())->IsLoaded () ||
+								IsDeferred (AvailablePlugins_.at (index.row ())) ?
 							QPalette::Normal :
 							QPalette::Disabled,
 						QPalette::WindowText);
@@ -192,7 +200,8 @@ namespace LeechCraft
 			}
 			else if (role == Qt::ForegroundRole)
 				return QApplication::palette ()
-					.brush (AvailablePlugins_.at (index.row ())->IsLoaded () ?
+					.brush (AvailablePlugins_.at (index.row ())->IsLoaded () ||
+								IsDeferred (AvailablePlugins_.at (index.row ())) ?
 							QPalette::Normal :
 							QPalette::Disabled,
 						QPalette::WindowText);
@@ -350,7 +359,18 @@ namespace LeechCraft
 			{
 				qDebug () << "Initializing" << ii->GetName ();
 				emit loadProgress (tr ("Initializing %1: stage one...").arg (ii->GetName ()));
-				ii->Init (std::make_shared<CoreProxy> ());
+
+				if (BackgroundInits_.contains (obj))
+				{
+					StartupTrace::Scope scope { Trace_, ii->GetName (), "background-wait" };
+					if (!BackgroundInits_.take (obj).result ())
+						return obj;
+				}
+
+				{
+					StartupTrace::Scope scope { Trace_, ii->GetName (), "init" };
+					ii->Init (std::make_shared<CoreProxy> ());
+				}
 
 				const auto& path = GetPluginLibraryPath (obj);
 				if (path.isEmpty ())
@@ -408,12 +428,18 @@ namespace LeechCraft
 		FillInstances ();
 
 		if (safeMode)
+		{
 			Plugins_.clear ();
 
+			QMutexLocker locker { &DeferredMutex_ };
+			Deferred_.clear ();
+		}
+
 		Plugins_.prepend (Core::Instance ().GetCoreInstanceObject ());
 
 		PluginTreeBuilder_->AddObjects (Plugins_);
 		PluginTreeBuilder_->Calculate ();
+		EntityManager::RebuildDispatchIndex ();
 
 		const auto& ordered = PluginTreeBuilder_->GetResult ();
 
@@ -428,10 +454,22 @@ namespace LeechCraft
 					qDebug () << val->Unload ();
 				}
 
+		StartBackgroundInit (ordered);
+
 		const auto& failed = FirstInitAll ();
 
+		/* The plugins whose Init() hasn't been reached due to earlier
+		 * failures might still be running their background part.
+		 */
+		for (auto future : BackgroundInits_)
+			future.waitForFinished ();
+		BackgroundInits_.clear ();
+
 		for (const auto obj : ordered)
+		{
+			StartupTrace::Scope scope { Trace_, qobject_cast<IInfo*> (obj)->GetName (), "setup" };
 			Core::Instance ().Setup (obj);
+		}
 
 		auto coreInstanceObj = Core::Instance ().GetCoreInstanceObject ();
 		for (auto obj : GetAllCastableRoots<IHaveShortcuts*> ())
@@ -452,6 +490,7 @@ namespace LeechCraft
 			try
 			{
 				emit loadProgress (tr ("Initializing %1: stage two...").arg (ii->GetName ()));
+				StartupTrace::Scope scope { Trace_, ii->GetName (), "second-init" };
 				ii->SecondInit ();
 			}
 			catch (const std::exception& e)
@@ -466,13 +505,111 @@ namespace LeechCraft
 		}
 
 		for (const auto plugin : GetAllPlugins ())
+		{
+			StartupTrace::Scope scope { Trace_, qobject_cast<IInfo*> (plugin)->GetName (), "post-second-init" };
 			Core::Instance ().PostSecondInit (plugin);
+		}
 
 		TryUnload (failed);
+
+		Trace_.DumpSummary ();
+		WriteStartupTrace ();
+	}
+
+	void PluginManager::StartBackgroundInit (const QObjectList& ordered)
+	{
+		/* For each plugin, the plugins with background init among all
+		 * its direct and indirect dependencies, since an indirect one
+		 * may well be reached only via dependencies not implementing
+		 * IHaveBackgroundInit. The list is in the dependency order, so
+		 * the closures of the dependencies are known by the time a
+		 * plugin is visited.
+		 */
+		QHash<QObject*, QSet<QObject*>> bgDeps;
+
+		for (const auto obj : ordered)
+		{
+			auto& objBgDeps = bgDeps [obj];
+			for (const auto dep : PluginTreeBuilder_->GetDependencies (obj))
+			{
+				objBgDeps += bgDeps.value (dep);
+				if (BackgroundInits_.contains (dep))
+					objBgDeps << dep;
+			}
+
+			const auto ibi = qobject_cast<IHaveBackgroundInit*> (obj);
+			if (!ibi)
+				continue;
+
+			/* The plugins are started in the dependency order, so the
+			 * dependencies are already running by the time this one is
+			 * picked by the thread pool, and waiting for them can't
+			 * deadlock the pool.
+			 */
+			QList<QFuture<bool>> deps;
+			for (const auto dep : objBgDeps)
+				deps << BackgroundInits_ [dep];
+
+			const auto& name = qobject_cast<IInfo*> (obj)->GetName ();
+			auto& trace = Trace_;
+			BackgroundInits_ [obj] = QtConcurrent::run ([ibi, deps, name, &trace] () -> bool
+					{
+						for (auto dep : deps)
+							dep.waitForFinished ();
+
+						StartupTrace::Scope scope { trace, name, "background-init" };
+						try
+						{
+							ibi->BackgroundInit ();
+							return true;
+						}
+						catch (const std::exception& e)
+						{
+							qWarning () << Q_FUNC_INFO
+									<< "background init of"
+									<< name
+									<< "failed with"
+									<< e.what ();
+						}
+						catch (...)
+						{
+							qWarning () << Q_FUNC_INFO
+									<< "background init of"
+									<< name
+									<< "failed";
+						}
+						return false;
+					});
+		}
+	}
+
+	void PluginManager::WriteStartupTrace () const
+	{
+		const auto& varMap = static_cast<Application*> (qApp)->GetVarMap ();
+		if (!varMap.count ("startup-trace"))
+			return;
+
+		const auto& path = QString::fromStdString (varMap ["startup-trace"].as<std::string> ());
+		QFile file { path };
+		if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< path
+					<< file.errorString ();
+			return;
+		}
+
+		file.write (Trace_.ToChromeTrace ());
 	}
 
 	void PluginManager::Release ()
 	{
+		{
+			QMutexLocker locker { &DeferredMutex_ };
+			Deferred_.clear ();
+		}
+
 		auto ordered = PluginTreeBuilder_->GetResult ();
 		std::reverse (ordered.begin (), ordered.end ());
 		for (const auto obj : ordered)
@@ -873,6 +1010,43 @@ namespace LeechCraft
 		}
 	}
 
+	void PluginManager::PruneUnfulfilled (const PluginManifest& manifest)
+	{
+		QHash<QString, PluginManifest::Entry> manifests;
+		for (const auto& loader : PluginContainers_)
+		{
+			PluginManifest::Entry entry;
+			const auto& path = loader->GetFileName ();
+
+			/* Unknown plugins and plugins spawning other plugins may
+			 * fulfill any dependencies, so nothing could be pruned.
+			 */
+			if (!manifest.Get (path, entry) || entry.IsAdaptor_)
+				return;
+
+			manifests [path] = entry;
+		}
+
+		PluginTreeBuilder builder;
+		builder.AddObjects ({ Core::Instance ().GetCoreInstanceObject () });
+		builder.AddManifests (manifests);
+		builder.Calculate ();
+
+		const auto& fulfilled = builder.GetResultPaths ().toSet ();
+		for (int i = PluginContainers_.size () - 1; i >= 0; --i)
+		{
+			const auto& path = PluginContainers_.at (i)->GetFileName ();
+			if (fulfilled.contains (path))
+				continue;
+
+			qDebug () << Q_FUNC_INFO
+					<< "not loading"
+					<< path
+					<< "since its dependencies can't be fulfilled";
+			PluginContainers_.removeAt (i);
+		}
+	}
+
 	void PluginManager::CheckPlugins ()
 	{
 		QSettings settings (QCoreApplication::organizationName (),
@@ -881,19 +1055,40 @@ namespace LeechCraft
 
 		QHash<QByteArray, QString> id2source;
 
+		PluginManifest manifest;
+		if (!DBusMode_)
+		{
+			PruneUnfulfilled (manifest);
+			DeferInstantiation (manifest, id2source);
+		}
+
 		QList<std::function<void (Loaders::IPluginLoader_ptr)>> checks;
 		checks << Checks::IsFile
-				<< Checks::TryLoad
-				<< Checks::APILevel;
+				<< Checks::TryLoad;
 
-		auto thrCheck = [checks] (Loaders::IPluginLoader_ptr loader) -> boost::optional<Checks::Fail>
+		/* The API level is recorded in the manifest, so it isn't
+		 * checked again for the unchanged libraries.
+		 */
+		auto& trace = Trace_;
+		auto thrCheck = [checks, &manifest, &trace] (Loaders::IPluginLoader_ptr loader) -> boost::optional<Checks::Fail>
 		{
+			StartupTrace::Scope scope { trace, QFileInfo { loader->GetFileName () }.fileName (), "load" };
+
 			for (const auto& check : checks)
 				try
 				{
 					check (loader);
-					{
-					}
+				}
+				catch (const Checks::Fail& f)
+				{
+					return f;
+				}
+
+			PluginManifest::Entry entry;
+			if (!manifest.Get (loader->GetFileName (), entry))
+				try
+				{
+					Checks::APILevel (loader);
 				}
 				catch (const Checks::Fail& f)
 				{
@@ -918,6 +1113,10 @@ namespace LeechCraft
 				PluginLoadErrors_ << fails [i]->Error_;
 			}
 
+		/* The core queries every other plugin right away (tab and
+		 * shortcut managers, IPluginReady::AddPlugin() and so on), so
+		 * all the plugins not deferred above are instantiated here.
+		 */
 		checks.clear ();
 		checks << Checks::TryInstance;
 
@@ -929,6 +1128,7 @@ namespace LeechCraft
 			for (auto check : checks)
 				try
 				{
+					StartupTrace::Scope scope { Trace_, QFileInfo { loader->GetFileName () }.fileName (), "instance" };
 					check (loader);
 				}
 				catch (const Checks::Fail& f)
@@ -988,9 +1188,145 @@ namespace LeechCraft
 			settings.setValue ("Name", name);
 			settings.setValue ("Info", pinfo);
 			settings.endGroup ();
+
+			PluginManifest::Entry entry;
+			if (!manifest.Get (loader->GetFileName (), entry))
+				manifest.Update (loader->GetFileName (), loader->Instance ());
 		}
 
 		settings.endGroup ();
+
+		manifest.Save ();
+	}
+
+	void PluginManager::DeferInstantiation (const PluginManifest& manifest, QHash<QByteArray, QString>& id2source)
+	{
+		QMutexLocker locker { &DeferredMutex_ };
+		for (int i = 0; i < PluginContainers_.size (); )
+		{
+			const auto loader = PluginContainers_.at (i);
+
+			PluginManifest::Entry entry;
+			if (!manifest.Get (loader->GetFileName (), entry) ||
+					!entry.IsDeferrable_ ||
+					id2source.contains (entry.UniqueID_))
+			{
+				++i;
+				continue;
+			}
+
+			qDebug () << Q_FUNC_INFO
+					<< "deferring instantiation of"
+					<< loader->GetFileName ();
+
+			id2source [entry.UniqueID_] = loader->GetFileName ();
+			Deferred_.append (DeferredPlugin { loader, entry.RoutingKeys_ });
+			PluginContainers_.removeAt (i);
+		}
+	}
+
+	bool PluginManager::IsDeferred (const Loaders::IPluginLoader_ptr& loader) const
+	{
+		QMutexLocker locker { &DeferredMutex_ };
+		return std::any_of (Deferred_.begin (), Deferred_.end (),
+				[&loader] (const DeferredPlugin& plugin) { return plugin.Loader_ == loader; });
+	}
+
+	void PluginManager::InstantiateDeferred (const Entity& e)
+	{
+		{
+			QMutexLocker locker { &DeferredMutex_ };
+			if (std::none_of (Deferred_.begin (), Deferred_.end (),
+					[&e] (const DeferredPlugin& plugin)
+						{ return EntityDispatchIndex::Matches (plugin.RoutingKeys_, e); }))
+				return;
+		}
+
+		if (QThread::currentThread () == thread ())
+			handleDeferredEntity (e);
+		else
+			QMetaObject::invokeMethod (this,
+					"handleDeferredEntity",
+					Qt::BlockingQueuedConnection,
+					Q_ARG (LeechCraft::Entity, e));
+	}
+
+	bool PluginManager::LoadDeferred (const Loaders::IPluginLoader_ptr& loader)
+	{
+		qDebug () << Q_FUNC_INFO
+				<< "loading"
+				<< loader->GetFileName ();
+
+		try
+		{
+			Checks::IsFile (loader);
+			Checks::TryLoad (loader);
+			Checks::TryInstance (loader);
+		}
+		catch (const Checks::Fail& f)
+		{
+			PluginLoadErrors_ << f.Error_;
+			if (f.Unload_)
+				loader->Unload ();
+			return false;
+		}
+
+		const auto inst = loader->Instance ();
+		PluginContainers_ << loader;
+		Plugins_ << inst;
+		Obj2Loader_ [inst] = loader;
+
+		PluginTreeBuilder_->AddObjects ({ inst });
+		PluginTreeBuilder_->Calculate ();
+		CacheValid_ = false;
+		PluginID2PluginCache_.remove (qobject_cast<IInfo*> (inst)->GetUniqueID ());
+
+		if (PluginTreeBuilder_->GetResult ().contains (inst))
+		{
+			try
+			{
+				InjectPlugin (inst);
+				EntityManager::RebuildDispatchIndex ();
+				return true;
+			}
+			catch (...)
+			{
+				// InjectPlugin() has already logged the error.
+			}
+		}
+		else
+			qWarning () << Q_FUNC_INFO
+					<< "dependencies aren't fulfilled for"
+					<< loader->GetFileName ();
+
+		PluginTreeBuilder_->RemoveObject (inst);
+		PluginTreeBuilder_->Calculate ();
+		CacheValid_ = false;
+
+		Obj2Loader_.remove (inst);
+		Plugins_.removeAll (inst);
+		PluginContainers_.removeAll (loader);
+		loader->Unload ();
+		return false;
+	}
+
+	void PluginManager::handleDeferredEntity (const Entity& e)
+	{
+		QList<Loaders::IPluginLoader_ptr> loaders;
+		{
+			QMutexLocker locker { &DeferredMutex_ };
+			for (auto i = Deferred_.begin (); i != Deferred_.end (); )
+				if (EntityDispatchIndex::Matches (i->RoutingKeys_, e))
+				{
+					loaders << i->Loader_;
+					i = Deferred_.erase (i);
+				}
+				else
+					++i;
+		}
+
+		for (const auto& loader : loaders)
+			LoadDeferred (loader);
 	}
 
 	void PluginManager::FillInstances ()
@@ -1030,6 +1366,7 @@ namespace LeechCraft
 			qDebug () << failed
 					<< "failed to initialize, recalculating dep tree...";
 			PluginTreeBuilder_->Calculate ();
+			EntityManager::RebuildDispatchIndex ();
 
 			ordered = PluginTreeBuilder_->GetResult ();
 			Q_FOREACH (QObject *obj, initialized)
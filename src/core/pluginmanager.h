@@ -36,7 +36,11 @@
 #include <QStringList>
 #include <QDir>
 #include <QIcon>
+#include <QFuture>
+#include <QMutex>
 #include "loaders/ipluginloader.h"
+#include "pluginmanifest.h"
+#include "startuptrace.h"
 #include "interfaces/iinfo.h"
 #include "interfaces/core/ipluginsmanager.h"
 
@@ -75,6 +79,18 @@ namespace LeechCraft
 
 		mutable bool CacheValid_;
 		mutable QObjectList SortedCache_;
+
+		StartupTrace Trace_;
+		QHash<QObject*, QFuture<bool>> BackgroundInits_;
+
+		struct DeferredPlugin
+		{
+			Loaders::IPluginLoader_ptr Loader_;
+			EntityRoutingKeys RoutingKeys_;
+		};
+		// Plugins not loaded until an entity matching their keys comes.
+		QList<DeferredPlugin> Deferred_;
+		mutable QMutex DeferredMutex_;
 	public:
 		enum Roles
 		{
@@ -122,6 +138,15 @@ namespace LeechCraft
 		QObject* GetProvider (const QString&) const;
 
 		const QStringList& GetPluginLoadErrors () const;
+
+		/** Loads and initializes the plugins whose instantiation has
+		 * been deferred and whose routing keys match the given entity,
+		 * so that they could be queried for it.
+		 *
+		 * This function may be called from any thread, but the plugins
+		 * are always loaded in the main thread.
+		 */
+		void InstantiateDeferred (const Entity&);
 	private:
 		QStringList FindPluginsPaths () const;
 		void FindPlugins ();
@@ -132,11 +157,38 @@ namespace LeechCraft
 		 */
 		void CheckPlugins ();
 
+		/** Filters out the plugins whose dependencies can't be
+		 * fulfilled, judging by their manifest entries, so that they
+		 * aren't even loaded.
+		 *
+		 * The plugins surviving pruning are loaded and instantiated by
+		 * CheckPlugins(), unless DeferInstantiation() moves them out.
+		 */
+		void PruneUnfulfilled (const PluginManifest&);
+
+		/** Moves the plugins whose manifest entries allow deferring
+		 * their instantiation from the PluginContainers_ list to the
+		 * Deferred_ list, recording their IDs in id2source.
+		 */
+		void DeferInstantiation (const PluginManifest&, QHash<QByteArray, QString>& id2source);
+
+		/** Loads, instantiates and initializes a deferred plugin,
+		 * returning whether it has succeeded.
+		 */
+		bool LoadDeferred (const Loaders::IPluginLoader_ptr&);
+		bool IsDeferred (const Loaders::IPluginLoader_ptr&) const;
+
 		/** Fills the Plugins_ list with all instances, both from "real"
 		 * plugins and from adaptors.
 		 */
 		void FillInstances ();
 
+		/** Starts IHaveBackgroundInit::BackgroundInit() for the
+		 * plugins implementing it on the global thread pool, each one
+		 * after the plugins it depends on.
+		 */
+		void StartBackgroundInit (const QObjectList&);
+
 		/** Tries to perform IInfo::Init() on all plugins. Returns the
 		 * list of plugins that failed.
 		 */
@@ -156,8 +208,12 @@ namespace LeechCraft
 
 		Loaders::IPluginLoader_ptr MakeLoader (const QString&);
 
+		void WriteStartupTrace () const;
+
 		QList<Plugins_t::iterator> FindProviders (const QString&);
 		QList<Plugins_t::iterator> FindProviders (const QSet<QByteArray>&);
+	private slots:
+		void handleDeferredEntity (const LeechCraft::Entity&);
 	signals:
 		void pluginInjected (QObject*);
 		void loadProgress (const QString&);
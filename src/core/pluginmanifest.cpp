@@ -0,0 +1,246 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "pluginmanifest.h"
+#include <stdexcept>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+#include <util/sys/paths.h>
+#include "interfaces/iinfo.h"
+#include "interfaces/iplugin2.h"
+#include "interfaces/ipluginready.h"
+#include "interfaces/ipluginadaptor.h"
+#include "interfaces/idownload.h"
+#include "interfaces/ientityhandler.h"
+
+namespace LeechCraft
+{
+	namespace
+	{
+		const quint32 ManifestVersion = 3;
+
+		QString GetManifestPath ()
+		{
+			try
+			{
+				return Util::GetUserDir (Util::UserDir::Cache, "core").filePath ("pluginmanifest");
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< e.what ();
+				return {};
+			}
+		}
+	}
+
+	QDataStream& operator<< (QDataStream& out, const PluginManifest::Entry& entry)
+	{
+		return out << entry.Modified_
+				<< entry.Size_
+				<< entry.APILevel_
+				<< entry.UniqueID_
+				<< entry.Name_
+				<< entry.Needs_
+				<< entry.Provides_
+				<< entry.PluginClasses_
+				<< entry.ExpectedClasses_
+				<< entry.IsAdaptor_
+				<< entry.IsDeferrable_
+				<< entry.RoutingKeys_.Mimes_
+				<< entry.RoutingKeys_.Schemes_
+				<< entry.RoutingKeys_.AdditionalKeys_
+				<< entry.RoutingKeys_.Types_;
+	}
+
+	QDataStream& operator>> (QDataStream& in, PluginManifest::Entry& entry)
+	{
+		return in >> entry.Modified_
+				>> entry.Size_
+				>> entry.APILevel_
+				>> entry.UniqueID_
+				>> entry.Name_
+				>> entry.Needs_
+				>> entry.Provides_
+				>> entry.PluginClasses_
+				>> entry.ExpectedClasses_
+				>> entry.IsAdaptor_
+				>> entry.IsDeferrable_
+				>> entry.RoutingKeys_.Mimes_
+				>> entry.RoutingKeys_.Schemes_
+				>> entry.RoutingKeys_.AdditionalKeys_
+				>> entry.RoutingKeys_.Types_;
+	}
+
+	PluginManifest::PluginManifest ()
+	{
+		const auto& path = GetManifestPath ();
+		if (path.isEmpty ())
+			return;
+
+		QFile file { path };
+		if (!file.open (QIODevice::ReadOnly))
+			return;
+
+		QDataStream in { &file };
+		quint32 version = 0;
+		in >> version;
+		if (version != ManifestVersion)
+		{
+			qDebug () << Q_FUNC_INFO
+					<< "unknown manifest version"
+					<< version;
+			return;
+		}
+
+		in >> Entries_;
+		if (in.status () != QDataStream::Ok)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "corrupted manifest";
+			Entries_.clear ();
+			return;
+		}
+
+		for (auto i = Entries_.begin (); i != Entries_.end (); )
+			if (QFileInfo { i.key () }.exists ())
+				++i;
+			else
+			{
+				i = Entries_.erase (i);
+				Changed_ = true;
+			}
+	}
+
+	bool PluginManifest::Get (const QString& path, Entry& entry) const
+	{
+		const auto pos = Entries_.find (path);
+		if (pos == Entries_.end ())
+			return false;
+
+		const QFileInfo fi { path };
+		if (pos->APILevel_ != CURRENT_API_LEVEL ||
+				pos->Size_ != fi.size () ||
+				pos->Modified_ != fi.lastModified ())
+			return false;
+
+		entry = *pos;
+		return true;
+	}
+
+	void PluginManifest::Update (const QString& path, QObject *instance)
+	{
+		const auto ii = qobject_cast<IInfo*> (instance);
+		if (!ii)
+			return;
+
+		const QFileInfo fi { path };
+
+		Entry entry
+		{
+			fi.lastModified (),
+			fi.size (),
+			CURRENT_API_LEVEL,
+			{},
+			{},
+			{},
+			{},
+			{},
+			{},
+			qobject_cast<IPluginAdaptor*> (instance) != nullptr,
+			false,
+			{}
+		};
+
+		try
+		{
+			entry.UniqueID_ = ii->GetUniqueID ();
+			entry.Name_ = ii->GetName ();
+			entry.Needs_ = ii->Needs ();
+			entry.Provides_ = ii->Provides ();
+			if (const auto ip2 = qobject_cast<IPlugin2*> (instance))
+				entry.PluginClasses_ = ip2->GetPluginClasses ();
+			if (const auto ipr = qobject_cast<IPluginReady*> (instance))
+				entry.ExpectedClasses_ = ipr->GetExpectedPluginClasses ();
+
+			if (const auto ihrk = qobject_cast<IHaveEntityRoutingKeys*> (instance))
+			{
+				entry.RoutingKeys_ = ihrk->GetEntityRoutingKeys ();
+
+				const bool isHandler = qobject_cast<IEntityHandler*> (instance) ||
+						qobject_cast<IDownload*> (instance);
+				entry.IsDeferrable_ = isHandler &&
+						!entry.IsAdaptor_ &&
+						entry.Provides_.isEmpty () &&
+						entry.PluginClasses_.isEmpty () &&
+						entry.ExpectedClasses_.isEmpty () &&
+						ihrk->IsInstantiationDeferrable ();
+			}
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to get plugin info for"
+					<< path
+					<< e.what ();
+			return;
+		}
+
+		Entries_ [path] = entry;
+		Changed_ = true;
+	}
+
+	void PluginManifest::Save ()
+	{
+		if (!Changed_)
+			return;
+
+		const auto& path = GetManifestPath ();
+		if (path.isEmpty ())
+			return;
+
+		QFile file { path };
+		if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< path
+					<< file.errorString ();
+			return;
+		}
+
+		QDataStream out { &file };
+		out << ManifestVersion << Entries_;
+
+		Changed_ = false;
+	}
+}
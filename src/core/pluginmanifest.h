@@ -0,0 +1,114 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QDateTime>
+#include "interfaces/ihaveentityroutingkeys.h"
+
+class QObject;
+class QDataStream;
+
+namespace LeechCraft
+{
+	/** @brief Persistent cache of the plugins metadata.
+	 *
+	 * For each plugin library the manifest keeps what's needed to
+	 * resolve its dependencies without loading the library: the
+	 * features it needs and provides, the plugin classes it belongs to
+	 * and the plugin classes it expects.
+	 *
+	 * The entries are keyed by the library path and are only valid while
+	 * the library modification time and size stay the same, and the core
+	 * API level is the same as when the entry was recorded.
+	 */
+	class PluginManifest
+	{
+	public:
+		struct Entry
+		{
+			QDateTime Modified_;
+			qint64 Size_;
+			quint64 APILevel_;
+
+			QByteArray UniqueID_;
+			QString Name_;
+
+			QStringList Needs_;
+			QStringList Provides_;
+			QSet<QByteArray> PluginClasses_;
+			QSet<QByteArray> ExpectedClasses_;
+
+			/** Whether the plugin is an IPluginAdaptor, spawning other
+			 * plugins not known in advance.
+			 */
+			bool IsAdaptor_;
+
+			/** Whether the plugin could be instantiated only when an
+			 * entity matching RoutingKeys_ is dispatched.
+			 *
+			 * @sa IHaveEntityRoutingKeys::IsInstantiationDeferrable()
+			 */
+			bool IsDeferrable_;
+			EntityRoutingKeys RoutingKeys_;
+		};
+	private:
+		QHash<QString, Entry> Entries_;
+		bool Changed_ = false;
+	public:
+		/** @brief Loads the manifest from the cache, if any.
+		 */
+		PluginManifest ();
+
+		/** @brief Returns the valid entry for the given library path.
+		 *
+		 * @param[in] path The canonical path of the plugin library.
+		 * @param[out] entry The entry to fill.
+		 * @return Whether the valid entry has been found.
+		 */
+		bool Get (const QString& path, Entry& entry) const;
+
+		/** @brief Records the entry for the plugin instance.
+		 *
+		 * @param[in] path The canonical path of the plugin library.
+		 * @param[in] instance The root instance of the plugin.
+		 */
+		void Update (const QString& path, QObject *instance);
+
+		/** @brief Saves the manifest to the cache if it has changed.
+		 */
+		void Save ();
+	};
+
+	QDataStream& operator<< (QDataStream&, const PluginManifest::Entry&);
+	QDataStream& operator>> (QDataStream&, PluginManifest::Entry&);
+}
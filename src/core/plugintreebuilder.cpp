@@ -67,6 +67,8 @@ namespace LeechCraft
 			throw std::runtime_error ("VertexInfo creation failed.");
 		}
 
+		Name_ = info->GetName ();
+
 		AllFeatureDeps_ = QSet<QString>::fromList (info->Needs ());
 		UnfulfilledFeatureDeps_ = AllFeatureDeps_;
 		FeatureProvides_ = QSet<QString>::fromList (info->Provides ());
@@ -83,6 +85,20 @@ namespace LeechCraft
 		}
 	}
 
+	PluginTreeBuilder::VertexInfo::VertexInfo (const QString& path, const PluginManifest::Entry& entry)
+	: IsFulfilled_ (false)
+	, AllFeatureDeps_ (QSet<QString>::fromList (entry.Needs_))
+	, AllP2PDeps_ (entry.PluginClasses_)
+	, UnfulfilledFeatureDeps_ (AllFeatureDeps_)
+	, UnfulfilledP2PDeps_ (AllP2PDeps_)
+	, FeatureProvides_ (QSet<QString>::fromList (entry.Provides_))
+	, P2PProvides_ (entry.ExpectedClasses_)
+	, Object_ (0)
+	, Path_ (path)
+	, Name_ (entry.Name_)
+	{
+	}
+
 	PluginTreeBuilder::PluginTreeBuilder ()
 	{
 	}
@@ -92,6 +108,11 @@ namespace LeechCraft
 		Instances_ << objs;
 	}
 
+	void PluginTreeBuilder::AddManifests (const QHash<QString, PluginManifest::Entry>& manifests)
+	{
+		Manifests_.unite (manifests);
+	}
+
 	void PluginTreeBuilder::RemoveObject (QObject *obj)
 	{
 		Instances_.removeAll (obj);
@@ -141,7 +162,7 @@ namespace LeechCraft
 			G_ [u].IsFulfilled_ = G_ [u].UnfulfilledFeatureDeps_.isEmpty () &&
 					G_ [u].UnfulfilledP2PDeps_.isEmpty ();
 			if (!G_ [u].IsFulfilled_)
-				qWarning () << qobject_cast<IInfo*> (G_ [u].Object_)->GetName ()
+				qWarning () << G_ [u].Name_
 						<< "failed to initialize because of:"
 						<< G_ [u].UnfulfilledFeatureDeps_
 						<< G_ [u].UnfulfilledP2PDeps_;
@@ -182,6 +203,8 @@ namespace LeechCraft
 		Graph_.clear ();
 		Object2Vertex_.clear ();
 		Result_.clear ();
+		ResultPaths_.clear ();
+		Dependencies_.clear ();
 
 		CreateGraph ();
 		const auto& edge2vert = MakeEdges ();
@@ -211,7 +234,21 @@ namespace LeechCraft
 		QList<Vertex_t> vertices;
 		boost::topological_sort (fulfilledSubgraph, std::back_inserter (vertices));
 		for (const auto& vertex : vertices)
-			Result_ << fulfilledSubgraph [vertex].Object_;
+		{
+			const auto& info = fulfilledSubgraph [vertex];
+			if (info.Object_)
+				Result_ << info.Object_;
+			else
+				ResultPaths_ << info.Path_;
+		}
+
+		for (const auto& pair : edge2vert)
+		{
+			const auto& dependent = Graph_ [pair.first];
+			const auto& dependency = Graph_ [pair.second];
+			if (dependent.IsFulfilled_ && dependent.Object_ && dependency.Object_)
+				Dependencies_ [dependent.Object_] << dependency.Object_;
+		}
 	}
 
 	QObjectList PluginTreeBuilder::GetResult () const
@@ -219,6 +256,16 @@ namespace LeechCraft
 		return Result_;
 	}
 
+	QStringList PluginTreeBuilder::GetResultPaths () const
+	{
+		return ResultPaths_;
+	}
+
+	QObjectList PluginTreeBuilder::GetDependencies (QObject *obj) const
+	{
+		return Dependencies_.value (obj);
+	}
+
 	void PluginTreeBuilder::CreateGraph ()
 	{
 		for (const auto object : Instances_)
@@ -240,6 +287,12 @@ namespace LeechCraft
 				continue;
 			}
 		}
+
+		for (auto i = Manifests_.begin (), end = Manifests_.end (); i != end; ++i)
+		{
+			const auto vertex = boost::add_vertex (Graph_);
+			Graph_ [vertex] = VertexInfo (i.key (), i.value ());
+		}
 	}
 
 	QMap<PluginTreeBuilder::Edge_t, QPair<PluginTreeBuilder::Vertex_t, PluginTreeBuilder::Vertex_t>> PluginTreeBuilder::MakeEdges ()
@@ -34,12 +34,14 @@
 #include <QObjectList>
 #include <QSet>
 #include <QHash>
+#include "pluginmanifest.h"
 
 namespace LeechCraft
 {
 	class PluginTreeBuilder
 	{
 		QObjectList Instances_;
+		QHash<QString, PluginManifest::Entry> Manifests_;
 
 		struct VertexInfo
 		{
@@ -63,8 +65,15 @@ namespace LeechCraft
 
 			QObject *Object_;
 
+			/* The path of the plugin library for the plugins added by
+			 * their manifests instead of instances.
+			 */
+			QString Path_;
+			QString Name_;
+
 			VertexInfo ();
 			VertexInfo (QObject*);
+			VertexInfo (const QString&, const PluginManifest::Entry&);
 		};
 
 		typedef boost::property<boost::vertex_color_t, boost::default_color_type,
@@ -80,13 +89,29 @@ namespace LeechCraft
 
 		QHash<QObject*, Vertex_t> Object2Vertex_;
 		QObjectList Result_;
+		QStringList ResultPaths_;
+		QHash<QObject*, QObjectList> Dependencies_;
 	public:
 		PluginTreeBuilder ();
 
 		void AddObjects (const QObjectList&);
+
+		/** Adds the not yet loaded plugins described by their manifest
+		 * entries, keyed by the library paths.
+		 */
+		void AddManifests (const QHash<QString, PluginManifest::Entry>&);
 		void RemoveObject (QObject*);
 		void Calculate ();
 		QObjectList GetResult () const;
+
+		/** Returns the library paths of the fulfilled plugins added by
+		 * their manifests, in the dependency order.
+		 */
+		QStringList GetResultPaths () const;
+
+		/** Returns the objects the given one directly depends on.
+		 */
+		QObjectList GetDependencies (QObject*) const;
 	private:
 		void CreateGraph ();
 		QMap<Edge_t, QPair<Vertex_t, Vertex_t>> MakeEdges ();
@@ -0,0 +1,160 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "startuptrace.h"
+#include <algorithm>
+#include <QCoreApplication>
+#include <QStringList>
+#include <QThread>
+#include <QtDebug>
+
+namespace LeechCraft
+{
+	StartupTrace::Scope::Scope (StartupTrace& trace, const QString& name, const QString& stage)
+	: Trace_ (trace)
+	, Name_ (name)
+	, Stage_ (stage)
+	, Start_ (trace.Now ())
+	{
+	}
+
+	StartupTrace::Scope::~Scope ()
+	{
+		Trace_.Record (Name_, Stage_, Start_, Trace_.Now () - Start_);
+	}
+
+	StartupTrace::StartupTrace ()
+	{
+		Timer_.start ();
+	}
+
+	qint64 StartupTrace::Now () const
+	{
+#if QT_VERSION >= 0x040800
+		return Timer_.nsecsElapsed () / 1000;
+#else
+		return Timer_.elapsed () * 1000;
+#endif
+	}
+
+	void StartupTrace::Record (const QString& name, const QString& stage, qint64 start, qint64 duration)
+	{
+		const auto thread = QThread::currentThread ();
+
+		QMutexLocker locker { &Mutex_ };
+		if (!ThreadIds_.contains (thread))
+			ThreadIds_ [thread] = ThreadIds_.size () + 1;
+		Events_.append ({ name, stage, start, duration, ThreadIds_ [thread] });
+	}
+
+	namespace
+	{
+		QByteArray Quote (const QString& str)
+		{
+			QByteArray result { "\"" };
+			for (const auto c : str)
+				switch (c.unicode ())
+				{
+				case '"':
+					result += "\\\"";
+					break;
+				case '\\':
+					result += "\\\\";
+					break;
+				default:
+					if (c.unicode () < 0x20)
+						result += "\\u" + QByteArray::number (c.unicode (), 16).rightJustified (4, '0');
+					else
+						result += QString { c }.toUtf8 ();
+					break;
+				}
+			return result + "\"";
+		}
+	}
+
+	QByteArray StartupTrace::ToChromeTrace () const
+	{
+		QMutexLocker locker { &Mutex_ };
+
+		const auto mainThread = QCoreApplication::instance () ?
+				QCoreApplication::instance ()->thread () :
+				nullptr;
+
+		QList<QByteArray> events;
+		for (auto i = ThreadIds_.begin (), end = ThreadIds_.end (); i != end; ++i)
+		{
+			const auto& threadName = i.key () == mainThread ?
+					QString { "main" } :
+					QString { "pool %1" }.arg (i.value ());
+			events << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" +
+					QByteArray::number (i.value ()) +
+					",\"args\":{\"name\":" + Quote (threadName) + "}}";
+		}
+
+		for (const auto& event : Events_)
+			events << "{\"name\":" + Quote (event.Name_) +
+					",\"cat\":" + Quote (event.Stage_) +
+					",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number (event.Thread_) +
+					",\"ts\":" + QByteArray::number (event.Start_) +
+					",\"dur\":" + QByteArray::number (event.Duration_) + "}";
+
+		QByteArray result { "{\"traceEvents\":[\n" };
+		for (int i = 0; i < events.size (); ++i)
+		{
+			if (i)
+				result += ",\n";
+			result += events.at (i);
+		}
+		result += "\n],\"displayTimeUnit\":\"ms\"}\n";
+		return result;
+	}
+
+	void StartupTrace::DumpSummary (int count) const
+	{
+		QList<Event> events;
+		{
+			QMutexLocker locker { &Mutex_ };
+			events = Events_;
+		}
+
+		std::stable_sort (events.begin (), events.end (),
+				[] (const Event& e1, const Event& e2) { return e1.Duration_ > e2.Duration_; });
+
+		QStringList lines;
+		for (const auto& event : events.mid (0, count))
+			lines << QString { "%1 (%2): %3 ms" }
+					.arg (event.Name_)
+					.arg (event.Stage_)
+					.arg (event.Duration_ / 1000.0, 0, 'f', 1);
+
+		qDebug () << Q_FUNC_INFO
+				<< "slowest plugin init stages:"
+				<< lines;
+	}
+}
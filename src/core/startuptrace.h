@@ -0,0 +1,105 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+class QThread;
+
+namespace LeechCraft
+{
+	/** @brief Records the time spent by plugins in each init stage.
+	 *
+	 * The recorded trace can be exported in the Chrome trace event
+	 * format, viewable in chrome://tracing or similar tools.
+	 *
+	 * This class is thread-safe.
+	 */
+	class StartupTrace
+	{
+		QElapsedTimer Timer_;
+
+		struct Event
+		{
+			QString Name_;
+			QString Stage_;
+			qint64 Start_;
+			qint64 Duration_;
+			int Thread_;
+		};
+
+		mutable QMutex Mutex_;
+		QList<Event> Events_;
+		QHash<QThread*, int> ThreadIds_;
+	public:
+		/** @brief Records an event for the lifetime of the object.
+		 */
+		class Scope
+		{
+			StartupTrace& Trace_;
+			const QString Name_;
+			const QString Stage_;
+			const qint64 Start_;
+		public:
+			Scope (StartupTrace&, const QString& name, const QString& stage);
+			~Scope ();
+
+			Scope (const Scope&) = delete;
+			Scope& operator= (const Scope&) = delete;
+		};
+
+		StartupTrace ();
+
+		/** @brief Returns the time since the trace creation in microseconds.
+		 */
+		qint64 Now () const;
+
+		/** @brief Records the event in the current thread.
+		 *
+		 * @param[in] name The name of the plugin.
+		 * @param[in] stage The name of the init stage.
+		 * @param[in] start The event start as returned by Now().
+		 * @param[in] duration The event duration in microseconds.
+		 */
+		void Record (const QString& name, const QString& stage, qint64 start, qint64 duration);
+
+		/** @brief Serializes the trace in the Chrome trace event format.
+		 */
+		QByteArray ToChromeTrace () const;
+
+		/** @brief Prints the slowest recorded events to the debug log.
+		 */
+		void DumpSummary (int count = 10) const;
+	};
+}
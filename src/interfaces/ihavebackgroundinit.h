@@ -0,0 +1,65 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QtPlugin>
+
+/** @brief Interface for plugins having thread-safe initialization work.
+ *
+ * Plugins whose initialization involves considerable blocking work not
+ * touching the GUI (like reading files or parsing resources) may
+ * implement this interface to have this work done off the main thread,
+ * in parallel with other plugins.
+ *
+ * BackgroundInit() is called on a thread from the global thread pool
+ * before IInfo::Init(). It is called only after BackgroundInit() of
+ * every plugin this one depends on (according to IInfo::Needs() and
+ * IPlugin2::GetPluginClasses()) has finished. IInfo::Init() is then
+ * called on the main thread, in the usual order, after this plugin's
+ * BackgroundInit() has finished.
+ *
+ * @sa IInfo::Init()
+ */
+class Q_DECL_EXPORT IHaveBackgroundInit
+{
+public:
+	virtual ~IHaveBackgroundInit () {}
+
+	/** @brief Performs the thread-safe part of the initialization.
+	 *
+	 * This function must not touch any GUI objects, must not use the
+	 * core proxy and must not leave any QObjects created during this
+	 * call living in the calling thread. Throwing an exception from
+	 * this function is treated as a failure of IInfo::Init().
+	 */
+	virtual void BackgroundInit () = 0;
+};
+
+Q_DECLARE_INTERFACE (IHaveBackgroundInit, "org.Deviant.LeechCraft.IHaveBackgroundInit/1.0");
@@ -0,0 +1,138 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QStringList>
+#include <QtPlugin>
+
+/** @brief Static routing keys of an entity handler or downloader.
+ *
+ * An entity matches the routing keys if at least one of the following
+ * holds:
+ * - Its MIME type (LeechCraft::Entity::Mime_) is listed in Mimes_.
+ *   A key ending with an asterisk (like <code>x-leechcraft/notification*</code>)
+ *   matches every MIME type starting with the part before the asterisk.
+ * - Its entity (LeechCraft::Entity::Entity_) is a QUrl or a string
+ *   whose URL scheme is listed in Schemes_. Schemes are compared
+ *   case-insensitively.
+ * - Its additional parameters (LeechCraft::Entity::Additional_)
+ *   contain a key listed in AdditionalKeys_.
+ * - The type name of its entity (as returned by QVariant::typeName(),
+ *   like <code>QByteArray</code> or <code>QList&lt;QUrl&gt;</code>)
+ *   is listed in Types_.
+ *
+ * @sa IHaveEntityRoutingKeys
+ */
+struct EntityRoutingKeys
+{
+	/** @brief The MIME types of the entities that could be handled.
+	 */
+	QStringList Mimes_;
+
+	/** @brief The URL schemes of the entities that could be handled.
+	 */
+	QStringList Schemes_;
+
+	/** @brief The keys in the additional parameters of the entities
+	 * that could be handled.
+	 */
+	QStringList AdditionalKeys_;
+
+	/** @brief The type names of the entities that could be handled
+	 * regardless of their MIME type.
+	 */
+	QStringList Types_;
+};
+
+/** @brief Interface for entity handlers declaring what entities they
+ * could handle.
+ *
+ * By default, IEntityHandler::CouldHandle() and IDownload::CouldDownload()
+ * of every plugin are called for every entity. A plugin implementing
+ * this interface guarantees that these functions return a priority of
+ * zero for every entity not matching the keys returned from
+ * GetEntityRoutingKeys(), so the core doesn't query it for such
+ * entities at all.
+ *
+ * Moreover, a plugin having nothing to do until the first matching
+ * entity arrives may allow the core to defer its instantiation by
+ * returning <code>true</code> from IsInstantiationDeferrable(). See the
+ * documentation of that function for the requirements.
+ *
+ * @sa EntityRoutingKeys, IEntityHandler, IDownload
+ */
+class Q_DECL_EXPORT IHaveEntityRoutingKeys
+{
+public:
+	virtual ~IHaveEntityRoutingKeys () {}
+
+	/** @brief Returns the routing keys of this plugin.
+	 *
+	 * The keys are queried once after the plugins are loaded and are
+	 * expected to stay the same during the whole plugin lifetime.
+	 *
+	 * The same keys are used for both IEntityHandler and IDownload
+	 * sides of the plugin, if it implements both.
+	 *
+	 * @return The routing keys of this plugin.
+	 */
+	virtual EntityRoutingKeys GetEntityRoutingKeys () const = 0;
+
+	/** @brief Returns whether the plugin could be loaded on demand.
+	 *
+	 * If this function returns <code>true</code>, the core may skip
+	 * loading this plugin on startup and load and initialize it only
+	 * when the first entity matching the keys returned from
+	 * GetEntityRoutingKeys() is dispatched. Until then the plugin is not
+	 * returned from IPluginsManager queries.
+	 *
+	 * Thus the plugin should only return <code>true</code> here if its
+	 * only duty is handling entities: it shouldn't provide any features
+	 * (IInfo::Provides()), be a second-level plugin or expect any, and
+	 * shouldn't do anything in IInfo::Init() or IInfo::SecondInit()
+	 * that is needed before it handles an entity. The core also ignores
+	 * this function for plugins not implementing either IEntityHandler
+	 * or IDownload.
+	 *
+	 * The value is recorded when the plugin is loaded and is expected
+	 * to stay the same for the same plugin library.
+	 *
+	 * The default implementation returns <code>false</code>.
+	 *
+	 * @return Whether the instantiation of this plugin could be
+	 * deferred.
+	 */
+	virtual bool IsInstantiationDeferrable () const
+	{
+		return false;
+	}
+};
+
+Q_DECLARE_INTERFACE (IHaveEntityRoutingKeys, "org.Deviant.LeechCraft.IHaveEntityRoutingKeys/1.0");
@@ -150,6 +150,11 @@ namespace AdvancedNotifications
 		return { Component_ };
 	}
 
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/notification*" }, {}, {} };
+	}
+
 	QSet<QByteArray> Plugin::GetExpectedPluginClasses () const
 	{
 		QSet<QByteArray> result;
@@ -34,6 +34,7 @@
 #include <QAction>
 #include <interfaces/iinfo.h>
 #include <interfaces/ientityhandler.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 #include <interfaces/ihavesettings.h>
 #include <interfaces/iactionsexporter.h>
 #include <interfaces/iquarkcomponentprovider.h>
@@ -54,6 +55,7 @@ namespace AdvancedNotifications
 				 , public IQuarkComponentProvider
 				 , public IPluginReady
 				 , public IANRulesStorage
+				 , public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
 		Q_INTERFACES (IInfo
@@ -62,7 +64,8 @@ namespace AdvancedNotifications
 				IActionsExporter
 				IQuarkComponentProvider
 				IPluginReady
-				IANRulesStorage)
+				IANRulesStorage
+				IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.AdvancedNotifications")
 
@@ -89,6 +92,8 @@ namespace AdvancedNotifications
 
 		QuarkComponents_t GetComponents () const;
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 		QSet<QByteArray> GetExpectedPluginClasses () const;
 		void AddPlugin (QObject*);
 
@@ -425,6 +425,17 @@ namespace Aggregator
 		Core::Instance ().Handle (e);
 	}
 
+	EntityRoutingKeys Aggregator::GetEntityRoutingKeys () const
+	{
+		return
+		{
+			{ "text/x-opml", "text/xml", "application/atom+xml", "application/rss+xml" },
+			{ "feed", "itpc" },
+			{},
+			{}
+		};
+	}
+
 	void Aggregator::SetShortcut (const QString& name, const QKeySequences_t& shortcuts)
 	{
 		Core::Instance ().GetShortcutManager ()->SetShortcut (name, shortcuts);
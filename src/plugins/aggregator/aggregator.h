@@ -44,6 +44,7 @@
 #include <interfaces/istartupwizard.h>
 #include <interfaces/ipluginready.h>
 #include <interfaces/ihaverecoverabletabs.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 
 class QSystemTrayIcon;
 class QTranslator;
@@ -71,6 +72,7 @@ namespace Aggregator
 					 , public IPluginReady
 					 , public IHaveRecoverableTabs
 					 , public IRecoverableTab
+					 , public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
 		Q_INTERFACES (IInfo
@@ -84,7 +86,8 @@ namespace Aggregator
 				IActionsExporter
 				IPluginReady
 				IHaveRecoverableTabs
-				IRecoverableTab)
+				IRecoverableTab
+				IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.Aggregator")
 
@@ -117,6 +120,8 @@ namespace Aggregator
 		EntityTestHandleResult CouldHandle (const LeechCraft::Entity&) const;
 		void Handle (LeechCraft::Entity);
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 		void SetShortcut (const QString&, const QKeySequences_t&);
 		QMap<QString, LeechCraft::ActionInfo> GetActionInfo () const;
 
@@ -57,8 +57,13 @@ namespace Aggregator
 		return true;
 	}
 	
+	bool Atom10Parser::IsItemElement (const QString& name, int depth) const
+	{
+		return depth == 1 && name == "entry";
+	}
+	
 	channels_container_t Atom10Parser::Parse (const QDomDocument& doc,
-			const IDType_t& feedId) const
+			const IDType_t& feedId, const ItemGetter_f& getter) const
 	{
 		channels_container_t channels;
 		Channel_ptr chan (new Channel (feedId));
@@ -85,7 +90,7 @@ namespace Aggregator
 		QDomElement entry = root.firstChildElement ("entry");
 		while (!entry.isNull ())
 		{
-			chan->Items_.push_back (Item_ptr (ParseItem (entry, chan->ChannelID_)));
+			chan->Items_.push_back (getter (entry, chan->ChannelID_));
 			entry = entry.nextSiblingElement ("entry");
 		}
 	
@@ -43,9 +43,10 @@ namespace Aggregator
 	public:
 		static Atom10Parser& Instance ();
 		virtual bool CouldParse (const QDomDocument&) const;
+		virtual bool IsItemElement (const QString&, int) const;
 	private:
 		channels_container_t Parse (const QDomDocument&,
-				const IDType_t&) const;
+				const IDType_t&, const ItemGetter_f&) const;
 		Item* ParseItem (const QDomElement&,
 				const IDType_t&) const;
 	};
@@ -0,0 +1,142 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <QStringList>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QVariantList>
+#include <util/db/dblock.h>
+#include "item.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	/** The maximum number of rows in a single multi-row INSERT.
+	 *
+	 * SQLite limits the number of host parameters in a query to 999 by
+	 * default, and the widest batch-inserted table (items) has 15
+	 * columns, so 64 rows is a safe limit.
+	 */
+	const int MaxRowsPerInsert = 64;
+
+	/** Returns the "(?, ?), (?, ?)" placeholders list for the given
+	 * number of \em columns and \em rows.
+	 */
+	inline QString MakeRowsPlaceholders (int columns, int rows)
+	{
+		QStringList row;
+		for (int i = 0; i < columns; ++i)
+			row << "?";
+		const auto& rowStr = "(" + row.join (", ") + ")";
+
+		QStringList result;
+		for (int i = 0; i < rows; ++i)
+			result << rowStr;
+		return result.join (", ");
+	}
+
+	/** @brief Inserts the \em rows using multi-row INSERTs.
+	 *
+	 * The \em insertPrefix should be the query up to and including the
+	 * VALUES keyword, like "INSERT INTO items (a, b) VALUES ". The
+	 * \em rowGetter should return the list of values of exactly
+	 * \em columns elements for each element of \em rows.
+	 *
+	 * This function doesn't start a transaction by itself.
+	 *
+	 * @throw std::runtime_error If the query fails.
+	 */
+	template<typename Cont, typename RowGetter>
+	void InsertRows (const QSqlDatabase& db, const QString& insertPrefix,
+			int columns, const Cont& rows, RowGetter rowGetter)
+	{
+		QSqlQuery fullChunk (db);
+		bool fullChunkPrepared = false;
+
+		const int size = rows.size ();
+		for (int pos = 0; pos < size; pos += MaxRowsPerInsert)
+		{
+			const auto count = std::min (MaxRowsPerInsert, size - pos);
+
+			QSqlQuery partialChunk (db);
+			auto& query = count == MaxRowsPerInsert ? fullChunk : partialChunk;
+			if (count != MaxRowsPerInsert || !fullChunkPrepared)
+			{
+				query.prepare (insertPrefix + MakeRowsPlaceholders (columns, count));
+				if (count == MaxRowsPerInsert)
+					fullChunkPrepared = true;
+			}
+
+			int bindPos = 0;
+			for (int i = pos; i < pos + count; ++i)
+				for (const auto& value : rowGetter (rows [i]))
+					query.bindValue (bindPos++, value);
+
+			Util::DBLock::Execute (query);
+			query.finish ();
+		}
+	}
+
+	/** The prefix for multi-row inserts into the items table, with the
+	 * columns order matching ItemToRow().
+	 */
+	const QString ItemsInsertPrefix = "INSERT INTO items ("
+			"item_id, channel_id, title, url, description, author, category, guid, pub_date, "
+			"unread, num_comments, comments_url, comments_page_url, latitude, longitude"
+			") VALUES ";
+
+	const int ItemsColumnsCount = 15;
+
+	inline QVariantList ItemToRow (const Item_ptr& item)
+	{
+		return
+		{
+			item->ItemID_,
+			item->ChannelID_,
+			item->Title_,
+			item->Link_,
+			item->Description_,
+			item->Author_,
+			item->Categories_.join ("<<<"),
+			item->Guid_,
+			item->PubDate_,
+			item->Unread_,
+			item->NumComments_,
+			item->CommentsLink_,
+			item->CommentsPageLink_,
+			QString::number (item->Latitude_),
+			QString::number (item->Longitude_)
+		};
+	}
+}
+}
@@ -33,9 +33,11 @@
 #include <QtDebug>
 #include <QImage>
 #include <QDir>
+#include <QFileInfo>
 #include <QDesktopServices>
 #include <QUrl>
 #include <QTimer>
+#include <QCoreApplication>
 #include <QTextCodec>
 #include <QXmlStreamWriter>
 #include <QNetworkReply>
@@ -49,6 +51,7 @@
 #include <util/sys/paths.h>
 #include <util/xpc/defaulthookproxy.h>
 #include <util/shortcuts/shortcutmanager.h>
+#include <util/sll/futures.h>
 #include "core.h"
 #include "regexpmatchermanager.h"
 #include "xmlsettingsmanager.h"
@@ -73,6 +76,8 @@
 #include "tovarmaps.h"
 #include "dumbstorage.h"
 #include "storagebackendmanager.h"
+#include "streamparser.h"
+#include "fetchscheduler.h"
 
 namespace LeechCraft
 {
@@ -85,6 +90,7 @@ namespace Aggregator
 	, ChannelsFilterModel_ (0)
 	, Initialized_ (false)
 	, ReprWidget_ (0)
+	, FetchScheduler_ (nullptr)
 	, PluginManager_ (nullptr)
 	, DBUpThread_ (new DBUpdateThread (this))
 	, ShortcutMgr_ (nullptr)
@@ -122,6 +128,14 @@ namespace Aggregator
 		if (DBUpThread_->isRunning ())
 			DBUpThread_->terminate ();
 
+		// The feeds stored by the DB thread commit their validators
+		// via queued calls, so deliver them before saving.
+		if (FetchScheduler_)
+		{
+			QCoreApplication::sendPostedEvents (FetchScheduler_, QEvent::MetaCall);
+			FetchScheduler_->Release ();
+		}
+
 		XmlSettingsManager::Instance ()->Release ();
 	}
 
@@ -140,9 +154,10 @@ namespace Aggregator
 		PluginManager_->AddPlugin (plugin);
 	}
 
-	Util::IDPool<IDType_t>& Core::GetPool (PoolType type)
+	IDType_t Core::GetNextID (PoolType type)
 	{
-		return Pools_ [type];
+		QMutexLocker locker (&PoolsMutex_);
+		return Pools_ [type].GetID ();
 	}
 
 	bool Core::CouldHandle (const LeechCraft::Entity& e)
@@ -320,6 +335,16 @@ namespace Aggregator
 
 		JobHolderRepresentation_ = new JobHolderRepresentation ();
 
+		FetchScheduler_ = new FetchScheduler (Proxy_->GetNetworkAccessManager (), this);
+		connect (FetchScheduler_,
+				SIGNAL (feedFetched (IDType_t, QString, QString)),
+				this,
+				SLOT (handleFeedFetched (IDType_t, QString, QString)));
+		connect (FetchScheduler_,
+				SIGNAL (feedFetchFailed (IDType_t, QString, QString)),
+				this,
+				SLOT (handleFeedFetchFailed (IDType_t, QString, QString)));
+
 		connect (DBUpThread_,
 				SIGNAL (started ()),
 				this,
@@ -402,7 +427,10 @@ namespace Aggregator
 
 	bool Core::ReinitStorage ()
 	{
-		Pools_.clear ();
+		{
+			QMutexLocker locker (&PoolsMutex_);
+			Pools_.clear ();
+		}
 		ChannelsModel_->Clear ();
 
 		StorageBackend_.reset (new DumbStorage);
@@ -470,6 +498,7 @@ namespace Aggregator
 						{ ChannelsModel_->AddChannel (chan); });
 		}
 
+		QMutexLocker locker (&PoolsMutex_);
 		for (int type = 0; type < PTMAX; ++type)
 		{
 			Util::IDPool<IDType_t> pool;
@@ -563,6 +592,7 @@ namespace Aggregator
 			emit channelRemoved (shorts [i].ChannelID_);
 		}
 		StorageBackend_->RemoveFeed (channel.FeedID_);
+		FetchScheduler_->Forget (channel.FeedID_);
 
 		UpdateUnreadItemsNumber ();
 	}
@@ -1118,78 +1148,108 @@ namespace Aggregator
 		PendingJobs_.remove (id);
 		ID2Downloader_.remove (id);
 
-		Util::FileRemoveGuard file (pj.Filename_);
-		if (!file.open (QIODevice::ReadOnly))
+		if (pj.Role_ == PendingJob::RFeedExternalData)
 		{
-			qWarning () << Q_FUNC_INFO << "could not open file for pj " << pj.Filename_;
+			Util::FileRemoveGuard file (pj.Filename_);
+			if (!file.open (QIODevice::ReadOnly))
+			{
+				qWarning () << Q_FUNC_INFO << "could not open file for pj " << pj.Filename_;
+				return;
+			}
+			if (!file.size ())
+				return;
+
+			HandleExternalData (pj.URL_, file);
+			UpdateUnreadItemsNumber ();
+			scheduleSave ();
 			return;
 		}
-		if (!file.size ())
+
+		ParseFeedFile (pj);
+	}
+
+	void Core::ParseFeedFile (const PendingJob& pj)
+	{
+		if (!QFileInfo (pj.Filename_).size ())
 		{
-			if (pj.Role_ != PendingJob::RFeedExternalData)
-				ErrorNotification (tr ("Feed error"),
-						tr ("Downloaded file from url %1 has null size.").arg (pj.URL_));
+			QFile::remove (pj.Filename_);
+			ErrorNotification (tr ("Feed error"),
+					tr ("Downloaded file from url %1 has null size.").arg (pj.URL_));
 			return;
 		}
 
-		channels_container_t channels;
-		if (pj.Role_ != PendingJob::RFeedExternalData)
-		{
-			QByteArray data = file.readAll ();
-			QDomDocument doc;
-			QString errorMsg;
-			int errorLine, errorColumn;
-			if (!doc.setContent (data, true, &errorMsg, &errorLine, &errorColumn))
-			{
-				file.copy (QDir::tempPath () + "/failedFile.xml");
-				ErrorNotification (tr ("Feed error"),
-						tr ("XML file parse error: %1, line %2, column %3, filename %4, from %5")
-						.arg (errorMsg)
-						.arg (errorLine)
-						.arg (errorColumn)
-						.arg (pj.Filename_)
-						.arg (pj.URL_));
-				return;
-			}
+		Util::ExecuteFuture ([] (const QString& filename)
+				{
+					return QtConcurrent::run ([filename] () -> StreamParser::Result
+						{
+							Util::FileRemoveGuard file (filename);
+							if (!file.open (QIODevice::ReadOnly))
+								return { StreamParser::Result::Status::ParseError, file.errorString (), 0, 0, {} };
+
+							const auto& result = StreamParser {}.Parse (&file, IDNotFound);
+							if (result.Status_ != StreamParser::Result::Status::Success)
+								file.copy (QDir::tempPath () + "/failedFile.xml");
+							return result;
+						});
+				},
+				[this, pj] (const StreamParser::Result& result) { HandleFeedParsed (result, pj); },
+				this,
+				pj.Filename_);
+	}
 
-			Parser *parser = ParserFactory::Instance ().Return (doc);
-			if (!parser)
-			{
-				file.copy (QDir::tempPath () + "/failedFile.xml");
-				ErrorNotification (tr ("Feed error"),
-						tr ("Could not find parser to parse file %1 from %2")
-						.arg (pj.Filename_)
-						.arg (pj.URL_));
-				return;
-			}
+	void Core::HandleFeedParsed (const StreamParser::Result& result, const PendingJob& pj)
+	{
+		if (result.Status_ != StreamParser::Result::Status::Success &&
+				pj.Role_ == PendingJob::RFeedUpdated)
+			FetchScheduler_->DropValidators (StorageBackend_->FindFeed (pj.URL_));
 
-			IDType_t feedId = IDNotFound;
-			if (pj.Role_ == PendingJob::RFeedAdded)
-			{
-				const auto& feed = std::make_shared<Feed> ();
-				feed->URL_ = pj.URL_;
-				StorageBackend_->AddFeed (feed);
-				feedId = feed->FeedID_;
-			}
-			else
-				feedId = StorageBackend_->FindFeed (pj.URL_);
+		switch (result.Status_)
+		{
+		case StreamParser::Result::Status::Success:
+			break;
+		case StreamParser::Result::Status::ParseError:
+			ErrorNotification (tr ("Feed error"),
+					tr ("XML file parse error: %1, line %2, column %3, filename %4, from %5")
+					.arg (result.ErrorString_)
+					.arg (result.ErrorLine_)
+					.arg (result.ErrorColumn_)
+					.arg (pj.Filename_)
+					.arg (pj.URL_));
+			return;
+		case StreamParser::Result::Status::NoParser:
+			ErrorNotification (tr ("Feed error"),
+					tr ("Could not find parser to parse file %1 from %2")
+					.arg (pj.Filename_)
+					.arg (pj.URL_));
+			return;
+		}
 
-			if (feedId == IDNotFound)
-			{
-				ErrorNotification (tr ("Feed error"),
-						tr ("Feed with url %1 not found.").arg (pj.URL_));
-				return;
-			}
+		IDType_t feedId = IDNotFound;
+		if (pj.Role_ == PendingJob::RFeedAdded)
+		{
+			const auto& feed = std::make_shared<Feed> ();
+			feed->URL_ = pj.URL_;
+			StorageBackend_->AddFeed (feed);
+			feedId = feed->FeedID_;
+		}
+		else
+			feedId = StorageBackend_->FindFeed (pj.URL_);
 
-			channels = parser->ParseFeed (doc, feedId);
+		if (feedId == IDNotFound)
+		{
+			ErrorNotification (tr ("Feed error"),
+					tr ("Feed with url %1 not found.").arg (pj.URL_));
+			return;
 		}
 
+		const auto& channels = result.Channels_;
+		for (const auto& channel : channels)
+			channel->FeedID_ = feedId;
+
 		if (pj.Role_ == PendingJob::RFeedAdded)
 			HandleFeedAdded (channels, pj);
 		else if (pj.Role_ == PendingJob::RFeedUpdated)
 			HandleFeedUpdated (channels, pj);
-		else if (pj.Role_ == PendingJob::RFeedExternalData)
-			HandleExternalData (pj.URL_, file);
 		UpdateUnreadItemsNumber ();
 		scheduleSave ();
 	}
@@ -1387,54 +1447,9 @@ namespace Aggregator
 		}
 	}
 
-	void Core::rotateUpdatesQueue ()
+	void Core::handleFeedFetched (IDType_t, const QString& url, const QString& filename)
 	{
-		if (UpdatesQueue_.isEmpty ())
-			return;
-
-		const IDType_t id = UpdatesQueue_.takeFirst ();
-
-		if (!UpdatesQueue_.isEmpty ())
-			QTimer::singleShot (2000,
-					this,
-					SLOT (rotateUpdatesQueue ()));
-
-		QString url = StorageBackend_->GetFeed (id)->URL_;
-		for (int key : PendingJobs_.keys ())
-			if (PendingJobs_ [key].URL_ == url)
-			{
-				QObject *provider = ID2Downloader_ [key];
-				IDownload *downloader = qobject_cast<IDownload*> (provider);
-				if (downloader)
-				{
-					qWarning () << Q_FUNC_INFO
-						<< "stalled task detected from"
-						<< downloader
-						<< "trying to kill...";
-					downloader->KillTask (key);
-					ID2Downloader_.remove (key);
-					PendingJobs_.remove (key);
-					qWarning () << Q_FUNC_INFO
-						<< "killed!";
-				}
-				else
-					qWarning () << Q_FUNC_INFO
-						<< "provider is not a downloader:"
-						<< provider
-						<< "; cannot kill the task";
-			}
-
-		QString filename = Util::GetTemporaryName ();
-
-		Entity e = Util::MakeEntity (QUrl (url),
-				filename,
-				LeechCraft::Internal |
-					LeechCraft::DoNotNotifyUser |
-					LeechCraft::DoNotSaveInHistory |
-					LeechCraft::NotPersistent |
-					LeechCraft::DoNotAnnounceEntity);
-
-		PendingJob pj =
+		const PendingJob pj
 		{
 			PendingJob::RFeedUpdated,
 			url,
@@ -1442,22 +1457,18 @@ namespace Aggregator
 			QStringList (),
 			std::shared_ptr<Feed::FeedSettings> ()
 		};
+		ParseFeedFile (pj);
+	}
 
-		int jobId = -1;
-		QObject *pr;
-		emit delegateEntity (e, &jobId, &pr);
-		if (jobId == -1)
-		{
-			qWarning () << Q_FUNC_INFO << url << "wasn't delegated";
-			emit gotEntity (Util::MakeNotification ("Aggregator",
-					tr ("Could not find plugin for feed with URL %1")
-						.arg (url), LeechCraft::PCritical_));
+	void Core::handleFeedFetchFailed (IDType_t, const QString& url, const QString& errorString)
+	{
+		if (XmlSettingsManager::Instance ()->property ("BeSilent").toBool ())
 			return;
-		}
 
-		HandleProvider (pr, jobId);
-		PendingJobs_ [jobId] = pj;
-		Updates_ [id] = QDateTime::currentDateTime ();
+		ErrorNotification (tr ("Download error"),
+				tr ("Unable to update feed %1:<br />%2")
+					.arg (url)
+					.arg (errorString));
 	}
 
 	void Core::handleDBUpThreadStarted ()
@@ -1476,6 +1487,11 @@ namespace Aggregator
 				SIGNAL (hookGotNewItems (LeechCraft::IHookProxy_ptr, QVariantList)),
 				this,
 				SIGNAL (hookGotNewItems (LeechCraft::IHookProxy_ptr, QVariantList)));
+		connect (DBUpThread_->GetWorker (),
+				SIGNAL (feedUpdated (IDType_t)),
+				FetchScheduler_,
+				SLOT (commitValidators (IDType_t)),
+				Qt::QueuedConnection);
 	}
 
 	void Core::handleDBUpGotNewChannel (const ChannelShort& chSh)
@@ -1641,12 +1657,8 @@ namespace Aggregator
 
 	void Core::UpdateFeed (const IDType_t& id)
 	{
-		if (UpdatesQueue_.isEmpty ())
-			QTimer::singleShot (500,
-					this,
-					SLOT (rotateUpdatesQueue ()));
-
-		UpdatesQueue_ << id;
+		FetchScheduler_->Schedule (id, StorageBackend_->GetFeed (id)->URL_);
+		Updates_ [id] = QDateTime::currentDateTime ();
 	}
 
 	void Core::HandleProvider (QObject *provider, int id)
@@ -36,6 +36,7 @@
 #include <QPair>
 #include <QList>
 #include <QDateTime>
+#include <QMutex>
 #include <interfaces/idownload.h>
 #include <interfaces/core/icoreproxy.h>
 #include <interfaces/core/ihookproxy.h>
@@ -45,6 +46,7 @@
 #include "feed.h"
 #include "storagebackend.h"
 #include "actionsstructs.h"
+#include "streamparser.h"
 
 class QTimer;
 class QNetworkReply;
@@ -63,6 +65,7 @@ namespace Util
 namespace Aggregator
 {
 	class DBUpdateThread;
+	class FetchScheduler;
 	class ChannelsModel;
 	class JobHolderRepresentation;
 	class ChannelsFilterModel;
@@ -127,7 +130,7 @@ namespace Aggregator
 		AppWideActions AppWideActions_;
 		ItemsWidget *ReprWidget_;
 
-		QList<IDType_t> UpdatesQueue_;
+		FetchScheduler *FetchScheduler_;
 
 		PluginManager *PluginManager_;
 
@@ -138,6 +141,7 @@ namespace Aggregator
 		Core ();
 	private:
 		QHash<PoolType, Util::IDPool<IDType_t>> Pools_;
+		QMutex PoolsMutex_;
 	public:
 		struct ChannelInfo
 		{
@@ -158,7 +162,13 @@ namespace Aggregator
 
 		void AddPlugin (QObject*);
 
-		Util::IDPool<IDType_t>& GetPool (PoolType);
+		/** Returns the next ID from the pool of the given type.
+			*
+			* This function is thread-safe, so items, channels and
+			* friends may be created by the parsers running in the
+			* worker threads.
+			*/
+		IDType_t GetNextID (PoolType);
 
 		bool CouldHandle (const LeechCraft::Entity&);
 		void Handle (LeechCraft::Entity);
@@ -247,7 +257,8 @@ namespace Aggregator
 		void saveSettings ();
 		void handleChannelDataUpdated (Channel_ptr);
 		void handleCustomUpdates ();
-		void rotateUpdatesQueue ();
+		void handleFeedFetched (IDType_t, const QString&, const QString&);
+		void handleFeedFetchFailed (IDType_t, const QString&, const QString&);
 
 		void handleDBUpThreadStarted ();
 		void handleDBUpGotNewChannel (const ChannelShort&);
@@ -256,6 +267,8 @@ namespace Aggregator
 		void FetchPixmap (const Channel_ptr&);
 		void FetchFavicon (const Channel_ptr&);
 		void HandleExternalData (const QString&, const QFile&);
+		void ParseFeedFile (const PendingJob&);
+		void HandleFeedParsed (const StreamParser::Result&, const PendingJob&);
 		void HandleFeedAdded (const channels_container_t&,
 				const PendingJob&);
 		void HandleFeedUpdated (const channels_container_t&,
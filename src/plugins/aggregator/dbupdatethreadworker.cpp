@@ -29,14 +29,19 @@
 
 #include "dbupdatethreadworker.h"
 #include <stdexcept>
-#include <boost/optional.hpp>
 #include <QUrl>
+#include <QSet>
+#include <QHash>
+#include <QFile>
+#include <QDataStream>
 #include <QtDebug>
+#include <util/sys/paths.h>
 #include <util/xpc/util.h>
 #include <util/xpc/defaulthookproxy.h>
 #include "xmlsettingsmanager.h"
 #include "core.h"
 #include "storagebackend.h"
+#include "storagebackendmanager.h"
 #include "regexpmatchermanager.h"
 #include "tovarmaps.h"
 
@@ -49,9 +54,9 @@ namespace Aggregator
 	{
 		try
 		{
-			const QString& strType = XmlSettingsManager::Instance ()->
+			StorageType_ = XmlSettingsManager::Instance ()->
 					property ("StorageType").toString ();
-			SB_ = StorageBackend::Create (strType, "_UpdateThread");
+			SB_ = StorageBackend::Create (StorageType_, "_UpdateThread");
 		}
 		catch (const std::runtime_error& s)
 		{
@@ -67,6 +72,64 @@ namespace Aggregator
 		}
 
 		SB_->Prepare ();
+
+		connect (&StorageBackendManager::Instance (),
+				SIGNAL (itemsRemoved (QSet<IDType_t>)),
+				this,
+				SLOT (handleItemsRemoved (QSet<IDType_t>)));
+
+		LoadIndex ();
+	}
+
+	DBUpdateThreadWorker::~DBUpdateThreadWorker ()
+	{
+		if (SB_)
+			SaveIndex ();
+	}
+
+	namespace
+	{
+		QString GetIndexPath ()
+		{
+			return Util::CreateIfNotExists ("aggregator").filePath ("itemsindex.dat");
+		}
+	}
+
+	void DBUpdateThreadWorker::LoadIndex ()
+	{
+		QFile file { GetIndexPath () };
+		if (!file.open (QIODevice::ReadOnly))
+			return;
+
+		QDataStream in { &file };
+		QString storageType;
+		in >> storageType;
+		if (storageType == StorageType_)
+			Index_.Load (in);
+
+		// The index is only valid as long as it is kept in sync with the
+		// storage, so it is removed until it is saved again on a clean
+		// shutdown. A crash thus leads to a rebuild instead of using a
+		// stale index.
+		file.close ();
+		file.remove ();
+	}
+
+	void DBUpdateThreadWorker::SaveIndex () const
+	{
+		QFile file { GetIndexPath () };
+		if (!file.open (QIODevice::WriteOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< file.fileName ()
+					<< file.errorString ();
+			return;
+		}
+
+		QDataStream out { &file };
+		out << StorageType_;
+		Index_.Save (out);
 	}
 
 	Feed::FeedSettings DBUpdateThreadWorker::GetFeedSettings (IDType_t feedId)
@@ -117,6 +180,12 @@ namespace Aggregator
 		channel->Items_.resize (truncateAt);
 
 		SB_->AddChannel (channel);
+
+		Index_.AddChannel (channel->ChannelID_);
+		for (const auto& item : channel->Items_)
+			Index_.Add (channel->ChannelID_, item->ItemID_,
+					item->Title_, item->Link_, ItemsIndex::HashContents (*item));
+
 		emit gotNewChannel (channel->ToShort ());
 
 		QString str = tr ("Added channel \"%1\" (%n item(s))",
@@ -126,8 +195,8 @@ namespace Aggregator
 		emit gotEntity (Util::MakeNotification ("Aggregator", str, PInfo_));
 	}
 
-	bool DBUpdateThreadWorker::AddItem (const Item_ptr& item, const Channel_ptr& channel,
-			const QVariantMap& channelDataMap, const Feed::FeedSettings& settings)
+	bool DBUpdateThreadWorker::PrepareNewItem (const Item_ptr& item, const Channel_ptr& channel,
+			const Feed::FeedSettings& settings)
 	{
 		if (item->PubDate_.isValid ())
 		{
@@ -138,31 +207,40 @@ namespace Aggregator
 			item->FixDate ();
 
 		item->ChannelID_ = channel->ChannelID_;
-		SB_->AddItem (item);
+		return true;
+	}
 
-		RegexpMatcherManager::Instance ().HandleItem (item);
+	void DBUpdateThreadWorker::HandleNewItems (const items_container_t& items, const Channel_ptr& channel,
+			const QVariantMap& channelDataMap, const Feed::FeedSettings& settings)
+	{
+		if (items.empty ())
+			return;
 
-		QVariantList itemData;
-		itemData << GetItemMapItemPart (item).unite (channelDataMap);
-		emit hookGotNewItems (Util::DefaultHookProxy_ptr (new Util::DefaultHookProxy),
-				itemData);
+		QVariantList itemsData;
+		for (const auto& item : items)
+		{
+			RegexpMatcherManager::Instance ().HandleItem (item);
 
-		if (settings.AutoDownloadEnclosures_)
-			for (const auto& e : item->Enclosures_)
-			{
-				auto de = Util::MakeEntity (QUrl (e.URL_),
-						XmlSettingsManager::Instance ()->
-							property ("EnclosuresDownloadPath").toString (),
-						0,
-						e.Type_);
-				de.Additional_ [" Tags"] = channel->Tags_;
-				emit gotEntity (de);
-			}
+			itemsData << GetItemMapItemPart (item).unite (channelDataMap);
 
-		return true;
+			if (settings.AutoDownloadEnclosures_)
+				for (const auto& e : item->Enclosures_)
+				{
+					auto de = Util::MakeEntity (QUrl (e.URL_),
+							XmlSettingsManager::Instance ()->
+								property ("EnclosuresDownloadPath").toString (),
+							0,
+							e.Type_);
+					de.Additional_ [" Tags"] = channel->Tags_;
+					emit gotEntity (de);
+				}
+		}
+
+		emit hookGotNewItems (Util::DefaultHookProxy_ptr (new Util::DefaultHookProxy),
+				itemsData);
 	}
 
-	bool DBUpdateThreadWorker::UpdateItem (const Item_ptr& item, const Item_ptr& ourItem)
+	bool DBUpdateThreadWorker::MergeItem (const Item_ptr& item, const Item_ptr& ourItem)
 	{
 		if (!IsModified (ourItem, item))
 			return false;
@@ -191,11 +269,22 @@ namespace Aggregator
 				ourItem->MRSSEntries_ << entry;
 			}
 
-		SB_->UpdateItem (ourItem);
-
 		return true;
 	}
 
+	void DBUpdateThreadWorker::EnsureIndexed (IDType_t channelId)
+	{
+		if (Index_.HasChannel (channelId))
+			return;
+
+		items_shorts_t shorts;
+		SB_->GetItems (shorts, channelId);
+
+		Index_.AddChannel (channelId);
+		for (const auto& item : shorts)
+			Index_.Add (channelId, item.ItemID_, item.Title_, item.URL_);
+	}
+
 	void DBUpdateThreadWorker::NotifyUpdates (int newItems, int updatedItems, const Channel_ptr& channel)
 	{
 		const auto& method = XmlSettingsManager::Instance ()->
@@ -227,18 +316,9 @@ namespace Aggregator
 		SB_->ToggleChannelUnread (channel, state);
 	}
 
-	namespace
+	void DBUpdateThreadWorker::handleItemsRemoved (const QSet<IDType_t>& items)
 	{
-		// TODO CPP14 merge with plusadic
-		template<typename T, template<typename, typename...> class List = std::initializer_list>
-		boost::optional<T> GetFirst (const List<std::function<boost::optional<T> ()>>& producers)
-		{
-			for (const auto& prod : producers)
-					if (const auto& res = prod ())
-							return res;
-
-			return {};
-		}
+		Index_.Remove (items);
 	}
 
 	void DBUpdateThreadWorker::updateFeed (channels_container_t channels, QString url)
@@ -257,46 +337,119 @@ namespace Aggregator
 		const auto ipc = feedSettings.NumItems_;
 		const auto days = feedSettings.ItemAge_;
 
-		for (const auto& channel : channels)
+		try
 		{
-			Channel_ptr ourChannel;
-			try
+			for (const auto& channel : channels)
 			{
-				const auto ourChannelID = SB_->FindChannel (channel->Title_,
-						channel->Link_, feedId);
-				ourChannel = SB_->GetChannel (ourChannelID, feedId);
-			}
-			catch (const StorageBackend::ChannelNotFoundError&)
-			{
-				AddChannel (channel, feedSettings);
-				continue;
-			}
+				Channel_ptr ourChannel;
+				try
+				{
+					const auto ourChannelID = SB_->FindChannel (channel->Title_,
+							channel->Link_, feedId);
+					ourChannel = SB_->GetChannel (ourChannelID, feedId);
+				}
+				catch (const StorageBackend::ChannelNotFoundError&)
+				{
+					AddChannel (channel, feedSettings);
+					continue;
+				}
 
-			const auto& channelPart = GetItemMapChannelPart (ourChannel);
+				const auto& channelPart = GetItemMapChannelPart (ourChannel);
 
-			int newItems = 0;
-			int updatedItems = 0;
+				items_container_t newItems;
+				items_container_t updatedItems;
 
-			for (const auto& item : channel->Items_)
-			{
-				if (const auto& ourItemID = GetFirst<IDType_t> ({
-							[&] { return SB_->FindItem (item->Title_, item->Link_, ourChannel->ChannelID_); },
-							[&] { return SB_->FindItemByLink (item->Link_, ourChannel->ChannelID_); },
-							[&] { return SB_->FindItemByTitle (item->Title_, ourChannel->ChannelID_); }
-						}))
+				// The new items are only written after the loop, so the
+				// duplicates inside the same update should be caught and
+				// merged here, just like the ones from the earlier updates.
+				QHash<QString, int> newTitles;
+				QHash<QString, int> newLinks;
+				QList<quint64> newHashes;
+				QHash<IDType_t, Item_ptr> updatedByID;
+
+				EnsureIndexed (ourChannel->ChannelID_);
+
+				for (const auto& item : channel->Items_)
 				{
-					const auto& ourItem = SB_->GetItem (*ourItemID);
-					if (UpdateItem (item, ourItem))
-						++updatedItems;
+					auto newPos = newTitles.value (item->Title_, -1);
+					if (newPos == -1 && !item->Link_.isEmpty ())
+						newPos = newLinks.value (item->Link_, -1);
+					if (newPos != -1)
+					{
+						const auto& newItem = newItems [newPos];
+						if (MergeItem (item, newItem))
+							newHashes [newPos] = ItemsIndex::HashContents (*newItem);
+						continue;
+					}
+
+					const auto contentHash = ItemsIndex::HashContents (*item);
+					const auto& lookup = Index_.Find (ourChannel->ChannelID_,
+							item->Title_, item->Link_, contentHash);
+					if (lookup.Status_ == ItemsIndex::Status::Unchanged)
+						continue;
+
+					if (lookup.Status_ == ItemsIndex::Status::Modified)
+					{
+						try
+						{
+							auto ourItem = updatedByID.value (lookup.ItemID_);
+							const bool isUpdated = static_cast<bool> (ourItem);
+							if (!isUpdated)
+								ourItem = SB_->GetItem (lookup.ItemID_);
+
+							if (MergeItem (item, ourItem) && !isUpdated)
+							{
+								updatedItems.push_back (ourItem);
+								updatedByID [lookup.ItemID_] = ourItem;
+							}
+							Index_.SetContentHash (lookup.ItemID_, contentHash);
+							continue;
+						}
+						catch (const StorageBackend::ItemNotFoundError&)
+						{
+							// The item has been removed behind our back, so
+							// handle the incoming one as a new one.
+							Index_.Remove ({ lookup.ItemID_ });
+						}
+					}
+
+					if (PrepareNewItem (item, ourChannel, feedSettings))
+					{
+						newTitles [item->Title_] = newItems.size ();
+						if (!item->Link_.isEmpty ())
+							newLinks [item->Link_] = newItems.size ();
+						newItems.push_back (item);
+						newHashes.push_back (contentHash);
+					}
+				}
+
+				SB_->AddItems (newItems);
+				SB_->UpdateItems (updatedItems);
+
+				for (size_t i = 0; i < newItems.size (); ++i)
+				{
+					const auto& item = newItems [i];
+					Index_.Add (ourChannel->ChannelID_, item->ItemID_,
+							item->Title_, item->Link_, newHashes.at (i));
 				}
-				else if (AddItem (item, ourChannel, channelPart, feedSettings))
-					++newItems;
-			}
 
-			SB_->TrimChannel (ourChannel->ChannelID_, days, ipc);
+				HandleNewItems (newItems, ourChannel, channelPart, feedSettings);
 
-			NotifyUpdates (newItems, updatedItems, channel);
+				SB_->TrimChannel (ourChannel->ChannelID_, days, ipc);
+
+				NotifyUpdates (newItems.size (), updatedItems.size (), channel);
+			}
 		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to update"
+					<< url
+					<< e.what ();
+			return;
+		}
+
+		emit feedUpdated (feedId);
 	}
 }
 }
@@ -36,6 +36,7 @@
 #include "common.h"
 #include "channel.h"
 #include "feed.h"
+#include "itemsindex.h"
 
 namespace LeechCraft
 {
@@ -50,22 +51,40 @@ namespace Aggregator
 		Q_OBJECT
 
 		std::shared_ptr<StorageBackend> SB_;
+		QString StorageType_;
+
+		ItemsIndex Index_;
 	public:
 		DBUpdateThreadWorker (QObject* = 0);
+		~DBUpdateThreadWorker ();
 	private:
+		void LoadIndex ();
+		void SaveIndex () const;
+
 		Feed::FeedSettings GetFeedSettings (IDType_t);
 		void AddChannel (const Channel_ptr& channel, const Feed::FeedSettings& settings);
-		bool AddItem (const Item_ptr& item, const Channel_ptr& channel,
+		bool PrepareNewItem (const Item_ptr& item, const Channel_ptr& channel,
+				const Feed::FeedSettings& settings);
+		void HandleNewItems (const items_container_t& items, const Channel_ptr& channel,
 				const QVariantMap& channelDataMap, const Feed::FeedSettings& settings);
-		bool UpdateItem (const Item_ptr& item, const Item_ptr& ourItem);
+		bool MergeItem (const Item_ptr& item, const Item_ptr& ourItem);
+		void EnsureIndexed (IDType_t channelId);
 		void NotifyUpdates (int newItems, int updatedItems, const Channel_ptr& channel);
 	public slots:
 		void toggleChannelUnread (IDType_t channel, bool state);
 		void updateFeed (channels_container_t channels, QString url);
+	private slots:
+		void handleItemsRemoved (const QSet<IDType_t>& items);
 	signals:
 		void gotNewChannel (const ChannelShort&);
 		void gotEntity (const LeechCraft::Entity&);
 
+		/** @brief Emitted once the update of the feed is stored.
+		 *
+		 * @param[out] feedId The ID of the updated feed.
+		 */
+		void feedUpdated (IDType_t feedId);
+
 		void hookGotNewItems (LeechCraft::IHookProxy_ptr proxy,
 				QVariantList items);
 	};
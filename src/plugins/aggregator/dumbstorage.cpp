@@ -124,6 +124,10 @@ namespace Aggregator
 	{
 	}
 
+	void DumbStorage::AddItems (const items_container_t&)
+	{
+	}
+
 	void DumbStorage::UpdateChannel (Channel_ptr)
 	{
 	}
@@ -136,6 +140,10 @@ namespace Aggregator
 	{
 	}
 
+	void DumbStorage::UpdateItems (const items_container_t&)
+	{
+	}
+
 	void DumbStorage::UpdateItem (const ItemShort&)
 	{
 	}
@@ -58,9 +58,11 @@ namespace Aggregator
 		void AddFeed (Feed_ptr);
 		void AddChannel (Channel_ptr);
 		void AddItem (Item_ptr);
+		void AddItems (const items_container_t&);
 		void UpdateChannel (Channel_ptr);
 		void UpdateChannel (const ChannelShort&);
 		void UpdateItem (Item_ptr);
+		void UpdateItems (const items_container_t&);
 		void UpdateItem (const ItemShort&);
 		void RemoveItems (const QSet<IDType_t>&);
 		void RemoveChannel (const IDType_t&);
@@ -39,7 +39,7 @@ namespace Aggregator
 {
 	Feed::FeedSettings::FeedSettings (IDType_t feedId,
 			int ut, int ni, int ia, bool ade)
-	: SettingsID_ (Core::Instance ().GetPool (PTFeedSettings).GetID ())
+	: SettingsID_ (Core::Instance ().GetNextID (PTFeedSettings))
 	, FeedID_ (feedId)
 	, UpdateTimeout_ (ut)
 	, NumItems_ (ni)
@@ -60,7 +60,7 @@ namespace Aggregator
 	}
 	
 	Feed::Feed ()
-	: FeedID_ (Core::Instance ().GetPool (PTFeed).GetID ())
+	: FeedID_ (Core::Instance ().GetNextID (PTFeed))
 	{
 	}
 	
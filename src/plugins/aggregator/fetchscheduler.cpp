@@ -0,0 +1,371 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "fetchscheduler.h"
+#include <algorithm>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QFile>
+#include <QTimer>
+#include <QSettings>
+#include <QCoreApplication>
+#include <QtDebug>
+#include <util/sys/paths.h>
+#include "xmlsettingsmanager.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	namespace
+	{
+		const int RequestTimeout = 60 * 1000;
+		const int MaxRedirects = 5;
+
+		const int BaseBackoff = 30;
+		const int MaxBackoff = 60 * 60;
+
+		int GetLimit (const char *prop)
+		{
+			return std::max (XmlSettingsManager::Instance ()->property (prop).toInt (), 1);
+		}
+	}
+
+	FetchScheduler::FetchScheduler (QNetworkAccessManager *nam, QObject *parent)
+	: QObject (parent)
+	, NAM_ (nam)
+	, SaveScheduled_ (false)
+	, BackoffTimer_ (new QTimer (this))
+	{
+		BackoffTimer_->setSingleShot (true);
+		connect (BackoffTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (dispatch ()));
+
+		LoadValidators ();
+	}
+
+	void FetchScheduler::Schedule (IDType_t feedId, const QString& url)
+	{
+		if (Scheduled_.contains (feedId))
+			return;
+
+		Scheduled_ << feedId;
+		Queue_.append ({ feedId, QUrl (url), url, 0 });
+
+		QTimer::singleShot (0,
+				this,
+				SLOT (dispatch ()));
+	}
+
+	void FetchScheduler::Forget (IDType_t feedId)
+	{
+		const auto pos = std::find_if (Queue_.begin (), Queue_.end (),
+				[feedId] (const Job& job) { return job.FeedID_ == feedId; });
+		if (pos != Queue_.end ())
+		{
+			Queue_.erase (pos);
+			Scheduled_.remove (feedId);
+		}
+
+		PendingValidators_.remove (feedId);
+		if (Validators_.remove (feedId))
+			ScheduleSave ();
+	}
+
+	void FetchScheduler::DropValidators (IDType_t feedId)
+	{
+		PendingValidators_.remove (feedId);
+	}
+
+	void FetchScheduler::Release ()
+	{
+		if (SaveScheduled_)
+			saveValidators ();
+	}
+
+	void FetchScheduler::commitValidators (IDType_t feedId)
+	{
+		const auto pos = PendingValidators_.find (feedId);
+		if (pos == PendingValidators_.end ())
+			return;
+
+		if (pos->ETag_.isEmpty () && pos->LastModified_.isEmpty ())
+			Validators_.remove (feedId);
+		else
+			Validators_ [feedId] = *pos;
+		PendingValidators_.erase (pos);
+
+		ScheduleSave ();
+	}
+
+	void FetchScheduler::LoadValidators ()
+	{
+		QSettings settings (QCoreApplication::organizationName (),
+				QCoreApplication::applicationName () + "_Aggregator");
+		const int size = settings.beginReadArray ("FeedValidators");
+		for (int i = 0; i < size; ++i)
+		{
+			settings.setArrayIndex (i);
+			const auto feedId = settings.value ("FeedID").value<IDType_t> ();
+			Validators_ [feedId] =
+			{
+				settings.value ("ETag").toByteArray (),
+				settings.value ("LastModified").toByteArray ()
+			};
+		}
+		settings.endArray ();
+	}
+
+	void FetchScheduler::ScheduleSave ()
+	{
+		if (SaveScheduled_)
+			return;
+
+		SaveScheduled_ = true;
+		QTimer::singleShot (5000,
+				this,
+				SLOT (saveValidators ()));
+	}
+
+	void FetchScheduler::saveValidators ()
+	{
+		SaveScheduled_ = false;
+
+		QSettings settings (QCoreApplication::organizationName (),
+				QCoreApplication::applicationName () + "_Aggregator");
+		settings.beginWriteArray ("FeedValidators");
+		settings.remove ("");
+		int i = 0;
+		for (auto it = Validators_.begin (), end = Validators_.end (); it != end; ++it)
+		{
+			settings.setArrayIndex (i++);
+			settings.setValue ("FeedID", it.key ());
+			settings.setValue ("ETag", it->ETag_);
+			settings.setValue ("LastModified", it->LastModified_);
+		}
+		settings.endArray ();
+	}
+
+	void FetchScheduler::dispatch ()
+	{
+		const auto globalLimit = GetLimit ("MaxConcurrentUpdates");
+		const auto hostLimit = GetLimit ("MaxConcurrentUpdatesPerHost");
+
+		const auto& now = QDateTime::currentDateTime ();
+		QDateTime earliestBackoff;
+
+		for (auto it = Queue_.begin ();
+				it != Queue_.end () && Running_.size () < globalLimit; )
+		{
+			const auto& host = it->URL_.host ();
+			const auto hostPos = Hosts_.find (host);
+			if (hostPos != Hosts_.end ())
+			{
+				if (hostPos->NextAllowed_.isValid () && hostPos->NextAllowed_ > now)
+				{
+					if (!earliestBackoff.isValid () || hostPos->NextAllowed_ < earliestBackoff)
+						earliestBackoff = hostPos->NextAllowed_;
+					++it;
+					continue;
+				}
+
+				if (hostPos->Running_ >= hostLimit)
+				{
+					++it;
+					continue;
+				}
+			}
+
+			const auto job = *it;
+			it = Queue_.erase (it);
+			Start (job);
+		}
+
+		if (earliestBackoff.isValid () && !BackoffTimer_->isActive ())
+			BackoffTimer_->start (std::max<qint64> (now.msecsTo (earliestBackoff), 0));
+	}
+
+	void FetchScheduler::Start (const Job& job)
+	{
+		const auto& filename = Util::GetTemporaryName ();
+		const auto file = std::make_shared<QFile> (filename);
+		if (!file->open (QIODevice::WriteOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< filename
+					<< file->errorString ();
+			Scheduled_.remove (job.FeedID_);
+			emit feedFetchFailed (job.FeedID_, job.OrigURL_, file->errorString ());
+			return;
+		}
+
+		QNetworkRequest req (job.URL_);
+		const auto validatorsPos = Validators_.find (job.FeedID_);
+		if (validatorsPos != Validators_.end ())
+		{
+			if (!validatorsPos->ETag_.isEmpty ())
+				req.setRawHeader ("If-None-Match", validatorsPos->ETag_);
+			if (!validatorsPos->LastModified_.isEmpty ())
+				req.setRawHeader ("If-Modified-Since", validatorsPos->LastModified_);
+		}
+
+		const auto reply = NAM_->get (req);
+		Running_ [reply] = { job, filename, file };
+
+		auto& hostState = Hosts_ [job.URL_.host ()];
+		++hostState.Running_;
+
+		connect (reply,
+				SIGNAL (readyRead ()),
+				this,
+				SLOT (handleReadyRead ()));
+		connect (reply,
+				SIGNAL (finished ()),
+				this,
+				SLOT (handleFinished ()));
+
+		const auto timer = new QTimer (reply);
+		timer->setSingleShot (true);
+		timer->start (RequestTimeout);
+		connect (timer,
+				SIGNAL (timeout ()),
+				reply,
+				SLOT (abort ()));
+	}
+
+	void FetchScheduler::HandleSuccess (const QString& host)
+	{
+		auto pos = Hosts_.find (host);
+		if (pos == Hosts_.end ())
+			return;
+
+		pos->Failures_ = 0;
+		pos->NextAllowed_ = QDateTime ();
+		if (!pos->Running_)
+			Hosts_.erase (pos);
+	}
+
+	void FetchScheduler::HandleFailure (const QString& host, int retryAfter)
+	{
+		auto& state = Hosts_ [host];
+		++state.Failures_;
+
+		const auto shift = std::min (state.Failures_ - 1, 16);
+		auto backoff = std::min (BaseBackoff << shift, MaxBackoff);
+		backoff = std::max (backoff, std::min (retryAfter, MaxBackoff));
+		state.NextAllowed_ = QDateTime::currentDateTime ().addSecs (backoff);
+	}
+
+	void FetchScheduler::handleReadyRead ()
+	{
+		const auto reply = qobject_cast<QNetworkReply*> (sender ());
+		const auto pos = Running_.find (reply);
+		if (pos == Running_.end ())
+			return;
+
+		pos->File_->write (reply->readAll ());
+	}
+
+	void FetchScheduler::handleFinished ()
+	{
+		const auto reply = qobject_cast<QNetworkReply*> (sender ());
+		reply->deleteLater ();
+
+		const auto pos = Running_.find (reply);
+		if (pos == Running_.end ())
+			return;
+
+		const auto running = *pos;
+		Running_.erase (pos);
+
+		const auto& job = running.Job_;
+		const auto& host = job.URL_.host ();
+		--Hosts_ [host].Running_;
+
+		const auto& file = running.File_;
+		file->write (reply->readAll ());
+		file->close ();
+
+		const auto status = reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+		const auto& redirect = reply->attribute (QNetworkRequest::RedirectionTargetAttribute).toUrl ();
+
+		if (reply->error () == QNetworkReply::NoError &&
+				redirect.isValid () &&
+				job.Redirects_ < MaxRedirects)
+		{
+			file->remove ();
+			HandleSuccess (host);
+			Queue_.prepend ({ job.FeedID_, job.URL_.resolved (redirect), job.OrigURL_, job.Redirects_ + 1 });
+		}
+		else if (reply->error () == QNetworkReply::NoError && status == 304)
+		{
+			file->remove ();
+			HandleSuccess (host);
+			Scheduled_.remove (job.FeedID_);
+			emit feedNotModified (job.FeedID_);
+		}
+		else if (reply->error () == QNetworkReply::NoError && !redirect.isValid ())
+		{
+			HandleSuccess (host);
+
+			PendingValidators_ [job.FeedID_] =
+			{
+				reply->rawHeader ("ETag"),
+				reply->rawHeader ("Last-Modified")
+			};
+
+			Scheduled_.remove (job.FeedID_);
+			emit feedFetched (job.FeedID_, job.OrigURL_, running.Filename_);
+		}
+		else
+		{
+			file->remove ();
+
+			const auto retryAfter = reply->rawHeader ("Retry-After").toInt ();
+			if (status == 429 || status >= 500 || status == 0)
+				HandleFailure (host, retryAfter);
+			else
+				HandleSuccess (host);
+
+			Scheduled_.remove (job.FeedID_);
+
+			const auto& errorString = redirect.isValid () ?
+					tr ("too many redirects") :
+					reply->errorString ();
+			emit feedFetchFailed (job.FeedID_, job.OrigURL_, errorString);
+		}
+
+		dispatch ();
+	}
+}
+}
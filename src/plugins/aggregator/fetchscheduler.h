@@ -0,0 +1,196 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QUrl>
+#include <QDateTime>
+#include "common.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QFile;
+class QTimer;
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	/** @brief Fetches feeds for updating with bounded concurrency.
+	 *
+	 * Feeds scheduled for updating are fetched concurrently, with no
+	 * more than MaxConcurrentUpdates requests in flight at once, and no
+	 * more than MaxConcurrentUpdatesPerHost requests to the same host.
+	 *
+	 * Hosts that fail to respond (or respond with an error) are backed
+	 * off exponentially, honoring the Retry-After header if it is
+	 * present.
+	 *
+	 * The ETag and Last-Modified validators are remembered per feed and
+	 * sent back with the next request, so that feeds that haven't
+	 * changed are reported via feedNotModified() and don't need to be
+	 * parsed at all.
+	 *
+	 * The validators of a fetched feed only become effective after
+	 * CommitValidators() is called for the feed, that is, once its
+	 * contents are parsed and stored. Otherwise a feed whose update has
+	 * failed would be reported as not modified from then on.
+	 */
+	class FetchScheduler : public QObject
+	{
+		Q_OBJECT
+
+		QNetworkAccessManager * const NAM_;
+
+		struct Job
+		{
+			IDType_t FeedID_;
+			QUrl URL_;
+			QString OrigURL_;
+			int Redirects_;
+		};
+		QList<Job> Queue_;
+		QSet<IDType_t> Scheduled_;
+
+		struct RunningJob
+		{
+			Job Job_;
+			QString Filename_;
+			std::shared_ptr<QFile> File_;
+		};
+		QHash<QNetworkReply*, RunningJob> Running_;
+
+		struct HostState
+		{
+			int Running_;
+			int Failures_;
+			QDateTime NextAllowed_;
+		};
+		QHash<QString, HostState> Hosts_;
+
+		struct Validators
+		{
+			QByteArray ETag_;
+			QByteArray LastModified_;
+		};
+		QHash<IDType_t, Validators> Validators_;
+		QHash<IDType_t, Validators> PendingValidators_;
+		bool SaveScheduled_;
+
+		QTimer * const BackoffTimer_;
+	public:
+		FetchScheduler (QNetworkAccessManager*, QObject* = 0);
+
+		/** @brief Schedules fetching the feed with the given ID.
+		 *
+		 * Does nothing if the feed is already scheduled or being
+		 * fetched.
+		 *
+		 * @param[in] feedId The ID of the feed.
+		 * @param[in] url The URL of the feed.
+		 */
+		void Schedule (IDType_t feedId, const QString& url);
+
+		/** @brief Forgets everything about the given feed.
+		 *
+		 * This function should be called when the feed is removed.
+		 *
+		 * @param[in] feedId The ID of the feed.
+		 */
+		void Forget (IDType_t feedId);
+
+		/** @brief Discards the validators of the last fetch of the feed.
+		 *
+		 * This function should be called when the fetched contents of
+		 * the feed couldn't be handled.
+		 *
+		 * @param[in] feedId The ID of the feed.
+		 */
+		void DropValidators (IDType_t feedId);
+
+		/** @brief Saves the validators that are not saved yet.
+		 *
+		 * This function should be called before the plugin is
+		 * unloaded, otherwise the validators committed during the last
+		 * few seconds are lost.
+		 */
+		void Release ();
+	public slots:
+		/** @brief Makes the validators of the last fetch of the feed
+		 * effective.
+		 *
+		 * This function should be called when the fetched contents of
+		 * the feed are stored.
+		 *
+		 * @param[in] feedId The ID of the feed.
+		 */
+		void commitValidators (IDType_t feedId);
+	private:
+		void LoadValidators ();
+		void ScheduleSave ();
+
+		void Start (const Job&);
+		void HandleSuccess (const QString& host);
+		void HandleFailure (const QString& host, int retryAfter);
+	private slots:
+		void dispatch ();
+		void handleReadyRead ();
+		void handleFinished ();
+		void saveValidators ();
+	signals:
+		/** @brief Emitted when the feed has been fetched successfully.
+		 *
+		 * The receiver is responsible for removing the file.
+		 *
+		 * @param[out] feedId The ID of the feed.
+		 * @param[out] url The URL of the feed as it was scheduled.
+		 * @param[out] filename The name of the file with the contents.
+		 */
+		void feedFetched (IDType_t feedId, const QString& url, const QString& filename);
+
+		/** @brief Emitted when the server says the feed hasn't changed.
+		 *
+		 * @param[out] feedId The ID of the feed.
+		 */
+		void feedNotModified (IDType_t feedId);
+
+		/** @brief Emitted when the feed couldn't be fetched.
+		 *
+		 * @param[out] feedId The ID of the feed.
+		 * @param[out] url The URL of the feed as it was scheduled.
+		 * @param[out] errorString The human-readable error description.
+		 */
+		void feedFetchFailed (IDType_t feedId, const QString& url, const QString& errorString);
+	};
+}
+}
@@ -0,0 +1,382 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "itemsindex.h"
+#include <cstring>
+#include <QStringList>
+#include <QDateTime>
+#include <QDataStream>
+#include <QtDebug>
+#include "item.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	namespace
+	{
+		// 64-bit FNV-1a.
+		class Hasher
+		{
+			quint64 Value_ = 14695981039346656037ULL;
+		public:
+			quint64 Get () const
+			{
+				return Value_;
+			}
+
+			Hasher& Feed (const void *data, size_t size)
+			{
+				const auto bytes = static_cast<const uchar*> (data);
+				for (size_t i = 0; i < size; ++i)
+				{
+					Value_ ^= bytes [i];
+					Value_ *= 1099511628211ULL;
+				}
+				return *this;
+			}
+
+			Hasher& operator<< (quint64 num)
+			{
+				return Feed (&num, sizeof (num));
+			}
+
+			Hasher& operator<< (qint64 num)
+			{
+				return *this << static_cast<quint64> (num);
+			}
+
+			Hasher& operator<< (int num)
+			{
+				return *this << static_cast<quint64> (num);
+			}
+
+			Hasher& operator<< (bool val)
+			{
+				return *this << static_cast<quint64> (val);
+			}
+
+			Hasher& operator<< (double num)
+			{
+				quint64 bits = 0;
+				std::memcpy (&bits, &num, sizeof (bits));
+				return *this << bits;
+			}
+
+			Hasher& operator<< (const QString& str)
+			{
+				// The length is mixed in so that "ab" + "c" differs from "a" + "bc".
+				*this << static_cast<quint64> (str.size ());
+				return Feed (str.constData (), str.size () * sizeof (QChar));
+			}
+
+			Hasher& operator<< (const QStringList& list)
+			{
+				*this << static_cast<quint64> (list.size ());
+				for (const auto& str : list)
+					*this << str;
+				return *this;
+			}
+
+			Hasher& operator<< (const QDateTime& dt)
+			{
+				return *this << (dt.isValid () ? dt.toMSecsSinceEpoch () : static_cast<qint64> (-1));
+			}
+
+			template<typename T>
+			Hasher& operator<< (const QList<T>& list)
+			{
+				// IsModified() compares lists as sets, so the order
+				// shouldn't matter.
+				quint64 sum = 0;
+				for (const auto& elem : list)
+				{
+					Hasher h;
+					h << elem;
+					sum += h.Get ();
+				}
+				return *this << static_cast<quint64> (list.size ()) << sum;
+			}
+		};
+
+		Hasher& operator<< (Hasher& h, const Enclosure& e)
+		{
+			return h << e.URL_ << e.Type_ << e.Length_ << e.Lang_;
+		}
+
+		Hasher& operator<< (Hasher& h, const MRSSThumbnail& t)
+		{
+			return h << t.URL_ << t.Width_ << t.Height_ << t.Time_;
+		}
+
+		Hasher& operator<< (Hasher& h, const MRSSCredit& c)
+		{
+			return h << c.Role_ << c.Who_;
+		}
+
+		Hasher& operator<< (Hasher& h, const MRSSComment& c)
+		{
+			return h << c.Type_ << c.Comment_;
+		}
+
+		Hasher& operator<< (Hasher& h, const MRSSPeerLink& pl)
+		{
+			return h << pl.Type_ << pl.Link_;
+		}
+
+		Hasher& operator<< (Hasher& h, const MRSSScene& s)
+		{
+			return h << s.Title_ << s.Description_ << s.StartTime_ << s.EndTime_;
+		}
+
+		Hasher& operator<< (Hasher& h, const MRSSEntry& e)
+		{
+			return h << e.URL_ << e.Size_ << e.Type_ << e.Medium_
+					<< e.IsDefault_ << e.Expression_ << e.Bitrate_
+					<< e.Framerate_ << e.SamplingRate_ << e.Channels_
+					<< e.Duration_ << e.Width_ << e.Height_ << e.Lang_
+					<< e.Rating_ << e.RatingScheme_ << e.Title_
+					<< e.Description_ << e.Keywords_
+					<< e.CopyrightURL_ << e.CopyrightText_
+					<< e.RatingAverage_ << e.RatingCount_
+					<< e.RatingMin_ << e.RatingMax_
+					<< e.Views_ << e.Favs_ << e.Tags_
+					<< e.Thumbnails_ << e.Credits_ << e.Comments_
+					<< e.PeerLinks_ << e.Scenes_;
+		}
+
+		quint64 HashString (const QString& str)
+		{
+			Hasher h;
+			h << str;
+			return h.Get ();
+		}
+
+		quint64 HashPair (const QString& first, const QString& second)
+		{
+			Hasher h;
+			h << first << second;
+			return h.Get ();
+		}
+
+		IDType_t FirstValue (const QMultiHash<quint64, IDType_t>& hash, quint64 key)
+		{
+			const auto pos = hash.find (key);
+			return pos == hash.end () ? IDNotFound : *pos;
+		}
+	}
+
+	bool ItemsIndex::HasChannel (IDType_t channelId) const
+	{
+		return Channels_.contains (channelId);
+	}
+
+	void ItemsIndex::AddChannel (IDType_t channelId)
+	{
+		Channels_ [channelId];
+	}
+
+	void ItemsIndex::RemoveChannel (IDType_t channelId)
+	{
+		const auto pos = Channels_.find (channelId);
+		if (pos == Channels_.end ())
+			return;
+
+		for (const auto itemId : pos->ByTitleLink_)
+			Items_.remove (itemId);
+
+		Channels_.erase (pos);
+	}
+
+	void ItemsIndex::Add (IDType_t channelId, IDType_t itemId,
+			const QString& title, const QString& link, quint64 contentHash)
+	{
+		if (Items_.contains (itemId))
+			Remove ({ itemId });
+
+		const Entry entry
+		{
+			channelId,
+			HashPair (title, link),
+			link.isEmpty () ? 0 : HashString (link),
+			HashString (title),
+			contentHash
+		};
+		Items_ [itemId] = entry;
+
+		auto& channel = Channels_ [channelId];
+		channel.ByTitleLink_.insert (entry.TitleLink_, itemId);
+		if (!link.isEmpty ())
+			channel.ByLink_.insert (entry.Link_, itemId);
+		channel.ByTitle_.insert (entry.Title_, itemId);
+	}
+
+	void ItemsIndex::SetContentHash (IDType_t itemId, quint64 contentHash)
+	{
+		const auto pos = Items_.find (itemId);
+		if (pos != Items_.end ())
+			pos->Content_ = contentHash;
+	}
+
+	void ItemsIndex::Remove (const QSet<IDType_t>& itemIds)
+	{
+		for (const auto itemId : itemIds)
+		{
+			const auto pos = Items_.find (itemId);
+			if (pos == Items_.end ())
+				continue;
+
+			const auto chanPos = Channels_.find (pos->ChannelID_);
+			if (chanPos != Channels_.end ())
+			{
+				chanPos->ByTitleLink_.remove (pos->TitleLink_, itemId);
+				if (pos->Link_)
+					chanPos->ByLink_.remove (pos->Link_, itemId);
+				chanPos->ByTitle_.remove (pos->Title_, itemId);
+			}
+
+			Items_.erase (pos);
+		}
+	}
+
+	ItemsIndex::Lookup ItemsIndex::Find (IDType_t channelId,
+			const QString& title, const QString& link, quint64 contentHash) const
+	{
+		const auto chanPos = Channels_.find (channelId);
+		if (chanPos == Channels_.end ())
+			return { Status::New, IDNotFound };
+
+		auto itemId = FirstValue (chanPos->ByTitleLink_, HashPair (title, link));
+		if (itemId == IDNotFound && !link.isEmpty ())
+			itemId = FirstValue (chanPos->ByLink_, HashString (link));
+		if (itemId == IDNotFound)
+			itemId = FirstValue (chanPos->ByTitle_, HashString (title));
+
+		if (itemId == IDNotFound)
+			return { Status::New, IDNotFound };
+
+		const auto storedHash = Items_ [itemId].Content_;
+		const auto status = storedHash && storedHash == contentHash ?
+				Status::Unchanged :
+				Status::Modified;
+		return { status, itemId };
+	}
+
+	int ItemsIndex::GetItemsCount () const
+	{
+		return Items_.size ();
+	}
+
+	void ItemsIndex::Save (QDataStream& out) const
+	{
+		out << static_cast<quint8> (1);
+
+		out << static_cast<quint32> (Channels_.size ());
+		for (auto i = Channels_.begin (); i != Channels_.end (); ++i)
+			out << i.key ();
+
+		out << static_cast<quint32> (Items_.size ());
+		for (auto i = Items_.begin (); i != Items_.end (); ++i)
+			out << i.key ()
+					<< i->ChannelID_
+					<< i->TitleLink_
+					<< i->Link_
+					<< i->Title_
+					<< i->Content_;
+	}
+
+	bool ItemsIndex::Load (QDataStream& in)
+	{
+		Items_.clear ();
+		Channels_.clear ();
+
+		quint8 version = 0;
+		in >> version;
+		if (version != 1)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unknown version"
+					<< version;
+			return false;
+		}
+
+		quint32 channelsCount = 0;
+		in >> channelsCount;
+		for (quint32 i = 0; i < channelsCount && in.status () == QDataStream::Ok; ++i)
+		{
+			IDType_t channelId = 0;
+			in >> channelId;
+			Channels_ [channelId];
+		}
+
+		quint32 itemsCount = 0;
+		in >> itemsCount;
+		for (quint32 i = 0; i < itemsCount && in.status () == QDataStream::Ok; ++i)
+		{
+			IDType_t itemId = 0;
+			Entry entry;
+			in >> itemId
+					>> entry.ChannelID_
+					>> entry.TitleLink_
+					>> entry.Link_
+					>> entry.Title_
+					>> entry.Content_;
+			Items_ [itemId] = entry;
+
+			auto& channel = Channels_ [entry.ChannelID_];
+			channel.ByTitleLink_.insert (entry.TitleLink_, itemId);
+			if (entry.Link_)
+				channel.ByLink_.insert (entry.Link_, itemId);
+			channel.ByTitle_.insert (entry.Title_, itemId);
+		}
+
+		if (in.status () != QDataStream::Ok)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "truncated index";
+			Items_.clear ();
+			Channels_.clear ();
+			return false;
+		}
+
+		return true;
+	}
+
+	quint64 ItemsIndex::HashContents (const Item& item)
+	{
+		Hasher h;
+		h << item.Title_ << item.Link_ << item.Description_ << item.Author_
+				<< item.Categories_ << item.PubDate_ << item.NumComments_
+				<< item.CommentsLink_ << item.CommentsPageLink_
+				<< item.Latitude_ << item.Longitude_
+				<< item.Enclosures_ << item.MRSSEntries_;
+		return h.Get () ? h.Get () : 1;
+	}
+}
+}
@@ -0,0 +1,212 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include "common.h"
+
+class QDataStream;
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	struct Item;
+
+	/** @brief In-memory index of the items already known for channels.
+	 *
+	 * The index is used during feed updates to find out whether an
+	 * incoming item is new, has been seen before unchanged or has been
+	 * modified, without issuing a database query per incoming item.
+	 *
+	 * Items are looked up the same way StorageBackend::FindItem(),
+	 * StorageBackend::FindItemByLink() and
+	 * StorageBackend::FindItemByTitle() are tried in sequence: first by
+	 * the (title, link) pair, then by link alone (if it's not empty) and
+	 * then by title alone. Strings are keyed by their 64-bit hashes.
+	 *
+	 * Each known item may also have a content hash associated with it
+	 * (see HashContents()). If the content hash of an incoming item is
+	 * equal to the recorded one, the item is considered unchanged and
+	 * there is no need to fetch it from the storage and compare.
+	 *
+	 * The index can be persisted between runs via Save() and Load().
+	 *
+	 * The index is not thread-safe.
+	 */
+	class ItemsIndex
+	{
+		struct Entry
+		{
+			IDType_t ChannelID_;
+			quint64 TitleLink_;
+			quint64 Link_;
+			quint64 Title_;
+			quint64 Content_;
+		};
+		QHash<IDType_t, Entry> Items_;
+
+		struct ChannelIndex
+		{
+			QMultiHash<quint64, IDType_t> ByTitleLink_;
+			QMultiHash<quint64, IDType_t> ByLink_;
+			QMultiHash<quint64, IDType_t> ByTitle_;
+		};
+		QHash<IDType_t, ChannelIndex> Channels_;
+	public:
+		enum class Status
+		{
+			/** The item is not known.
+			 */
+			New,
+
+			/** The item is known, but its contents may differ from the
+			 * stored ones.
+			 */
+			Modified,
+
+			/** The item is known and its contents are the same as last
+			 * time they've been recorded.
+			 */
+			Unchanged
+		};
+
+		struct Lookup
+		{
+			Status Status_;
+
+			/** The ID of the matched item, or IDNotFound if Status_
+			 * is Status::New.
+			 */
+			IDType_t ItemID_;
+		};
+
+		/** @brief Checks whether the given channel has been indexed.
+		 *
+		 * @param[in] channelId The ID of the channel.
+		 * @return Whether AddChannel() has been called for the channel.
+		 */
+		bool HasChannel (IDType_t channelId) const;
+
+		/** @brief Marks the channel as indexed.
+		 *
+		 * The channel's items should be added via Add() afterwards.
+		 *
+		 * @param[in] channelId The ID of the channel.
+		 */
+		void AddChannel (IDType_t channelId);
+
+		/** @brief Forgets the channel and all its items.
+		 *
+		 * @param[in] channelId The ID of the channel.
+		 */
+		void RemoveChannel (IDType_t channelId);
+
+		/** @brief Adds the item to the index of the given channel.
+		 *
+		 * If the item is already in the index, its entry is replaced.
+		 *
+		 * @param[in] channelId The ID of the channel containing the item.
+		 * @param[in] itemId The ID of the item.
+		 * @param[in] title The title of the item.
+		 * @param[in] link The link of the item.
+		 * @param[in] contentHash The content hash of the item, or 0 if
+		 * it's unknown.
+		 */
+		void Add (IDType_t channelId, IDType_t itemId,
+				const QString& title, const QString& link, quint64 contentHash = 0);
+
+		/** @brief Updates the content hash recorded for the item.
+		 *
+		 * Does nothing if the item is not in the index.
+		 *
+		 * @param[in] itemId The ID of the item.
+		 * @param[in] contentHash The new content hash of the item.
+		 */
+		void SetContentHash (IDType_t itemId, quint64 contentHash);
+
+		/** @brief Removes the given items from the index.
+		 *
+		 * Unknown IDs are ignored.
+		 *
+		 * @param[in] itemIds The IDs of the items to remove.
+		 */
+		void Remove (const QSet<IDType_t>& itemIds);
+
+		/** @brief Looks up the item in the given channel.
+		 *
+		 * @param[in] channelId The ID of the channel to look in.
+		 * @param[in] title The title of the incoming item.
+		 * @param[in] link The link of the incoming item.
+		 * @param[in] contentHash The content hash of the incoming item.
+		 * @return The lookup result.
+		 */
+		Lookup Find (IDType_t channelId,
+				const QString& title, const QString& link, quint64 contentHash) const;
+
+		/** @brief Returns the number of indexed items.
+		 */
+		int GetItemsCount () const;
+
+		/** @brief Serializes the index into the given stream.
+		 *
+		 * @param[in] out The stream to write the index to.
+		 */
+		void Save (QDataStream& out) const;
+
+		/** @brief Replaces the contents of the index with the ones
+		 * previously saved by Save().
+		 *
+		 * If the stream contains an unknown version or is truncated,
+		 * the index is left empty.
+		 *
+		 * @param[in] in The stream to read the index from.
+		 * @return Whether the index has been loaded successfully.
+		 */
+		bool Load (QDataStream& in);
+
+		/** @brief Calculates the hash of the item's contents.
+		 *
+		 * Only the fields considered by IsModified() are taken into
+		 * account, and enclosures and MediaRSS entries are hashed
+		 * regardless of their order. Thus, if two items have equal
+		 * content hashes, IsModified() returns false for them (barring
+		 * hash collisions). The opposite doesn't necessarily hold.
+		 *
+		 * The returned value is never 0.
+		 *
+		 * @param[in] item The item to hash.
+		 * @return The content hash of the item.
+		 */
+		static quint64 HashContents (const Item& item);
+	};
+}
+}
@@ -68,7 +68,15 @@ namespace Aggregator
 
 	channels_container_t Parser::ParseFeed (const QDomDocument& recent, const IDType_t& feedId) const
 	{
-		channels_container_t newes = Parse (recent, feedId);
+		return ParseFeed (recent, feedId,
+				[this] (const QDomElement& elem, const IDType_t& channelId)
+					{ return Item_ptr (ParseItem (elem, channelId)); });
+	}
+
+	channels_container_t Parser::ParseFeed (const QDomDocument& recent,
+			const IDType_t& feedId, const ItemGetter_f& getter) const
+	{
+		channels_container_t newes = Parse (recent, feedId, getter);
 		for (const auto& newChannel : newes)
 		{
 			if (newChannel->Link_.isEmpty ())
@@ -30,6 +30,7 @@
 #ifndef PLUGINS_AGGREGATOR_PARSER_H
 #define PLUGINS_AGGREGATOR_PARSER_H
 #include <vector>
+#include <functional>
 #include <QPair>
 #include <QDomDocument>
 #include "channel.h"
@@ -41,7 +42,16 @@ namespace Aggregator
 	class Parser
 	{
 		friend class MRSSParser;
+		friend class StreamParser;
 	public:
+		/** @brief Returns an item for the given item element.
+			*
+			* The first parameter is the item element (\<item\>,
+			* \<entry\> and such), and the second one is the ID of
+			* the channel the item belongs to.
+			*/
+		typedef std::function<Item_ptr (const QDomElement&, const IDType_t&)> ItemGetter_f;
+
 		virtual ~Parser ();
 		/** @brief Indicates whether parser could parse the document.
 			*
@@ -62,6 +72,36 @@ namespace Aggregator
 			*/
 		virtual channels_container_t ParseFeed (const QDomDocument& document,
 				const IDType_t& feedId) const;
+
+		/** @brief Parses the document using custom item getter.
+			*
+			* This function is the same as the other overload, but
+			* the item elements found in the \em document are passed
+			* to the \em getter instead of being parsed directly.
+			* This way the \em document may contain just stubs for
+			* the items that have been parsed already, like the
+			* StreamParser does.
+			*
+			* @param[in] document The XML document.
+			* @param[in] feedId The ID of the parent feed.
+			* @param[in] getter The function returning the item for an
+			* item element.
+			* @return Container (channels_container_t) with new items.
+			*
+			* @sa StreamParser
+			*/
+		channels_container_t ParseFeed (const QDomDocument& document,
+				const IDType_t& feedId, const ItemGetter_f& getter) const;
+
+		/** @brief Checks whether the element holds a single item.
+			*
+			* @param[in] name The local name of the element.
+			* @param[in] depth The depth of the element, with the root
+			* element having the depth of 0.
+			* @return Whether the element with the given \em name at
+			* the given \em depth is an item element.
+			*/
+		virtual bool IsItemElement (const QString& name, int depth) const = 0;
 	protected:
 		static const QString DC_;
 		static const QString WFW_;
@@ -76,6 +116,8 @@ namespace Aggregator
 		static const QString Content_;
 
 		virtual channels_container_t Parse (const QDomDocument&,
+				const IDType_t&, const ItemGetter_f&) const = 0;
+		virtual Item* ParseItem (const QDomElement&,
 				const IDType_t&) const = 0;
 		QString GetDescription (const QDomElement&) const;
 		void GetDescription (const QDomElement&, QString&) const;
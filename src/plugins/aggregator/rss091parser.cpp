@@ -56,8 +56,13 @@ namespace Aggregator
 				root.attribute ("version") == "0.92");
 	}
 
+	bool RSS091Parser::IsItemElement (const QString& name, int depth) const
+	{
+		return depth == 2 && name == "item";
+	}
+
 	channels_container_t RSS091Parser::Parse (const QDomDocument& doc,
-			const IDType_t& feedId) const
+			const IDType_t& feedId, const ItemGetter_f& getter) const
 	{
 		channels_container_t channels;
 		QDomElement root = doc.documentElement ();
@@ -76,7 +81,7 @@ namespace Aggregator
 			QDomElement item = channel.firstChildElement ("item");
 			while (!item.isNull ())
 			{
-				itemsList.push_back (Item_ptr (ParseItem (item, chan->ChannelID_)));
+				itemsList.push_back (getter (item, chan->ChannelID_));
 				item = item.nextSiblingElement ("item");
 			}
 			if (!chan->LastBuild_.isValid () || chan->LastBuild_.isNull ())
@@ -42,9 +42,10 @@ namespace Aggregator
 		virtual ~RSS091Parser ();
 		static RSS091Parser& Instance ();
 		virtual bool CouldParse (const QDomDocument&) const;
+		virtual bool IsItemElement (const QString&, int) const;
 	protected:
 		virtual channels_container_t Parse (const QDomDocument&,
-				const IDType_t&) const;
+				const IDType_t&, const ItemGetter_f&) const;
 		Item* ParseItem (const QDomElement&,
 				const IDType_t&) const;
 	};
@@ -54,8 +54,13 @@ namespace Aggregator
 		return root.tagName () == "RDF";
 	}
 	
+	bool RSS10Parser::IsItemElement (const QString& name, int depth) const
+	{
+		return depth == 1 && name == "item";
+	}
+	
 	channels_container_t RSS10Parser::Parse (const QDomDocument& doc,
-			const IDType_t& feedId) const
+			const IDType_t& feedId, const ItemGetter_f& getter) const
 	{
 		channels_container_t result;
 	
@@ -96,32 +101,39 @@ namespace Aggregator
 			QString about = itemDescr.attributeNS (RDF_, "about");
 			if (item2Channel.contains (about))
 			{
-				Item_ptr item (new Item (item2Channel [about]->ChannelID_));
-				item->Title_ = itemDescr.firstChildElement ("title").text ();
-				item->Link_ = itemDescr.firstChildElement ("link").text ();
-				item->Description_ = itemDescr.firstChildElement ("description").text ();
-				GetDescription (itemDescr, item->Description_);
-	
-				item->Categories_ = GetAllCategories (itemDescr);
-				item->Author_ = GetAuthor (itemDescr);
-				item->PubDate_ = GetDCDateTime (itemDescr);
-				item->Unread_ = true;
-				item->NumComments_ = GetNumComments (itemDescr);
-				item->CommentsLink_ = GetCommentsRSS (itemDescr);
-				item->CommentsPageLink_ = GetCommentsLink (itemDescr);
-				item->Enclosures_ = GetEncEnclosures (itemDescr, item->ItemID_);
-				QPair<double, double> point = GetGeoPoint (itemDescr);
-				item->Latitude_ = point.first;
-				item->Longitude_ = point.second;
-				if (item->Guid_.isEmpty ())
-					item->Guid_ = "empty";
-	
-				item2Channel [about]->Items_.push_back (item);
+				const auto& channel = item2Channel [about];
+				channel->Items_.push_back (getter (itemDescr, channel->ChannelID_));
 			}
 			itemDescr = itemDescr.nextSiblingElement ("item");
 		}
 	
 		return result;
 	}
+	
+	Item* RSS10Parser::ParseItem (const QDomElement& itemDescr,
+			const IDType_t& channelId) const
+	{
+		Item *item = new Item (channelId);
+		item->Title_ = itemDescr.firstChildElement ("title").text ();
+		item->Link_ = itemDescr.firstChildElement ("link").text ();
+		item->Description_ = itemDescr.firstChildElement ("description").text ();
+		GetDescription (itemDescr, item->Description_);
+	
+		item->Categories_ = GetAllCategories (itemDescr);
+		item->Author_ = GetAuthor (itemDescr);
+		item->PubDate_ = GetDCDateTime (itemDescr);
+		item->Unread_ = true;
+		item->NumComments_ = GetNumComments (itemDescr);
+		item->CommentsLink_ = GetCommentsRSS (itemDescr);
+		item->CommentsPageLink_ = GetCommentsLink (itemDescr);
+		item->Enclosures_ = GetEncEnclosures (itemDescr, item->ItemID_);
+		QPair<double, double> point = GetGeoPoint (itemDescr);
+		item->Latitude_ = point.first;
+		item->Longitude_ = point.second;
+		if (item->Guid_.isEmpty ())
+			item->Guid_ = "empty";
+	
+		return item;
+	}
 }
 }
@@ -43,8 +43,11 @@ namespace Aggregator
 		virtual ~RSS10Parser ();
 		static RSS10Parser& Instance ();
 		virtual bool CouldParse (const QDomDocument&) const;
+		virtual bool IsItemElement (const QString&, int) const;
 	private:
 		channels_container_t Parse (const QDomDocument&,
+				const IDType_t&, const ItemGetter_f&) const;
+		Item* ParseItem (const QDomElement&,
 				const IDType_t&) const;
 	};
 }
@@ -58,8 +58,13 @@ namespace Aggregator
 			root.attribute ("version") == "2.0";
 	}
 
+	bool RSS20Parser::IsItemElement (const QString& name, int depth) const
+	{
+		return depth == 2 && name == "item";
+	}
+
 	channels_container_t RSS20Parser::Parse (const QDomDocument& doc,
-			const IDType_t& feedId) const
+			const IDType_t& feedId, const ItemGetter_f& getter) const
 	{
 		channels_container_t channels;
 		QDomElement root = doc.documentElement ();
@@ -85,7 +90,7 @@ namespace Aggregator
 			QDomElement item = channel.firstChildElement ("item");
 			while (!item.isNull ())
 			{
-				itemsList.push_back (Item_ptr (ParseItem (item, chan->ChannelID_)));
+				itemsList.push_back (getter (item, chan->ChannelID_));
 				item = item.nextSiblingElement ("item");
 			}
 			if (!chan->LastBuild_.isValid () || chan->LastBuild_.isNull ())
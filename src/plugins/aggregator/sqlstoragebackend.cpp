@@ -44,6 +44,7 @@
 #include <interfaces/core/itagsmanager.h>
 #include "xmlsettingsmanager.h"
 #include "core.h"
+#include "batchinsert.h"
 
 namespace LeechCraft
 {
@@ -1511,52 +1512,55 @@ namespace Aggregator
 
 	void SQLStorageBackend::UpdateItem (Item_ptr item)
 	{
-		UpdateItem_.bindValue (":item_id", item->ItemID_);
-		UpdateItem_.bindValue (":description", item->Description_);
-		UpdateItem_.bindValue (":author", item->Author_);
-		UpdateItem_.bindValue (":category", item->Categories_.join ("<<<"));
-		UpdateItem_.bindValue (":pub_date", item->PubDate_);
-		UpdateItem_.bindValue (":unread", item->Unread_);
-		UpdateItem_.bindValue (":num_comments", item->NumComments_);
-		UpdateItem_.bindValue (":comments_url", item->CommentsLink_);
-		UpdateItem_.bindValue (":comments_page_url", item->CommentsPageLink_);
-		UpdateItem_.bindValue (":latitude", QString::number (item->Latitude_));
-		UpdateItem_.bindValue (":longitude", QString::number (item->Longitude_));
+		UpdateItems ({ item });
+	}
+
+	void SQLStorageBackend::UpdateItems (const items_container_t& items)
+	{
+		if (items.empty ())
+			return;
 
-		if (!UpdateItem_.exec ())
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
+		for (const auto& item : items)
 		{
-			qWarning () << Q_FUNC_INFO;
-			Util::DBLock::DumpError (UpdateItem_);
-			throw std::runtime_error (qPrintable (QString (
-							"Failed to save item {id: %1, title: %2, url: %3}")
-						.arg (item->ItemID_)
-						.arg (item->Title_)
-						.arg (item->Link_)));
-		}
+			UpdateItem_.bindValue (":item_id", item->ItemID_);
+			UpdateItem_.bindValue (":description", item->Description_);
+			UpdateItem_.bindValue (":author", item->Author_);
+			UpdateItem_.bindValue (":category", item->Categories_.join ("<<<"));
+			UpdateItem_.bindValue (":pub_date", item->PubDate_);
+			UpdateItem_.bindValue (":unread", item->Unread_);
+			UpdateItem_.bindValue (":num_comments", item->NumComments_);
+			UpdateItem_.bindValue (":comments_url", item->CommentsLink_);
+			UpdateItem_.bindValue (":comments_page_url", item->CommentsPageLink_);
+			UpdateItem_.bindValue (":latitude", QString::number (item->Latitude_));
+			UpdateItem_.bindValue (":longitude", QString::number (item->Longitude_));
 
-		if (!UpdateItem_.numRowsAffected ())
-			qWarning () << Q_FUNC_INFO
-				<< "no rows affected by UpdateItem_";
+			if (!UpdateItem_.exec ())
+			{
+				qWarning () << Q_FUNC_INFO;
+				Util::DBLock::DumpError (UpdateItem_);
+				throw std::runtime_error (qPrintable (QString (
+								"Failed to save item {id: %1, title: %2, url: %3}")
+							.arg (item->ItemID_)
+							.arg (item->Title_)
+							.arg (item->Link_)));
+			}
 
-		UpdateItem_.finish ();
+			if (!UpdateItem_.numRowsAffected ())
+				qWarning () << Q_FUNC_INFO
+					<< "no rows affected by UpdateItem_";
 
-		WriteEnclosures (item->Enclosures_);
-		WriteMRSSEntries (item->MRSSEntries_);
+			UpdateItem_.finish ();
 
-		try
-		{
-			IDType_t cid = item->ChannelID_;
-			Channel_ptr channel = GetChannel (cid,
-					FindParentFeedForChannel (cid));
-			emit itemDataUpdated (item, channel);
-			emit channelDataUpdated (channel);
-		}
-		catch (const ChannelNotFoundError&)
-		{
-			qWarning () << Q_FUNC_INFO
-				<< "channel not found"
-				<< item->ChannelID_;
+			WriteEnclosures (item->Enclosures_);
+			WriteMRSSEntries (item->MRSSEntries_);
 		}
+
+		lock.Good ();
+
+		NotifyItemsUpdated (items);
 	}
 
 	void SQLStorageBackend::UpdateItem (const ItemShort& item)
@@ -1628,59 +1632,73 @@ namespace Aggregator
 
 		InsertChannel_.finish ();
 
-		std::for_each (channel->Items_.begin (), channel->Items_.end (),
-				[this] (Item_ptr item) { AddItem (item); });
+		AddItems (channel->Items_);
 	}
 
 	void SQLStorageBackend::AddItem (Item_ptr item)
 	{
-		InsertItem_.bindValue (":item_id", item->ItemID_);
-		InsertItem_.bindValue (":channel_id", item->ChannelID_);
-		InsertItem_.bindValue (":title", item->Title_);
-		InsertItem_.bindValue (":url", item->Link_);
-		InsertItem_.bindValue (":description", item->Description_);
-		InsertItem_.bindValue (":author", item->Author_);
-		InsertItem_.bindValue (":category", item->Categories_.join ("<<<"));
-		InsertItem_.bindValue (":guid", item->Guid_);
-		InsertItem_.bindValue (":pub_date", item->PubDate_);
-		InsertItem_.bindValue (":unread", item->Unread_);
-		InsertItem_.bindValue (":num_comments", item->NumComments_);
-		InsertItem_.bindValue (":comments_url", item->CommentsLink_);
-		InsertItem_.bindValue (":comments_page_url", item->CommentsPageLink_);
-		InsertItem_.bindValue (":latitude", QString::number (item->Latitude_));
-		InsertItem_.bindValue (":longitude", QString::number (item->Longitude_));
-
-		if (!InsertItem_.exec ())
+		AddItems ({ item });
+	}
+
+	void SQLStorageBackend::AddItems (const items_container_t& items)
+	{
+		if (items.empty ())
+			return;
+
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
+		try
+		{
+			InsertRows (DB_, ItemsInsertPrefix, ItemsColumnsCount, items, &ItemToRow);
+		}
+		catch (const std::exception&)
 		{
 			qWarning () << Q_FUNC_INFO;
-			LeechCraft::Util::DBLock::DumpError (InsertItem_);
 			throw std::runtime_error (qPrintable (QString (
-							"Failed to save item {id: %1, channel: %2, title: %3, url: %4")
-						.arg (item->ItemID_)
-						.arg (item->ChannelID_)
-						.arg (item->Title_)
-						.arg (item->Link_)));
+							"Failed to save %1 items starting with {id: %2, channel: %3}")
+						.arg (items.size ())
+						.arg (items.front ()->ItemID_)
+						.arg (items.front ()->ChannelID_)));
 		}
 
-		InsertItem_.finish ();
-
-		WriteEnclosures (item->Enclosures_);
-		WriteMRSSEntries (item->MRSSEntries_);
-
-		try
+		for (const auto& item : items)
 		{
-			IDType_t cid = item->ChannelID_;
-			Channel_ptr channel = GetChannel (cid,
-					FindParentFeedForChannel (cid));
-			emit itemDataUpdated (item, channel);
-			emit channelDataUpdated (channel);
+			WriteEnclosures (item->Enclosures_);
+			WriteMRSSEntries (item->MRSSEntries_);
 		}
-		catch (const ChannelNotFoundError&)
+
+		lock.Good ();
+
+		NotifyItemsUpdated (items);
+	}
+
+	void SQLStorageBackend::NotifyItemsUpdated (const items_container_t& items)
+	{
+		QHash<IDType_t, Channel_ptr> channels;
+		for (const auto& item : items)
 		{
-			qWarning () << Q_FUNC_INFO
-				<< "channel not found"
-				<< item->ChannelID_;
+			const auto cid = item->ChannelID_;
+			if (!channels.contains (cid))
+				try
+				{
+					channels [cid] = GetChannel (cid, FindParentFeedForChannel (cid));
+				}
+				catch (const ChannelNotFoundError&)
+				{
+					qWarning () << Q_FUNC_INFO
+						<< "channel not found"
+						<< cid;
+					channels [cid] = Channel_ptr ();
+				}
+
+			if (const auto& channel = channels [cid])
+				emit itemDataUpdated (item, channel);
 		}
+
+		for (const auto& channel : channels)
+			if (channel)
+				emit channelDataUpdated (channel);
 	}
 
 	namespace
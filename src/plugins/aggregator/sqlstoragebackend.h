@@ -601,8 +601,10 @@ namespace Aggregator
 		virtual void UpdateChannel (const ChannelShort&);
 		virtual void UpdateItem (Item_ptr);
 		virtual void UpdateItem (const ItemShort&);
+		virtual void UpdateItems (const items_container_t&);
 		virtual void AddChannel (Channel_ptr);
 		virtual void AddItem (Item_ptr);
+		virtual void AddItems (const items_container_t&);
 		virtual void RemoveItems (const QSet<IDType_t>&);
 		virtual void RemoveChannel (const IDType_t&);
 		virtual void RemoveFeed (const IDType_t&);
@@ -643,6 +645,7 @@ namespace Aggregator
 
 		IDType_t FindParentFeedForChannel (const IDType_t&) const;
 		void FillItem (const QSqlQuery&, Item_ptr&) const;
+		void NotifyItemsUpdated (const items_container_t&);
 		void WriteEnclosures (const QList<Enclosure>&);
 		void GetEnclosures (const IDType_t&, QList<Enclosure>&) const;
 		void WriteMRSSEntries (const QList<MRSSEntry>&);
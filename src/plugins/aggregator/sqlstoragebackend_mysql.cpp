@@ -40,6 +40,7 @@
 #include <util/db/dblock.h>
 #include "xmlsettingsmanager.h"
 #include "core.h"
+#include "batchinsert.h"
 
 namespace LeechCraft
 {
@@ -836,52 +837,55 @@ namespace Aggregator
 
 	void SQLStorageBackendMysql::UpdateItem (Item_ptr item)
 	{
-		UpdateItem_.bindValue (0, item->ItemID_);
-		UpdateItem_.bindValue (1, item->Description_);
-		UpdateItem_.bindValue (2, item->Author_);
-		UpdateItem_.bindValue (3, item->Categories_.join ("<<<"));
-		UpdateItem_.bindValue (4, item->PubDate_);
-		UpdateItem_.bindValue (5, item->Unread_);
-		UpdateItem_.bindValue (6, item->NumComments_);
-		UpdateItem_.bindValue (7, item->CommentsLink_);
-		UpdateItem_.bindValue (8, item->CommentsPageLink_);
-		UpdateItem_.bindValue (9, QString::number (item->Latitude_));
-		UpdateItem_.bindValue (10, QString::number (item->Longitude_));
-
-		if (!UpdateItem_.exec ())
-		{
-			qWarning () << Q_FUNC_INFO;
-			Util::DBLock::DumpError (UpdateItem_);
-			throw std::runtime_error (qPrintable (QString (
-							"Failed to save item {id: %1, title: %2, url: %3}")
-						.arg (item->ItemID_)
-						.arg (item->Title_)
-						.arg (item->Link_)));
-		}
+		UpdateItems ({ item });
+	}
 
-		if (!UpdateItem_.numRowsAffected ())
-			qWarning () << Q_FUNC_INFO
-				<< "no rows affected by UpdateItem_";
+	void SQLStorageBackendMysql::UpdateItems (const items_container_t& items)
+	{
+		if (items.empty ())
+			return;
 
-		UpdateItem_.finish ();
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
+		for (const auto& item : items)
+		{
+			UpdateItem_.bindValue (0, item->ItemID_);
+			UpdateItem_.bindValue (1, item->Description_);
+			UpdateItem_.bindValue (2, item->Author_);
+			UpdateItem_.bindValue (3, item->Categories_.join ("<<<"));
+			UpdateItem_.bindValue (4, item->PubDate_);
+			UpdateItem_.bindValue (5, item->Unread_);
+			UpdateItem_.bindValue (6, item->NumComments_);
+			UpdateItem_.bindValue (7, item->CommentsLink_);
+			UpdateItem_.bindValue (8, item->CommentsPageLink_);
+			UpdateItem_.bindValue (9, QString::number (item->Latitude_));
+			UpdateItem_.bindValue (10, QString::number (item->Longitude_));
+
+			if (!UpdateItem_.exec ())
+			{
+				qWarning () << Q_FUNC_INFO;
+				Util::DBLock::DumpError (UpdateItem_);
+				throw std::runtime_error (qPrintable (QString (
+								"Failed to save item {id: %1, title: %2, url: %3}")
+							.arg (item->ItemID_)
+							.arg (item->Title_)
+							.arg (item->Link_)));
+			}
 
-		WriteEnclosures (item->Enclosures_);
-		WriteMRSSEntries (item->MRSSEntries_);
+			if (!UpdateItem_.numRowsAffected ())
+				qWarning () << Q_FUNC_INFO
+					<< "no rows affected by UpdateItem_";
 
-		try
-		{
-			IDType_t cid = item->ChannelID_;
-			Channel_ptr channel = GetChannel (cid,
-					FindParentFeedForChannel (cid));
-			emit itemDataUpdated (item, channel);
-			emit channelDataUpdated (channel);
-		}
-		catch (const ChannelNotFoundError&)
-		{
-			qWarning () << Q_FUNC_INFO
-				<< "channel not found"
-				<< item->ChannelID_;
+			UpdateItem_.finish ();
+
+			WriteEnclosures (item->Enclosures_);
+			WriteMRSSEntries (item->MRSSEntries_);
 		}
+
+		lock.Good ();
+
+		NotifyItemsUpdated (items);
 	}
 
 	void SQLStorageBackendMysql::UpdateItem (const ItemShort& item)
@@ -957,59 +961,73 @@ namespace Aggregator
 
 		InsertChannel_.finish ();
 
-		std::for_each (channel->Items_.begin (), channel->Items_.end (),
-				[this] (Item_ptr item) { AddItem (item); });
+		AddItems (channel->Items_);
 	}
 
 	void SQLStorageBackendMysql::AddItem (Item_ptr item)
 	{
-		InsertItem_.bindValue (0, item->ItemID_);
-		InsertItem_.bindValue (1, item->ChannelID_);
-		InsertItem_.bindValue (2, item->Title_);
-		InsertItem_.bindValue (3, item->Link_);
-		InsertItem_.bindValue (4, item->Description_);
-		InsertItem_.bindValue (5, item->Author_);
-		InsertItem_.bindValue (6, item->Categories_.join ("<<<"));
-		InsertItem_.bindValue (7, item->Guid_);
-		InsertItem_.bindValue (8, item->PubDate_);
-		InsertItem_.bindValue (9, item->Unread_);
-		InsertItem_.bindValue (10, item->NumComments_);
-		InsertItem_.bindValue (11, item->CommentsLink_);
-		InsertItem_.bindValue (12, item->CommentsPageLink_);
-		InsertItem_.bindValue (13, QString::number (item->Latitude_));
-		InsertItem_.bindValue (14, QString::number (item->Longitude_));
-
-		if (!InsertItem_.exec ())
+		AddItems ({ item });
+	}
+
+	void SQLStorageBackendMysql::AddItems (const items_container_t& items)
+	{
+		if (items.empty ())
+			return;
+
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
+		try
+		{
+			InsertRows (DB_, ItemsInsertPrefix, ItemsColumnsCount, items, &ItemToRow);
+		}
+		catch (const std::exception&)
 		{
 			qWarning () << Q_FUNC_INFO;
-			LeechCraft::Util::DBLock::DumpError (InsertItem_);
 			throw std::runtime_error (qPrintable (QString (
-							"Failed to save item {id: %1, channel: %2, title: %3, url: %4")
-						.arg (item->ItemID_)
-						.arg (item->ChannelID_)
-						.arg (item->Title_)
-						.arg (item->Link_)));
+							"Failed to save %1 items starting with {id: %2, channel: %3}")
+						.arg (items.size ())
+						.arg (items.front ()->ItemID_)
+						.arg (items.front ()->ChannelID_)));
 		}
 
-		InsertItem_.finish ();
-
-		WriteEnclosures (item->Enclosures_);
-		WriteMRSSEntries (item->MRSSEntries_);
-
-		try
+		for (const auto& item : items)
 		{
-			IDType_t cid = item->ChannelID_;
-			Channel_ptr channel = GetChannel (cid,
-					FindParentFeedForChannel (cid));
-			emit itemDataUpdated (item, channel);
-			emit channelDataUpdated (channel);
+			WriteEnclosures (item->Enclosures_);
+			WriteMRSSEntries (item->MRSSEntries_);
 		}
-		catch (const ChannelNotFoundError&)
+
+		lock.Good ();
+
+		NotifyItemsUpdated (items);
+	}
+
+	void SQLStorageBackendMysql::NotifyItemsUpdated (const items_container_t& items)
+	{
+		QHash<IDType_t, Channel_ptr> channels;
+		for (const auto& item : items)
 		{
-			qWarning () << Q_FUNC_INFO
-				<< "channel not found"
-				<< item->ChannelID_;
+			const auto cid = item->ChannelID_;
+			if (!channels.contains (cid))
+				try
+				{
+					channels [cid] = GetChannel (cid, FindParentFeedForChannel (cid));
+				}
+				catch (const ChannelNotFoundError&)
+				{
+					qWarning () << Q_FUNC_INFO
+						<< "channel not found"
+						<< cid;
+					channels [cid] = Channel_ptr ();
+				}
+
+			if (const auto& channel = channels [cid])
+				emit itemDataUpdated (item, channel);
 		}
+
+		for (const auto& channel : channels)
+			if (channel)
+				emit channelDataUpdated (channel);
 	}
 
 	namespace
@@ -315,6 +315,24 @@ namespace Aggregator
 		 */
 		virtual void AddItem (Item_ptr item) = 0;
 
+		/** @brief Adds a batch of new items to already existing
+		 * channels.
+		 *
+		 * This function is the batched version of AddItem(). All the
+		 * items are written in a single transaction, so either all of
+		 * them are added or none of them.
+		 *
+		 * itemDataUpdated() is emitted for each of the items, while
+		 * channelDataUpdated() is emitted just once per each channel
+		 * the items belong to.
+		 *
+		 * @param[in] items The items that should be added.
+		 *
+		 * @sa AddItem()
+		 * @sa UpdateItems()
+		 */
+		virtual void AddItems (const items_container_t& items) = 0;
+
 		/** @brief Updates an already existing channel.
 		 *
 		 * If the specified channel doesn't exist in the storage, it should
@@ -351,6 +369,23 @@ namespace Aggregator
 		 */
 		virtual void UpdateItem (Item_ptr item) = 0;
 
+		/** @brief Updates a batch of already existing items.
+		 *
+		 * This function is the batched version of UpdateItem(). All the
+		 * items are written in a single transaction.
+		 *
+		 * itemDataUpdated() is emitted for each of the items, while
+		 * channelDataUpdated() is emitted just once per each channel
+		 * the items belong to.
+		 *
+		 * @param[in] items The new versions of the items that should be
+		 * updated.
+		 *
+		 * @sa UpdateItem()
+		 * @sa AddItems()
+		 */
+		virtual void UpdateItems (const items_container_t& items) = 0;
+
 		/** @brief Updates an already existing item.
 		 *
 		 * This is an overloaded function provided for convenience.
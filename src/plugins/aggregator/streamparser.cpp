@@ -0,0 +1,251 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "streamparser.h"
+#include <algorithm>
+#include <QXmlStreamWriter>
+#include <QDomDocument>
+#include <QtDebug>
+#include "parser.h"
+#include "parserfactory.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	namespace
+	{
+		const QString StubNS = "urn:x-leechcraft:aggregator:stubs";
+		const QString StubPrefix = "lcstub";
+
+		void WriteStartElement (QXmlStreamWriter& writer, const QXmlStreamReader& reader,
+				const QXmlStreamNamespaceDeclarations& decls)
+		{
+			writer.writeStartElement (reader.qualifiedName ().toString ());
+			for (const auto& decl : decls)
+			{
+				const auto& prefix = decl.prefix ().toString ();
+				writer.writeAttribute (prefix.isEmpty () ? "xmlns" : "xmlns:" + prefix,
+						decl.namespaceUri ().toString ());
+			}
+			for (const auto& attr : reader.attributes ())
+				writer.writeAttribute (attr.qualifiedName ().toString (), attr.value ().toString ());
+		}
+
+		void WriteCharacters (QXmlStreamWriter& writer, const QXmlStreamReader& reader)
+		{
+			if (reader.isCDATA ())
+				writer.writeCDATA (reader.text ().toString ());
+			else
+				writer.writeCharacters (reader.text ().toString ());
+		}
+
+		QXmlStreamNamespaceDeclarations MergeDecls (const QList<QXmlStreamNamespaceDeclarations>& stack)
+		{
+			QXmlStreamNamespaceDeclarations result;
+			for (const auto& decls : stack)
+				for (const auto& decl : decls)
+				{
+					const auto pos = std::find_if (result.begin (), result.end (),
+							[&decl] (const QXmlStreamNamespaceDeclaration& other)
+								{ return other.prefix () == decl.prefix (); });
+					if (pos == result.end ())
+						result << decl;
+					else
+						*pos = decl;
+				}
+			return result;
+		}
+
+		Parser* FindParser (const QXmlStreamReader& reader)
+		{
+			QByteArray rootData;
+			{
+				QXmlStreamWriter writer (&rootData);
+				WriteStartElement (writer, reader, reader.namespaceDeclarations ());
+				writer.writeEndElement ();
+			}
+
+			QDomDocument rootDoc;
+			if (!rootDoc.setContent (rootData, true))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to parse root element"
+						<< rootData;
+				return nullptr;
+			}
+
+			return ParserFactory::Instance ().Return (rootDoc);
+		}
+	}
+
+	StreamParser::Result StreamParser::Parse (QIODevice *device, const IDType_t& feedId) const
+	{
+		QXmlStreamReader reader (device);
+
+		QByteArray skeletonData;
+		QXmlStreamWriter skeleton (&skeletonData);
+
+		QList<QXmlStreamNamespaceDeclarations> nsStack;
+		const Parser *parser = nullptr;
+		QList<Item_ptr> items;
+
+		while (!reader.atEnd () && !reader.hasError ())
+		{
+			switch (reader.readNext ())
+			{
+			case QXmlStreamReader::StartElement:
+			{
+				const auto depth = nsStack.size ();
+				const auto& decls = reader.namespaceDeclarations ();
+				if (!depth)
+				{
+					parser = FindParser (reader);
+					if (!parser)
+						return { Result::Status::NoParser, {}, 0, 0, {} };
+
+					WriteStartElement (skeleton, reader, decls);
+					skeleton.writeAttribute ("xmlns:" + StubPrefix, StubNS);
+				}
+				else if (parser->IsItemElement (reader.name ().toString (), depth))
+				{
+					WriteStartElement (skeleton, reader, decls);
+					skeleton.writeAttribute (StubPrefix + ":idx", QString::number (items.size ()));
+					skeleton.writeEndElement ();
+
+					nsStack << decls;
+					const auto& item = ReadItem (reader, MergeDecls (nsStack), parser);
+					nsStack.removeLast ();
+					if (item)
+						items << item;
+					break;
+				}
+				else
+					WriteStartElement (skeleton, reader, decls);
+
+				nsStack << decls;
+				break;
+			}
+			case QXmlStreamReader::EndElement:
+				skeleton.writeEndElement ();
+				nsStack.removeLast ();
+				break;
+			case QXmlStreamReader::Characters:
+				if (!nsStack.isEmpty ())
+					WriteCharacters (skeleton, reader);
+				break;
+			default:
+				break;
+			}
+		}
+
+		if (reader.hasError ())
+			return
+			{
+				Result::Status::ParseError,
+				reader.errorString (),
+				reader.lineNumber (),
+				reader.columnNumber (),
+				{}
+			};
+
+		if (!parser)
+			return { Result::Status::NoParser, {}, 0, 0, {} };
+
+		QDomDocument doc;
+		QString errorMsg;
+		int errorLine = 0, errorColumn = 0;
+		if (!doc.setContent (skeletonData, true, &errorMsg, &errorLine, &errorColumn))
+			return { Result::Status::ParseError, errorMsg, errorLine, errorColumn, {} };
+
+		const auto& getter = [&items, parser] (const QDomElement& stub, const IDType_t& channelId) -> Item_ptr
+		{
+			bool ok = false;
+			const auto idx = stub.attributeNS (StubNS, "idx").toInt (&ok);
+			if (!ok || idx < 0 || idx >= items.size ())
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "no item for the stub, parsing it as is";
+				return Item_ptr (parser->ParseItem (stub, channelId));
+			}
+
+			const auto& item = items.at (idx);
+			item->ChannelID_ = channelId;
+			return item;
+		};
+
+		return { Result::Status::Success, {}, 0, 0, parser->ParseFeed (doc, feedId, getter) };
+	}
+
+	Item_ptr StreamParser::ReadItem (QXmlStreamReader& reader,
+			const QXmlStreamNamespaceDeclarations& decls, const Parser *parser) const
+	{
+		QByteArray itemData;
+		{
+			QXmlStreamWriter writer (&itemData);
+			WriteStartElement (writer, reader, decls);
+
+			int level = 1;
+			while (level && !reader.atEnd ())
+			{
+				switch (reader.readNext ())
+				{
+				case QXmlStreamReader::StartElement:
+					WriteStartElement (writer, reader, reader.namespaceDeclarations ());
+					++level;
+					break;
+				case QXmlStreamReader::EndElement:
+					writer.writeEndElement ();
+					--level;
+					break;
+				case QXmlStreamReader::Characters:
+					WriteCharacters (writer, reader);
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		if (reader.hasError ())
+			return {};
+
+		QDomDocument doc;
+		if (!doc.setContent (itemData, true))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to parse item"
+					<< itemData;
+			return {};
+		}
+
+		return Item_ptr (parser->ParseItem (doc.documentElement (), IDNotFound));
+	}
+}
+}
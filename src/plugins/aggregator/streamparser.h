@@ -0,0 +1,93 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QXmlStreamReader>
+#include "channel.h"
+
+class QIODevice;
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	class Parser;
+
+	/** @brief Parses feeds incrementally without building the full DOM.
+	 *
+	 * The document is read via QXmlStreamReader. Each item element
+	 * (as reported by Parser::IsItemElement()) is copied into its own
+	 * small QDomDocument, parsed right away and dropped, and only an
+	 * empty stub is left in its place. Everything else (which is
+	 * basically channel metadata) is collected into a skeleton
+	 * document, which is then passed to the Parser along with the
+	 * already parsed items.
+	 *
+	 * Thus the memory used while parsing is proportional to the size
+	 * of a single item rather than to the whole document.
+	 *
+	 * This class is reentrant and is intended to be used from the
+	 * worker threads.
+	 */
+	class StreamParser
+	{
+	public:
+		struct Result
+		{
+			enum class Status
+			{
+				Success,
+				ParseError,
+				NoParser
+			} Status_;
+
+			QString ErrorString_;
+			qint64 ErrorLine_;
+			qint64 ErrorColumn_;
+
+			channels_container_t Channels_;
+		};
+
+		/** @brief Parses the feed from the given device.
+		 *
+		 * The device should be already opened for reading.
+		 *
+		 * @param[in] device The device to read the feed from.
+		 * @param[in] feedId The ID of the parent feed.
+		 * @return The parse result.
+		 */
+		Result Parse (QIODevice *device, const IDType_t& feedId) const;
+	private:
+		Item_ptr ReadItem (QXmlStreamReader&,
+				const QXmlStreamNamespaceDeclarations&, const Parser*) const;
+	};
+}
+}
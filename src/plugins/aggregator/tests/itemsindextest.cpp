@@ -0,0 +1,263 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "itemsindextest.h"
+#include <QtTest>
+#include "itemsindex.h"
+
+QTEST_MAIN (LeechCraft::Aggregator::ItemsIndexTest)
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	namespace
+	{
+		const IDType_t ChannelId = 1;
+		const int ReplayItemsCount = 10000;
+
+		QString MakeTitle (int i)
+		{
+			return QString ("Item number %1").arg (i);
+		}
+
+		QString MakeLink (int i)
+		{
+			return QString ("http://example.com/feed/items/%1.html").arg (i);
+		}
+
+		void FillReplayChannel (ItemsIndex& index)
+		{
+			index.AddChannel (ChannelId);
+			for (int i = 0; i < ReplayItemsCount; ++i)
+				index.Add (ChannelId, i, MakeTitle (i), MakeLink (i), i + 1);
+		}
+	}
+
+	void ItemsIndexTest::testFindByTitleLink ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", "http://link", 1);
+
+		const auto& lookup = index.Find (ChannelId, "title", "http://link", 2);
+		QCOMPARE (lookup.Status_, ItemsIndex::Status::Modified);
+		QCOMPARE (lookup.ItemID_, IDType_t (10));
+
+		QCOMPARE (index.Find (ChannelId + 1, "title", "http://link", 2).Status_,
+				ItemsIndex::Status::New);
+	}
+
+	void ItemsIndexTest::testFindByLink ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", "http://link", 1);
+
+		const auto& lookup = index.Find (ChannelId, "changed title", "http://link", 1);
+		QCOMPARE (lookup.Status_, ItemsIndex::Status::Unchanged);
+		QCOMPARE (lookup.ItemID_, IDType_t (10));
+	}
+
+	void ItemsIndexTest::testFindByTitle ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", "http://link", 1);
+
+		const auto& lookup = index.Find (ChannelId, "title", "http://other", 1);
+		QCOMPARE (lookup.Status_, ItemsIndex::Status::Unchanged);
+		QCOMPARE (lookup.ItemID_, IDType_t (10));
+
+		QCOMPARE (index.Find (ChannelId, "other", "http://other", 1).Status_,
+				ItemsIndex::Status::New);
+	}
+
+	void ItemsIndexTest::testEmptyLink ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", QString (), 1);
+
+		QCOMPARE (index.Find (ChannelId, "other", QString (), 1).Status_,
+				ItemsIndex::Status::New);
+		QCOMPARE (index.Find (ChannelId, "title", QString (), 1).ItemID_,
+				IDType_t (10));
+	}
+
+	void ItemsIndexTest::testContentHash ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", "http://link");
+
+		QCOMPARE (index.Find (ChannelId, "title", "http://link", 5).Status_,
+				ItemsIndex::Status::Modified);
+
+		index.SetContentHash (10, 5);
+		QCOMPARE (index.Find (ChannelId, "title", "http://link", 5).Status_,
+				ItemsIndex::Status::Unchanged);
+		QCOMPARE (index.Find (ChannelId, "title", "http://link", 6).Status_,
+				ItemsIndex::Status::Modified);
+	}
+
+	void ItemsIndexTest::testRemove ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", "http://link", 1);
+		index.Add (ChannelId, 11, "title 2", "http://link2", 1);
+
+		index.Remove ({ 10, 42 });
+
+		QCOMPARE (index.GetItemsCount (), 1);
+		QCOMPARE (index.Find (ChannelId, "title", "http://link", 1).Status_,
+				ItemsIndex::Status::New);
+		QCOMPARE (index.Find (ChannelId, "title 2", "http://link2", 1).Status_,
+				ItemsIndex::Status::Unchanged);
+	}
+
+	void ItemsIndexTest::testRemoveChannel ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", "http://link", 1);
+		index.AddChannel (ChannelId + 1);
+		index.Add (ChannelId + 1, 11, "title", "http://link", 1);
+
+		index.RemoveChannel (ChannelId);
+
+		QCOMPARE (index.HasChannel (ChannelId), false);
+		QCOMPARE (index.HasChannel (ChannelId + 1), true);
+		QCOMPARE (index.GetItemsCount (), 1);
+	}
+
+	void ItemsIndexTest::testDuplicates ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", "http://link", 1);
+		index.Add (ChannelId, 11, "title", "http://link", 1);
+
+		index.Remove ({ 11 });
+
+		const auto& lookup = index.Find (ChannelId, "title", "http://link", 1);
+		QCOMPARE (lookup.Status_, ItemsIndex::Status::Unchanged);
+		QCOMPARE (lookup.ItemID_, IDType_t (10));
+	}
+
+	void ItemsIndexTest::testSaveLoad ()
+	{
+		ItemsIndex index;
+		index.AddChannel (ChannelId);
+		index.Add (ChannelId, 10, "title", "http://link", 1);
+		index.Add (ChannelId, 11, "title 2", QString (), 2);
+		index.AddChannel (ChannelId + 1);
+
+		QByteArray data;
+		{
+			QDataStream out { &data, QIODevice::WriteOnly };
+			index.Save (out);
+		}
+
+		ItemsIndex loaded;
+		QDataStream in { data };
+		QCOMPARE (loaded.Load (in), true);
+
+		QCOMPARE (loaded.GetItemsCount (), 2);
+		QCOMPARE (loaded.HasChannel (ChannelId + 1), true);
+		QCOMPARE (loaded.Find (ChannelId, "other", "http://link", 1).Status_,
+				ItemsIndex::Status::Unchanged);
+		QCOMPARE (loaded.Find (ChannelId, "title 2", QString (), 3).ItemID_,
+				IDType_t (11));
+
+		const auto& truncatedData = data.left (data.size () - 1);
+		ItemsIndex truncated;
+		QDataStream truncatedIn { truncatedData };
+		QCOMPARE (truncated.Load (truncatedIn), false);
+		QCOMPARE (truncated.GetItemsCount (), 0);
+	}
+
+	void ItemsIndexTest::benchmarkReplayUnchanged ()
+	{
+		ItemsIndex index;
+		FillReplayChannel (index);
+
+		QStringList titles;
+		QStringList links;
+		for (int i = 0; i < ReplayItemsCount; ++i)
+		{
+			titles << MakeTitle (i);
+			links << MakeLink (i);
+		}
+
+		int unchanged = 0;
+		QBENCHMARK
+		{
+			unchanged = 0;
+			for (int i = 0; i < ReplayItemsCount; ++i)
+				if (index.Find (ChannelId, titles.at (i), links.at (i), i + 1).Status_ ==
+						ItemsIndex::Status::Unchanged)
+					++unchanged;
+		}
+
+		QCOMPARE (unchanged, ReplayItemsCount);
+	}
+
+	void ItemsIndexTest::benchmarkReplayModified ()
+	{
+		ItemsIndex index;
+		FillReplayChannel (index);
+
+		QStringList titles;
+		QStringList links;
+		for (int i = 0; i < ReplayItemsCount; ++i)
+		{
+			// Every tenth item gets a new title but keeps its link.
+			titles << (i % 10 ? MakeTitle (i) : MakeTitle (i) + " (updated)");
+			links << MakeLink (i);
+		}
+
+		int modified = 0;
+		QBENCHMARK
+		{
+			modified = 0;
+			for (int i = 0; i < ReplayItemsCount; ++i)
+			{
+				const auto contentHash = i % 10 ? i + 1 : -i;
+				if (index.Find (ChannelId, titles.at (i), links.at (i), contentHash).Status_ ==
+						ItemsIndex::Status::Modified)
+					++modified;
+			}
+		}
+
+		QCOMPARE (modified, ReplayItemsCount / 10);
+	}
+}
+}
@@ -656,9 +656,9 @@ namespace Azoth
 		if (msg->GetQObject ()->property ("Azoth/HiddenMessage").toBool ())
 			return false;
 
-		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
-		emit hookShouldCountUnread (proxy, msg->GetQObject ());
-		if (proxy->IsCancelled ())
+		const auto& proxy = PluginManager_->RunHook ("hookShouldCountUnread(LeechCraft::IHookProxy_ptr,QObject*)",
+				[this, msg] (const IHookProxy_ptr& proxy) { emit hookShouldCountUnread (proxy, msg->GetQObject ()); });
+		if (proxy && proxy->IsCancelled ())
 			return proxy->GetReturnValue ().toBool ();
 
 		return !ChatTabsManager_->IsActiveChat (entry) &&
@@ -668,9 +668,9 @@ namespace Azoth
 
 	bool Core::IsHighlightMessage (IMessage *msg)
 	{
-		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
-		emit hookIsHighlightMessage (proxy, msg->GetQObject ());
-		if (proxy->IsCancelled ())
+		const auto& proxy = PluginManager_->RunHook ("hookIsHighlightMessage(LeechCraft::IHookProxy_ptr,QObject*)",
+				[this, msg] (const IHookProxy_ptr& proxy) { emit hookIsHighlightMessage (proxy, msg->GetQObject ()); });
+		if (proxy && proxy->IsCancelled ())
 			return proxy->GetReturnValue ().toBool ();
 
 		IMUCEntry *mucEntry =
@@ -798,24 +798,30 @@ namespace Azoth
 
 	QString Core::FormatDate (QDateTime dt, IMessage *msg)
 	{
-		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
-		emit hookFormatDateTime (proxy, this, dt, msg->GetQObject ());
-		if (proxy->IsCancelled ())
-			return proxy->GetReturnValue ().toString ();
+		const auto& proxy = PluginManager_->RunHook ("hookFormatDateTime(LeechCraft::IHookProxy_ptr,QObject*,QDateTime,QObject*)",
+				[this, dt, msg] (const IHookProxy_ptr& proxy) { emit hookFormatDateTime (proxy, this, dt, msg->GetQObject ()); });
+		if (proxy)
+		{
+			if (proxy->IsCancelled ())
+				return proxy->GetReturnValue ().toString ();
 
-		proxy->FillValue ("dateTime", dt);
+			proxy->FillValue ("dateTime", dt);
+		}
 
 		return dt.time ().toString ();
 	}
 
 	QString Core::FormatNickname (QString nick, IMessage *msg, const QString& color)
 	{
-		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
-		emit hookFormatNickname (proxy, this, nick, msg->GetQObject ());
-		if (proxy->IsCancelled ())
-			return proxy->GetReturnValue ().toString ();
+		const auto& proxy = PluginManager_->RunHook ("hookFormatNickname(LeechCraft::IHookProxy_ptr,QObject*,QString,QObject*)",
+				[this, &nick, msg] (const IHookProxy_ptr& proxy) { emit hookFormatNickname (proxy, this, nick, msg->GetQObject ()); });
+		if (proxy)
+		{
+			if (proxy->IsCancelled ())
+				return proxy->GetReturnValue ().toString ();
 
-		proxy->FillValue ("nick", nick);
+			proxy->FillValue ("nick", nick);
+		}
 
 		QString string;
 
@@ -907,13 +913,19 @@ namespace Azoth
 		IRichTextMessage *rtMsg = qobject_cast<IRichTextMessage*> (msgObj);
 		const bool isRich = rtMsg && rtMsg->GetRichBody () == body;
 
-		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
-		proxy->SetValue ("body", body);
-		emit hookFormatBodyBegin (proxy, msgObj);
-		if (proxy->IsCancelled ())
-			return proxy->GetReturnValue ().toString ();
+		auto proxy = PluginManager_->RunHook ("hookFormatBodyBegin(LeechCraft::IHookProxy_ptr,QObject*)",
+				[this, &body, msgObj] (const Util::DefaultHookProxy_ptr& proxy)
+				{
+					proxy->SetValue ("body", body);
+					emit hookFormatBodyBegin (proxy, msgObj);
+				});
+		if (proxy)
+		{
+			if (proxy->IsCancelled ())
+				return proxy->GetReturnValue ().toString ();
 
-		proxy->FillValue ("body", body);
+			proxy->FillValue ("body", body);
+		}
 
 		if (!isRich)
 		{
@@ -928,9 +940,15 @@ namespace Azoth
 				XmlSettingsManager::Instance ().property ("HighlightNicksInBody").toBool ())
 			HighlightNicks (body, msg, colors);
 
-		proxy.reset (new Util::DefaultHookProxy);
-		proxy->SetValue ("body", body);
-		emit hookFormatBodyEnd (proxy, msgObj);
+		proxy = PluginManager_->RunHook ("hookFormatBodyEnd(LeechCraft::IHookProxy_ptr,QObject*)",
+				[this, &body, msgObj] (const Util::DefaultHookProxy_ptr& proxy)
+				{
+					proxy->SetValue ("body", body);
+					emit hookFormatBodyEnd (proxy, msgObj);
+				});
+		if (!proxy)
+			return body;
+
 		proxy->FillValue ("body", body);
 
 		return proxy->IsCancelled () ?
@@ -943,9 +961,9 @@ namespace Azoth
 		const QString& pack = XmlSettingsManager::Instance ()
 				.property ("SmileIcons").toString ();
 
-		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
-		emit hookGonnaHandleSmiles (proxy, body, pack);
-		if (proxy->IsCancelled ())
+		const auto& proxy = PluginManager_->RunHook ("hookGonnaHandleSmiles(LeechCraft::IHookProxy_ptr,QString,QString)",
+				[this, &body, &pack] (const IHookProxy_ptr& proxy) { emit hookGonnaHandleSmiles (proxy, body, pack); });
+		if (proxy && proxy->IsCancelled ())
 		{
 			const QString& cand = proxy->GetReturnValue ().toString ();
 			return cand.isEmpty () ? body : cand;
@@ -1043,9 +1061,9 @@ namespace Azoth
 	void Core::AddCLEntry (ICLEntry *clEntry,
 			QStandardItem *accItem)
 	{
-		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
-		emit hookAddingCLEntryBegin (proxy, clEntry->GetQObject ());
-		if (proxy->IsCancelled ())
+		const auto& beginProxy = PluginManager_->RunHook ("hookAddingCLEntryBegin(LeechCraft::IHookProxy_ptr,QObject*)",
+				[this, clEntry] (const IHookProxy_ptr& proxy) { emit hookAddingCLEntryBegin (proxy, clEntry->GetQObject ()); });
+		if (beginProxy && beginProxy->IsCancelled ())
 			return;
 
 		ResourcesManager::Instance ().HandleEntry (clEntry);
@@ -1131,8 +1149,7 @@ namespace Azoth
 		ChatTabsManager_->UpdateEntryMapping (id, clEntry->GetQObject ());
 		ChatTabsManager_->SetChatEnabled (id, true);
 
-		proxy.reset (new Util::DefaultHookProxy);
-		emit hookAddingCLEntryEnd (proxy, clEntry->GetQObject ());
+		emit hookAddingCLEntryEnd (std::make_shared<Util::DefaultHookProxy> (), clEntry->GetQObject ());
 	}
 
 	QList<QStandardItem*> Core::GetCategoriesItems (QStringList cats, QStandardItem *account)
@@ -1189,8 +1206,9 @@ namespace Azoth
 
 	void Core::HandleStatusChanged (const EntryStatus&, ICLEntry *entry, const QString& variant)
 	{
-		emit hookEntryStatusChanged (Util::DefaultHookProxy_ptr (new Util::DefaultHookProxy),
-				entry->GetQObject (), variant);
+		PluginManager_->RunHook ("hookEntryStatusChanged(LeechCraft::IHookProxy_ptr,QObject*,QString)",
+				[this, entry, &variant] (const IHookProxy_ptr& proxy)
+					{ emit hookEntryStatusChanged (proxy, entry->GetQObject (), variant); });
 
 		const State state = entry->GetStatus ().State_;
 		const auto& icon = ResourcesManager::Instance ().GetIconPathForState (state);
@@ -1983,13 +2001,13 @@ namespace Azoth
 			return;
 		}
 
-		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
-		emit hookGotMessage (proxy, msgObj);
-		if (proxy->IsCancelled ())
+		const auto& proxy = PluginManager_->RunHook ("hookGotMessage(LeechCraft::IHookProxy_ptr,QObject*)",
+				[this, msgObj] (const IHookProxy_ptr& proxy) { emit hookGotMessage (proxy, msgObj); });
+		if (proxy && proxy->IsCancelled ())
 			return;
 
-		proxy.reset (new Util::DefaultHookProxy);
-		emit hookGotMessage2 (proxy, msgObj);
+		PluginManager_->RunHook ("hookGotMessage2(LeechCraft::IHookProxy_ptr,QObject*)",
+				[this, msgObj] (const IHookProxy_ptr& proxy) { emit hookGotMessage2 (proxy, msgObj); });
 
 		if (msg->GetMessageType () != IMessage::Type::MUCMessage &&
 				msg->GetMessageType () != IMessage::Type::ChatMessage)
@@ -34,6 +34,7 @@
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QDir>
+#include <QTimer>
 #include <QtDebug>
 #include <util/db/dblock.h>
 #include <util/sys/paths.h>
@@ -68,11 +69,21 @@ namespace ChatHistory
 		return Date_.isNull () || !EntryID_ || !AccountID_;
 	}
 
-	Storage::Storage (QObject *parent)
+	Storage::Storage (const QString& dbPath, QObject *parent)
 	: QObject (parent)
+	, FlushTimer_ (new QTimer (this))
 	{
+		FlushTimer_->setSingleShot (true);
+		FlushTimer_->setInterval (MaxFlushDelay);
+		connect (FlushTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (flushMessages ()));
+
 		DB_.reset (new QSqlDatabase (QSqlDatabase::addDatabase ("QSQLITE", "History connection")));
-		DB_->setDatabaseName (Util::CreateIfNotExists ("azoth").filePath ("history.db"));
+		DB_->setDatabaseName (dbPath.isEmpty () ?
+				Util::CreateIfNotExists ("azoth").filePath ("history.db") :
+				dbPath);
 		if (!DB_->open ())
 		{
 			qWarning () << Q_FUNC_INFO
@@ -83,7 +94,8 @@ namespace ChatHistory
 
 		QSqlQuery pragma (*DB_);
 		pragma.exec ("PRAGMA foreign_keys = ON;");
-		pragma.exec ("PRAGMA synchronous = OFF;");
+		pragma.exec ("PRAGMA journal_mode = WAL;");
+		pragma.exec ("PRAGMA synchronous = NORMAL;");
 
 		InitializeTables ();
 
@@ -126,32 +138,26 @@ namespace ChatHistory
 				"AND Date >= :lower_date "
 				"AND Date <= :upper_date");
 
-		LogsSearcher_ = QSqlQuery (*DB_);
-		LogsSearcher_.prepare ("SELECT date FROM azoth_history "
-				"WHERE Id = :entry_id "
-				"AND AccountID = :account_id "
-				"AND Date = (SELECT Date FROM azoth_history "
-				"	WHERE Id = :inner_entry_id "
-				"	AND AccountID = :inner_account_id "
-				"	AND ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
-
-		LogsSearcherWOContact_ = QSqlQuery (*DB_);
-		LogsSearcherWOContact_.prepare ("SELECT Date, Id FROM azoth_history "
-				"WHERE AccountID = :account_id "
-				"AND Date = (SELECT Date FROM azoth_history "
-				"	WHERE AccountID = :inner_account_id "
-				"	AND ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
-
-		LogsSearcherWOContactAccount_ = QSqlQuery (*DB_);
-		LogsSearcherWOContactAccount_.prepare ("SELECT Date, Id, AccountID FROM azoth_history "
-				"WHERE Date = (SELECT Date FROM azoth_history "
-				"	WHERE ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
+		if (FTSKind_ != FTSKind::None)
+		{
+			FTSIndexer_ = QSqlQuery (*DB_);
+			FTSIndexer_.prepare ("INSERT INTO azoth_history_fts (rowid, Message) "
+					"SELECT rowid, Message FROM azoth_history "
+					"WHERE rowid >= :lower AND rowid < :upper;");
+
+			FTSBoundaryUpdater_ = QSqlQuery (*DB_);
+			FTSBoundaryUpdater_.prepare ("UPDATE azoth_history_fts_progress SET Boundary = :boundary;");
+
+			FTSChunkLowerGetter_ = QSqlQuery (*DB_);
+			FTSChunkLowerGetter_.prepare ("SELECT rowid FROM azoth_history "
+					"WHERE rowid < :upper "
+					"ORDER BY rowid DESC LIMIT 1 OFFSET :offset;");
+
+			if (FTSBoundary_ > 0)
+				QTimer::singleShot (0,
+						this,
+						SLOT (indexFTSChunk ()));
+		}
 
 		HistoryGetter_ = QSqlQuery (*DB_);
 		HistoryGetter_.prepare ("SELECT Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy "
@@ -201,6 +207,11 @@ namespace ChatHistory
 		PrepareEntryCache ();
 	}
 
+	Storage::~Storage ()
+	{
+		flushMessages ();
+	}
+
 	void Storage::InitializeTables ()
 	{
 		Util::DBLock lock (*DB_);
@@ -292,9 +303,158 @@ namespace ChatHistory
 		if (!hadAcc2User)
 			regenUsersCache ();
 
+		InitializeFTS ();
+
 		lock.Good ();
 	}
 
+	namespace
+	{
+		QString GetFTSTableSQL (const QSqlDatabase& db)
+		{
+			QSqlQuery query { db };
+			if (!query.exec ("SELECT sql FROM sqlite_master WHERE name = 'azoth_history_fts';") ||
+					!query.next ())
+				return {};
+
+			return query.value (0).toString ();
+		}
+	}
+
+	void Storage::InitializeFTS ()
+	{
+		QSqlQuery query { *DB_ };
+
+		const auto& tables = DB_->tables ();
+		const bool hasProgress = tables.contains ("azoth_history_fts_progress");
+
+		const auto& existingSql = GetFTSTableSQL (*DB_);
+		if (!existingSql.isEmpty ())
+		{
+			FTSKind_ = existingSql.contains ("fts5", Qt::CaseInsensitive) ?
+					FTSKind::FTS5 :
+					FTSKind::FTS4;
+
+			/* The index isn't maintained if there is no progress table
+			 * (see below), and it's also unusable if the SQLite library
+			 * doesn't support its kind anymore.
+			 */
+			if (!hasProgress || !query.exec ("SELECT 1 FROM azoth_history_fts LIMIT 0;"))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "dropping the stale full-text index";
+				query.exec ("DROP TRIGGER IF EXISTS azoth_history_fts_insert;");
+				query.exec ("DROP TRIGGER IF EXISTS azoth_history_fts_delete;");
+				query.exec ("DROP TABLE IF EXISTS azoth_history_fts_progress;");
+				if (!query.exec ("DROP TABLE azoth_history_fts;"))
+				{
+					Util::DBLock::DumpError (query);
+					FTSKind_ = FTSKind::None;
+					return;
+				}
+			}
+			else
+			{
+				if (!query.exec ("SELECT Boundary FROM azoth_history_fts_progress;") ||
+						!query.next ())
+				{
+					Util::DBLock::DumpError (query);
+					FTSKind_ = FTSKind::None;
+					return;
+				}
+
+				FTSBoundary_ = query.value (0).toLongLong ();
+				return;
+			}
+		}
+
+		FTSKind_ = FTSKind::None;
+
+		/* Failing to create the index isn't fatal, so it's created in a
+		 * savepoint to be rolled back separately from the rest of the
+		 * schema.
+		 */
+		if (!query.exec ("SAVEPOINT azoth_history_fts;"))
+		{
+			Util::DBLock::DumpError (query);
+			return;
+		}
+
+		auto rollback = [&query, this]
+		{
+			Util::DBLock::DumpError (query);
+			query.exec ("ROLLBACK TO azoth_history_fts;");
+			query.exec ("RELEASE azoth_history_fts;");
+			FTSKind_ = FTSKind::None;
+		};
+
+		if (query.exec ("CREATE VIRTUAL TABLE azoth_history_fts USING fts5 ("
+					"Message, content = 'azoth_history', tokenize = 'trigram');"))
+			FTSKind_ = FTSKind::FTS5;
+		else if (query.exec ("CREATE VIRTUAL TABLE azoth_history_fts USING fts4 ("
+					"content = 'azoth_history', Message);"))
+			FTSKind_ = FTSKind::FTS4;
+		else
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "neither FTS5 nor FTS4 are supported, search won't be indexed";
+			rollback ();
+			return;
+		}
+
+		/* The old messages are indexed from the newest to the oldest
+		 * one, and the delete trigger should only touch the messages
+		 * already indexed, otherwise the index gets corrupted.
+		 */
+		QStringList queries
+		{
+			"CREATE TABLE azoth_history_fts_progress (Boundary INTEGER);",
+			"INSERT INTO azoth_history_fts_progress (Boundary) "
+				"SELECT IFNULL (MAX (rowid), 0) + 1 FROM azoth_history;",
+			"CREATE TRIGGER azoth_history_fts_insert AFTER INSERT ON azoth_history BEGIN "
+				"INSERT INTO azoth_history_fts (rowid, Message) VALUES (new.rowid, new.Message); "
+				"END;"
+		};
+		switch (FTSKind_)
+		{
+		case FTSKind::FTS5:
+			queries << "CREATE TRIGGER azoth_history_fts_delete AFTER DELETE ON azoth_history "
+					"WHEN old.rowid >= (SELECT Boundary FROM azoth_history_fts_progress) BEGIN "
+					"INSERT INTO azoth_history_fts (azoth_history_fts, rowid, Message) "
+					"VALUES ('delete', old.rowid, old.Message); "
+					"END;";
+			break;
+		case FTSKind::FTS4:
+			queries << "CREATE TRIGGER azoth_history_fts_delete BEFORE DELETE ON azoth_history "
+					"WHEN old.rowid >= (SELECT Boundary FROM azoth_history_fts_progress) BEGIN "
+					"DELETE FROM azoth_history_fts WHERE docid = old.rowid; "
+					"END;";
+			break;
+		case FTSKind::None:
+			break;
+		}
+
+		for (const auto& queryStr : queries)
+			if (!query.exec (queryStr))
+			{
+				rollback ();
+				return;
+			}
+
+		if (!query.exec ("SELECT Boundary FROM azoth_history_fts_progress;") ||
+				!query.next ())
+		{
+			rollback ();
+			return;
+		}
+
+		FTSBoundary_ = query.value (0).toLongLong ();
+		query.finish ();
+
+		if (!query.exec ("RELEASE azoth_history_fts;"))
+			rollback ();
+	}
+
 	void Storage::UpdateTables ()
 	{
 		QSqlQuery query { *DB_ };
@@ -471,14 +631,6 @@ namespace ChatHistory
 		}
 	}
 
-	namespace
-	{
-		std::shared_ptr<void> CleanupQueryGuard (QSqlQuery& query)
-		{
-			return std::shared_ptr<void> (nullptr, [&query] (void*) { query.finish (); });
-		}
-	}
-
 	Storage::RawSearchResult Storage::Search (const QString& accountId,
 			const QString& entryId, const QString& text, int shift, bool cs)
 	{
@@ -501,32 +653,7 @@ namespace ChatHistory
 			return RawSearchResult ();
 		}
 
-		const qint32 intEntryId = Users_ [entryId];
-		const qint32 intAccId = Accounts_ [accountId];
-		LogsSearcher_.bindValue (":entry_id", intEntryId);
-		LogsSearcher_.bindValue (":account_id", intAccId);
-		LogsSearcher_.bindValue (":inner_entry_id", intEntryId);
-		LogsSearcher_.bindValue (":inner_account_id", intAccId);
-		LogsSearcher_.bindValue (":text", '%' + text + '%');
-		LogsSearcher_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcher_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcher_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcher_.bindValue (":offset", shift);
-		if (!LogsSearcher_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcher_);
-			return RawSearchResult ();
-		}
-		auto guard = CleanupQueryGuard (LogsSearcher_);
-
-		if (!LogsSearcher_.next ())
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "unable to move to the next entry";
-			return RawSearchResult ();
-		}
-
-		return RawSearchResult (intEntryId, intAccId, LogsSearcher_.value (0).toDateTime ());
+		return Search (Accounts_ [accountId], Users_ [entryId], text, shift, cs);
 	}
 
 	Storage::RawSearchResult Storage::Search (const QString& accountId,
@@ -542,59 +669,142 @@ namespace ChatHistory
 			return RawSearchResult ();
 		}
 
-		const qint32 intAccId = Accounts_ [accountId];
-		LogsSearcherWOContact_.bindValue (":account_id", intAccId);
-		LogsSearcherWOContact_.bindValue (":inner_account_id", intAccId);
-		LogsSearcherWOContact_.bindValue (":text", '%' + text + '%');
-		LogsSearcherWOContact_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcherWOContact_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcherWOContact_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcherWOContact_.bindValue (":offset", shift);
-		if (!LogsSearcherWOContact_.exec ())
+		return Search (Accounts_ [accountId], 0, text, shift, cs);
+	}
+
+	Storage::RawSearchResult Storage::Search (const QString& text, int shift, bool cs)
+	{
+		return Search (0, 0, text, shift, cs);
+	}
+
+	QString Storage::MakeFTSQuery (const QString& text, bool cs) const
+	{
+		/* The index is only used to preselect the candidate messages,
+		 * which are then checked with LIKE or GLOB as before. Thus the
+		 * FTS query should match a superset of what the pattern matches,
+		 * and this isn't the case if the pattern has wildcards.
+		 */
+		const QString wildcards = cs ? "*?[" : "%_";
+		for (const auto c : wildcards)
+			if (text.contains (c))
+				return {};
+
+		switch (FTSKind_)
 		{
-			Util::DBLock::DumpError (LogsSearcherWOContact_);
-			return RawSearchResult ();
+		case FTSKind::None:
+			return {};
+		case FTSKind::FTS5:
+		{
+			// trigram tokenizer doesn't match anything shorter than 3 chars
+			if (text.toUcs4 ().size () < 3)
+				return {};
+
+			auto escaped = text;
+			escaped.replace ('"', "\"\"");
+			return '"' + escaped + '"';
+		}
+		case FTSKind::FTS4:
+			break;
 		}
 
-		if (!LogsSearcherWOContact_.next ())
+		/* The simple tokenizer of FTS4 splits on ASCII non-alphanumeric
+		 * characters and folds only ASCII case. The token touching the
+		 * end of the text is matched as a prefix. FTS4 can't match
+		 * inside a token, and the token touching the beginning of the
+		 * text may be the end of a longer word in the message, so that
+		 * token is left to the LIKE or GLOB check alone. If it is the
+		 * only token, the index isn't used at all.
+		 */
+		auto isTokenChar = [] (QChar c)
 		{
-			qWarning () << Q_FUNC_INFO
-					<< "unable to move to the next entry";
-			return RawSearchResult ();
-		}
+			return c.unicode () >= 0x80 || c.isLetterOrNumber ();
+		};
+
+		QStringList terms;
+		for (int pos = 0; pos < text.size (); )
+		{
+			if (!isTokenChar (text.at (pos)))
+			{
+				++pos;
+				continue;
+			}
 
-		auto guard = CleanupQueryGuard (LogsSearcherWOContact_);
+			const auto start = pos;
+			while (pos < text.size () && isTokenChar (text.at (pos)))
+				++pos;
+
+			if (!start)
+				continue;
 
-		return RawSearchResult (LogsSearcherWOContact_.value (1).toInt (),
-				intAccId,
-				LogsSearcherWOContact_.value (0).toDateTime ());
+			QString term;
+			for (const auto c : text.mid (start, pos - start))
+				term += c.unicode () < 0x80 ? c.toLower () : c;
+			if (pos == text.size ())
+				term += '*';
+			terms << term;
+		}
+		return terms.join (" ");
 	}
 
-	Storage::RawSearchResult Storage::Search (const QString& text, int shift, bool cs)
+	Storage::RawSearchResult Storage::Search (qint32 accountId, qint32 entryId,
+			const QString& text, int shift, bool cs)
 	{
-		LogsSearcherWOContactAccount_.bindValue (":text", '%' + text + '%');
-		LogsSearcherWOContactAccount_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcherWOContactAccount_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcherWOContactAccount_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcherWOContactAccount_.bindValue (":offset", shift);
-		if (!LogsSearcherWOContactAccount_.exec ())
+		QStringList conditions;
+		if (accountId)
+			conditions << "AccountID = :account_id";
+		if (entryId)
+			conditions << "Id = :entry_id";
+		conditions << (cs ? "Message GLOB :ctext" : "Message LIKE :text");
+
+		const auto& ftsQuery = MakeFTSQuery (text, cs);
+		if (!ftsQuery.isEmpty ())
 		{
-			Util::DBLock::DumpError (LogsSearcherWOContactAccount_);
+			const QString indexed { "rowid IN (SELECT rowid FROM azoth_history_fts WHERE azoth_history_fts MATCH :fts_query)" };
+			conditions << (FTSBoundary_ > 0 ?
+					"((rowid >= :indexed_boundary AND " + indexed + ") OR rowid < :unindexed_boundary)" :
+					indexed);
+		}
+
+		QSqlQuery query { *DB_ };
+		query.prepare ("SELECT Date, Id, AccountID FROM azoth_history "
+				"WHERE " + conditions.join (" AND ") + " "
+				"ORDER BY rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
+		if (accountId)
+			query.bindValue (":account_id", accountId);
+		if (entryId)
+			query.bindValue (":entry_id", entryId);
+		if (cs)
+			query.bindValue (":ctext", '*' + text + '*');
+		else
+			query.bindValue (":text", '%' + text + '%');
+		if (!ftsQuery.isEmpty ())
+		{
+			query.bindValue (":fts_query", ftsQuery);
+			if (FTSBoundary_ > 0)
+			{
+				query.bindValue (":indexed_boundary", FTSBoundary_);
+				query.bindValue (":unindexed_boundary", FTSBoundary_);
+			}
+		}
+		query.bindValue (":offset", shift);
+
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
 			return RawSearchResult ();
 		}
 
-		if (!LogsSearcherWOContactAccount_.next ())
+		if (!query.next ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "unable to move to the next entry";
 			return RawSearchResult ();
 		}
 
-		auto guard = CleanupQueryGuard (LogsSearcherWOContactAccount_);
-
-		return RawSearchResult (LogsSearcherWOContactAccount_.value (1).toInt (),
-				LogsSearcherWOContactAccount_.value (2).toInt (),
-				LogsSearcherWOContactAccount_.value (0).toDateTime ());
+		return RawSearchResult (query.value (1).toInt (),
+				query.value (2).toInt (),
+				query.value (0).toDateTime ());
 	}
 
 	void Storage::SearchDate (qint32 accountId, qint32 entryId, const QDateTime& dt)
@@ -621,19 +831,13 @@ namespace ChatHistory
 		emit gotSearchPosition (Accounts_.key (accountId), Users_.key (entryId), index);
 	}
 
-	void Storage::regenUsersCache ()
+	void Storage::indexFTSChunk ()
 	{
-		QSqlQuery query (*DB_);
-		if (!query.exec ("DELETE FROM azoth_acc2users2;") ||
-			!query.exec ("INSERT INTO azoth_acc2users2 (AccountId, UserId) SELECT DISTINCT AccountId, Id FROM azoth_history;"))
-		{
-			Util::DBLock::DumpError (query);
-			query.exec ("DROP TABLE azoth_acc2users2");
-		}
-	}
+		if (FTSKind_ == FTSKind::None || FTSBoundary_ <= 0)
+			return;
+
+		const int chunkSize = 2000;
 
-	void Storage::addMessage (const QVariantMap& data)
-	{
 		Util::DBLock lock (*DB_);
 		try
 		{
@@ -647,6 +851,59 @@ namespace ChatHistory
 			return;
 		}
 
+		FTSChunkLowerGetter_.bindValue (":upper", FTSBoundary_);
+		FTSChunkLowerGetter_.bindValue (":offset", chunkSize - 1);
+		if (!FTSChunkLowerGetter_.exec ())
+		{
+			Util::DBLock::DumpError (FTSChunkLowerGetter_);
+			return;
+		}
+
+		const qint64 lower = FTSChunkLowerGetter_.next () ?
+				FTSChunkLowerGetter_.value (0).toLongLong () :
+				0;
+		FTSChunkLowerGetter_.finish ();
+
+		FTSIndexer_.bindValue (":lower", lower);
+		FTSIndexer_.bindValue (":upper", FTSBoundary_);
+		if (!FTSIndexer_.exec ())
+		{
+			Util::DBLock::DumpError (FTSIndexer_);
+			return;
+		}
+
+		FTSBoundaryUpdater_.bindValue (":boundary", lower);
+		if (!FTSBoundaryUpdater_.exec ())
+		{
+			Util::DBLock::DumpError (FTSBoundaryUpdater_);
+			return;
+		}
+
+		lock.Good ();
+
+		FTSBoundary_ = lower;
+		if (FTSBoundary_ > 0)
+			QTimer::singleShot (0,
+					this,
+					SLOT (indexFTSChunk ()));
+		else
+			qDebug () << Q_FUNC_INFO
+					<< "history full-text index is complete";
+	}
+
+	void Storage::regenUsersCache ()
+	{
+		QSqlQuery query (*DB_);
+		if (!query.exec ("DELETE FROM azoth_acc2users2;") ||
+			!query.exec ("INSERT INTO azoth_acc2users2 (AccountId, UserId) SELECT DISTINCT AccountId, Id FROM azoth_history;"))
+		{
+			Util::DBLock::DumpError (query);
+			query.exec ("DROP TABLE azoth_acc2users2");
+		}
+	}
+
+	bool Storage::AddMessage (const QVariantMap& data)
+	{
 		const QString& accountID = data ["AccountID"].toString ();
 		if (!Accounts_.contains (accountID))
 		{
@@ -660,7 +917,7 @@ namespace ChatHistory
 						<< accountID
 						<< "unable to add account ID to the DB:"
 						<< e.what ();
-				return;
+				return false;
 			}
 		}
 
@@ -677,7 +934,7 @@ namespace ChatHistory
 						<< entryID
 						<< "unable to add the user to the DB:"
 						<< e.what ();
-				return;
+				return false;
 			}
 		}
 
@@ -723,19 +980,65 @@ namespace ChatHistory
 		if (!MessageDumper_.exec ())
 		{
 			Util::DBLock::DumpError (MessageDumper_);
+			return false;
+		}
+
+		return true;
+	}
+
+	void Storage::addMessage (const QVariantMap& data)
+	{
+		PendingMessages_ << data;
+
+		if (PendingMessages_.size () >= MaxPendingMessages)
+			flushMessages ();
+		else if (!FlushTimer_->isActive ())
+			FlushTimer_->start ();
+	}
+
+	void Storage::flushMessages ()
+	{
+		FlushTimer_->stop ();
+
+		if (PendingMessages_.isEmpty ())
+			return;
+
+		const auto messages = PendingMessages_;
+		PendingMessages_.clear ();
+
+		Util::DBLock lock (*DB_);
+		try
+		{
+			lock.Init ();
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to start transaction:"
+					<< e.what ();
 			return;
 		}
 
+		for (const auto& message : messages)
+			if (!AddMessage (message))
+				qWarning () << Q_FUNC_INFO
+						<< "unable to store message from"
+						<< message ["EntryID"].toString ();
+
 		lock.Good ();
 	}
 
 	void Storage::getOurAccounts ()
 	{
+		flushMessages ();
+
 		emit gotOurAccounts (Accounts_.keys ());
 	}
 
 	void Storage::getUsersForAccount (const QString& accountId)
 	{
+		flushMessages ();
+
 		if (!Accounts_.contains (accountId))
 		{
 			qWarning () << Q_FUNC_INFO
@@ -768,6 +1071,8 @@ namespace ChatHistory
 	void Storage::getChatLogs (const QString& accountId,
 			const QString& entryId, int backpages, int amount)
 	{
+		flushMessages ();
+
 		if (!Accounts_.contains (accountId))
 		{
 			qWarning () << Q_FUNC_INFO
@@ -818,6 +1123,8 @@ namespace ChatHistory
 	void Storage::search (const QString& accountId,
 			const QString& entryId, const QString& text, int shift, bool cs)
 	{
+		flushMessages ();
+
 		RawSearchResult res;
 		if (!accountId.isEmpty () && !entryId.isEmpty ())
 			res = Search (accountId, entryId, text, shift, cs);
@@ -840,6 +1147,8 @@ namespace ChatHistory
 
 	void Storage::searchDate (const QString& account, const QString& entry, const QDateTime& dt)
 	{
+		flushMessages ();
+
 		if (!Accounts_.contains (account))
 		{
 			qWarning () << Q_FUNC_INFO
@@ -866,6 +1175,8 @@ namespace ChatHistory
 
 	void Storage::getDaysForSheet (const QString& account, const QString& entry, int year, int month)
 	{
+		flushMessages ();
+
 		if (!Accounts_.contains (account))
 		{
 			qWarning () << Q_FUNC_INFO
@@ -914,6 +1225,8 @@ namespace ChatHistory
 
 	void Storage::clearHistory (const QString& accountId, const QString& entryId)
 	{
+		flushMessages ();
+
 		if (!Accounts_.contains (accountId) ||
 				!Users_.contains (entryId))
 		{
@@ -36,6 +36,7 @@
 #include <QDateTime>
 
 class QSqlDatabase;
+class QTimer;
 
 namespace LeechCraft
 {
@@ -60,9 +61,9 @@ namespace ChatHistory
 		QSqlQuery UsersForAccountGetter_;
 		QSqlQuery Date2Pos_;
 		QSqlQuery GetMonthDates_;
-		QSqlQuery LogsSearcher_;
-		QSqlQuery LogsSearcherWOContact_;
-		QSqlQuery LogsSearcherWOContactAccount_;
+		QSqlQuery FTSIndexer_;
+		QSqlQuery FTSBoundaryUpdater_;
+		QSqlQuery FTSChunkLowerGetter_;
 		QSqlQuery HistoryGetter_;
 		QSqlQuery HistoryClearer_;
 		QSqlQuery UserClearer_;
@@ -75,6 +76,32 @@ namespace ChatHistory
 
 		QHash<qint32, QString> EntryCache_;
 
+		/** Incoming messages are queued and written in a single
+		 * transaction once either MaxPendingMessages are queued or
+		 * MaxFlushDelay milliseconds pass since the first queued one.
+		 */
+		QList<QVariantMap> PendingMessages_;
+		QTimer *FlushTimer_;
+
+		static const int MaxPendingMessages = 200;
+		static const int MaxFlushDelay = 500;
+
+		/** The kind of the full-text index over the message bodies,
+		 * depending on what the SQLite library supports.
+		 */
+		enum class FTSKind
+		{
+			None,
+			FTS4,
+			FTS5
+		} FTSKind_ = FTSKind::None;
+
+		/** The messages with rowids not less than this are indexed. The
+		 * older messages are indexed in background chunks, and until
+		 * then they are searched by scanning.
+		 */
+		qint64 FTSBoundary_ = 0;
+
 		struct RawSearchResult
 		{
 			qint32 EntryID_;
@@ -87,10 +114,17 @@ namespace ChatHistory
 			bool IsEmpty () const;
 		};
 	public:
-		Storage (QObject* = 0);
+		/** Constructs the storage working with the database at the given
+		 * path, or at the default history database location if the path
+		 * is empty.
+		 */
+		Storage (const QString& dbPath = QString (), QObject* = 0);
+		~Storage ();
 	private:
 		void InitializeTables ();
 		void UpdateTables ();
+		void InitializeFTS ();
+		QString MakeFTSQuery (const QString& text, bool cs) const;
 
 		QHash<QString, qint32> GetUsers ();
 		qint32 GetUserID (const QString&);
@@ -101,11 +135,17 @@ namespace ChatHistory
 		QHash<QString, qint32> GetAccounts ();
 		qint32 GetAccountID (const QString&);
 		void AddAccount (const QString& id);
+		bool AddMessage (const QVariantMap&);
 		RawSearchResult Search (const QString& accountId, const QString& entryId,
 				const QString& text, int shift, bool cs);
 		RawSearchResult Search (const QString& accountId, const QString& text, int shift, bool cs);
 		RawSearchResult Search (const QString& text, int shift, bool cs);
+		RawSearchResult Search (qint32 accountId, qint32 entryId,
+				const QString& text, int shift, bool cs);
 		void SearchDate (qint32, qint32, const QDateTime&);
+	private slots:
+		void indexFTSChunk ();
+		void flushMessages ();
 	public slots:
 		void regenUsersCache ();
 
@@ -0,0 +1,267 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "storagetest.h"
+#include <algorithm>
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <util/sys/paths.h>
+#include <interfaces/azoth/imessage.h>
+#include "storage.h"
+
+QTEST_MAIN (LeechCraft::Azoth::ChatHistory::StorageTest)
+
+namespace LeechCraft
+{
+namespace Azoth
+{
+namespace ChatHistory
+{
+	namespace
+	{
+		const QString AccountID { "test_account" };
+		const QString RoomID { "test_account/room@conference.example.com" };
+
+		QVariantMap MakeMUCMessage (int idx)
+		{
+			const auto& nick = QString ("nick%1").arg (idx % 50);
+			const auto& body = QString ("message number %1 in a busy room").arg (idx);
+			return
+			{
+				{ "AccountID", AccountID },
+				{ "EntryID", RoomID },
+				{ "VisibleName", "room@conference.example.com" },
+				{ "DateTime", QDateTime { QDate { 2014, 1, 1 } }.addSecs (idx) },
+				{ "Direction", "IN" },
+				{ "Body", body },
+				{ "OtherVariant", nick },
+				{ "RichBody", QString () },
+				{ "EscapePolicy", "Esc" },
+				{ "Type", static_cast<int> (IMessage::Type::MUCMessage) }
+			};
+		}
+
+		/* Checks the database with a separate connection, like the
+		 * next LeechCraft run would see it.
+		 */
+		struct DBCheckResult
+		{
+			bool IntegrityOk_;
+			int MessagesCount_;
+		};
+
+		DBCheckResult CheckDatabase (const QString& path)
+		{
+			const QString connName { "History check connection" };
+
+			DBCheckResult result { false, -1 };
+			{
+				auto db = QSqlDatabase::addDatabase ("QSQLITE", connName);
+				db.setDatabaseName (path);
+				if (!db.open ())
+					return result;
+
+				QSqlQuery query { db };
+				if (query.exec ("PRAGMA integrity_check;") && query.next ())
+					result.IntegrityOk_ = query.value (0).toString () == "ok";
+				if (query.exec ("SELECT COUNT(1) FROM azoth_history;") && query.next ())
+					result.MessagesCount_ = query.value (0).toInt ();
+			}
+			QSqlDatabase::removeDatabase (connName);
+
+			return result;
+		}
+
+		void Flush (Storage *storage)
+		{
+			QMetaObject::invokeMethod (storage, "flushMessages", Qt::DirectConnection);
+		}
+	}
+
+	void StorageTest::init ()
+	{
+		DBPath_ = Util::GetTemporaryName ("lc_azoth_chathistory_test.XXXXXX");
+	}
+
+	void StorageTest::cleanup ()
+	{
+		for (const auto& path : CopiedPaths_ + QStringList { DBPath_ })
+			for (const auto& suffix : { "", "-wal", "-shm" })
+				QFile::remove (path + suffix);
+		CopiedPaths_.clear ();
+	}
+
+	/* Copies the database files as they are on disk at the moment,
+	 * without closing or checkpointing the database, which is what's
+	 * left if LeechCraft crashes at this point.
+	 */
+	QString StorageTest::CopyDatabase ()
+	{
+		const auto& copyPath = Util::GetTemporaryName ("lc_azoth_chathistory_test_copy.XXXXXX");
+		CopiedPaths_ << copyPath;
+
+		for (const auto& suffix : { "", "-wal" })
+			if (QFile::exists (DBPath_ + suffix))
+				QFile::copy (DBPath_ + suffix, copyPath + suffix);
+
+		return copyPath;
+	}
+
+	void StorageTest::testBatchedFlush ()
+	{
+		Storage storage { DBPath_ };
+
+		for (int i = 0; i < 10; ++i)
+			storage.addMessage (MakeMUCMessage (i));
+		QCOMPARE (CheckDatabase (DBPath_).MessagesCount_, 0);
+
+		Flush (&storage);
+		QCOMPARE (CheckDatabase (DBPath_).MessagesCount_, 10);
+	}
+
+	void StorageTest::testFlushOnDestruction ()
+	{
+		{
+			Storage storage { DBPath_ };
+			for (int i = 0; i < 10; ++i)
+				storage.addMessage (MakeMUCMessage (i));
+		}
+
+		QCOMPARE (CheckDatabase (DBPath_).MessagesCount_, 10);
+	}
+
+	void StorageTest::testFlushBeforeReading ()
+	{
+		Storage storage { DBPath_ };
+		for (int i = 0; i < 10; ++i)
+			storage.addMessage (MakeMUCMessage (i));
+
+		QSignalSpy spy (&storage, SIGNAL (gotChatLogs (QString, QString, int, int, QVariant)));
+		storage.getChatLogs (AccountID, RoomID, 0, 100);
+
+		QCOMPARE (spy.count (), 1);
+		QCOMPARE (qvariant_cast<QVariant> (spy.at (0).at (4)).toList ().size (), 10);
+	}
+
+	void StorageTest::testCrashSafety ()
+	{
+		Storage storage { DBPath_ };
+
+		int idx = 0;
+		for (int flushes = 0; flushes < 5; ++flushes)
+		{
+			for (int i = 0; i < 100; ++i)
+				storage.addMessage (MakeMUCMessage (idx++));
+			Flush (&storage);
+
+			const auto& result = CheckDatabase (CopyDatabase ());
+			QVERIFY (result.IntegrityOk_);
+			QCOMPARE (result.MessagesCount_, idx);
+		}
+
+		for (int i = 0; i < 50; ++i)
+			storage.addMessage (MakeMUCMessage (idx++));
+
+		const auto& result = CheckDatabase (CopyDatabase ());
+		QVERIFY (result.IntegrityOk_);
+		QCOMPARE (result.MessagesCount_, idx - 50);
+	}
+
+	namespace
+	{
+		int SearchPosition (Storage& storage, const QString& text, int shift)
+		{
+			QSignalSpy spy (&storage, SIGNAL (gotSearchPosition (QString, QString, int)));
+			storage.search (AccountID, RoomID, text, shift, false);
+			return spy.count () == 1 ? spy.at (0).at (2).toInt () : -1;
+		}
+	}
+
+	void StorageTest::testSearch ()
+	{
+		Storage storage { DBPath_ };
+		for (int i = 0; i < 10; ++i)
+			storage.addMessage (MakeMUCMessage (i));
+
+		// The position is the number of messages since the found one.
+		QCOMPARE (SearchPosition (storage, "number 3 in", 0), 7);
+		QCOMPARE (SearchPosition (storage, "number 7 in", 0), 3);
+
+		// A single word is found newest first too.
+		QCOMPARE (SearchPosition (storage, "numb", 6), 7);
+		QCOMPARE (SearchPosition (storage, "NUMBER", 2), 3);
+	}
+
+	void StorageTest::testInfixSearch ()
+	{
+		Storage storage { DBPath_ };
+		for (int i = 0; i < 10; ++i)
+			storage.addMessage (MakeMUCMessage (i));
+
+		// The text may start or be in the middle of a word.
+		QCOMPARE (SearchPosition (storage, "umbe", 0), 1);
+		QCOMPARE (SearchPosition (storage, "essage number 4", 0), 6);
+		QCOMPARE (SearchPosition (storage, "ber 5 in a bu", 0), 5);
+		QCOMPARE (SearchPosition (storage, "usy roo", 3), 4);
+	}
+
+	void StorageTest::benchmarkMUCBurst ()
+	{
+		const int count = 10000;
+
+		QList<QVariantMap> messages;
+		for (int i = 0; i < count; ++i)
+			messages << MakeMUCMessage (i);
+
+		Storage storage { DBPath_ };
+
+		QElapsedTimer timer;
+		timer.start ();
+
+		for (const auto& message : messages)
+			storage.addMessage (message);
+		Flush (&storage);
+
+		const auto elapsed = std::max<qint64> (timer.elapsed (), 1);
+		qDebug () << count
+				<< "messages stored in"
+				<< elapsed
+				<< "ms;"
+				<< count * 1000 / elapsed
+				<< "messages per second";
+
+		QCOMPARE (CheckDatabase (DBPath_).MessagesCount_, count);
+	}
+}
+}
+}
@@ -38,6 +38,7 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QSettings>
+#include <QSet>
 #include <QToolBar>
 #include <QTimer>
 #include <QMenu>
@@ -101,6 +102,35 @@ namespace LeechCraft
 {
 namespace BitTorrent
 {
+	namespace
+	{
+		/* Requesting resume data for thousands of torrents at once
+		 * makes libtorrent write all of them in a single burst, so the
+		 * periodic saves request it in batches.
+		 */
+		const int ResumeBatchSize = 50;
+		const int ResumeBatchInterval = 500;
+
+		/* The saved torrents are read and decoded on the thread pool,
+		 * and the main thread submits them to the session in batches,
+		 * picking up the added handles on each tick as well, so the
+		 * rows appear incrementally and the UI stays responsive.
+		 */
+		const int RestoreBatchSize = 100;
+		const int RestoreBatchInterval = 50;
+
+		QByteArray GetHashKey (const libtorrent::sha1_hash& hash)
+		{
+			const auto& str = hash.to_string ();
+			return QByteArray (str.data (), str.size ());
+		}
+
+		QString GetTorrentsDir ()
+		{
+			return QDir::homePath () + "/.leechcraft/bittorrent/";
+		}
+	}
+
 	Core::PerTrackerAccumulator::PerTrackerAccumulator (Core::pertrackerstats_t& stats)
 	: Stats_ (stats)
 	{
@@ -109,7 +139,7 @@ namespace BitTorrent
 	int Core::PerTrackerAccumulator::operator() (int,
 			const Core::TorrentStruct& str)
 	{
-		const auto& s = str.Handle_.status (0);
+		const auto& s = str.Status_;
 		QString domain = QUrl (s.current_tracker.c_str ()).host ();
 		if (domain.size ())
 		{
@@ -131,6 +161,8 @@ namespace BitTorrent
 	, CurrentTorrent_ (-1)
 	, FinishedTimer_ (new QTimer ())
 	, WarningWatchdog_ (new QTimer ())
+	, ResumeTimer_ (new QTimer ())
+	, RestoreTimer_ (new QTimer ())
 	, LiveStreamManager_ (new LiveStreamManager ())
 	, SaveScheduled_ (false)
 	, Toolbar_ (0)
@@ -262,16 +294,76 @@ namespace BitTorrent
 				this,
 				SLOT (writeSettings ()));
 
+		connect (ResumeTimer_.get (),
+				SIGNAL (timeout ()),
+				this,
+				SLOT (saveResumeDataBatch ()));
+		connect (RestoreTimer_.get (),
+				SIGNAL (timeout ()),
+				this,
+				SLOT (restoreNextBatch ()));
+
+		if (!QDir::home ().mkpath (".leechcraft/bittorrent"))
+			emit error (tr ("Could not create path %1/.leechcraft/bittorrent")
+					.arg (QDir::toNativeSeparators (QDir::homePath ())));
+
+		try
+		{
+			Store_ = std::make_shared<SessionStore> (GetTorrentsDir ());
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open the session store, falling back to the settings:"
+					<< e.what ();
+		}
+
 		RestoreTorrents ();
 	}
 
 	void Core::Release ()
 	{
+		/* The torrents whose restore hasn't finished aren't in Handles_,
+		 * so their records are kept for the final save below, otherwise
+		 * they'd be removed from the store.
+		 */
+		if (IsRestoring ())
+		{
+			QSet<QString> pending;
+			for (const auto& restore : PendingRestores_)
+				pending << restore.Record_.Filename_;
+
+			for (int i = 0; i < RestoreRecords_.size (); ++i)
+			{
+				const auto& record = RestoreRecords_.at (i);
+				if ((RestoreWatcher_ && i >= RestoreNext_) ||
+						pending.contains (record.Filename_))
+					Unrestored_ << record;
+			}
+
+			qDebug () << Q_FUNC_INFO
+					<< "restore interrupted,"
+					<< Unrestored_.size ()
+					<< "torrents haven't been restored";
+		}
+
+		if (RestoreWatcher_)
+		{
+			RestoreWatcher_->cancel ();
+			RestoreWatcher_->waitForFinished ();
+			RestoreWatcher_.reset ();
+		}
+		PendingRestores_.clear ();
+		RestoreRecords_.clear ();
+		RestoreTimer_.reset ();
+
 		Session_->pause ();
-		writeSettings ();
+		WriteSettings (ResumeSaving::Immediate);
 
 		FinishedTimer_.reset ();
 		WarningWatchdog_.reset ();
+		ResumeTimer_.reset ();
+		Store_.reset ();
 
 		QObjectList kids = children ();
 		for (int i = 0; i < kids.size (); ++i)
@@ -499,7 +591,7 @@ namespace BitTorrent
 			return QVariant ();
 
 		const auto& h = Handles_.at (row).Handle_;
-		const auto& status = GetCachedStatus (h);
+		const auto& status = Handles_.at (row).Status_;
 
 		switch (role)
 		{
@@ -1060,6 +1152,8 @@ namespace BitTorrent
 			});
 		endInsertRows ();
 
+		SaveTorrentFile (Handles_.last ());
+
 		if (tryLive)
 		{
 			LiveStreamManager_->EnableOn (handle);
@@ -1144,7 +1238,7 @@ namespace BitTorrent
 			return;
 
 		const auto& handle = Handles_.at (pos).Handle_;
-		const auto& status = handle.status (0);
+		const auto& status = Handles_.at (pos).Status_;
 		switch (status.state)
 		{
 		case libtorrent::torrent_status::checking_files:
@@ -1320,7 +1414,7 @@ namespace BitTorrent
 		if (!CheckValidity (idx))
 			return false;
 
-		return GetCachedStatus (Handles_.at (idx).Handle_).auto_managed;
+		return Handles_.at (idx).Status_.auto_managed;
 	};
 
 	void Core::SetTorrentManaged (bool man, int idx)
@@ -1328,8 +1422,14 @@ namespace BitTorrent
 		if (!CheckValidity (idx))
 			return;
 
-		Handles_.at (idx).Handle_.auto_managed (man);
-		Handles_ [idx].AutoManaged_ = man;
+		/* The cached status is only refreshed by the next status update
+		 * from libtorrent, so it's updated right away for the getters
+		 * to return the new value in the meantime.
+		 */
+		auto& torrent = Handles_ [idx];
+		torrent.Handle_.auto_managed (man);
+		torrent.Status_.auto_managed = man;
+		torrent.AutoManaged_ = man;
 	}
 
 	bool Core::IsTorrentSequentialDownload (int idx) const
@@ -1337,7 +1437,7 @@ namespace BitTorrent
 		if (!CheckValidity (idx))
 			return false;
 
-		return GetCachedStatus (Handles_.at (idx).Handle_).sequential_download;
+		return Handles_.at (idx).Status_.sequential_download;
 	}
 
 	void Core::SetTorrentSequentialDownload (bool seq, int idx)
@@ -1345,7 +1445,9 @@ namespace BitTorrent
 		if (!CheckValidity (idx))
 			return;
 
-		Handles_.at (idx).Handle_.set_sequential_download (seq);
+		auto& torrent = Handles_ [idx];
+		torrent.Handle_.set_sequential_download (seq);
+		torrent.Status_.sequential_download = seq;
 	}
 
 	bool Core::IsTorrentSuperSeeding (int idx) const
@@ -1353,7 +1455,7 @@ namespace BitTorrent
 		if (!CheckValidity (idx))
 			return false;
 
-		return GetCachedStatus (Handles_.at (idx).Handle_).super_seeding;
+		return Handles_.at (idx).Status_.super_seeding;
 	}
 
 	void Core::SetTorrentSuperSeeding (bool sup, int idx)
@@ -1361,7 +1463,9 @@ namespace BitTorrent
 		if (!CheckValidity (idx))
 			return;
 
-		Handles_.at (idx).Handle_.super_seeding (sup);
+		auto& torrent = Handles_ [idx];
+		torrent.Handle_.super_seeding (sup);
+		torrent.Status_.super_seeding = sup;
 	}
 
 	void Core::MakeTorrent (const NewTorrentParams& params) const
@@ -1434,8 +1538,7 @@ namespace BitTorrent
 			return;
 		}
 
-		const auto& status = a.handle.status (0);
-		if (!status.error.empty ())
+		if (!torrent->Status_.error.empty ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "not saving erroneous torrent:"
@@ -1444,10 +1547,7 @@ namespace BitTorrent
 			return;
 		}
 
-		QFile file (QDir::homePath () +
-				"/.leechcraft/bittorrent/" +
-				torrent->TorrentFileName_ +
-				".resume");
+		QFile file (GetTorrentsDir () + torrent->TorrentFileName_ + ".resume");
 
 		if (!file.open (QIODevice::WriteOnly))
 		{
@@ -1498,6 +1598,8 @@ namespace BitTorrent
 		e ["info"] = infoE;
 		libtorrent::bencode (std::back_inserter (torrent->TorrentFileContents_), e);
 
+		SaveTorrentFile (*torrent);
+
 		qDebug () << "HandleMetadata"
 			<< std::distance (Handles_.begin (), torrent)
 			<< torrent->TorrentFileName_;
@@ -1505,6 +1607,19 @@ namespace BitTorrent
 		ScheduleSave ();
 	}
 
+	void Core::HandleStorageMoved (const libtorrent::storage_moved_alert& a)
+	{
+		/* The cached status is used when saving the torrents list, so it
+		 * should get the new path right away.
+		 */
+		const auto torrent = FindHandle (a.handle);
+		if (torrent == Handles_.end ())
+			return;
+
+		torrent->Status_.save_path = a.path;
+		ScheduleSave ();
+	}
+
 	void Core::PieceRead (const libtorrent::read_piece_alert& a)
 	{
 		LiveStreamManager_->PieceRead (a);
@@ -1514,10 +1629,7 @@ namespace BitTorrent
 	{
 		for (const auto& status : statuses)
 		{
-			const auto handle = status.handle;
-			Handle2Status_ [handle] = status;
-
-			const auto pos = FindHandle (handle);
+			const auto pos = FindHandle (status.handle);
 			if (pos == Handles_.end ())
 			{
 				qWarning () << Q_FUNC_INFO
@@ -1525,6 +1637,8 @@ namespace BitTorrent
 				continue;
 			}
 
+			pos->Status_ = status;
+
 			const auto row = std::distance (Handles_.begin (), pos);
 			emit dataChanged (index (row, 0), index (row, columnCount () - 1));
 		}
@@ -1670,16 +1784,6 @@ namespace BitTorrent
 				[&h] (const TorrentStruct& ts) { return ts.Handle_ == h; });
 	}
 
-	libtorrent::torrent_status Core::GetCachedStatus (const libtorrent::torrent_handle& handle) const
-	{
-		if (Handle2Status_.contains (handle))
-			return Handle2Status_ [handle];
-
-		const auto& status = handle.status (0);
-		Handle2Status_ [handle] = status;
-		return status;
-	}
-
 	void Core::MoveToTop (int row)
 	{
 		Handles_.at (row).Handle_.queue_position_top ();
@@ -1711,84 +1815,27 @@ namespace BitTorrent
 		QSettings settings (QCoreApplication::organizationName (),
 				QCoreApplication::applicationName () + "_Torrent");
 		settings.beginGroup ("Core");
-		int torrents = settings.beginReadArray ("AddedTorrents");
-		qDebug () << Q_FUNC_INFO << "gonna restore" << torrents << "torrents";
-		for (int i = 0; i < torrents; ++i)
-		{
-			settings.setArrayIndex (i);
-			const auto& pathStr = settings.value ("SavePath").toString ();
-			const auto& path = std::string (pathStr.toUtf8 ().constData ());
-			QString filename = settings.value ("Filename").toString ();
-			QFile torrent (QDir::homePath () + "/.leechcraft/bittorrent/" + filename);
-			if (!torrent.open (QIODevice::ReadOnly))
-			{
-				emit error (tr ("Could not open saved torrent %1 for read.").arg (filename));
-				continue;
-			}
-			QByteArray data = torrent.readAll ();
-			torrent.close ();
-			if (data.isEmpty ())
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "empty torrent data for"
-						<< filename;
-				continue;
-			}
-
-			QFile resumeDataFile (QDir::homePath () + "/.leechcraft/bittorrent/" +
-					filename + ".resume");
-			QByteArray resumed;
-			if (resumeDataFile.open (QIODevice::ReadOnly))
-			{
-				resumed = resumeDataFile.readAll ();
-				resumeDataFile.close ();
-			}
-
-			bool automanaged = settings.value ("AutoManaged", true).toBool ();
-			TaskParameters taskParameters = static_cast<TaskParameters> (settings
-						.value ("Parameters").toInt ());
-
-			auto handle = RestoreSingleTorrent (data,
-					resumed,
-					path,
-					automanaged,
-					taskParameters & NoAutostart);
-			if (!handle.is_valid ())
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "got invalid handle for"
-						<< filename;
-				continue;
-			}
 
-			std::vector<int> priorities;
-			QByteArray prioritiesLine = settings.value ("Priorities").toByteArray ();
-			std::copy (prioritiesLine.begin (), prioritiesLine.end (),
-					std::back_inserter (priorities));
-
-			if (priorities.empty ())
-			{
-				priorities.resize (handle.get_torrent_info ().num_files ());
-				std::fill (priorities.begin (), priorities.end (), 1);
-			}
-
-			handle.prioritize_files (priorities);
+		QList<SessionStore::Record> records;
+		if (Store_)
+		{
+			records = Store_->Load ();
+			if (records.isEmpty ())
+				records = Store_->MigrateLegacy (settings);
+		}
+		else
+			records = SessionStore::LoadLegacy (settings);
 
-			beginInsertRows ({}, Handles_.size (), Handles_.size ());
-			Handles_.append ({
-					priorities,
-					handle,
-					data,
-					filename,
-					settings.value ("Tags").toStringList (),
-					automanaged,
-					Proxy_->GetID (),
-					taskParameters
-				});
-			endInsertRows ();
-			qDebug () << "restored a torrent";
+		qDebug () << Q_FUNC_INFO << "gonna restore" << records.size () << "torrents";
+		if (!records.isEmpty ())
+		{
+			RestoreTime_.start ();
+			RestoreNext_ = 0;
+			RestoreRecords_ = records;
+			RestoreWatcher_ = std::make_shared<QFutureWatcher<SavedTorrent>> ();
+			RestoreWatcher_->setFuture (LoadSavedTorrents (GetTorrentsDir (), records));
+			RestoreTimer_->start (RestoreBatchInterval);
 		}
-		settings.endArray ();
 
 		int filters = settings.beginReadArray ("IPFilter");
 		for (int i = 0; i < filters; ++i)
@@ -1803,6 +1850,24 @@ namespace BitTorrent
 		settings.endGroup ();
 	}
 
+	void Core::SaveTorrentFile (const TorrentStruct& torrent)
+	{
+		if (torrent.TorrentFileName_.isEmpty () ||
+				torrent.TorrentFileContents_.isEmpty ())
+			return;
+
+		QFile file (GetTorrentsDir () + torrent.TorrentFileName_);
+		if (!file.open (QIODevice::WriteOnly))
+		{
+			emit error (QString ("Cannot write settings! "
+						"Cannot open file %1 for write!")
+					.arg (torrent.TorrentFileName_));
+			return;
+		}
+
+		file.write (torrent.TorrentFileContents_);
+	}
+
 	bool Core::DecodeEntry (const QByteArray& data, libtorrent::lazy_entry& e)
 	{
 		boost::system::error_code ec;
@@ -1816,44 +1881,108 @@ namespace BitTorrent
 		return true;
 	}
 
-	libtorrent::torrent_handle Core::RestoreSingleTorrent (const QByteArray& data,
-			const QByteArray& resumeData,
-			const boost::filesystem::path& path,
-			bool automanaged,
-			bool pause)
+	bool Core::IsRestoring () const
 	{
-		libtorrent::torrent_handle handle;
+		return RestoreWatcher_ || !PendingRestores_.isEmpty ();
+	}
 
-		libtorrent::lazy_entry e;
-		if (!DecodeEntry (data, e))
-			return handle;
+	void Core::AddSavedTorrent (const SavedTorrent& saved)
+	{
+		if (!saved.Info_)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< saved.Error_;
+			emit error (saved.Error_);
+			return;
+		}
+
+		const auto& hash = GetHashKey (saved.Info_->info_hash ());
+		if (PendingRestores_.contains (hash))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "duplicate torrent"
+					<< saved.Record_.Filename_;
+			return;
+		}
 
 		try
 		{
-			libtorrent::add_torrent_params atp;
-			atp.ti = new libtorrent::torrent_info (e);
-			atp.storage_mode = GetCurrentStorageMode ();
-			atp.save_path = path.string ();
-			if (!automanaged)
-				atp.flags &= ~libtorrent::add_torrent_params::flag_auto_managed;
-			if (pause)
-				atp.flags |= libtorrent::add_torrent_params::flag_paused;
-			atp.flags |= libtorrent::add_torrent_params::flag_duplicate_is_error;
+			Session_->async_add_torrent (MakeRestoreParams (saved));
+			PendingRestores_ [hash] = { saved.Record_, saved.TorrentData_ };
+		}
+		catch (const libtorrent::libtorrent_exception& e)
+		{
+			qWarning () << Q_FUNC_INFO << e.what ();
+			HandleLibtorrentException (e);
+		}
+	}
+
+	libtorrent::add_torrent_params Core::MakeRestoreParams (const SavedTorrent& saved) const
+	{
+		const auto& record = saved.Record_;
+		const auto& resumeData = saved.ResumeData_;
+
+		libtorrent::add_torrent_params atp;
+		atp.ti = saved.Info_;
+		atp.storage_mode = GetCurrentStorageMode ();
+		atp.save_path = std::string (record.SavePath_.toUtf8 ().constData ());
+		if (!record.AutoManaged_)
+			atp.flags &= ~libtorrent::add_torrent_params::flag_auto_managed;
+		if (static_cast<TaskParameters> (record.Parameters_) & NoAutostart)
+			atp.flags |= libtorrent::add_torrent_params::flag_paused;
+		atp.flags |= libtorrent::add_torrent_params::flag_duplicate_is_error;
 
 #if LIBTORRENT_VERSION_NUM >= 10000
-			std::copy (resumeData.constData (),
-					resumeData.constData () + resumeData.size (),
-					std::back_inserter (atp.resume_data));
+		std::copy (resumeData.constData (),
+				resumeData.constData () + resumeData.size (),
+				std::back_inserter (atp.resume_data));
 #else
-			atp.resume_data = new std::vector<char>;
-			std::copy (resumeData.constData (),
-					resumeData.constData () + resumeData.size (),
-					std::back_inserter (*atp.resume_data));
+		atp.resume_data = new std::vector<char>;
+		std::copy (resumeData.constData (),
+				resumeData.constData () + resumeData.size (),
+				std::back_inserter (*atp.resume_data));
 #endif
 
-			handle = Session_->add_torrent (atp);
+		return atp;
+	}
+
+	void Core::HandleTorrentAdded (const libtorrent::add_torrent_alert& a)
+	{
+		const auto& info = a.params.ti;
+		if (!info)
+			return;
+
+		const auto& hash = GetHashKey (info->info_hash ());
+		if (!PendingRestores_.contains (hash))
+			return;
+
+		const auto& pending = PendingRestores_.take (hash);
+		const auto& record = pending.Record_;
+		if (a.error)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "got invalid handle for"
+					<< record.Filename_
+					<< a.error.message ().c_str ();
+			emit error (tr ("Could not restore torrent %1: %2.")
+					.arg (record.Filename_)
+					.arg (QString::fromUtf8 (a.error.message ().c_str ())));
+			return;
+		}
+
+		auto handle = a.handle;
+
+		std::vector<int> priorities;
+		std::copy (record.Priorities_.begin (), record.Priorities_.end (),
+				std::back_inserter (priorities));
+		if (priorities.empty ())
+			priorities.resize (info->num_files (), 1);
+
+		try
+		{
 			if (XmlSettingsManager::Instance ()->property ("ResolveCountries").toBool ())
 				handle.resolve_countries (true);
+			handle.prioritize_files (priorities);
 		}
 		catch (const libtorrent::libtorrent_exception& e)
 		{
@@ -1861,7 +1990,20 @@ namespace BitTorrent
 			HandleLibtorrentException (e);
 		}
 
-		return handle;
+		const auto taskParameters = static_cast<TaskParameters> (record.Parameters_);
+
+		beginInsertRows ({}, Handles_.size (), Handles_.size ());
+		Handles_.append ({
+				priorities,
+				handle,
+				pending.TorrentData_,
+				record.Filename_,
+				record.Tags_,
+				record.AutoManaged_,
+				Proxy_->GetID (),
+				taskParameters
+			});
+		endInsertRows ();
 	}
 
 	void Core::HandleSingleFinished (int i)
@@ -1870,8 +2012,7 @@ namespace BitTorrent
 		const auto& info = torrent.Handle_.get_torrent_info ();
 
 		if (LiveStreamManager_->IsEnabledOn (torrent.Handle_) &&
-				torrent.Handle_.status (libtorrent::torrent_handle::query_pieces).num_pieces !=
-					torrent.Handle_.get_torrent_info ().num_pieces ())
+				torrent.Status_.num_pieces != info.num_pieces ())
 			return;
 
 		QString name = QString::fromUtf8 (info.name ().c_str ());
@@ -1986,23 +2127,68 @@ namespace BitTorrent
 
 	void Core::writeSettings ()
 	{
-		SaveScheduled_ = false;
-		QDir home = QDir::home ();
-		if (!home.exists (".leechcraft/bittorrent"))
-			if (!home.mkdir (".leechcraft/bittorrent"))
+		WriteSettings (ResumeSaving::Staggered);
+	}
+
+	void Core::saveResumeDataBatch ()
+	{
+		for (int i = 0; i < ResumeBatchSize && !ResumeQueue_.isEmpty (); ++i)
+		{
+			const auto id = ResumeQueue_.takeFirst ();
+			const auto pos = std::find_if (Handles_.begin (), Handles_.end (),
+					[id] (const TorrentStruct& ts) { return ts.ID_ == id; });
+			if (pos == Handles_.end ())
+				continue;
+
+			try
 			{
-				emit error (QDir::toNativeSeparators (tr ("Could not create path %1/.leechcraft/bittorrent"))
-						.arg (QDir::toNativeSeparators (QDir::homePath ())));
-				return;
+				if (pos->Handle_.need_save_resume_data ())
+					pos->Handle_.save_resume_data ();
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO << e.what ();
 			}
+		}
 
-		QSettings settings (QCoreApplication::organizationName (),
-				QCoreApplication::applicationName () + "_Torrent");
-		settings.beginGroup ("Core");
-		settings.beginWriteArray ("AddedTorrents");
+		if (ResumeQueue_.isEmpty ())
+			ResumeTimer_->stop ();
+	}
+
+	void Core::restoreNextBatch ()
+	{
+		if (RestoreWatcher_)
+		{
+			const auto& future = RestoreWatcher_->future ();
+			for (int i = 0; i < RestoreBatchSize && future.isResultReadyAt (RestoreNext_); ++i)
+				AddSavedTorrent (future.resultAt (RestoreNext_++));
+
+			if (future.isFinished () && !future.isResultReadyAt (RestoreNext_))
+				RestoreWatcher_.reset ();
+		}
+
+		queryLibtorrentForWarnings ();
+
+		if (IsRestoring ())
+			return;
+
+		RestoreRecords_.clear ();
+		RestoreTimer_->stop ();
+		qDebug () << Q_FUNC_INFO
+				<< "restored"
+				<< Handles_.size ()
+				<< "torrents in"
+				<< RestoreTime_.elapsed ()
+				<< "ms";
+	}
+
+	void Core::WriteSettings (ResumeSaving resumeSaving)
+	{
+		SaveScheduled_ = false;
+
+		QList<SessionStore::Record> records;
 		for (int i = 0; i < Handles_.size (); ++i)
 		{
-			settings.setArrayIndex (i);
 			if (!CheckValidity (i))
 			{
 				qWarning () << Q_FUNC_INFO
@@ -2010,52 +2196,35 @@ namespace BitTorrent
 					<< i;
 				continue;
 			}
-			if (Handles_.at (i).TorrentFileName_.isEmpty ())
+
+			const auto& torrent = Handles_.at (i);
+			if (torrent.TorrentFileName_.isEmpty ())
 			{
 				qWarning () << Q_FUNC_INFO
 					<< "empty file name"
 					<< i;
 				continue;
 			}
-			int oldCurrent = CurrentTorrent_;
-			CurrentTorrent_ = i;
+
 			try
 			{
-				QFile file_info (QDir::homePath () +
-						"/.leechcraft/bittorrent/" +
-						Handles_.at (i).TorrentFileName_);
-				if (!file_info.open (QIODevice::WriteOnly))
-					emit error (QString ("Cannot write settings! "
-								"Cannot open file %1 for write!")
-							.arg (Handles_.at (i).TorrentFileName_));
-				else
-				{
-					file_info.write (Handles_.at (i).TorrentFileContents_);
-					file_info.close ();
-
-					const auto& handle = Handles_.at (i).Handle_;
-					if (handle.need_save_resume_data ())
-						handle.save_resume_data ();
-
-					settings.setValue ("SavePath",
-							QString::fromUtf8 (handle.save_path ().c_str ()));
-					settings.setValue ("Filename",
-							Handles_.at (i).TorrentFileName_);
-					settings.setValue ("Tags",
-							Handles_.at (i).Tags_);
-					settings.setValue ("ID",
-							Handles_.at (i).ID_);
-					settings.setValue ("Parameters",
-							static_cast<int> (Handles_.at (i).Parameters_));
-					settings.setValue ("AutoManaged",
-							Handles_.at (i).AutoManaged_);
-
-					QByteArray prioritiesLine;
-					std::copy (Handles_.at (i).FilePriorities_.begin (),
-							Handles_.at (i).FilePriorities_.end (),
-							std::back_inserter (prioritiesLine));
-					settings.setValue ("Priorities", prioritiesLine);
-				}
+				QByteArray prioritiesLine;
+				std::copy (torrent.FilePriorities_.begin (),
+						torrent.FilePriorities_.end (),
+						std::back_inserter (prioritiesLine));
+
+				records.append ({
+						torrent.TorrentFileName_,
+						QString::fromUtf8 (torrent.Status_.save_path.c_str ()),
+						torrent.Tags_,
+						static_cast<int> (torrent.Parameters_),
+						torrent.AutoManaged_,
+						prioritiesLine
+					});
+
+				if (resumeSaving == ResumeSaving::Immediate &&
+						torrent.Handle_.need_save_resume_data ())
+					torrent.Handle_.save_resume_data ();
 			}
 			catch (const std::exception& e)
 			{
@@ -2065,9 +2234,57 @@ namespace BitTorrent
 			{
 				qWarning () << Q_FUNC_INFO << "unknown exception";
 			}
-			CurrentTorrent_ = oldCurrent;
 		}
-		settings.endArray ();
+
+		switch (resumeSaving)
+		{
+		case ResumeSaving::Immediate:
+			ResumeQueue_.clear ();
+			ResumeTimer_->stop ();
+			break;
+		case ResumeSaving::Staggered:
+			if (ResumeQueue_.isEmpty ())
+			{
+				for (const auto& torrent : Handles_)
+					ResumeQueue_ << torrent.ID_;
+				ResumeTimer_->start (ResumeBatchInterval);
+			}
+			break;
+		}
+
+		QSettings settings (QCoreApplication::organizationName (),
+				QCoreApplication::applicationName () + "_Torrent");
+		settings.beginGroup ("Core");
+
+		/* The torrents that haven't been restored yet aren't in
+		 * Handles_, so saving the list now would drop them. If the
+		 * restore has been interrupted, their records are merged back
+		 * instead.
+		 */
+		if (!Unrestored_.isEmpty ())
+			records = MergeUnrestored (records, Unrestored_);
+
+		if (IsRestoring ())
+			qDebug () << Q_FUNC_INFO
+					<< "skipping saving the torrents list during restore";
+		else if (Store_)
+			Store_->Save (records);
+		else
+		{
+			settings.beginWriteArray ("AddedTorrents");
+			for (int i = 0; i < records.size (); ++i)
+			{
+				const auto& record = records.at (i);
+				settings.setArrayIndex (i);
+				settings.setValue ("SavePath", record.SavePath_);
+				settings.setValue ("Filename", record.Filename_);
+				settings.setValue ("Tags", record.Tags_);
+				settings.setValue ("Parameters", record.Parameters_);
+				settings.setValue ("AutoManaged", record.AutoManaged_);
+				settings.setValue ("Priorities", record.Priorities_);
+			}
+			settings.endArray ();
+		}
 
 		settings.beginWriteArray ("IPFilter");
 		settings.remove ("");
@@ -2107,7 +2324,7 @@ namespace BitTorrent
 			if (Handles_.at (i).State_ == TSSeeding)
 				continue;
 
-			const auto& status = Handles_.at (i).Handle_.status (0);
+			const auto& status = Handles_.at (i).Status_;
 			libtorrent::torrent_status::state_t state = status.state;
 
 			if (status.paused)
@@ -2181,6 +2398,8 @@ namespace BitTorrent
 					.arg (QString::fromUtf8 (a.handle.name ().c_str ()))
 					.arg (QString::fromUtf8 (a.path.c_str ()));
 			IEM_->HandleEntity (Util::MakeNotification ("BitTorrent", text, PInfo_));
+
+			Core::Instance ()->HandleStorageMoved (a);
 		}
 
 		void operator() (const libtorrent::storage_moved_failed_alert& a) const
@@ -2196,6 +2415,12 @@ namespace BitTorrent
 			Core::Instance ()->HandleMetadata (a);
 		}
 
+		void operator() (const libtorrent::add_torrent_alert& a) const
+		{
+			Core::Instance ()->HandleTorrentAdded (a);
+			NeedToLog_ = false;
+		}
+
 		void operator() (const libtorrent::file_renamed_alert& a) const
 		{
 			Core::Instance ()->HandleFileRenamed (a);
@@ -2359,6 +2584,7 @@ namespace BitTorrent
 					, libtorrent::storage_moved_alert
 					, libtorrent::storage_moved_failed_alert
 					, libtorrent::metadata_received_alert
+					, libtorrent::add_torrent_alert
 					, libtorrent::file_error_alert
 					, libtorrent::file_renamed_alert
 					, libtorrent::file_rename_failed_alert
@@ -38,6 +38,8 @@
 #include <QList>
 #include <QVector>
 #include <QIcon>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
 #include <libtorrent/alert_types.hpp>
 #include <libtorrent/torrent_info.hpp>
 #include <libtorrent/torrent_handle.hpp>
@@ -49,12 +51,15 @@
 #include "torrentinfo.h"
 #include "fileinfo.h"
 #include "peerinfo.h"
+#include "sessionstore.h"
+#include "savedtorrentloader.h"
 
 class QTimer;
 class QDomElement;
 class QToolBar;
 class QStandardItemModel;
 class QDataStream;
+class QSettings;
 
 namespace libtorrent
 {
@@ -111,6 +116,11 @@ namespace BitTorrent
 
 			bool PauseAfterCheck_ = false;
 
+			/** Last status snapshot delivered by the session. Refreshed
+			 * from state update alerts, never queried synchronously.
+			 */
+			libtorrent::torrent_status Status_;
+
 			TorrentStruct (const libtorrent::torrent_handle& handle,
 					const QStringList& tags,
 					int id,
@@ -120,6 +130,7 @@ namespace BitTorrent
 			, ID_ { id }
 			, Parameters_ { params }
 			{
+				Status_.handle = handle;
 			}
 
 			TorrentStruct (const std::vector<int>& prios,
@@ -139,12 +150,12 @@ namespace BitTorrent
 			, ID_ { id }
 			, Parameters_ { params }
 			{
+				Status_.handle = handle;
 			}
 		};
 
 		friend struct SimpleDispatcher;
 
-		mutable QMap<libtorrent::torrent_handle, libtorrent::torrent_status> Handle2Status_;
 	public:
 		struct PerTrackerStats
 		{
@@ -170,7 +181,26 @@ namespace BitTorrent
 		HandleDict_t Handles_;
 		QList<QString> Headers_;
 		mutable int CurrentTorrent_;
-		std::shared_ptr<QTimer> FinishedTimer_, WarningWatchdog_;
+		std::shared_ptr<QTimer> FinishedTimer_, WarningWatchdog_, ResumeTimer_;
+		std::shared_ptr<SessionStore> Store_;
+		QList<int> ResumeQueue_;
+
+		struct PendingRestore
+		{
+			SessionStore::Record Record_;
+			QByteArray TorrentData_;
+		};
+		std::shared_ptr<QFutureWatcher<SavedTorrent>> RestoreWatcher_;
+		std::shared_ptr<QTimer> RestoreTimer_;
+		int RestoreNext_ = 0;
+		QHash<QByteArray, PendingRestore> PendingRestores_;
+		// The records being restored, in their stored order.
+		QList<SessionStore::Record> RestoreRecords_;
+		/* The records of the torrents not restored by the time the
+		 * restore has been interrupted, kept in the torrents list.
+		 */
+		QList<SessionStore::Record> Unrestored_;
+		QElapsedTimer RestoreTime_;
 		std::shared_ptr<LiveStreamManager> LiveStreamManager_;
 		QString ExternalAddress_;
 		bool SaveScheduled_;
@@ -336,6 +366,8 @@ namespace BitTorrent
 
 		void SaveResumeData (const libtorrent::save_resume_data_alert&) const;
 		void HandleMetadata (const libtorrent::metadata_received_alert&);
+		void HandleStorageMoved (const libtorrent::storage_moved_alert&);
+		void HandleTorrentAdded (const libtorrent::add_torrent_alert&);
 		void PieceRead (const libtorrent::read_piece_alert&);
 		void UpdateStatus (const std::vector<libtorrent::torrent_status>&);
 
@@ -351,17 +383,22 @@ namespace BitTorrent
 		HandleDict_t::iterator FindHandle (const libtorrent::torrent_handle&);
 		HandleDict_t::const_iterator FindHandle (const libtorrent::torrent_handle&) const;
 
-		libtorrent::torrent_status GetCachedStatus (const libtorrent::torrent_handle&) const;
 
 		void MoveToTop (int);
 		void MoveToBottom (int);
 		void RestoreTorrents ();
+		void SaveTorrentFile (const TorrentStruct&);
+
+		enum class ResumeSaving
+		{
+			Staggered,
+			Immediate
+		};
+		void WriteSettings (ResumeSaving);
 		bool DecodeEntry (const QByteArray&, libtorrent::lazy_entry&);
-		libtorrent::torrent_handle RestoreSingleTorrent (const QByteArray&,
-				const QByteArray&,
-				const boost::filesystem::path&,
-				bool,
-				bool);
+		bool IsRestoring () const;
+		void AddSavedTorrent (const SavedTorrent&);
+		libtorrent::add_torrent_params MakeRestoreParams (const SavedTorrent&) const;
 
 		void HandleSingleFinished (int);
 		void HandleFileRenamed (const libtorrent::file_renamed_alert&);
@@ -382,6 +419,8 @@ namespace BitTorrent
 		void HandleLibtorrentException (const libtorrent::libtorrent_exception&);
 	private slots:
 		void writeSettings ();
+		void saveResumeDataBatch ();
+		void restoreNextBatch ();
 		void checkFinished ();
 		void scrape ();
 	public slots:
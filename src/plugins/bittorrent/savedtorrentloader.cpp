@@ -0,0 +1,89 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "savedtorrentloader.h"
+#include <functional>
+#include <QFile>
+#include <QCoreApplication>
+#include <QtConcurrentMap>
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	SavedTorrent LoadSavedTorrent (const QString& dir, const SessionStore::Record& record)
+	{
+		SavedTorrent result { record, {}, {}, {}, {} };
+
+		QFile torrent (dir + record.Filename_);
+		if (!torrent.open (QIODevice::ReadOnly))
+		{
+			result.Error_ = QCoreApplication::translate ("LeechCraft::BitTorrent::Core",
+					"Could not open saved torrent %1 for read.")
+					.arg (record.Filename_);
+			return result;
+		}
+
+		result.TorrentData_ = torrent.readAll ();
+		if (result.TorrentData_.isEmpty ())
+		{
+			result.Error_ = QString ("empty torrent data for %1").arg (record.Filename_);
+			return result;
+		}
+
+		QFile resumeDataFile (dir + record.Filename_ + ".resume");
+		if (resumeDataFile.open (QIODevice::ReadOnly))
+			result.ResumeData_ = resumeDataFile.readAll ();
+
+		boost::system::error_code ec;
+		boost::intrusive_ptr<libtorrent::torrent_info> info
+		{
+			new libtorrent::torrent_info (result.TorrentData_.constData (),
+					result.TorrentData_.size (), ec)
+		};
+		if (ec)
+		{
+			result.Error_ = QCoreApplication::translate ("LeechCraft::BitTorrent::Core",
+					"Bad bencoding in saved torrent data: %1")
+					.arg (QString::fromUtf8 (ec.message ().c_str ()));
+			return result;
+		}
+
+		result.Info_ = info;
+		return result;
+	}
+
+	QFuture<SavedTorrent> LoadSavedTorrents (const QString& dir, const QList<SessionStore::Record>& records)
+	{
+		std::function<SavedTorrent (SessionStore::Record)> loader =
+				[dir] (const SessionStore::Record& record) { return LoadSavedTorrent (dir, record); };
+		return QtConcurrent::mapped (records, loader);
+	}
+}
+}
@@ -0,0 +1,72 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <QFuture>
+#include <QByteArray>
+#include <libtorrent/torrent_info.hpp>
+#include "sessionstore.h"
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	/** A saved torrent read from the disk and ready to be added to the
+	 * session.
+	 */
+	struct SavedTorrent
+	{
+		SessionStore::Record Record_;
+
+		QByteArray TorrentData_;
+		QByteArray ResumeData_;
+		boost::intrusive_ptr<libtorrent::torrent_info> Info_;
+
+		/** Human-readable description of the error, if any. If this
+		 * is not empty, Info_ is null.
+		 */
+		QString Error_;
+	};
+
+	/** Reads and decodes the .torrent file and the resume data of the
+	 * torrent described by \em record from the directory \em dir.
+	 *
+	 * This function is thread-safe.
+	 */
+	SavedTorrent LoadSavedTorrent (const QString& dir, const SessionStore::Record& record);
+
+	/** Runs LoadSavedTorrent() for each of the \em records on the
+	 * global thread pool. The results are in the same order as the
+	 * records.
+	 */
+	QFuture<SavedTorrent> LoadSavedTorrents (const QString& dir, const QList<SessionStore::Record>& records);
+}
+}
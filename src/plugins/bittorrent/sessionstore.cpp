@@ -0,0 +1,385 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "sessionstore.h"
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <QDir>
+#include <QSet>
+#include <QSettings>
+#include <QVector>
+#include <QSqlError>
+#include <QUuid>
+#include <QtDebug>
+#include <util/db/dblock.h>
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	SessionStore::SessionStore (const QString& dir)
+	: DB_ (QSqlDatabase::addDatabase ("QSQLITE",
+			"org.LeechCraft.BitTorrent.SessionStore_" + QUuid::createUuid ().toString ()))
+	{
+		DB_.setDatabaseName (QDir { dir }.absoluteFilePath ("torrents.db"));
+		if (!DB_.open ())
+		{
+			Util::DBLock::DumpError (DB_.lastError ());
+			throw std::runtime_error ("BitTorrent session store creation failed");
+		}
+
+		QSqlQuery query { DB_ };
+		query.exec ("PRAGMA journal_mode = WAL;");
+		query.exec ("PRAGMA synchronous = NORMAL;");
+
+		if (!DB_.tables ().contains ("torrents") &&
+				!query.exec ("CREATE TABLE torrents ("
+						"Filename TEXT PRIMARY KEY, "
+						"Position INTEGER NOT NULL, "
+						"SavePath TEXT NOT NULL, "
+						"Tags TEXT, "
+						"Parameters INTEGER NOT NULL, "
+						"AutoManaged INTEGER NOT NULL, "
+						"Priorities BLOB"
+						");"))
+		{
+			Util::DBLock::DumpError (query);
+			throw std::runtime_error ("unable to create the torrents table");
+		}
+
+		Replacer_ = QSqlQuery { DB_ };
+		Replacer_.prepare ("INSERT OR REPLACE INTO torrents "
+				"(Filename, Position, SavePath, Tags, Parameters, AutoManaged, Priorities) "
+				"VALUES (:filename, :position, :save_path, :tags, :parameters, :auto_managed, :priorities);");
+
+		Remover_ = QSqlQuery { DB_ };
+		Remover_.prepare ("DELETE FROM torrents WHERE Filename = :filename;");
+	}
+
+	SessionStore::~SessionStore ()
+	{
+		const auto& connName = DB_.connectionName ();
+
+		Replacer_ = QSqlQuery {};
+		Remover_ = QSqlQuery {};
+		DB_.close ();
+		DB_ = QSqlDatabase {};
+
+		QSqlDatabase::removeDatabase (connName);
+	}
+
+	QList<SessionStore::Record> SessionStore::Load ()
+	{
+		Written_.clear ();
+		Positions_.clear ();
+
+		QSqlQuery query { DB_ };
+		if (!query.exec ("SELECT Filename, SavePath, Tags, Parameters, AutoManaged, Priorities, Position "
+				"FROM torrents ORDER BY Position;"))
+		{
+			Util::DBLock::DumpError (query);
+			return {};
+		}
+
+		QList<Record> result;
+		while (query.next ())
+		{
+			const auto& tags = query.value (2).toString ();
+			const Record record
+			{
+				query.value (0).toString (),
+				query.value (1).toString (),
+				tags.isEmpty () ? QStringList {} : tags.split (';'),
+				query.value (3).toInt (),
+				query.value (4).toBool (),
+				query.value (5).toByteArray ()
+			};
+			result << record;
+
+			Written_ [record.Filename_] = record;
+			Positions_ [record.Filename_] = query.value (6).toLongLong ();
+		}
+		return result;
+	}
+
+	namespace
+	{
+		const qint64 PositionStep = 1 << 16;
+		const qint64 NoPosition = std::numeric_limits<qint64>::min ();
+
+		/* Returns the indexes of the longest subsequence of the
+		 * positions that is already increasing. The new records have
+		 * NoPosition and are never included.
+		 */
+		QSet<int> GetSortedIndexes (const QVector<qint64>& positions)
+		{
+			QVector<int> tails;
+			QVector<int> prevs (positions.size (), -1);
+			for (int i = 0; i < positions.size (); ++i)
+			{
+				const auto pos = positions.at (i);
+				if (pos == NoPosition)
+					continue;
+
+				const auto tailPos = std::lower_bound (tails.begin (), tails.end (), pos,
+						[&positions] (int idx, qint64 pos) { return positions.at (idx) < pos; });
+				if (tailPos != tails.begin ())
+					prevs [i] = *(tailPos - 1);
+				if (tailPos == tails.end ())
+					tails << i;
+				else
+					*tailPos = i;
+			}
+
+			QSet<int> result;
+			for (int i = tails.isEmpty () ? -1 : tails.last (); i != -1; i = prevs.at (i))
+				result << i;
+			return result;
+		}
+
+		/* Assigns the positions to the records not in the kept
+		 * subsequence, spreading them evenly between their kept
+		 * neighbours. Returns false if some gap is too small.
+		 */
+		bool FillPositions (QVector<qint64>& positions, const QSet<int>& kept)
+		{
+			int runStart = 0;
+			for (int i = 0; i <= positions.size (); ++i)
+			{
+				if (i < positions.size () && !kept.contains (i))
+					continue;
+
+				const auto runLength = i - runStart;
+				if (runLength)
+				{
+					const auto hasPrev = runStart > 0;
+					const auto hasNext = i < positions.size ();
+					qint64 prev = hasPrev ? positions.at (runStart - 1) : 0;
+					qint64 step = PositionStep;
+					if (hasNext)
+					{
+						const auto next = positions.at (i);
+						if (!hasPrev)
+							prev = next - PositionStep * (runLength + 1);
+						step = (next - prev) / (runLength + 1);
+					}
+
+					if (step < 1)
+						return false;
+
+					for (int j = 0; j < runLength; ++j)
+						positions [runStart + j] = prev + step * (j + 1);
+				}
+
+				runStart = i + 1;
+			}
+			return true;
+		}
+	}
+
+	bool SessionStore::Save (const QList<Record>& records)
+	{
+		/* The records that are already stored in the right relative
+		 * order keep their positions, and only the new and moved ones
+		 * get new positions between their neighbours. If there is no
+		 * room left between them, all the records are renumbered.
+		 */
+		QVector<qint64> positions;
+		positions.reserve (records.size ());
+		for (const auto& record : records)
+			positions << Positions_.value (record.Filename_, NoPosition);
+
+		if (!FillPositions (positions, GetSortedIndexes (positions)))
+		{
+			qDebug () << Q_FUNC_INFO
+					<< "renumbering the torrents positions";
+			for (int i = 0; i < positions.size (); ++i)
+				positions [i] = PositionStep * (i + 1);
+		}
+
+		/* The transaction is handled here and not via Util::DBLock,
+		 * since the caller needs to know whether the commit succeeded.
+		 * The connection is private to this store, so nothing else can
+		 * be running a transaction on it.
+		 */
+		if (!DB_.transaction ())
+		{
+			Util::DBLock::DumpError (DB_.lastError ());
+			return false;
+		}
+
+		auto newWritten = Written_;
+		QHash<QString, qint64> newPositions;
+		newPositions.reserve (records.size ());
+
+		auto rollback = [this] () -> bool
+		{
+			if (!DB_.rollback ())
+				Util::DBLock::DumpError (DB_.lastError ());
+			return false;
+		};
+
+		int changed = 0;
+		for (int i = 0; i < records.size (); ++i)
+		{
+			const auto& record = records.at (i);
+			const auto position = positions.at (i);
+			newPositions [record.Filename_] = position;
+
+			const auto pos = newWritten.find (record.Filename_);
+			if (pos != newWritten.end () &&
+					*pos == record &&
+					Positions_.value (record.Filename_) == position)
+				continue;
+
+			Replacer_.bindValue (":filename", record.Filename_);
+			Replacer_.bindValue (":position", position);
+			Replacer_.bindValue (":save_path", record.SavePath_);
+			Replacer_.bindValue (":tags", record.Tags_.join (";"));
+			Replacer_.bindValue (":parameters", record.Parameters_);
+			Replacer_.bindValue (":auto_managed", record.AutoManaged_);
+			Replacer_.bindValue (":priorities", record.Priorities_);
+			if (!Replacer_.exec ())
+			{
+				Util::DBLock::DumpError (Replacer_);
+				return rollback ();
+			}
+
+			newWritten [record.Filename_] = record;
+			++changed;
+		}
+
+		for (auto i = newWritten.begin (); i != newWritten.end (); )
+		{
+			if (newPositions.contains (i.key ()))
+			{
+				++i;
+				continue;
+			}
+
+			Remover_.bindValue (":filename", i.key ());
+			if (!Remover_.exec ())
+			{
+				Util::DBLock::DumpError (Remover_);
+				return rollback ();
+			}
+
+			i = newWritten.erase (i);
+			++changed;
+		}
+
+		if (!changed)
+		{
+			rollback ();
+			return true;
+		}
+
+		if (!DB_.commit ())
+		{
+			Util::DBLock::DumpError (DB_.lastError ());
+			return rollback ();
+		}
+
+		Written_ = newWritten;
+		Positions_ = newPositions;
+		return true;
+	}
+
+	QList<SessionStore::Record> SessionStore::MigrateLegacy (QSettings& settings)
+	{
+		const auto& records = LoadLegacy (settings);
+		if (records.isEmpty ())
+			return records;
+
+		qDebug () << Q_FUNC_INFO
+				<< "migrating"
+				<< records.size ()
+				<< "torrents to the session store";
+		if (Save (records))
+			settings.remove ("AddedTorrents");
+		else
+			qWarning () << Q_FUNC_INFO
+					<< "unable to migrate the torrents, keeping the legacy list";
+
+		return records;
+	}
+
+	QList<SessionStore::Record> SessionStore::LoadLegacy (QSettings& settings)
+	{
+		QList<Record> records;
+
+		const int torrents = settings.beginReadArray ("AddedTorrents");
+		for (int i = 0; i < torrents; ++i)
+		{
+			settings.setArrayIndex (i);
+			records.append ({
+					settings.value ("Filename").toString (),
+					settings.value ("SavePath").toString (),
+					settings.value ("Tags").toStringList (),
+					settings.value ("Parameters").toInt (),
+					settings.value ("AutoManaged", true).toBool (),
+					settings.value ("Priorities").toByteArray ()
+				});
+		}
+		settings.endArray ();
+
+		return records;
+	}
+
+	QList<SessionStore::Record> MergeUnrestored (QList<SessionStore::Record> current,
+			const QList<SessionStore::Record>& unrestored)
+	{
+		QSet<QString> present;
+		for (const auto& record : current)
+			present << record.Filename_;
+
+		for (const auto& record : unrestored)
+			if (!present.contains (record.Filename_))
+				current << record;
+
+		return current;
+	}
+
+	bool operator== (const SessionStore::Record& r1, const SessionStore::Record& r2)
+	{
+		return r1.Filename_ == r2.Filename_ &&
+				r1.SavePath_ == r2.SavePath_ &&
+				r1.Tags_ == r2.Tags_ &&
+				r1.Parameters_ == r2.Parameters_ &&
+				r1.AutoManaged_ == r2.AutoManaged_ &&
+				r1.Priorities_ == r2.Priorities_;
+	}
+
+	bool operator!= (const SessionStore::Record& r1, const SessionStore::Record& r2)
+	{
+		return !(r1 == r2);
+	}
+}
+}
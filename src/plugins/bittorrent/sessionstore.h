@@ -0,0 +1,127 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QHash>
+
+class QSettings;
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	/** Persistent storage for the metadata of the added torrents.
+	 *
+	 * Each torrent is stored in its own row, and Save() only writes the
+	 * rows that have changed since the previous Save() or Load().
+	 *
+	 * The order of the torrents is kept via sparse position keys, so
+	 * adding, removing or moving a torrent doesn't touch the rows of
+	 * the other ones.
+	 */
+	class SessionStore
+	{
+	public:
+		struct Record
+		{
+			QString Filename_;
+			QString SavePath_;
+			QStringList Tags_;
+			int Parameters_;
+			bool AutoManaged_;
+			QByteArray Priorities_;
+		};
+	private:
+		QSqlDatabase DB_;
+
+		QSqlQuery Replacer_;
+		QSqlQuery Remover_;
+
+		QHash<QString, Record> Written_;
+		QHash<QString, qint64> Positions_;
+	public:
+		/** Opens or creates the store in the given directory.
+		 *
+		 * Throws std::runtime_error if the database can't be opened.
+		 */
+		SessionStore (const QString& dir);
+		~SessionStore ();
+
+		SessionStore (const SessionStore&) = delete;
+		SessionStore& operator= (const SessionStore&) = delete;
+
+		/** Returns the stored records in the order they have been
+		 * saved.
+		 */
+		QList<Record> Load ();
+
+		/** Makes the stored records equal to the given ones, writing
+		 * only the added, changed or moved ones and removing the
+		 * missing ones.
+		 *
+		 * Returns whether the records have been stored. Nothing is
+		 * changed in the store if false is returned.
+		 */
+		bool Save (const QList<Record>&);
+
+		/** Imports the torrents list stored in the legacy format, as the
+		 * AddedTorrents array in the current group of the given
+		 * settings, and removes it from the settings once it has been
+		 * saved to this store.
+		 *
+		 * This function should only be called if the store is empty.
+		 *
+		 * Returns the imported records, whether they have been saved or
+		 * not.
+		 */
+		QList<Record> MigrateLegacy (QSettings&);
+
+		/** Reads the torrents list stored in the legacy format, as the
+		 * AddedTorrents array in the current group of the given
+		 * settings.
+		 */
+		static QList<Record> LoadLegacy (QSettings&);
+	};
+
+	/** Appends the records of the torrents whose restore has been
+	 * interrupted to the records of the current torrents, skipping the
+	 * ones already present there, so that saving the result doesn't
+	 * remove the unrestored torrents from the store.
+	 */
+	QList<SessionStore::Record> MergeUnrestored (QList<SessionStore::Record> current,
+			const QList<SessionStore::Record>& unrestored);
+
+	bool operator== (const SessionStore::Record&, const SessionStore::Record&);
+	bool operator!= (const SessionStore::Record&, const SessionStore::Record&);
+}
+}
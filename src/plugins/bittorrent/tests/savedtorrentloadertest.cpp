@@ -0,0 +1,191 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "savedtorrentloadertest.h"
+#include <cstring>
+#include <string>
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QUuid>
+#include <libtorrent/bencode.hpp>
+#include <libtorrent/create_torrent.hpp>
+#include <libtorrent/entry.hpp>
+#include <libtorrent/file_storage.hpp>
+#include "savedtorrentloader.h"
+
+QTEST_MAIN (LeechCraft::BitTorrent::SavedTorrentLoaderTest)
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	namespace
+	{
+		const int SessionSize = 5000;
+
+		QByteArray Bencode (const libtorrent::entry& e)
+		{
+			QByteArray result;
+			libtorrent::bencode (std::back_inserter (result), e);
+			return result;
+		}
+
+		/* Builds a torrent with a single 16 MiB file without touching
+		 * the disk: the piece hashes are just made up.
+		 */
+		QByteArray MakeTorrent (int idx)
+		{
+			libtorrent::file_storage fs;
+			fs.add_file ("synthetic_" + std::to_string (idx) + "/data.bin", 16 * 1024 * 1024);
+
+			libtorrent::create_torrent ct { fs, 256 * 1024 };
+			for (int i = 0; i < ct.num_pieces (); ++i)
+			{
+				char hash [20] = { 0 };
+				std::memcpy (hash, &idx, sizeof (idx));
+				std::memcpy (hash + sizeof (idx), &i, sizeof (i));
+				ct.set_hash (i, libtorrent::sha1_hash { hash });
+			}
+			ct.add_tracker ("http://tracker.example.com/announce");
+
+			return Bencode (ct.generate ());
+		}
+
+		QByteArray MakeResumeData (int idx)
+		{
+			libtorrent::entry e;
+			e ["file-format"] = "libtorrent resume file";
+			e ["file-version"] = 1;
+			e ["total_uploaded"] = idx;
+			e ["total_downloaded"] = idx * 2;
+			return Bencode (e);
+		}
+
+		void WriteFile (const QString& path, const QByteArray& data)
+		{
+			QFile file { path };
+			QVERIFY (file.open (QIODevice::WriteOnly));
+			QCOMPARE (file.write (data), static_cast<qint64> (data.size ()));
+		}
+
+		SessionStore::Record MakeRecord (const QString& filename)
+		{
+			return { filename, QDir::tempPath (), {}, 0, true, {} };
+		}
+	}
+
+	void SavedTorrentLoaderTest::initTestCase ()
+	{
+		Dir_ = QDir::temp ().absoluteFilePath ("lc_bittorrent_test_" +
+				QUuid::createUuid ().toString ().mid (1, 36)) + "/";
+		QVERIFY (QDir {}.mkpath (Dir_));
+
+		for (int i = 0; i < SessionSize; ++i)
+		{
+			const auto& filename = QString ("synthetic_%1.torrent").arg (i);
+			WriteFile (Dir_ + filename, MakeTorrent (i));
+			WriteFile (Dir_ + filename + ".resume", MakeResumeData (i));
+			Records_ << MakeRecord (filename);
+		}
+
+		WriteFile (Dir_ + "broken.torrent", "d4:infoi42e");
+	}
+
+	void SavedTorrentLoaderTest::cleanupTestCase ()
+	{
+		QDir dir { Dir_ };
+		for (const auto& file : dir.entryList (QDir::Files))
+			dir.remove (file);
+		QDir::temp ().rmdir (dir.dirName ());
+	}
+
+	void SavedTorrentLoaderTest::testLoad ()
+	{
+		const auto& saved = LoadSavedTorrent (Dir_, Records_.at (42));
+
+		QVERIFY (saved.Error_.isEmpty ());
+		QVERIFY (saved.Info_);
+		QCOMPARE (QString::fromStdString (saved.Info_->name ()), QString ("synthetic_42"));
+		QCOMPARE (saved.Info_->num_files (), 1);
+		QCOMPARE (saved.TorrentData_, MakeTorrent (42));
+		QCOMPARE (saved.ResumeData_, MakeResumeData (42));
+		QCOMPARE (saved.Record_.Filename_, Records_.at (42).Filename_);
+	}
+
+	void SavedTorrentLoaderTest::testMissingTorrent ()
+	{
+		const auto& saved = LoadSavedTorrent (Dir_, MakeRecord ("nonexistent.torrent"));
+
+		QVERIFY (!saved.Error_.isEmpty ());
+		QVERIFY (!saved.Info_);
+	}
+
+	void SavedTorrentLoaderTest::testBrokenTorrent ()
+	{
+		const auto& saved = LoadSavedTorrent (Dir_, MakeRecord ("broken.torrent"));
+
+		QVERIFY (!saved.Error_.isEmpty ());
+		QVERIFY (!saved.Info_);
+	}
+
+	void SavedTorrentLoaderTest::testParallelOrder ()
+	{
+		auto future = LoadSavedTorrents (Dir_, Records_);
+		future.waitForFinished ();
+
+		const auto& results = future.results ();
+		QCOMPARE (results.size (), Records_.size ());
+		for (int i = 0; i < results.size (); ++i)
+		{
+			QCOMPARE (results.at (i).Record_.Filename_, Records_.at (i).Filename_);
+			QVERIFY (results.at (i).Info_);
+			QCOMPARE (QString::fromStdString (results.at (i).Info_->name ()),
+					QString ("synthetic_%1").arg (i));
+		}
+	}
+
+	void SavedTorrentLoaderTest::benchmarkSerial5k ()
+	{
+		QBENCHMARK
+		{
+			for (const auto& record : Records_)
+				LoadSavedTorrent (Dir_, record);
+		}
+	}
+
+	void SavedTorrentLoaderTest::benchmarkParallel5k ()
+	{
+		QBENCHMARK
+		{
+			LoadSavedTorrents (Dir_, Records_).waitForFinished ();
+		}
+	}
+}
+}
@@ -0,0 +1,282 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "sessionstoretest.h"
+#include <QtTest>
+#include <QDir>
+#include <QSettings>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QUuid>
+#include "sessionstore.h"
+
+QTEST_MAIN (LeechCraft::BitTorrent::SessionStoreTest)
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	namespace
+	{
+		SessionStore::Record MakeRecord (const QString& filename)
+		{
+			return { filename, "/tmp/" + filename, {}, 0, true, {} };
+		}
+
+		QList<SessionStore::Record> MakeRecords (const QStringList& filenames)
+		{
+			QList<SessionStore::Record> result;
+			for (const auto& filename : filenames)
+				result << MakeRecord (filename);
+			return result;
+		}
+
+		QStringList GetFilenames (const QList<SessionStore::Record>& records)
+		{
+			QStringList result;
+			for (const auto& record : records)
+				result << record.Filename_;
+			return result;
+		}
+
+		/* Reads the positions directly from the database, bypassing the
+		 * store.
+		 */
+		QHash<QString, qint64> ReadPositions (const QString& dir)
+		{
+			const QString connName { "org.LeechCraft.BitTorrent.SessionStoreTest" };
+
+			QHash<QString, qint64> result;
+			{
+				auto db = QSqlDatabase::addDatabase ("QSQLITE", connName);
+				db.setDatabaseName (QDir { dir }.absoluteFilePath ("torrents.db"));
+				if (db.open ())
+				{
+					QSqlQuery query { db };
+					query.exec ("SELECT Filename, Position FROM torrents;");
+					while (query.next ())
+						result [query.value (0).toString ()] = query.value (1).toLongLong ();
+				}
+			}
+			QSqlDatabase::removeDatabase (connName);
+
+			return result;
+		}
+	}
+
+	void SessionStoreTest::init ()
+	{
+		Dir_ = QDir::temp ().absoluteFilePath ("lc_bittorrent_sessionstore_test_" +
+				QUuid::createUuid ().toString ().mid (1, 36));
+		QVERIFY (QDir {}.mkpath (Dir_));
+	}
+
+	void SessionStoreTest::cleanup ()
+	{
+		QDir dir { Dir_ };
+		for (const auto& file : dir.entryList (QDir::Files))
+			dir.remove (file);
+		QDir::temp ().rmdir (dir.dirName ());
+	}
+
+	void SessionStoreTest::testRoundTrip ()
+	{
+		QList<SessionStore::Record> records
+		{
+			{ "a.torrent", "/tmp/a", { "tag1", "tag2" }, 1, true, QByteArray ("\x01\x00\x07", 3) },
+			{ "b.torrent", "/tmp/b", {}, 0, false, {} },
+			{ "c.torrent", "/tmp/c", { "tag3" }, 2, true, QByteArray ("\x04") }
+		};
+
+		{
+			SessionStore store { Dir_ };
+			QVERIFY (store.Load ().isEmpty ());
+			QVERIFY (store.Save (records));
+		}
+
+		SessionStore store { Dir_ };
+		QVERIFY (store.Load () == records);
+	}
+
+	void SessionStoreTest::testRemove ()
+	{
+		{
+			SessionStore store { Dir_ };
+			store.Load ();
+			QVERIFY (store.Save (MakeRecords ({ "a", "b", "c" })));
+			QVERIFY (store.Save (MakeRecords ({ "a", "c" })));
+		}
+
+		SessionStore store { Dir_ };
+		QCOMPARE (GetFilenames (store.Load ()), QStringList ({ "a", "c" }));
+		QCOMPARE (ReadPositions (Dir_).size (), 2);
+	}
+
+	void SessionStoreTest::testInsertKeepsPositions ()
+	{
+		SessionStore store { Dir_ };
+		store.Load ();
+		QVERIFY (store.Save (MakeRecords ({ "a", "b", "c" })));
+		const auto& before = ReadPositions (Dir_);
+
+		QVERIFY (store.Save (MakeRecords ({ "a", "x", "b", "c" })));
+		const auto& after = ReadPositions (Dir_);
+
+		QCOMPARE (after ["a"], before ["a"]);
+		QCOMPARE (after ["b"], before ["b"]);
+		QCOMPARE (after ["c"], before ["c"]);
+		QVERIFY (after ["a"] < after ["x"]);
+		QVERIFY (after ["x"] < after ["b"]);
+
+		QCOMPARE (GetFilenames (SessionStore { Dir_ }.Load ()), QStringList ({ "a", "x", "b", "c" }));
+	}
+
+	void SessionStoreTest::testMoveKeepsPositions ()
+	{
+		SessionStore store { Dir_ };
+		store.Load ();
+		QVERIFY (store.Save (MakeRecords ({ "a", "b", "c", "d" })));
+		const auto& before = ReadPositions (Dir_);
+
+		// Only "b" is out of the longest already sorted subsequence.
+		QVERIFY (store.Save (MakeRecords ({ "a", "c", "d", "b" })));
+		const auto& after = ReadPositions (Dir_);
+
+		QCOMPARE (after ["a"], before ["a"]);
+		QCOMPARE (after ["c"], before ["c"]);
+		QCOMPARE (after ["d"], before ["d"]);
+		QVERIFY (after ["b"] > after ["d"]);
+
+		QCOMPARE (GetFilenames (SessionStore { Dir_ }.Load ()), QStringList ({ "a", "c", "d", "b" }));
+	}
+
+	void SessionStoreTest::testRenumber ()
+	{
+		SessionStore store { Dir_ };
+		store.Load ();
+
+		/* Each insertion right after the first record halves the gap,
+		 * so the positions run out and get renumbered at some point.
+		 */
+		QStringList filenames { "first", "last" };
+		QVERIFY (store.Save (MakeRecords (filenames)));
+		for (int i = 0; i < 24; ++i)
+		{
+			filenames.insert (1, QString::number (i));
+			QVERIFY (store.Save (MakeRecords (filenames)));
+		}
+
+		QCOMPARE (GetFilenames (SessionStore { Dir_ }.Load ()), filenames);
+	}
+
+	void SessionStoreTest::testInterruptedRestore ()
+	{
+		{
+			SessionStore store { Dir_ };
+			store.Load ();
+			QVERIFY (store.Save (MakeRecords ({ "a", "b", "c", "d" })));
+		}
+		const auto& before = ReadPositions (Dir_);
+
+		SessionStore store { Dir_ };
+		const auto& stored = store.Load ();
+		QCOMPARE (stored.size (), 4);
+
+		/* Only the first two torrents have been restored when the
+		 * restore is cancelled, and one of them has been changed.
+		 */
+		auto restored = stored.mid (0, 2);
+		restored [1].Tags_ << "changed";
+		const auto& unrestored = stored.mid (2);
+
+		QVERIFY (store.Save (MergeUnrestored (restored, unrestored)));
+		QCOMPARE (ReadPositions (Dir_), before);
+
+		const auto& loaded = SessionStore { Dir_ }.Load ();
+		QCOMPARE (GetFilenames (loaded), QStringList ({ "a", "b", "c", "d" }));
+		QCOMPARE (loaded.at (1).Tags_, QStringList { "changed" });
+	}
+
+	void SessionStoreTest::testLegacyMigration ()
+	{
+		const auto& settingsPath = QDir { Dir_ }.absoluteFilePath ("legacy.ini");
+
+		const QList<SessionStore::Record> expected
+		{
+			{ "a.torrent", "/tmp/a", { "tag1" }, 1, false, QByteArray ("\x01\x02") },
+			{ "b.torrent", "/tmp/b", {}, 0, true, {} }
+		};
+
+		{
+			QSettings settings { settingsPath, QSettings::IniFormat };
+			settings.beginGroup ("Core");
+			settings.beginWriteArray ("AddedTorrents");
+			settings.setArrayIndex (0);
+			settings.setValue ("Filename", "a.torrent");
+			settings.setValue ("SavePath", "/tmp/a");
+			settings.setValue ("Tags", QStringList { "tag1" });
+			settings.setValue ("Parameters", 1);
+			settings.setValue ("AutoManaged", false);
+			settings.setValue ("Priorities", QByteArray ("\x01\x02"));
+			// The older versions didn't store the AutoManaged flag.
+			settings.setArrayIndex (1);
+			settings.setValue ("Filename", "b.torrent");
+			settings.setValue ("SavePath", "/tmp/b");
+			settings.setValue ("Parameters", 0);
+			settings.endArray ();
+			settings.endGroup ();
+		}
+
+		{
+			QSettings settings { settingsPath, QSettings::IniFormat };
+			settings.beginGroup ("Core");
+
+			SessionStore store { Dir_ };
+			QVERIFY (store.Load ().isEmpty ());
+			QVERIFY (store.MigrateLegacy (settings) == expected);
+			QVERIFY (!settings.childGroups ().contains ("AddedTorrents"));
+			settings.endGroup ();
+		}
+
+		SessionStore store { Dir_ };
+		QVERIFY (store.Load () == expected);
+	}
+
+	void SessionStoreTest::testNoLegacy ()
+	{
+		QSettings settings { QDir { Dir_ }.absoluteFilePath ("legacy.ini"), QSettings::IniFormat };
+		settings.beginGroup ("Core");
+
+		SessionStore store { Dir_ };
+		QVERIFY (store.Load ().isEmpty ());
+		QVERIFY (store.MigrateLegacy (settings).isEmpty ());
+		QVERIFY (ReadPositions (Dir_).isEmpty ());
+	}
+}
+}
@@ -325,6 +325,14 @@ namespace BitTorrent
 		Core::Instance ()->Handle (e);
 	}
 
+	EntityRoutingKeys TorrentPlugin::GetEntityRoutingKeys () const
+	{
+		/* Torrents are downloaded from magnet links, local .torrent
+		 * files and raw .torrent contents.
+		 */
+		return { {}, { "magnet", "file" }, {}, { "QByteArray" } };
+	}
+
 	void TorrentPlugin::KillTask (int id)
 	{
 		Core::Instance ()->KillTask (id);
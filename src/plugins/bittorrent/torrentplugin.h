@@ -45,6 +45,7 @@
 #include <interfaces/istartupwizard.h>
 #include <interfaces/iactionsexporter.h>
 #include <interfaces/ihavediaginfo.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 #include <util/tags/tagscompleter.h>
 #include <xmlsettingsdialog/xmlsettingsdialog.h>
 #include "tabwidget.h"
@@ -79,6 +80,7 @@ namespace BitTorrent
 						, public IStartupWizard
 						, public IActionsExporter
 						, public IHaveDiagInfo
+						, public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
 
@@ -93,7 +95,8 @@ namespace BitTorrent
 				IHaveTabs
 				IStartupWizard
 				IActionsExporter
-				IHaveDiagInfo)
+				IHaveDiagInfo
+				IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.BitTorrent")
 
@@ -173,6 +176,8 @@ namespace BitTorrent
 		EntityTestHandleResult CouldHandle (const LeechCraft::Entity&) const;
 		void Handle (LeechCraft::Entity);
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 		// IJobHolder
 		QAbstractItemModel* GetRepresentation () const;
 
@@ -51,6 +51,7 @@
 #include <util/xpc/notificationactionhandler.h>
 #include <util/xpc/util.h>
 #include "task.h"
+#include "filewriter.h"
 #include "xmlsettingsmanager.h"
 #include "addtask.h"
 
@@ -76,10 +77,12 @@ namespace CSTP
 	: Headers_ { "URL", tr ("State"), tr ("Progress") }
 	, SaveScheduled_ (false)
 	, Toolbar_ (0)
+	, Writer_ (new FileWriter)
 	{
 		setObjectName ("CSTP Core");
 		qRegisterMetaType<std::shared_ptr<QFile>> ("std::shared_ptr<QFile>");
 		qRegisterMetaType<QNetworkReply*> ("QNetworkReply*");
+		qRegisterMetaType<WriteBuffer_ptr> ("LeechCraft::CSTP::WriteBuffer_ptr");
 
 		ReadSettings ();
 	}
@@ -92,7 +95,17 @@ namespace CSTP
 
 	void Core::Release ()
 	{
+		for (const auto& td : ActiveTasks_)
+			td.Task_->flushWrites ();
+		Writer_->Release ();
+
+		// Only save the tasks once everything they've downloaded is on
+		// disk, so the saved state matches the files.
 		writeSettings ();
+
+		// The writer is back in this thread now, and the tasks still
+		// refer to it until they are destroyed along with the core.
+		Writer_->setParent (this);
 	}
 
 	void Core::SetCoreProxy (ICoreProxy_ptr proxy)
@@ -325,6 +338,10 @@ namespace CSTP
 				SIGNAL (updateInterface ()),
 				this,
 				SLOT (updateInterface ()));
+		connect (Writer_,
+				SIGNAL (flushed (LeechCraft::CSTP::WriteBuffer_ptr)),
+				td.Task_.get (),
+				SLOT (handleBufferFlushed (LeechCraft::CSTP::WriteBuffer_ptr)));
 
 		beginInsertRows (QModelIndex (), rowCount (), rowCount ());
 		ActiveTasks_.push_back (td);
@@ -425,6 +442,11 @@ namespace CSTP
 		FinishedReplies_.remove (rep);
 	}
 
+	FileWriter* Core::GetFileWriter () const
+	{
+		return Writer_;
+	}
+
 	int Core::columnCount (const QModelIndex&) const
 	{
 		return Headers_.size ();
@@ -488,6 +510,20 @@ namespace CSTP
 				return QVariant ();
 			}
 		}
+		else if (role == Qt::ToolTipRole)
+		{
+			const auto& stats = TaskAt (index.row ()).Task_->GetWriteStats ();
+			if (!stats.Capacity_)
+				return {};
+
+			return tr ("Write buffer: %1 of %2<br/>Written: %3 in %4 flushes<br/>Last flush: %5 in %6 ms")
+					.arg (Util::MakePrettySize (stats.Pending_))
+					.arg (Util::MakePrettySize (stats.Capacity_))
+					.arg (Util::MakePrettySize (stats.Written_))
+					.arg (stats.Flushes_)
+					.arg (Util::MakePrettySize (stats.LastFlushSize_))
+					.arg (stats.LastFlushTime_);
+		}
 		else if (role == LeechCraft::RoleControls)
 			return QVariant::fromValue<QToolBar*> (Toolbar_);
 		else if (role == CustomDataRoles::RoleJobHolderRow)
@@ -792,6 +828,10 @@ namespace CSTP
 					SIGNAL (updateInterface ()),
 					this,
 					SLOT (updateInterface ()));
+			connect (Writer_,
+					SIGNAL (flushed (LeechCraft::CSTP::WriteBuffer_ptr)),
+					td.Task_.get (),
+					SLOT (handleBufferFlushed (LeechCraft::CSTP::WriteBuffer_ptr)));
 
 			QString filename = settings.value ("Filename").toString ();
 			td.File_.reset (new QFile (filename));
@@ -59,6 +59,7 @@ namespace LeechCraft
 namespace CSTP
 {
 	class Task;
+	class FileWriter;
 
 	class Core : public QAbstractItemModel
 	{
@@ -84,6 +85,7 @@ namespace CSTP
 		QSet<QNetworkReply*> FinishedReplies_;
 		QModelIndex Selected_;
 		ICoreProxy_ptr CoreProxy_;
+		FileWriter * const Writer_;
 
 		explicit Core ();
 	public:
@@ -116,6 +118,7 @@ namespace CSTP
 		QNetworkAccessManager* GetNetworkAccessManager () const;
 		bool HasFinishedReply (QNetworkReply*) const;
 		void RemoveFinishedReply (QNetworkReply*);
+		FileWriter* GetFileWriter () const;
 
 		virtual int columnCount (const QModelIndex& = QModelIndex ()) const;
 		virtual QVariant data (const QModelIndex&, int = Qt::DisplayRole) const;
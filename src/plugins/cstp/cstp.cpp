@@ -201,6 +201,11 @@ namespace CSTP
 		return XmlSettingsDialog_;
 	}
 
+	EntityRoutingKeys CSTP::GetEntityRoutingKeys () const
+	{
+		return { {}, { "http", "https", "file" }, {}, { "QNetworkReply*", "QList<QUrl>" } };
+	}
+
 	template<typename T>
 	void CSTP::ApplyCore2Selection (void (Core::*temp) (const QModelIndex&), T view)
 	{
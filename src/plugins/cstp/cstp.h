@@ -36,6 +36,7 @@
 #include <interfaces/ijobholder.h>
 #include <interfaces/ihavesettings.h>
 #include <interfaces/structures.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 #include <xmlsettingsdialog/xmlsettingsdialog.h>
 
 class QTabWidget;
@@ -61,9 +62,10 @@ namespace CSTP
 				, public IDownload
 				, public IJobHolder
 				, public IHaveSettings
+				, public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo IDownload IJobHolder IHaveSettings)
+		Q_INTERFACES (IInfo IDownload IJobHolder IHaveSettings IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.CSTP")
 
@@ -96,6 +98,8 @@ namespace CSTP
 		QAbstractItemModel* GetRepresentation () const;
 
 		Util::XmlSettingsDialog_ptr GetSettingsDialog () const;
+
+		EntityRoutingKeys GetEntityRoutingKeys () const;
 	private:
 		template<typename T> void ApplyCore2Selection (void (Core::*) (const QModelIndex&), T);
 		void SetupToolbar ();
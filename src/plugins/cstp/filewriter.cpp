@@ -0,0 +1,287 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filewriter.h"
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <QThread>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QtDebug>
+
+namespace LeechCraft
+{
+namespace CSTP
+{
+	WriteBuffer::WriteBuffer (const QString& path, qint64 capacity)
+	: Capacity_ (capacity)
+	, FlushThreshold_ (std::min<qint64> (capacity / 4, 1024 * 1024))
+	, Path_ (path)
+	{
+	}
+
+	bool WriteBuffer::Enqueue (qint64 pos, const QByteArray& data)
+	{
+		QMutexLocker locker (&Mutex_);
+		Chunks_.append ({ pos, data });
+		Queued_ += data.size ();
+		++Seq_;
+		return !Scheduled_ && Queued_ >= FlushThreshold_;
+	}
+
+	quint64 WriteBuffer::GetLastSeq () const
+	{
+		QMutexLocker locker (&Mutex_);
+		return Seq_;
+	}
+
+	quint64 WriteBuffer::GetWrittenSeq () const
+	{
+		QMutexLocker locker (&Mutex_);
+		return WrittenSeq_;
+	}
+
+	void WriteBuffer::Discard ()
+	{
+		{
+			QMutexLocker locker (&Mutex_);
+			Chunks_.clear ();
+			Queued_ = 0;
+		}
+
+		QMutexLocker ioLocker (&IOMutex_);
+	}
+
+	void WriteBuffer::SetPath (const QString& path)
+	{
+		QMutexLocker locker (&Mutex_);
+		Path_ = path;
+	}
+
+	void WriteBuffer::Rename (const std::function<QString ()>& rename)
+	{
+		QMutexLocker ioLocker (&IOMutex_);
+		const auto& path = rename ();
+
+		QMutexLocker locker (&Mutex_);
+		Path_ = path;
+	}
+
+	void WriteBuffer::SetPreallocationSize (qint64 size)
+	{
+		QMutexLocker locker (&Mutex_);
+		Preallocate_ = size;
+	}
+
+	bool WriteBuffer::IsFull () const
+	{
+		QMutexLocker locker (&Mutex_);
+		return Queued_ + InFlight_ >= Capacity_;
+	}
+
+	qint64 WriteBuffer::GetPending () const
+	{
+		QMutexLocker locker (&Mutex_);
+		return Queued_ + InFlight_;
+	}
+
+	QString WriteBuffer::TakeError ()
+	{
+		QMutexLocker locker (&Mutex_);
+		QString result;
+		std::swap (result, Error_);
+		return result;
+	}
+
+	WriteBuffer::Stats WriteBuffer::GetStats () const
+	{
+		QMutexLocker locker (&Mutex_);
+		return
+		{
+			Queued_ + InFlight_,
+			Capacity_,
+			Written_,
+			Flushes_,
+			LastFlushSize_,
+			LastFlushTime_
+		};
+	}
+
+	FileWriter::FileWriter ()
+	: Thread_ (new QThread)
+	{
+		moveToThread (Thread_);
+		Thread_->start (QThread::LowPriority);
+	}
+
+	void FileWriter::Schedule (const WriteBuffer_ptr& buffer)
+	{
+		{
+			QMutexLocker locker (&buffer->Mutex_);
+			if (buffer->Scheduled_ || buffer->Chunks_.isEmpty ())
+				return;
+			buffer->Scheduled_ = true;
+		}
+
+		QMetaObject::invokeMethod (this,
+				"flush",
+				Qt::QueuedConnection,
+				Q_ARG (LeechCraft::CSTP::WriteBuffer_ptr, buffer));
+	}
+
+	void FileWriter::Release ()
+	{
+		QMetaObject::invokeMethod (this,
+				"quitThread",
+				Qt::QueuedConnection);
+		Thread_->wait ();
+		delete Thread_;
+	}
+
+	namespace
+	{
+		void Preallocate (QFile& file, qint64 size)
+		{
+#ifdef Q_OS_LINUX
+			if (fallocate (file.handle (), FALLOC_FL_KEEP_SIZE, 0, size))
+				qWarning () << Q_FUNC_INFO
+						<< "unable to preallocate"
+						<< size
+						<< "bytes for"
+						<< file.fileName ()
+						<< strerror (errno);
+#else
+			Q_UNUSED (file)
+			Q_UNUSED (size)
+#endif
+		}
+	}
+
+	void FileWriter::flush (const WriteBuffer_ptr& buffer)
+	{
+		QList<WriteBuffer::Chunk> chunks;
+		QString path;
+		qint64 preallocate = 0;
+		quint64 seq = 0;
+		{
+			QMutexLocker locker (&buffer->Mutex_);
+			buffer->Scheduled_ = false;
+			std::swap (chunks, buffer->Chunks_);
+			std::swap (preallocate, buffer->Preallocate_);
+			buffer->InFlight_ = buffer->Queued_;
+			buffer->Queued_ = 0;
+			seq = buffer->Seq_;
+		}
+
+		if (chunks.isEmpty ())
+			return;
+
+		QElapsedTimer timer;
+		timer.start ();
+
+		qint64 written = 0;
+		QString error;
+		{
+			QMutexLocker ioLocker (&buffer->IOMutex_);
+
+			// The file might have been renamed while we were waiting.
+			{
+				QMutexLocker locker (&buffer->Mutex_);
+				path = buffer->Path_;
+			}
+
+			QFile file (path);
+			if (!file.open (QIODevice::ReadWrite | QIODevice::Unbuffered))
+				error = file.errorString ();
+			else
+			{
+				if (preallocate)
+					Preallocate (file, preallocate);
+
+				std::stable_sort (chunks.begin (), chunks.end (),
+						[] (const WriteBuffer::Chunk& left, const WriteBuffer::Chunk& right)
+							{ return left.Pos_ < right.Pos_; });
+
+				for (int i = 0; i < chunks.size (); )
+				{
+					const auto pos = chunks.at (i).Pos_;
+					auto data = chunks.at (i++).Data_;
+					while (i < chunks.size () &&
+							chunks.at (i).Pos_ == pos + data.size ())
+						data += chunks.at (i++).Data_;
+
+					if (!file.seek (pos) ||
+							file.write (data) != data.size ())
+					{
+						error = file.errorString ();
+						break;
+					}
+
+					written += data.size ();
+				}
+			}
+		}
+
+		if (!error.isEmpty ())
+			qWarning () << Q_FUNC_INFO
+					<< "error writing to"
+					<< path
+					<< error;
+
+		{
+			QMutexLocker locker (&buffer->Mutex_);
+			buffer->InFlight_ = 0;
+			buffer->Written_ += written;
+			++buffer->Flushes_;
+			buffer->LastFlushSize_ = written;
+			buffer->LastFlushTime_ = timer.elapsed ();
+			if (error.isEmpty ())
+				buffer->WrittenSeq_ = seq;
+			else
+				buffer->Error_ = error;
+		}
+
+		emit flushed (buffer);
+	}
+
+	void FileWriter::quitThread ()
+	{
+		// Hand the object back to the thread owning the QThread so that
+		// it could be safely deleted there.
+		moveToThread (Thread_->thread ());
+		Thread_->quit ();
+	}
+}
+}
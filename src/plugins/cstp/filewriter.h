@@ -0,0 +1,179 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <QObject>
+#include <QMutex>
+#include <QList>
+#include <QString>
+
+class QThread;
+
+namespace LeechCraft
+{
+namespace CSTP
+{
+	class FileWriter;
+
+	/** Pending positioned writes of a single task.
+	 *
+	 * The buffer is filled by its task in the GUI thread and drained by
+	 * the FileWriter in the writer thread. It is bounded: once the amount
+	 * of not yet written data reaches the capacity, IsFull() returns true
+	 * and the task is expected to stop reading from the network until the
+	 * writer catches up.
+	 */
+	class WriteBuffer
+	{
+		friend class FileWriter;
+
+		struct Chunk
+		{
+			qint64 Pos_;
+			QByteArray Data_;
+		};
+
+		mutable QMutex Mutex_;
+		QMutex IOMutex_;
+
+		QList<Chunk> Chunks_;
+		qint64 Queued_ = 0;
+		qint64 InFlight_ = 0;
+		const qint64 Capacity_;
+		const qint64 FlushThreshold_;
+
+		QString Path_;
+		qint64 Preallocate_ = 0;
+		bool Scheduled_ = false;
+		QString Error_;
+
+		quint64 Seq_ = 0;
+		quint64 WrittenSeq_ = 0;
+
+		qint64 Written_ = 0;
+		int Flushes_ = 0;
+		qint64 LastFlushSize_ = 0;
+		int LastFlushTime_ = 0;
+	public:
+		struct Stats
+		{
+			qint64 Pending_;
+			qint64 Capacity_;
+			qint64 Written_;
+			int Flushes_;
+			qint64 LastFlushSize_;
+			int LastFlushTime_;
+		};
+
+		WriteBuffer (const QString& path, qint64 capacity);
+
+		/** Queues the data to be written at the given position.
+		 *
+		 * Returns true if enough data has been accumulated to be worth
+		 * scheduling a flush.
+		 */
+		bool Enqueue (qint64 pos, const QByteArray& data);
+
+		/** Returns the sequence number of the last enqueued chunk.
+		 */
+		quint64 GetLastSeq () const;
+
+		/** Returns the sequence number up to which all the enqueued
+		 * chunks have been written to the file, not counting the
+		 * discarded ones.
+		 */
+		quint64 GetWrittenSeq () const;
+
+		/** Drops all the data not yet picked up by the writer and waits
+		 * for the write in progress, if any, to complete.
+		 */
+		void Discard ();
+
+		void SetPath (const QString&);
+
+		/** Renames the file via the given function, which should
+		 * return the new path. No writes happen to the file while
+		 * the function runs, and the following ones go to the new
+		 * path.
+		 */
+		void Rename (const std::function<QString ()>&);
+
+		/** Asks the writer to reserve the given amount of disk space
+		 * for the file before the next write, if the platform supports
+		 * it. The file size is not changed.
+		 */
+		void SetPreallocationSize (qint64);
+
+		bool IsFull () const;
+		qint64 GetPending () const;
+		QString TakeError ();
+		Stats GetStats () const;
+	};
+
+	typedef std::shared_ptr<WriteBuffer> WriteBuffer_ptr;
+
+	/** Writes the data queued in WriteBuffers in a single thread shared by
+	 * all the tasks.
+	 *
+	 * The chunks of a buffer picked up at once are sorted and adjacent
+	 * ones are merged, so a flush results in a few large writes.
+	 */
+	class FileWriter : public QObject
+	{
+		Q_OBJECT
+
+		QThread * const Thread_;
+	public:
+		FileWriter ();
+
+		/** Schedules writing the data queued in the buffer.
+		 *
+		 * Does nothing if the buffer is empty or already scheduled.
+		 */
+		void Schedule (const WriteBuffer_ptr&);
+
+		/** Writes all the scheduled data and stops the writer thread.
+		 *
+		 * The object can be deleted afterwards.
+		 */
+		void Release ();
+	private slots:
+		void flush (const LeechCraft::CSTP::WriteBuffer_ptr&);
+		void quitThread ();
+	signals:
+		/** Emitted from the writer thread after the buffer has been
+		 * flushed or an error has occurred while doing so.
+		 */
+		void flushed (const LeechCraft::CSTP::WriteBuffer_ptr&);
+	};
+}
+}
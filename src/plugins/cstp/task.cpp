@@ -29,6 +29,7 @@
 
 #include "task.h"
 #include <algorithm>
+#include <limits>
 #include <typeinfo>
 #include <stdexcept>
 #include <QUrl>
@@ -36,6 +37,8 @@
 #include <QDataStream>
 #include <QDir>
 #include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 #include <QtDebug>
 #include <util/xpc/util.h>
 #include <interfaces/core/icoreproxy.h>
@@ -53,6 +56,62 @@ namespace CSTP
 			if (rep)
 				rep->deleteLater ();
 		}
+
+		/** Downloads smaller than this are never split.
+		 */
+		const qint64 MinSegmentedSize = 4 * 1024 * 1024;
+
+		/** A segment is never split into parts smaller than this.
+		 */
+		const qint64 MinSegmentSize = 512 * 1024;
+
+		/** The number of failed segment connections after which the
+		 * whole task fails.
+		 */
+		const int MaxSegmentErrors = 5;
+
+		/** The amount of data a reply may buffer while the task doesn't
+		 * read from it because its write buffer is full.
+		 */
+		const qint64 ReplyReadBufferSize = 1024 * 1024;
+
+		struct ContentRange
+		{
+			qint64 Start_ = -1;
+			qint64 End_ = -1;
+			qint64 Total_ = -1;
+		};
+
+		ContentRange ParseContentRange (QByteArray header)
+		{
+			ContentRange result;
+
+			header = header.trimmed ();
+			if (!header.startsWith ("bytes "))
+				return result;
+			header = header.mid (6);
+
+			const auto slashPos = header.indexOf ('/');
+			const auto dashPos = header.indexOf ('-');
+			if (slashPos == -1 || dashPos == -1 || dashPos > slashPos)
+				return result;
+
+			bool ok = false;
+			const auto start = header.left (dashPos).toLongLong (&ok);
+			if (!ok)
+				return result;
+			const auto end = header.mid (dashPos + 1, slashPos - dashPos - 1).toLongLong (&ok);
+			if (!ok)
+				return result;
+
+			result.Start_ = start;
+			result.End_ = end;
+
+			const auto total = header.mid (slashPos + 1).toLongLong (&ok);
+			if (ok)
+				result.Total_ = total;
+			return result;
+		}
 	}
 
 	Task::Task (const QUrl& url, const QVariantMap& params)
@@ -67,6 +126,11 @@ namespace CSTP
 	, CanChangeName_ (true)
 	, Referer_ (params ["Referer"].toUrl ())
 	, Params_ (params)
+	, WritePos_ (0)
+	, DoneAtStart_ (0)
+	, SegmentErrors_ (0)
+	, ReadPaused_ (false)
+	, FinishPending_ (false)
 	{
 		StartTime_.start ();
 
@@ -74,6 +138,10 @@ namespace CSTP
 				SIGNAL (timeout ()),
 				this,
 				SIGNAL (updateInterface ()));
+		connect (Timer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (flushWrites ()));
 	}
 
 	Task::Task (QNetworkReply *reply)
@@ -85,6 +153,11 @@ namespace CSTP
 	, UpdateCounter_ (0)
 	, Timer_ (new QTimer (this))
 	, CanChangeName_ (true)
+	, WritePos_ (0)
+	, DoneAtStart_ (0)
+	, SegmentErrors_ (0)
+	, ReadPaused_ (false)
+	, FinishPending_ (false)
 	{
 		StartTime_.start ();
 
@@ -92,12 +165,37 @@ namespace CSTP
 				SIGNAL (timeout ()),
 				this,
 				SIGNAL (updateInterface ()));
+		connect (Timer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (flushWrites ()));
 	}
 
 	void Task::Start (const std::shared_ptr<QFile>& tof)
 	{
 		FileSizeAtStart_ = tof->size ();
 		To_ = tof;
+		WritePos_ = 0;
+		ReadPaused_ = false;
+		FinishPending_ = false;
+
+		if (!Buffer_)
+		{
+			const auto bufferSize = XmlSettingsManager::Instance ()
+					.property ("WriteBufferSize").toLongLong ();
+			Buffer_ = std::make_shared<WriteBuffer> (tof->fileName (),
+					std::max<qint64> (bufferSize, 1) * 1024 * 1024);
+		}
+		else
+			Buffer_->SetPath (tof->fileName ());
+
+		if (!Segments_.empty () && !tof->size ())
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "the partially downloaded file is gone, restarting"
+					<< tof->fileName ();
+			Segments_.clear ();
+		}
 
 		if (!Reply_.get ())
 		{
@@ -109,28 +207,18 @@ namespace CSTP
 				return;
 			}
 
-			QString ua = XmlSettingsManager::Instance ()
-				.property ("UserUserAgent").toString ();
-			if (ua.isEmpty ())
-				ua = XmlSettingsManager::Instance ()
-					.property ("PredefinedUserAgent").toString ();
-
-			if (ua == "%leechcraft%")
-				ua = "LeechCraft.CSTP/" + Core::Instance ().GetCoreProxy ()->GetVersion ();
+			if (!Segments_.empty ())
+			{
+				StartSegmented ();
+				return;
+			}
 
-			QNetworkRequest req (URL_);
+			auto req = MakeRequest ();
 			if (tof->size ())
+			{
 				req.setRawHeader ("Range", QString ("bytes=%1-").arg (tof->size ()).toLatin1 ());
-			req.setRawHeader ("User-Agent", ua.toLatin1 ());
-
-			if (Referer_.isEmpty ())
-				req.setRawHeader ("Referer", QString (QString ("http://") + URL_.host ()).toLatin1 ());
-			else
-				req.setRawHeader ("Referer", Referer_.toEncoded ());
-
-			req.setRawHeader ("Host", URL_.host ().toLatin1 ());
-			req.setRawHeader ("Origin", URL_.scheme ().toLatin1 () + "://" + URL_.host ().toLatin1 ());
-			req.setRawHeader ("Accept", "*/*");
+				WritePos_ = tof->size ();
+			}
 
 			StartTime_.restart ();
 
@@ -152,6 +240,8 @@ namespace CSTP
 				handleError ();
 				return;
 			}
+
+			Reply_->setReadBufferSize (ReplyReadBufferSize);
 		}
 		else
 		{
@@ -208,6 +298,12 @@ namespace CSTP
 	{
 		if (Reply_.get ())
 			Reply_->abort ();
+		else if (HasActiveSegments ())
+		{
+			for (size_t i = 0; i < Segments_.size (); ++i)
+				DetachSegment (i);
+			emit done (true);
+		}
 	}
 
 	void Task::ForbidNameChanges ()
@@ -219,14 +315,25 @@ namespace CSTP
 	{
 		QByteArray result;
 		{
+			// Only the data that has reached the file is persisted.
+			qint64 unflushed = 0;
+			for (const auto& segment : Segments_)
+				unflushed += segment.Pos_ - segment.Flushed_;
+
 			QDataStream out (&result, QIODevice::WriteOnly);
-			out << 2
+			out << 3
 				<< URL_
 				<< StartTime_
-				<< Done_
+				<< Done_ - unflushed
 				<< Total_
 				<< Speed_
 				<< CanChangeName_;
+
+			const auto isPending = [] (const Segment& segment) { return segment.Flushed_ < segment.End_; };
+			out << static_cast<quint32> (std::count_if (Segments_.begin (), Segments_.end (), isPending));
+			for (const auto& segment : Segments_)
+				if (isPending (segment))
+					out << segment.Flushed_ << segment.End_;
 		}
 		return result;
 	}
@@ -246,8 +353,22 @@ namespace CSTP
 		}
 		if (version >= 2)
 			in >> CanChangeName_;
+		if (version >= 3)
+		{
+			quint32 count = 0;
+			in >> count;
 
-		if (version < 1 || version > 2)
+			Segments_.clear ();
+			for (quint32 i = 0; i < count; ++i)
+			{
+				Segment segment {};
+				in >> segment.Pos_ >> segment.End_;
+				segment.Flushed_ = segment.Pos_;
+				Segments_.push_back (segment);
+			}
+		}
+
+		if (version < 1 || version > 3)
 			throw std::runtime_error ("Unknown version");
 	}
 
@@ -268,10 +389,14 @@ namespace CSTP
 
 	QString Task::GetState () const
 	{
-		if (!Reply_.get ())
+		if (FinishPending_)
+			return tr ("Writing to disk");
+		else if (!Reply_.get () && !HasActiveSegments ())
 			return tr ("Stopped");
 		else if (Done_ == Total_)
 			return tr ("Finished");
+		else if (ReadPaused_)
+			return tr ("Waiting for disk");
 		else
 			return tr ("Running");
 	}
@@ -288,12 +413,31 @@ namespace CSTP
 
 	bool Task::IsRunning () const
 	{
-		return Reply_.get () && !URL_.isEmpty ();
+		return (Reply_.get () || HasActiveSegments () || FinishPending_) &&
+				!URL_.isEmpty ();
 	}
 
 	QString Task::GetErrorString () const
 	{
-		return Reply_.get () ? Reply_->errorString () : tr ("Task isn't initialized properly");
+		if (Reply_.get ())
+			return Reply_->errorString ();
+		if (!LastError_.isEmpty ())
+			return LastError_;
+		return tr ("Task isn't initialized properly");
+	}
+
+	WriteBuffer::Stats Task::GetWriteStats () const
+	{
+		if (!Buffer_)
+			return {};
+
+		return Buffer_->GetStats ();
+	}
+
+	void Task::flushWrites ()
+	{
+		if (Buffer_)
+			Core::Instance ().GetFileWriter ()->Schedule (Buffer_);
 	}
 
 	void Task::Reset ()
@@ -303,12 +447,20 @@ namespace CSTP
 		Total_ = 0;
 		Speed_ = 0;
 		FileSizeAtStart_ = -1;
+		WritePos_ = 0;
 		Reply_.reset ();
+
+		for (size_t i = 0; i < Segments_.size (); ++i)
+			DetachSegment (i);
+		Segments_.clear ();
+		SegmentErrors_ = 0;
+		LastError_.clear ();
 	}
 
 	void Task::RecalculateSpeed ()
 	{
-		Speed_ = static_cast<double> (Done_ * 1000) / static_cast<double> (StartTime_.elapsed ());
+		const auto done = Segments_.empty () ? Done_ : Done_ - DoneAtStart_;
+		Speed_ = static_cast<double> (done * 1000) / static_cast<double> (StartTime_.elapsed ());
 	}
 
 	void Task::HandleMetadataRedirection ()
@@ -432,24 +584,452 @@ namespace CSTP
 			return;
 		}
 
-		QIODevice::OpenMode om = To_->openMode ();
-		To_->close ();
+		// The writer thread mustn't write to the old path meanwhile.
+		Buffer_->Rename ([this, &path, &oldPath]
+				{
+					QIODevice::OpenMode om = To_->openMode ();
+					To_->close ();
+
+					if (!To_->rename (path))
+					{
+						qWarning () << Q_FUNC_INFO
+							<< "failed to rename to"
+							<< path
+							<< To_->errorString ();
+					}
+					if (!To_->open (om))
+					{
+						qWarning () << Q_FUNC_INFO
+							<< "failed to re-open the renamed file"
+							<< path;
+						To_->rename (oldPath);
+						To_->open (om);
+					}
+
+					return To_->fileName ();
+				});
+	}
+
+	QNetworkRequest Task::MakeRequest () const
+	{
+		QString ua = XmlSettingsManager::Instance ()
+			.property ("UserUserAgent").toString ();
+		if (ua.isEmpty ())
+			ua = XmlSettingsManager::Instance ()
+				.property ("PredefinedUserAgent").toString ();
+
+		if (ua == "%leechcraft%")
+			ua = "LeechCraft.CSTP/" + Core::Instance ().GetCoreProxy ()->GetVersion ();
+
+		QNetworkRequest req (URL_);
+		req.setRawHeader ("User-Agent", ua.toLatin1 ());
+
+		if (Referer_.isEmpty ())
+			req.setRawHeader ("Referer", QString (QString ("http://") + URL_.host ()).toLatin1 ());
+		else
+			req.setRawHeader ("Referer", Referer_.toEncoded ());
+
+		req.setRawHeader ("Host", URL_.host ().toLatin1 ());
+		req.setRawHeader ("Origin", URL_.scheme ().toLatin1 () + "://" + URL_.host ().toLatin1 ());
+		req.setRawHeader ("Accept", "*/*");
+		return req;
+	}
+
+	void Task::WriteAt (qint64 pos, const QByteArray& data)
+	{
+		if (data.isEmpty ())
+			return;
+
+		if (Buffer_->Enqueue (pos, data))
+			Core::Instance ().GetFileWriter ()->Schedule (Buffer_);
+	}
+
+	void Task::HandleWriteError (const QString& error)
+	{
+		qWarning () << Q_FUNC_INFO
+				<< "Error writing to file:"
+				<< To_->fileName ()
+				<< error;
+
+		LastError_ = tr ("Error writing to file %1: %2")
+				.arg (To_->fileName ())
+				.arg (error);
+		Entity e = Util::MakeNotification ("LeechCraft CSTP",
+				LastError_,
+				PCritical_);
+		emit gotEntity (e);
+
+		FinishPending_ = false;
+		ReadPaused_ = false;
+
+		for (size_t i = 0; i < Segments_.size (); ++i)
+			DetachSegment (i);
+		Buffer_->Discard ();
+		UpdateFlushed ();
+		DropUnflushed ();
+		Cleanup ();
+
+		QTimer::singleShot (0,
+				this,
+				SLOT (handleError ()));
+	}
+
+	void Task::TrySegment ()
+	{
+		if (!Segments_.empty () ||
+				URL_.isEmpty () ||
+				!Reply_)
+			return;
+
+		if (Params_.value ("Operation", QNetworkAccessManager::GetOperation).toInt () !=
+				QNetworkAccessManager::GetOperation)
+			return;
+
+		const auto maxConns = XmlSettingsManager::Instance ()
+				.property ("MaxConnections").toInt ();
+		if (maxConns < 2)
+			return;
+
+		// Ranges of a content-encoded entity refer to the encoded bytes.
+		if (!Reply_->rawHeader ("Content-Encoding").isEmpty ())
+			return;
+
+		qint64 total = -1;
+		const auto status = Reply_->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+		if (status == 206)
+			total = ParseContentRange (Reply_->rawHeader ("Content-Range")).Total_;
+		else if (status == 200 &&
+				Reply_->rawHeader ("Accept-Ranges").trimmed ().toLower () == "bytes")
+			total = Reply_->header (QNetworkRequest::ContentLengthHeader).toLongLong ();
+
+		const auto remaining = total - WritePos_;
+		if (total <= 0 || remaining < MinSegmentedSize)
+			return;
 
-		if (!To_->rename (path))
+		const auto count = std::min<qint64> (maxConns, remaining / MinSegmentSize);
+		const auto chunk = remaining / count;
+
+		qDebug () << Q_FUNC_INFO
+				<< "splitting"
+				<< URL_
+				<< "into"
+				<< count
+				<< "segments";
+
+		Total_ = total;
+		Done_ = WritePos_;
+		DoneAtStart_ = Done_;
+		SegmentErrors_ = 0;
+		LastError_.clear ();
+
+		if (XmlSettingsManager::Instance ().property ("PreallocateFiles").toBool ())
+			Buffer_->SetPreallocationSize (total);
+
+		for (qint64 i = 0; i < count; ++i)
 		{
-			qWarning () << Q_FUNC_INFO
-				<< "failed to rename to"
-				<< path
-				<< To_->errorString ();
+			Segment segment {};
+			segment.Pos_ = WritePos_ + i * chunk;
+			segment.End_ = i == count - 1 ? total : segment.Pos_ + chunk;
+			segment.Flushed_ = segment.Pos_;
+			Segments_.push_back (segment);
 		}
-		if (!To_->open (om))
+
+		// The reply we already have becomes the first segment.
+		auto primary = Reply_.release ();
+		disconnect (primary,
+				0,
+				this,
+				0);
+		AttachSegment (0, primary, true);
+
+		for (size_t i = 1; i < Segments_.size (); ++i)
+			StartSegment (i);
+	}
+
+	void Task::StartSegmented ()
+	{
+		qint64 remaining = 0;
+		for (const auto& segment : Segments_)
+			remaining += segment.End_ - segment.Pos_;
+
+		Done_ = Total_ - remaining;
+		DoneAtStart_ = Done_;
+		SegmentErrors_ = 0;
+		LastError_.clear ();
+		StartTime_.restart ();
+
+		if (XmlSettingsManager::Instance ().property ("PreallocateFiles").toBool ())
+			Buffer_->SetPreallocationSize (Total_);
+
+		const auto maxConns = std::max (1,
+				XmlSettingsManager::Instance ().property ("MaxConnections").toInt ());
+
+		int started = 0;
+		for (size_t i = 0; i < Segments_.size () && started < maxConns; ++i)
+			if (Segments_ [i].Pos_ < Segments_ [i].End_)
+			{
+				StartSegment (i);
+				++started;
+			}
+
+		if (!started)
 		{
-			qWarning () << Q_FUNC_INFO
-				<< "failed to re-open the renamed file"
-				<< path;
-			To_->rename (oldPath);
-			To_->open (om);
+			Segments_.clear ();
+			QTimer::singleShot (0,
+					this,
+					SLOT (handleFinished ()));
+			return;
+		}
+
+		if (!Timer_->isActive ())
+			Timer_->start (3000);
+	}
+
+	void Task::StartSegment (size_t idx)
+	{
+		const auto& segment = Segments_ [idx];
+
+		auto req = MakeRequest ();
+		req.setRawHeader ("Range",
+				QString ("bytes=%1-%2").arg (segment.Pos_).arg (segment.End_ - 1).toLatin1 ());
+
+		auto reply = Core::Instance ().GetNetworkAccessManager ()->get (req);
+		reply->setReadBufferSize (ReplyReadBufferSize);
+		AttachSegment (idx, reply, false);
+	}
+
+	void Task::AttachSegment (size_t idx, QNetworkReply *reply, bool validated)
+	{
+		auto& segment = Segments_ [idx];
+		segment.Reply_ = reply;
+		segment.Validated_ = validated;
+		segment.StartTime_.start ();
+		segment.PosAtStart_ = segment.Pos_;
+
+		reply->setParent (this);
+		connect (reply,
+				SIGNAL (readyRead ()),
+				this,
+				SLOT (handleSegmentReadyRead ()));
+		connect (reply,
+				SIGNAL (finished ()),
+				this,
+				SLOT (handleSegmentFinished ()));
+		connect (reply,
+				SIGNAL (error (QNetworkReply::NetworkError)),
+				this,
+				SLOT (handleSegmentError ()));
+	}
+
+	void Task::ReadSegment (size_t idx)
+	{
+		auto& segment = Segments_ [idx];
+		const auto reply = segment.Reply_;
+
+		if (!segment.Validated_)
+		{
+			const auto status = reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+			const auto& range = ParseContentRange (reply->rawHeader ("Content-Range"));
+			if (status != 206 || range.Start_ != segment.Pos_)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "range request not honoured"
+						<< status
+						<< reply->rawHeader ("Content-Range");
+				LastError_ = tr ("Server doesn't support range requests.");
+				FailSegment (idx);
+				return;
+			}
+			segment.Validated_ = true;
+		}
+
+		if (Buffer_->IsFull () && !reply->isFinished ())
+		{
+			ReadPaused_ = true;
+			return;
 		}
+
+		const auto& data = reply->read (segment.End_ - segment.Pos_);
+		WriteAt (segment.Pos_, data);
+
+		segment.Pos_ += data.size ();
+		Done_ += data.size ();
+		if (!data.isEmpty ())
+			segment.Checkpoints_.append ({ Buffer_->GetLastSeq (), segment.Pos_ });
+		RecalculateSpeed ();
+
+		if (segment.Pos_ >= segment.End_)
+			FinishSegment (idx);
+	}
+
+	void Task::DetachSegment (size_t idx)
+	{
+		auto& segment = Segments_ [idx];
+		if (!segment.Reply_)
+			return;
+
+		disconnect (segment.Reply_,
+				0,
+				this,
+				0);
+		segment.Reply_->abort ();
+		segment.Reply_->deleteLater ();
+		segment.Reply_ = nullptr;
+	}
+
+	void Task::FinishSegment (size_t idx)
+	{
+		DetachSegment (idx);
+		Rebalance ();
+	}
+
+	void Task::FailSegment (size_t idx)
+	{
+		qWarning () << Q_FUNC_INFO
+				<< "segment"
+				<< Segments_ [idx].Pos_
+				<< Segments_ [idx].End_
+				<< "failed:"
+				<< LastError_;
+
+		DetachSegment (idx);
+
+		// The segment stays in the map and is picked up again by the next
+		// connection that becomes free.
+		if (++SegmentErrors_ <= MaxSegmentErrors &&
+				HasActiveSegments ())
+			return;
+
+		for (size_t i = 0; i < Segments_.size (); ++i)
+			DetachSegment (i);
+		QTimer::singleShot (0,
+				this,
+				SLOT (handleError ()));
+	}
+
+	void Task::Rebalance ()
+	{
+		const auto isPending = [] (const Segment& segment) { return segment.Pos_ < segment.End_; };
+		/* The segments are kept until the task is done, so that the
+		 * data still in the write buffer isn't persisted as written.
+		 */
+		if (std::none_of (Segments_.begin (), Segments_.end (), isPending))
+		{
+			Done_ = Total_;
+			QTimer::singleShot (0,
+					this,
+					SLOT (handleFinished ()));
+			return;
+		}
+
+		const auto maxConns = std::max (1,
+				XmlSettingsManager::Instance ().property ("MaxConnections").toInt ());
+		auto active = std::count_if (Segments_.begin (), Segments_.end (),
+				[] (const Segment& segment) { return segment.Reply_; });
+
+		while (active < maxConns)
+		{
+			const auto idle = std::find_if (Segments_.begin (), Segments_.end (),
+					[&isPending] (const Segment& segment) { return !segment.Reply_ && isPending (segment); });
+			if (idle != Segments_.end ())
+			{
+				StartSegment (idle - Segments_.begin ());
+				++active;
+				continue;
+			}
+
+			// Steal the second half of the segment expected to finish last.
+			int victim = -1;
+			double worstEta = -1;
+			for (size_t i = 0; i < Segments_.size (); ++i)
+			{
+				const auto& segment = Segments_ [i];
+				const auto remaining = segment.End_ - segment.Pos_;
+				if (!segment.Reply_ || remaining < 2 * MinSegmentSize)
+					continue;
+
+				const auto elapsed = segment.StartTime_.elapsed ();
+				const auto speed = elapsed > 0 ?
+						(segment.Pos_ - segment.PosAtStart_) * 1000. / elapsed :
+						0.;
+				const auto eta = speed > 0 ?
+						remaining / speed :
+						std::numeric_limits<double>::max ();
+				if (eta > worstEta)
+				{
+					worstEta = eta;
+					victim = i;
+				}
+			}
+
+			if (victim == -1)
+				break;
+
+			auto& segment = Segments_ [victim];
+			Segment stolen {};
+			stolen.Pos_ = segment.Pos_ + (segment.End_ - segment.Pos_) / 2;
+			stolen.End_ = segment.End_;
+			stolen.Flushed_ = stolen.Pos_;
+			segment.End_ = stolen.Pos_;
+
+			Segments_.push_back (stolen);
+			StartSegment (Segments_.size () - 1);
+			++active;
+		}
+	}
+
+	void Task::UpdateFlushed ()
+	{
+		const auto written = Buffer_->GetWrittenSeq ();
+		for (auto& segment : Segments_)
+		{
+			auto& checkpoints = segment.Checkpoints_;
+			while (!checkpoints.isEmpty () && checkpoints.first ().first <= written)
+				segment.Flushed_ = checkpoints.takeFirst ().second;
+		}
+	}
+
+	/* The write buffer has been discarded, so the segments go back to
+	 * the last written positions, and the data after them will be
+	 * downloaded again.
+	 */
+	void Task::DropUnflushed ()
+	{
+		for (auto& segment : Segments_)
+		{
+			Done_ -= segment.Pos_ - segment.Flushed_;
+			segment.Pos_ = segment.Flushed_;
+			segment.Checkpoints_.clear ();
+		}
+	}
+
+	int Task::FindSegment (QNetworkReply *reply) const
+	{
+		if (!reply)
+			return -1;
+
+		for (size_t i = 0; i < Segments_.size (); ++i)
+			if (Segments_ [i].Reply_ == reply)
+				return i;
+		return -1;
+	}
+
+	bool Task::HasActiveSegments () const
+	{
+		return std::any_of (Segments_.begin (), Segments_.end (),
+				[] (const Segment& segment) { return segment.Reply_; });
+	}
+
+	void Task::FinishWhenFlushed ()
+	{
+		if (!Buffer_ || !Buffer_->GetPending ())
+		{
+			emit done (false);
+			return;
+		}
+
+		FinishPending_ = true;
+		Core::Instance ().GetFileWriter ()->Schedule (Buffer_);
 	}
 
 	void Task::Cleanup ()
@@ -487,6 +1067,7 @@ namespace CSTP
 		}
 
 		Reply_.reset ();
+		Buffer_->Discard ();
 
 		Referer_ = URL_;
 		URL_ = QUrl::fromEncoded (newUrl);
@@ -497,91 +1078,130 @@ namespace CSTP
 	{
 		HandleMetadataRedirection ();
 		HandleMetadataFilename ();
-	}
 
-	void Task::handleLocalTransfer ()
-	{
-		QString localFile = URL_.toLocalFile ();
-		qDebug () << "LOCAL FILE" << localFile << To_->fileName ();
-		QFileInfo fi (localFile);
-		if (!fi.isFile ())
-		{
-			qWarning () << Q_FUNC_INFO
-					<< URL_
-					<< "is not a file";
-			QTimer::singleShot (0,
-					this,
-					SLOT (handleError ()));
+		if (!Reply_)
 			return;
+
+		qint64 total = -1;
+		const auto status = Reply_->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+		if (status == 200)
+		{
+			WritePos_ = 0;
+			total = Reply_->header (QNetworkRequest::ContentLengthHeader).toLongLong ();
+		}
+		else if (status == 206)
+		{
+			const auto& range = ParseContentRange (Reply_->rawHeader ("Content-Range"));
+			if (range.Start_ >= 0)
+				WritePos_ = range.Start_;
+			total = range.Total_;
 		}
+		else
+			return;
 
-		QString destination = To_->fileName ();
-		QFile file (localFile);
-		To_->close ();
-		if (!To_->remove () ||
-				!file.copy (destination))
+		if (total > 0 &&
+				XmlSettingsManager::Instance ().property ("PreallocateFiles").toBool ())
+			Buffer_->SetPreallocationSize (total);
+
+		TrySegment ();
+	}
+
+	namespace
+	{
+		bool CopyLocalFile (const QString& source, const QString& destination)
 		{
-			if (!To_->open (QIODevice::WriteOnly))
+			QFile::remove (destination);
+			if (QFile::copy (source, destination))
+				return true;
+
+			QFile to (destination);
+			if (!to.open (QIODevice::WriteOnly))
 			{
 				qWarning () << Q_FUNC_INFO
 						<< "unable to open destfile"
-						<< To_->fileName ()
+						<< destination
 						<< "for writing";
-				QTimer::singleShot (0,
-						this,
-						SLOT (handleError ()));
-				return;
+				return false;
 			}
 
-			if (!file.open (QIODevice::ReadOnly))
+			QFile from (source);
+			if (!from.open (QIODevice::ReadOnly))
 			{
 				qWarning () << Q_FUNC_INFO
 						<< "unable to open sourcefile"
-						<< file.fileName ()
+						<< source
 						<< "for reading";
-				QTimer::singleShot (0,
-						this,
-						SLOT (handleError ()));
-				return;
+				return false;
 			}
 
 			const int chunkSize = 10 * 1024 * 1024;
-			QByteArray chunk = file.read (chunkSize);
+			QByteArray chunk = from.read (chunkSize);
 			while (chunk.size ())
 			{
-				To_->write (chunk);
-				chunk = file.read (chunkSize);
+				if (to.write (chunk) != chunk.size ())
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "error writing to"
+							<< destination
+							<< to.errorString ();
+					return false;
+				}
+				chunk = from.read (chunkSize);
 			}
+			return true;
 		}
+	}
 
-		QTimer::singleShot (0,
+	void Task::handleLocalTransfer ()
+	{
+		QString localFile = URL_.toLocalFile ();
+		qDebug () << "LOCAL FILE" << localFile << To_->fileName ();
+		QFileInfo fi (localFile);
+		if (!fi.isFile ())
+		{
+			qWarning () << Q_FUNC_INFO
+					<< URL_
+					<< "is not a file";
+			QTimer::singleShot (0,
+					this,
+					SLOT (handleError ()));
+			return;
+		}
+
+		To_->close ();
+
+		auto watcher = new QFutureWatcher<bool> (this);
+		connect (watcher,
+				SIGNAL (finished ()),
 				this,
-				SLOT (handleFinished ()));
+				SLOT (handleLocalTransferFinished ()));
+		watcher->setFuture (QtConcurrent::run (CopyLocalFile, localFile, To_->fileName ()));
+	}
+
+	void Task::handleLocalTransferFinished ()
+	{
+		auto watcher = dynamic_cast<QFutureWatcher<bool>*> (sender ());
+		watcher->deleteLater ();
+
+		if (watcher->result ())
+			handleFinished ();
+		else
+			handleError ();
 	}
 
 	bool Task::handleReadyRead ()
 	{
 		if (Reply_.get ())
 		{
-			quint64 avail = Reply_->bytesAvailable ();
-			quint64 res = To_->write (Reply_->readAll ());
-			if ((static_cast<quint64> (-1) == res) ||
-					(res != avail))
+			if (Buffer_->IsFull () && !Reply_->isFinished ())
 			{
-				qWarning () << Q_FUNC_INFO
-						<< "Error writing to file:"
-						<< To_->fileName ()
-						<< To_->errorString ();
-
-				QString errString = tr ("Error writing to file %1: %2")
-						.arg (To_->fileName ())
-						.arg (To_->errorString ());
-				Entity e = Util::MakeNotification ("LeechCraft CSTP",
-						errString,
-						PCritical_);
-				emit gotEntity (e);
-				emit done (true);
+				ReadPaused_ = true;
+				return false;
 			}
+
+			const auto& data = Reply_->readAll ();
+			WriteAt (WritePos_, data);
+			WritePos_ += data.size ();
 		}
 		if (URL_.isEmpty () &&
 				Core::Instance ().HasFinishedReply (Reply_.get ()))
@@ -594,8 +1214,15 @@ namespace CSTP
 
 	void Task::handleFinished ()
 	{
+		if (Reply_.get ())
+		{
+			const auto& data = Reply_->readAll ();
+			WriteAt (WritePos_, data);
+			WritePos_ += data.size ();
+		}
+
 		Cleanup ();
-		emit done (false);
+		FinishWhenFlushed ();
 	}
 
 	void Task::handleError ()
@@ -603,5 +1230,73 @@ namespace CSTP
 		Cleanup ();
 		emit done (true);
 	}
+
+	void Task::handleSegmentReadyRead ()
+	{
+		const auto idx = FindSegment (qobject_cast<QNetworkReply*> (sender ()));
+		if (idx != -1)
+			ReadSegment (idx);
+	}
+
+	void Task::handleSegmentFinished ()
+	{
+		const auto reply = qobject_cast<QNetworkReply*> (sender ());
+		auto idx = FindSegment (reply);
+		if (idx == -1)
+			return;
+
+		// Reading detaches the reply if its segment is complete.
+		ReadSegment (idx);
+
+		idx = FindSegment (reply);
+		if (idx != -1)
+		{
+			LastError_ = tr ("Connection closed before the segment was downloaded.");
+			FailSegment (idx);
+		}
+	}
+
+	void Task::handleSegmentError ()
+	{
+		const auto reply = qobject_cast<QNetworkReply*> (sender ());
+		const auto idx = FindSegment (reply);
+		if (idx == -1)
+			return;
+
+		LastError_ = reply->errorString ();
+		FailSegment (idx);
+	}
+	void Task::handleBufferFlushed (const WriteBuffer_ptr& buffer)
+	{
+		if (buffer != Buffer_)
+			return;
+
+		const auto& error = Buffer_->TakeError ();
+		if (!error.isEmpty ())
+		{
+			HandleWriteError (error);
+			return;
+		}
+
+		UpdateFlushed ();
+
+		if (ReadPaused_ && !Buffer_->IsFull ())
+		{
+			ReadPaused_ = false;
+
+			if (Reply_.get ())
+				handleReadyRead ();
+			else
+				for (size_t i = 0; i < Segments_.size () && !ReadPaused_; ++i)
+					if (Segments_ [i].Reply_)
+						ReadSegment (i);
+		}
+
+		if (FinishPending_ && !Buffer_->GetPending ())
+		{
+			FinishPending_ = false;
+			emit done (false);
+		}
+	}
 }
 }
@@ -30,12 +30,14 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <QObject>
 #include <QUrl>
 #include <QTime>
 #include <QNetworkReply>
 #include <QStringList>
 #include <interfaces/structures.h>
+#include "filewriter.h"
 
 class QAuthenticator;
 class QNetworkProxy;
@@ -64,6 +66,42 @@ namespace CSTP
 
 		QUrl Referer_;
 		const QVariantMap Params_;
+
+		/** The offset in the file the next chunk of a single-connection
+		 * transfer is written at.
+		 */
+		qint64 WritePos_;
+
+		/** A part of the file downloaded over its own connection.
+		 *
+		 * Bytes [Pos_, End_) are yet to be downloaded. A segment without
+		 * a reply is idle and is picked up by the next free connection.
+		 *
+		 * Bytes [Flushed_, Pos_) are downloaded but may still be in the
+		 * write buffer, so only Flushed_ is persisted. Checkpoints_ maps
+		 * the write buffer sequence numbers to the values Flushed_ will
+		 * take once the chunks up to them are written.
+		 */
+		struct Segment
+		{
+			qint64 Pos_;
+			qint64 End_;
+			qint64 Flushed_;
+			QList<QPair<quint64, qint64>> Checkpoints_;
+			QNetworkReply *Reply_;
+			bool Validated_;
+
+			QTime StartTime_;
+			qint64 PosAtStart_;
+		};
+		std::vector<Segment> Segments_;
+		qint64 DoneAtStart_;
+		int SegmentErrors_;
+		QString LastError_;
+
+		WriteBuffer_ptr Buffer_;
+		bool ReadPaused_;
+		bool FinishPending_;
 	public:
 		explicit Task (const QUrl& url = QUrl (), const QVariantMap& params = QVariantMap ());
 		explicit Task (QNetworkReply*);
@@ -83,23 +121,53 @@ namespace CSTP
 		int GetTimeFromStart () const;
 		bool IsRunning () const;
 		QString GetErrorString () const;
+		WriteBuffer::Stats GetWriteStats () const;
+	public slots:
+		/** Schedules writing out all the data buffered so far.
+		 */
+		void flushWrites ();
+		void handleBufferFlushed (const LeechCraft::CSTP::WriteBuffer_ptr&);
 	private:
 		void Reset ();
 		void RecalculateSpeed ();
 		void HandleMetadataRedirection ();
 		void HandleMetadataFilename ();
 
+		QNetworkRequest MakeRequest () const;
+		void WriteAt (qint64, const QByteArray&);
+		void HandleWriteError (const QString&);
+		void FinishWhenFlushed ();
+
+		void TrySegment ();
+		void StartSegmented ();
+		void StartSegment (size_t);
+		void AttachSegment (size_t, QNetworkReply*, bool);
+		void ReadSegment (size_t);
+		void DetachSegment (size_t);
+		void FinishSegment (size_t);
+		void FailSegment (size_t);
+		void Rebalance ();
+		void UpdateFlushed ();
+		void DropUnflushed ();
+		int FindSegment (QNetworkReply*) const;
+		bool HasActiveSegments () const;
+
 		void Cleanup ();
 	private slots:
 		void handleDataTransferProgress (qint64, qint64);
 		void redirectedConstruction (const QByteArray&);
 		void handleMetaDataChanged ();
 		void handleLocalTransfer ();
+		void handleLocalTransferFinished ();
 		/** Returns true if the reply is at end after this read.
 			*/
 		bool handleReadyRead ();
 		void handleFinished ();
 		void handleError ();
+
+		void handleSegmentReadyRead ();
+		void handleSegmentFinished ();
+		void handleSegmentError ();
 	signals:
 		void gotEntity (const LeechCraft::Entity&);
 		void updateInterface ();
@@ -36,13 +36,18 @@ namespace LeechCraft
 {
 namespace DeadLyrics
 {
+	void DeadLyRicS::BackgroundInit ()
+	{
+		SiteDescs_ = SitesSearcher::ParseSites (":/deadlyrics/resources/sites.xml");
+	}
+
 	void DeadLyRicS::Init (ICoreProxy_ptr proxy)
 	{
 		Util::InstallTranslator ("deadlyrics");
 
 		Proxy_ = proxy;
 
-		Searchers_ << Searcher_ptr (new SitesSearcher (":/deadlyrics/resources/sites.xml", proxy));
+		Searchers_ << Searcher_ptr (new SitesSearcher (SiteDescs_, proxy));
 		for (auto searcher : Searchers_)
 			connect (searcher.get (),
 					SIGNAL (gotLyrics (Media::LyricsResults)),
@@ -33,9 +33,11 @@
 #include <QStringList>
 #include <QTranslator>
 #include <interfaces/iinfo.h>
+#include <interfaces/ihavebackgroundinit.h>
 #include <interfaces/ifinder.h>
 #include <interfaces/media/ilyricsfinder.h>
 #include "searcher.h"
+#include "concretesite.h"
 
 namespace LeechCraft
 {
@@ -43,16 +45,20 @@ namespace DeadLyrics
 {
 	class DeadLyRicS : public QObject
 						, public IInfo
+						, public IHaveBackgroundInit
 						, public Media::ILyricsFinder
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo Media::ILyricsFinder)
+		Q_INTERFACES (IInfo IHaveBackgroundInit Media::ILyricsFinder)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.DeadLyrics")
 
 		ICoreProxy_ptr Proxy_;
 		Searchers_t Searchers_;
+
+		QList<ConcreteSiteDesc> SiteDescs_;
 	public:
+		void BackgroundInit ();
 		void Init (ICoreProxy_ptr);
 		void SecondInit ();
 		void Release ();
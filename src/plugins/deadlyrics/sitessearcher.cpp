@@ -37,8 +37,13 @@ namespace LeechCraft
 {
 namespace DeadLyrics
 {
-	SitesSearcher::SitesSearcher (const QString& configPath, ICoreProxy_ptr proxy)
+	SitesSearcher::SitesSearcher (const QList<ConcreteSiteDesc>& descs, ICoreProxy_ptr proxy)
 	: Proxy_ (proxy)
+	, Descs_ (descs)
+	{
+	}
+
+	QList<ConcreteSiteDesc> SitesSearcher::ParseSites (const QString& configPath)
 	{
 		QFile file (configPath);
 		if (!file.open (QIODevice::ReadOnly))
@@ -46,7 +51,7 @@ namespace DeadLyrics
 			qWarning () << Q_FUNC_INFO
 					<< "unable to open"
 					<< configPath;
-			return;
+			return {};
 		}
 
 		QDomDocument doc;
@@ -55,15 +60,16 @@ namespace DeadLyrics
 			qWarning () << Q_FUNC_INFO
 					<< "unable to parse"
 					<< configPath;
-			return;
+			return {};
 		}
 
+		QList<ConcreteSiteDesc> descs;
 		auto provider = doc.documentElement ().firstChildElement ("provider");
 		while (!provider.isNull ())
 		{
 			try
 			{
-				Descs_ << ConcreteSiteDesc (provider);
+				descs << ConcreteSiteDesc (provider);
 			}
 			catch (const std::exception& e)
 			{
@@ -73,6 +79,7 @@ namespace DeadLyrics
 			}
 			provider = provider.nextSiblingElement ("provider");
 		}
+		return descs;
 	}
 
 	void SitesSearcher::Search (const Media::LyricsQuery& query, Media::QueryOptions)
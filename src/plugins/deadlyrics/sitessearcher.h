@@ -44,7 +44,13 @@ namespace DeadLyrics
 		ICoreProxy_ptr Proxy_;
 		QList<ConcreteSiteDesc> Descs_;
 	public:
-		SitesSearcher (const QString&, ICoreProxy_ptr proxy);
+		SitesSearcher (const QList<ConcreteSiteDesc>&, ICoreProxy_ptr proxy);
+
+		/** Parses the site descriptions from the XML file at the given
+		 * path. Doesn't touch any QObjects, so it's safe to call from
+		 * any thread.
+		 */
+		static QList<ConcreteSiteDesc> ParseSites (const QString&);
 
 		void Search (const Media::LyricsQuery&, Media::QueryOptions);
 	};
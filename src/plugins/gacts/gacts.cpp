@@ -127,6 +127,16 @@ namespace GActs
 		RegisterChildren (sh, e);
 	}
 
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/global-action-register", "x-leechcraft/global-action-unregister" }, {}, {} };
+	}
+
+	bool Plugin::IsInstantiationDeferrable () const
+	{
+		return true;
+	}
+
 	void Plugin::RegisterChildren (QxtGlobalShortcut *sh, const Entity& e)
 	{
 		for (const auto& seqVar : e.Additional_ ["AltShortcuts"].toList ())
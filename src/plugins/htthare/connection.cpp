@@ -36,13 +36,18 @@ namespace LeechCraft
 namespace HttHare
 {
 	Connection::Connection (boost::asio::io_service& service,
-			const StorageManager& stMgr, IconResolver *resolver, TrManager *trMgr)
+			const StorageManager& stMgr, DirListingCache& listingCache,
+			IconResolver *resolver, TrManager *trMgr,
+			const KeepAliveParams& keepAlive)
 	: Strand_ { service }
 	, Socket_ { service }
 	, StorageMgr_ (stMgr)
+	, ListingCache_ (listingCache)
 	, IconResolver_ { resolver }
 	, TrManager_ { trMgr }
-	, Buf_ { 2 * 1024 }
+	, Buf_ { 8 * 1024 }
+	, IdleTimer_ { service }
+	, KeepAlive_ (keepAlive)
 	{
 	}
 
@@ -71,9 +76,29 @@ namespace HttHare
 		return StorageMgr_;
 	}
 
+	DirListingCache& Connection::GetDirListingCache () const
+	{
+		return ListingCache_;
+	}
+
+	const KeepAliveParams& Connection::GetKeepAliveParams () const
+	{
+		return KeepAlive_;
+	}
+
+	int Connection::GetRemainingRequests () const
+	{
+		return KeepAlive_.MaxRequests_ - ServedRequests_;
+	}
+
 	void Connection::Start ()
 	{
 		auto conn = shared_from_this ();
+
+		IdleTimer_.expires_from_now (KeepAlive_.Timeout_);
+		IdleTimer_.async_wait (Strand_.wrap ([conn] (const boost::system::error_code& ec)
+					{ conn->HandleIdleTimeout (ec); }));
+
 		boost::asio::async_read_until (Socket_,
 				Buf_,
 				std::string { "\r\n\r\n" },
@@ -81,15 +106,56 @@ namespace HttHare
 					{ conn->HandleHeader (ec, transferred); }));
 	}
 
-	void Connection::HandleHeader (const boost::system::error_code&, unsigned long transferred)
+	void Connection::FinishRequest (bool keepAlive)
+	{
+		if (keepAlive)
+			Start ();
+		else
+			Close ();
+	}
+
+	void Connection::HandleHeader (const boost::system::error_code& ec, unsigned long transferred)
 	{
+		// This also cancels the pending wait, and HandleIdleTimeout()
+		// ignores the timer if it has already fired but not been handled.
+		IdleTimer_.expires_at (boost::asio::steady_timer::time_point::max ());
+
+		if (ec)
+		{
+			if (ec != boost::asio::error::eof &&
+					ec != boost::asio::error::operation_aborted)
+				qWarning () << Q_FUNC_INFO
+						<< ec.message ().c_str ();
+			Close ();
+			return;
+		}
+
+		++ServedRequests_;
+
 		QByteArray data;
 		data.resize (transferred);
 
 		std::istream istr (&Buf_);
 		istr.read (data.data (), transferred);
 
-		RequestHandler { shared_from_this () } (data);
+		const auto handler = std::make_shared<RequestHandler> (shared_from_this ());
+		(*handler) (data);
+	}
+
+	void Connection::HandleIdleTimeout (const boost::system::error_code& ec)
+	{
+		if (ec == boost::asio::error::operation_aborted ||
+				IdleTimer_.expires_at () > boost::asio::steady_timer::clock_type::now ())
+			return;
+
+		Close ();
+	}
+
+	void Connection::Close ()
+	{
+		boost::system::error_code ec;
+		Socket_.shutdown (boost::asio::socket_base::shutdown_both, ec);
+		Socket_.close (ec);
 	}
 }
 }
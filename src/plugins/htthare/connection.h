@@ -30,7 +30,9 @@
 #pragma once
 
 #include <memory>
+#include <chrono>
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 namespace LeechCraft
 {
@@ -39,6 +41,22 @@ namespace HttHare
 	class StorageManager;
 	class IconResolver;
 	class TrManager;
+	class DirListingCache;
+
+	/** Persistent connections parameters shared by all the connections
+	 * of a server.
+	 */
+	struct KeepAliveParams
+	{
+		/** How long a connection may stay idle waiting for a request.
+		 */
+		std::chrono::seconds Timeout_;
+
+		/** The maximum number of requests served over a single
+		 * connection.
+		 */
+		int MaxRequests_;
+	};
 
 	class Connection : public std::enable_shared_from_this<Connection>
 	{
@@ -46,12 +64,18 @@ namespace HttHare
 		boost::asio::ip::tcp::socket Socket_;
 
 		const StorageManager& StorageMgr_;
+		DirListingCache& ListingCache_;
 		IconResolver * const IconResolver_;
 		TrManager * const TrManager_;
 
 		boost::asio::streambuf Buf_;
+
+		boost::asio::steady_timer IdleTimer_;
+		const KeepAliveParams KeepAlive_;
+		int ServedRequests_ = 0;
 	public:
-		Connection (boost::asio::io_service&, const StorageManager&, IconResolver*, TrManager*);
+		Connection (boost::asio::io_service&, const StorageManager&, DirListingCache&,
+				IconResolver*, TrManager*, const KeepAliveParams&);
 
 		Connection (const Connection&) = delete;
 		Connection& operator= (const Connection&) = delete;
@@ -62,10 +86,34 @@ namespace HttHare
 		TrManager* GetTrManager () const;
 
 		const StorageManager& GetStorageManager () const;
+		DirListingCache& GetDirListingCache () const;
+
+		const KeepAliveParams& GetKeepAliveParams () const;
 
+		/** Returns the number of requests that may still be served over
+		 * this connection after the current one.
+		 */
+		int GetRemainingRequests () const;
+
+		/** Starts waiting for the next request.
+		 *
+		 * Requests pipelined by the client are left in the buffer and
+		 * are handled one after another, each one after the response to
+		 * the previous one has been written.
+		 */
 		void Start ();
+
+		/** Must be called from the strand once the response to the
+		 * current request is written.
+		 *
+		 * Starts reading the next request if keepAlive is true and
+		 * closes the connection otherwise.
+		 */
+		void FinishRequest (bool keepAlive);
 	private:
 		void HandleHeader (const boost::system::error_code&, unsigned long);
+		void HandleIdleTimeout (const boost::system::error_code&);
+		void Close ();
 	};
 
 	typedef std::shared_ptr<Connection> Connection_ptr;
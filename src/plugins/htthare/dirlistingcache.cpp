@@ -0,0 +1,170 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "dirlistingcache.h"
+#include <array>
+#include <QCryptographicHash>
+#include <QFileInfo>
+
+namespace LeechCraft
+{
+namespace HttHare
+{
+	namespace
+	{
+		const auto MaxListingAge = 30;
+
+		quint32 Crc32 (const QByteArray& data)
+		{
+			static const auto table = []
+			{
+				std::array<quint32, 256> result;
+				for (quint32 i = 0; i < result.size (); ++i)
+				{
+					auto c = i;
+					for (int k = 0; k < 8; ++k)
+						c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+					result [i] = c;
+				}
+				return result;
+			} ();
+
+			quint32 crc = 0xffffffff;
+			for (const auto ch : data)
+				crc = table [(crc ^ static_cast<quint8> (ch)) & 0xff] ^ (crc >> 8);
+			return crc ^ 0xffffffff;
+		}
+
+		void AppendLE (QByteArray& ba, quint32 value)
+		{
+			for (int i = 0; i < 4; ++i, value >>= 8)
+				ba.append (static_cast<char> (value & 0xff));
+		}
+
+		QByteArray Gzip (const QByteArray& data)
+		{
+			// qCompress() returns the 4 bytes of the uncompressed length
+			// followed by a zlib stream: 2 bytes of the header, the raw
+			// deflate data and 4 bytes of the Adler-32 checksum.
+			const auto& zlib = qCompress (data, 6);
+			if (zlib.size () < 10)
+				return {};
+
+			const char header [] = { 0x1f, static_cast<char> (0x8b), 8, 0, 0, 0, 0, 0, 0, 3 };
+
+			QByteArray result;
+			result.reserve (zlib.size () + 12);
+			result.append (header, sizeof (header));
+			result.append (zlib.constData () + 6, zlib.size () - 10);
+			AppendLE (result, Crc32 (data));
+			AppendLE (result, data.size ());
+			return result;
+		}
+	}
+
+	DirListingCache::DirListingCache (bool gzipListings)
+	: GzipListings_ (gzipListings)
+	, Listings_ (32 * 1024)
+	, Mimes_ (100 * 1000)
+	{
+	}
+
+	DirListingCache::Listing_ptr DirListingCache::GetListing (const QString& key, const QDateTime& dirMTime)
+	{
+		QMutexLocker locker (&Mutex_);
+
+		const auto cached = Listings_.object (key);
+		if (!cached ||
+				cached->DirMTime_ != dirMTime ||
+				cached->Created_.secsTo (QDateTime::currentDateTimeUtc ()) > MaxListingAge)
+			return {};
+
+		return cached->Listing_;
+	}
+
+	DirListingCache::Listing_ptr DirListingCache::AddListing (const QString& key,
+			const QDateTime& dirMTime, const QDateTime& lastModified, const QByteArray& html)
+	{
+		const auto listing = std::make_shared<Listing> ();
+		listing->Html_ = html;
+		listing->ETag_ = '"' + QCryptographicHash::hash (html, QCryptographicHash::Md5).toHex () + '"';
+		listing->LastModified_ = lastModified;
+		if (GzipListings_)
+			listing->Gzipped_ = Gzip (html);
+
+		// The cost is in kibibytes.
+		const auto cost = (listing->Html_.size () + listing->Gzipped_.size ()) / 1024 + 1;
+
+		QMutexLocker locker (&Mutex_);
+		Listings_.insert (key,
+				new CachedListing { dirMTime, QDateTime::currentDateTimeUtc (), listing },
+				cost);
+		return listing;
+	}
+
+	QByteArray DirListingCache::GetMimeType (const QFileInfo& fi)
+	{
+		const auto& path = fi.filePath ();
+		const auto size = fi.size ();
+		const auto& modified = fi.lastModified ();
+
+		{
+			QMutexLocker locker (&Mutex_);
+			if (const auto cached = Mimes_.object (path))
+				if (cached->Size_ == size && cached->Modified_ == modified)
+					return cached->Mime_;
+		}
+
+		QByteArray mime;
+		{
+			QMutexLocker locker (&DetectorMutex_);
+			mime = Detector_ (path);
+		}
+
+		QMutexLocker locker (&Mutex_);
+		Mimes_.insert (path, new CachedMime { size, modified, mime });
+		return mime;
+	}
+
+	boost::optional<QByteArray> DirListingCache::GetIcon (const QByteArray& mime)
+	{
+		QMutexLocker locker (&Mutex_);
+		const auto pos = Icons_.find (mime);
+		if (pos == Icons_.end ())
+			return {};
+		return *pos;
+	}
+
+	void DirListingCache::AddIcon (const QByteArray& mime, const QByteArray& icon)
+	{
+		QMutexLocker locker (&Mutex_);
+		Icons_ [mime] = icon;
+	}
+}
+}
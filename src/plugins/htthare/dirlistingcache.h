@@ -0,0 +1,127 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <boost/optional.hpp>
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <util/sys/mimedetector.h>
+
+class QFileInfo;
+
+namespace LeechCraft
+{
+namespace HttHare
+{
+	/** Caches the generated directory listings and the data they are
+	 * built from.
+	 *
+	 * A listing is keyed by the directory path and the request variant
+	 * (URL and languages). It is valid as long as the directory mtime
+	 * doesn't change, but at most for a short while, since file sizes
+	 * may change without touching the directory.
+	 *
+	 * MIME types of files and icons of MIME types outlive the listings.
+	 * So regenerating the listing of a changed directory only inspects
+	 * the files that have actually changed.
+	 *
+	 * All the methods are thread-safe.
+	 */
+	class DirListingCache
+	{
+	public:
+		struct Listing
+		{
+			QByteArray Html_;
+
+			/** Gzip-compressed Html_, empty if listings compression is
+			 * disabled.
+			 */
+			QByteArray Gzipped_;
+
+			QByteArray ETag_;
+
+			/** The latest modification time of the directory and its
+			 * entries.
+			 */
+			QDateTime LastModified_;
+		};
+		typedef std::shared_ptr<const Listing> Listing_ptr;
+	private:
+		const bool GzipListings_;
+
+		struct CachedListing
+		{
+			QDateTime DirMTime_;
+			QDateTime Created_;
+			Listing_ptr Listing_;
+		};
+
+		struct CachedMime
+		{
+			qint64 Size_;
+			QDateTime Modified_;
+			QByteArray Mime_;
+		};
+
+		QMutex Mutex_;
+		QCache<QString, CachedListing> Listings_;
+		QCache<QString, CachedMime> Mimes_;
+		QHash<QByteArray, QByteArray> Icons_;
+
+		QMutex DetectorMutex_;
+		Util::MimeDetector Detector_;
+	public:
+		DirListingCache (bool gzipListings);
+
+		DirListingCache (const DirListingCache&) = delete;
+		DirListingCache& operator= (const DirListingCache&) = delete;
+
+		/** Returns the listing for the given key if it is still valid for
+		 * the given directory mtime, or a null pointer otherwise.
+		 */
+		Listing_ptr GetListing (const QString& key, const QDateTime& dirMTime);
+
+		/** Creates a listing from the given HTML, computing its ETag and
+		 * its compressed version, and caches it.
+		 */
+		Listing_ptr AddListing (const QString& key, const QDateTime& dirMTime,
+				const QDateTime& lastModified, const QByteArray& html);
+
+		QByteArray GetMimeType (const QFileInfo&);
+
+		boost::optional<QByteArray> GetIcon (const QByteArray& mime);
+		void AddIcon (const QByteArray& mime, const QByteArray& icon);
+	};
+}
+}
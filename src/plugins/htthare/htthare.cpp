@@ -51,7 +51,7 @@ namespace HttHare
 		connect (AddrMgr_,
 				SIGNAL (addressesChanged ()),
 				this,
-				SLOT (reapplyAddresses ()));
+				SLOT (restartServer ()));
 
 		XSD_.reset (new Util::XmlSettingsDialog);
 		XSD_->RegisterObject (&XmlSettingsManager::Instance (), "httharesettings.xml");
@@ -61,6 +61,9 @@ namespace HttHare
 		XmlSettingsManager::Instance ().RegisterObject ("EnableServer",
 				this, "handleEnableServerChanged");
 		handleEnableServerChanged ();
+
+		XmlSettingsManager::Instance ().RegisterObject ({ "KeepAliveTimeout", "MaxKeepAliveRequests", "GzipListings" },
+				this, "restartServer");
 	}
 
 	void Plugin::SecondInit ()
@@ -92,6 +95,25 @@ namespace HttHare
 		return QIcon ();
 	}
 
+	namespace
+	{
+		KeepAliveParams GetKeepAliveParams ()
+		{
+			const auto& xsm = XmlSettingsManager::Instance ();
+			return
+			{
+				std::chrono::seconds { xsm.property ("KeepAliveTimeout").toInt () },
+				xsm.property ("MaxKeepAliveRequests").toInt ()
+			};
+		}
+
+		Server* MakeServer (const QList<QPair<QString, QString>>& addresses)
+		{
+			const auto gzip = XmlSettingsManager::Instance ().property ("GzipListings").toBool ();
+			return new Server { addresses, GetKeepAliveParams (), gzip };
+		}
+	}
+
 	Util::XmlSettingsDialog_ptr Plugin::GetSettingsDialog () const
 	{
 		return XSD_;
@@ -108,12 +130,12 @@ namespace HttHare
 			S_.reset ();
 		else
 		{
-			S_.reset (new Server { AddrMgr_->GetAddresses () });
+			S_.reset (MakeServer (AddrMgr_->GetAddresses ()));
 			S_->Start ();
 		}
 	}
 
-	void Plugin::reapplyAddresses ()
+	void Plugin::restartServer ()
 	{
 		if (!S_)
 			return;
@@ -125,7 +147,7 @@ namespace HttHare
 		QTimer::singleShot (100, &loop, SLOT (quit ()));
 		loop.exec ();
 
-		S_.reset (new Server { AddrMgr_->GetAddresses () });
+		S_.reset (MakeServer (AddrMgr_->GetAddresses ()));
 		S_->Start ();
 	}
 }
@@ -70,7 +70,7 @@ namespace HttHare
 		Util::XmlSettingsDialog_ptr GetSettingsDialog () const;
 	private slots:
 		void handleEnableServerChanged ();
-		void reapplyAddresses ();
+		void restartServer ();
 	};
 }
 }
@@ -48,12 +48,13 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDateTime>
+#include <QLocale>
 #include <util/util.h>
-#include <util/sys/mimedetector.h>
 #include "connection.h"
 #include "storagemanager.h"
 #include "iconresolver.h"
 #include "trmanager.h"
+#include "dirlistingcache.h"
 
 namespace LeechCraft
 {
@@ -92,6 +93,18 @@ namespace HttHare
 			Headers_ [line.left (colonPos)] = line.mid (colonPos + 1).trimmed ();
 		}
 
+		const auto& version = req.value (2).toUpper ();
+		const auto& connection = Headers_.value ("Connection").toLower ();
+		KeepAlive_ = Conn_->GetRemainingRequests () > 0 &&
+				(version == "HTTP/1.1" ?
+					!connection.contains ("close") :
+					connection.contains ("keep-alive"));
+
+		// Request bodies aren't read, so the connection can't be reused.
+		if (Headers_.value ("Content-Length", "0") != "0" ||
+				Headers_.contains ("Transfer-Encoding"))
+			KeepAlive_ = false;
+
 #ifdef QT_DEBUG
 		qDebug () << Q_FUNC_INFO << "got request";
 		qDebug () << req << Url_;
@@ -104,8 +117,11 @@ namespace HttHare
 		else if (verb == "get")
 			HandleRequest (Verb::Get);
 		else
+		{
+			KeepAlive_ = false;
 			return ErrorResponse (405, "Method Not Allowed",
 					"Method " + verb + " not supported by this server.");
+		}
 	}
 
 	QString RequestHandler::Tr (const char *msg)
@@ -159,33 +175,45 @@ namespace HttHare
 		const auto IconSize = 16;
 	}
 
-	QByteArray RequestHandler::MakeDirResponse (const QFileInfo& fi, const QString& path, const QUrl& url)
+	QByteArray RequestHandler::MakeDirResponse (const QFileInfo& fi,
+			const QString& path, const QUrl& url, QDateTime& lastModified)
 	{
 		const auto& entries = QDir { path }
 				.entryInfoList (QDir::AllEntries | QDir::NoDot,
 						QDir::Name | QDir::DirsFirst);
 
+		auto& cache = Conn_->GetDirListingCache ();
+
+		lastModified = fi.lastModified ();
+
 		struct MimeInfo
 		{
 			QString MimeType_;
 		};
 		QHash<QString, QByteArray> mimeCache;
 		QList<MimeInfo> mimes;
-		Util::MimeDetector detector;
 		for (const auto& entry : entries)
 		{
-			const auto& type = detector (entry.filePath ());
+			lastModified = std::max (lastModified, entry.lastModified ());
+
+			const auto& type = cache.GetMimeType (entry);
 
 			if (!mimeCache.contains (type))
 			{
-				QByteArray image;
-				QMetaObject::invokeMethod (Conn_->GetIconResolver (),
-						"resolveMime",
-						Qt::BlockingQueuedConnection,
-						Q_ARG (QString, type),
-						Q_ARG (QByteArray&, image),
-						Q_ARG (int, IconSize));
-				mimeCache [type] = image;
+				if (const auto cached = cache.GetIcon (type))
+					mimeCache [type] = *cached;
+				else
+				{
+					QByteArray image;
+					QMetaObject::invokeMethod (Conn_->GetIconResolver (),
+							"resolveMime",
+							Qt::BlockingQueuedConnection,
+							Q_ARG (QString, type),
+							Q_ARG (QByteArray&, image),
+							Q_ARG (int, IconSize));
+					cache.AddIcon (type, image);
+					mimeCache [type] = image;
+				}
 			}
 
 			mimes.append ({ type });
@@ -225,6 +253,104 @@ namespace HttHare
 		return result.toUtf8 ();
 	}
 
+	DirListingCache::Listing_ptr RequestHandler::GetListing (const QFileInfo& fi,
+			const QString& path, const QUrl& url)
+	{
+		auto& cache = Conn_->GetDirListingCache ();
+
+		// The listing depends on the URL it is shown for and on the
+		// languages it is translated to.
+		const auto& key = path + '\n' + url.toString () + '\n' + Headers_.value ("Accept-Language");
+
+		const auto& dirMTime = fi.lastModified ();
+		if (const auto listing = cache.GetListing (key, dirMTime))
+			return listing;
+
+		QDateTime lastModified;
+		const auto& html = MakeDirResponse (fi, path, url, lastModified);
+		return cache.AddListing (key, dirMTime, lastModified, html);
+	}
+
+	namespace
+	{
+		const auto HttpDateFormat = "ddd, dd MMM yyyy hh:mm:ss 'GMT'";
+
+		QByteArray FormatHttpDate (const QDateTime& dt)
+		{
+			return QLocale::c ().toString (dt.toUTC (), HttpDateFormat).toLatin1 ();
+		}
+
+		QDateTime ParseHttpDate (const QString& str)
+		{
+			auto dt = QLocale::c ().toDateTime (str.trimmed (), HttpDateFormat);
+			dt.setTimeSpec (Qt::UTC);
+			return dt;
+		}
+
+		QByteArray MakeFileETag (const QFileInfo& fi)
+		{
+			return '"' + QByteArray::number (fi.size (), 16) +
+					'-' + QByteArray::number (fi.lastModified ().toMSecsSinceEpoch (), 16) + '"';
+		}
+
+		bool SupportsEncoding (const QString& acceptEncoding, const QString& encoding)
+		{
+			for (const auto& val : acceptEncoding.split (','))
+				if (!val.section (';', 0, 0).trimmed ().compare (encoding, Qt::CaseInsensitive))
+					return true;
+
+			return false;
+		}
+
+		QByteArray WithCoding (QByteArray etag, const QByteArray& coding)
+		{
+			if (!coding.isEmpty ())
+				etag.insert (etag.size () - 1, '-' + coding);
+			return etag;
+		}
+	}
+
+	void RequestHandler::AddValidators (const QByteArray& etag, const QDateTime& lastModified)
+	{
+		ResponseHeaders_.append ({ "ETag", etag });
+		ResponseHeaders_.append ({ "Last-Modified", FormatHttpDate (lastModified) });
+	}
+
+	bool RequestHandler::IsNotModified (const QByteArray& etag, const QDateTime& lastModified) const
+	{
+		// If-None-Match takes precedence over If-Modified-Since, see RFC 7232.
+		const auto& noneMatch = Headers_.value ("If-None-Match");
+		if (!noneMatch.isEmpty ())
+		{
+			for (auto tag : noneMatch.split (','))
+			{
+				tag = tag.trimmed ();
+				if (tag == "*")
+					return true;
+
+				if (tag.startsWith ("W/"))
+					tag = tag.mid (2);
+				if (tag.toLatin1 () == etag)
+					return true;
+			}
+
+			return false;
+		}
+
+		const auto& since = ParseHttpDate (Headers_.value ("If-Modified-Since"));
+		return since.isValid () &&
+				lastModified.toUTC ().toTime_t () <= since.toTime_t ();
+	}
+
+	void RequestHandler::NotModified (Verb verb)
+	{
+		ResponseLine_ = "HTTP/1.1 304 Not Modified\r\n";
+		ResponseBody_.clear ();
+		HasBody_ = false;
+
+		DefaultWrite (verb);
+	}
+
 	namespace
 	{
 		QList<QPair<qint64, qint64>> ParseRanges (QString str, qint64 fullSize)
@@ -312,6 +438,7 @@ namespace HttHare
 		struct Sendfiler
 		{
 			boost::asio::ip::tcp::socket& Sock_;
+			boost::asio::io_service::strand& Strand_;
 			std::shared_ptr<QFile> File_;
 			off_t Offset_;
 
@@ -365,7 +492,7 @@ namespace HttHare
 					if (ec == boost::asio::error::would_block ||
 							ec == boost::asio::error::try_again)
 					{
-						Sock_.async_write_some (boost::asio::null_buffers {}, *this);
+						Sock_.async_write_some (boost::asio::null_buffers {}, Strand_.wrap (*this));
 						return;
 					}
 
@@ -375,7 +502,7 @@ namespace HttHare
 					if (!toTransfer && !TailRanges_.isEmpty ())
 					{
 						CurrentRange_ = TailRanges_.takeFirst ();
-						Sock_.async_write_some (boost::asio::null_buffers {}, *this);
+						Sock_.async_write_some (boost::asio::null_buffers {}, Strand_.wrap (*this));
 						return;
 					}
 				}
@@ -445,10 +572,36 @@ namespace HttHare
 	{
 		if (Url_.path ().endsWith ('/'))
 		{
+			const auto& listing = GetListing (fi, path, Url_);
+
+			// Each content coding is a different representation, so it
+			// needs its own strong validator.
+			const auto& acceptEncoding = Headers_.value ("Accept-Encoding");
+			QByteArray coding;
+			if (!listing->Gzipped_.isEmpty () && SupportsEncoding (acceptEncoding, "gzip"))
+				coding = "gzip";
+			else if (SupportsEncoding (acceptEncoding, "deflate"))
+				coding = "deflate";
+			const auto& etag = WithCoding (listing->ETag_, coding);
+
+			ResponseHeaders_.append ({ "Vary", "Accept-Encoding, Accept-Language" });
+			ResponseHeaders_.append ({ "Cache-Control", "no-cache" });
+			AddValidators (etag, listing->LastModified_);
+
+			if (IsNotModified (etag, listing->LastModified_))
+				return NotModified (verb);
+
 			ResponseLine_ = "HTTP/1.1 200 OK\r\n";
 
 			ResponseHeaders_.append ({ "Content-Type", "text/html; charset=utf-8" });
-			ResponseBody_ = MakeDirResponse (fi, path, Url_);
+			if (coding == "gzip")
+			{
+				ResponseHeaders_.append ({ "Content-Encoding", "gzip" });
+				ResponseBody_ = listing->Gzipped_;
+				BodyEncoded_ = true;
+			}
+			else
+				ResponseBody_ = listing->Html_;
 
 			DefaultWrite (verb);
 		}
@@ -459,7 +612,7 @@ namespace HttHare
 			auto url = Url_;
 			url.setPath (url.path () + '/');
 			ResponseHeaders_.append ({ "Location", url.toString ().toUtf8 () });
-			ResponseBody_ = MakeDirResponse (fi, path, url);
+			ResponseBody_ = GetListing (fi, path, url)->Html_;
 
 			DefaultWrite (verb);
 		}
@@ -467,9 +620,23 @@ namespace HttHare
 
 	void RequestHandler::WriteFile (const QString& path, const QFileInfo& fi, RequestHandler::Verb verb)
 	{
+		const auto& etag = MakeFileETag (fi);
+		const auto& lastModified = fi.lastModified ();
+		AddValidators (etag, lastModified);
+
+		if (IsNotModified (etag, lastModified))
+			return NotModified (verb);
+
 		auto ranges = ParseRanges (Headers_.value ("Range"), fi.size ());
 
-		const auto& mime = Util::MimeDetector {} (path);
+		// The ranges are only valid for the entity the client already has.
+		const auto& ifRange = Headers_.value ("If-Range").toLatin1 ();
+		if (!ifRange.isEmpty () &&
+				ifRange != etag &&
+				ifRange != FormatHttpDate (lastModified))
+			ranges.clear ();
+
+		const auto& mime = Conn_->GetDirListingCache ().GetMimeType (fi);
 		ResponseHeaders_.append ({ "Content-Type", mime });
 
 		if (ranges.isEmpty ())
@@ -488,25 +655,27 @@ namespace HttHare
 			ResponseHeaders_.append ({ "Content-Length", QByteArray::number (totalSize) });
 		}
 
+		auto self = shared_from_this ();
 		auto c = Conn_;
 		boost::asio::async_write (c->GetSocket (),
 				ToBuffers (verb),
-				c->GetStrand ().wrap ([c, path, verb, ranges] (boost::system::error_code ec, ulong) mutable -> void
+				c->GetStrand ().wrap ([self, c, path, verb, ranges] (boost::system::error_code ec, ulong) mutable -> void
 					{
 						if (ec)
+						{
 							qWarning () << Q_FUNC_INFO
 									<< ec.message ().c_str ();
-
-						auto& s = c->GetSocket ();
-
-						std::shared_ptr<void> shutdownGuard = std::shared_ptr<void> (nullptr,
-								[&s, &ec] (void*)
-								{
-									s.shutdown (boost::asio::socket_base::shutdown_both, ec);
-								});
+							c->FinishRequest (false);
+							return;
+						}
 
 						if (verb != Verb::Get)
+						{
+							c->FinishRequest (self->KeepAlive_);
 							return;
+						}
+
+						auto& s = c->GetSocket ();
 
 						std::shared_ptr<QFile> file { new QFile { path } };
 						file->open (QIODevice::ReadOnly);
@@ -521,28 +690,30 @@ namespace HttHare
 						Sendfiler
 						{
 							s,
+							c->GetStrand (),
 							file,
 							0,
 							headRange,
 							ranges,
-							[c, shutdownGuard] (boost::system::error_code, ulong) {}
+							[self, c] (boost::system::error_code sendEc, ulong)
+								{ c->FinishRequest (!sendEc && self->KeepAlive_); }
 						} (ec, 0);
 					}));
 	}
 
 	void RequestHandler::DefaultWrite (Verb verb)
 	{
+		auto self = shared_from_this ();
 		auto c = Conn_;
 		boost::asio::async_write (c->GetSocket (),
 				ToBuffers (verb),
-				c->GetStrand ().wrap ([c] (const boost::system::error_code& ec, ulong)
+				c->GetStrand ().wrap ([self, c] (const boost::system::error_code& ec, ulong)
 					{
 						if (ec)
 							qWarning () << Q_FUNC_INFO
 									<< ec.message ().c_str ();
 
-						boost::system::error_code iec;
-						c->GetSocket ().shutdown (boost::asio::socket_base::shutdown_both, iec);
+						c->FinishRequest (!ec && self->KeepAlive_);
 					}));
 	}
 
@@ -553,14 +724,6 @@ namespace HttHare
 			return { ba.constData (), static_cast<size_t> (ba.size ()) };
 		}
 
-		bool SupportsDeflate (const QStringList& ae)
-		{
-			for (const auto& val : ae)
-				if (!val.trimmed ().compare ("deflate", Qt::CaseInsensitive))
-					return true;
-
-			return false;
-		}
 	}
 
 	std::vector<boost::asio::const_buffer> RequestHandler::ToBuffers (Verb verb)
@@ -571,19 +734,31 @@ namespace HttHare
 				[] (decltype (ResponseHeaders_.at (0)) pair)
 					{ return pair.first.toLower () == "content-length"; }) != ResponseHeaders_.end ();
 
-		const auto& splitAe = Headers_.value ("Accept-Encoding").split (',');
 		if (verb == Verb::Get &&
+				HasBody_ &&
+				!BodyEncoded_ &&
 				!ResponseBody_.isEmpty () &&
-				SupportsDeflate (splitAe))
+				SupportsEncoding (Headers_.value ("Accept-Encoding"), "deflate"))
 		{
 			ResponseHeaders_.append ({ "Content-Encoding", "deflate" });
 			ResponseBody_ = qCompress (ResponseBody_, 6);
 			ResponseBody_.remove (0, 4);
 		}
 
-		if (!hasContentLength)
+		if (!hasContentLength && HasBody_)
 			ResponseHeaders_.append ({ "Content-Length", QByteArray::number (ResponseBody_.size ()) });
 
+		if (KeepAlive_)
+		{
+			const auto& params = Conn_->GetKeepAliveParams ();
+			ResponseHeaders_.append ({ "Connection", "keep-alive" });
+			ResponseHeaders_.append ({ "Keep-Alive",
+					"timeout=" + QByteArray::number (static_cast<int> (params.Timeout_.count ())) +
+					", max=" + QByteArray::number (Conn_->GetRemainingRequests ()) });
+		}
+		else
+			ResponseHeaders_.append ({ "Connection", "close" });
+
 		CookedRH_.clear ();
 		for (const auto& pair : ResponseHeaders_)
 			CookedRH_ += pair.first + ": " + pair.second + "\r\n";
@@ -599,7 +774,7 @@ namespace HttHare
 		result.push_back (BA2Buffer (ResponseLine_));
 		result.push_back (BA2Buffer (CookedRH_));
 
-		if (verb == Verb::Get)
+		if (verb == Verb::Get && HasBody_)
 			result.push_back (BA2Buffer (ResponseBody_));
 
 		return result;
@@ -35,8 +35,10 @@
 #include <QUrl>
 #include <QMap>
 #include <QCoreApplication>
+#include "dirlistingcache.h"
 
 class QFileInfo;
+class QDateTime;
 
 namespace LeechCraft
 {
@@ -45,7 +47,7 @@ namespace HttHare
 	class Connection;
 	typedef std::shared_ptr<Connection> Connection_ptr;
 
-	class RequestHandler
+	class RequestHandler : public std::enable_shared_from_this<RequestHandler>
 	{
 		Q_DECLARE_TR_FUNCTIONS (LeechCraft::HttHare::RequestHandler)
 
@@ -54,11 +56,16 @@ namespace HttHare
 		QUrl Url_;
 		QMap<QString, QString> Headers_;
 
+		bool KeepAlive_ = false;
+
 		QByteArray ResponseLine_;
 		QList<QPair<QByteArray, QByteArray>> ResponseHeaders_;
 		QByteArray CookedRH_;
 		QByteArray ResponseBody_;
 
+		bool HasBody_ = true;
+		bool BodyEncoded_ = false;
+
 		enum class Verb
 		{
 			Get,
@@ -72,7 +79,12 @@ namespace HttHare
 		QString Tr (const char*);
 
 		void ErrorResponse (int, const QByteArray&, const QByteArray& = QByteArray ());
-		QByteArray MakeDirResponse (const QFileInfo&, const QString&, const QUrl&);
+		QByteArray MakeDirResponse (const QFileInfo&, const QString&, const QUrl&, QDateTime&);
+		DirListingCache::Listing_ptr GetListing (const QFileInfo&, const QString&, const QUrl&);
+
+		void AddValidators (const QByteArray&, const QDateTime&);
+		bool IsNotModified (const QByteArray&, const QDateTime&) const;
+		void NotModified (Verb);
 
 		void HandleRequest (Verb);
 		void WriteDir (const QString&, const QFileInfo&, Verb);
@@ -40,9 +40,12 @@ namespace HttHare
 {
 	namespace ip = boost::asio::ip;
 
-	Server::Server (const QList<QPair<QString, QString>>& addresses)
-	: IconResolver_ { new IconResolver  }
+	Server::Server (const QList<QPair<QString, QString>>& addresses,
+			const KeepAliveParams& keepAlive, bool gzipListings)
+	: ListingCache_ { gzipListings }
+	, IconResolver_ { new IconResolver  }
 	, TrManager_ { new TrManager }
+	, KeepAlive_ (keepAlive)
 	{
 		ip::tcp::resolver resolver { IoService_ };
 
@@ -97,7 +100,7 @@ namespace HttHare
 
 	void Server::StartAccept ()
 	{
-		Connection_ptr connection { new Connection { IoService_, StorageMgr_, IconResolver_, TrManager_ } };
+		Connection_ptr connection { new Connection { IoService_, StorageMgr_, ListingCache_, IconResolver_, TrManager_, KeepAlive_ } };
 
 		for (auto& acceptor : Acceptors_)
 			acceptor->async_accept (connection->GetSocket (),
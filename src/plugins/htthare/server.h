@@ -32,6 +32,8 @@
 #include <thread>
 #include <boost/asio.hpp>
 #include "storagemanager.h"
+#include "connection.h"
+#include "dirlistingcache.h"
 
 template<typename T>
 class QSet;
@@ -51,13 +53,17 @@ namespace HttHare
 		std::vector<std::unique_ptr<boost::asio::ip::tcp::acceptor>> Acceptors_;
 
 		StorageManager StorageMgr_;
+		DirListingCache ListingCache_;
 
 		std::vector<std::thread> Threads_;
 
 		IconResolver * const IconResolver_;
 		TrManager * const TrManager_;
+
+		const KeepAliveParams KeepAlive_;
 	public:
-		Server (const QList<QPair<QString, QString>>& addresses);
+		Server (const QList<QPair<QString, QString>>& addresses,
+				const KeepAliveParams&, bool gzipListings);
 		~Server ();
 
 		Server (const Server&) = delete;
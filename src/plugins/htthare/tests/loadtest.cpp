@@ -0,0 +1,426 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+/* A load generator for HttHare.
+ *
+ * Each of the connections issues the given number of GET requests for
+ * the listed paths, in turn, optionally keeping the connection alive
+ * and pipelining several requests at once. With -r, every request asks
+ * for a random range of the given size instead of the whole file,
+ * which is what media players do when seeking.
+ *
+ * Reports the throughput and the latency distribution.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+
+namespace LeechCraft
+{
+namespace HttHare
+{
+namespace LoadTest
+{
+	namespace asio = boost::asio;
+	using asio::ip::tcp;
+	using Clock_t = std::chrono::steady_clock;
+
+	struct Options
+	{
+		std::string Host_ = "127.0.0.1";
+		std::string Port_ = "14801";
+		int Connections_ = 8;
+		int Requests_ = 1000;
+		int Depth_ = 1;
+		long long RangeSize_ = 0;
+		bool KeepAlive_ = true;
+		std::vector<std::string> Paths_;
+	};
+
+	struct Target
+	{
+		std::string Path_;
+		long long Size_;
+	};
+
+	struct Stats
+	{
+		std::vector<double> Latencies_;
+		size_t Errors_ = 0;
+		size_t Connects_ = 0;
+		unsigned long long Bytes_ = 0;
+	};
+
+	struct Response
+	{
+		int Status_ = 0;
+		long long ContentLength_ = 0;
+		bool Close_ = false;
+	};
+
+	std::string ToLower (std::string str)
+	{
+		std::transform (str.begin (), str.end (), str.begin (),
+				[] (unsigned char c) { return std::tolower (c); });
+		return str;
+	}
+
+	bool ReadResponse (tcp::socket& sock, asio::streambuf& buf, bool head, Response& resp)
+	{
+		boost::system::error_code ec;
+		const auto headerSize = asio::read_until (sock, buf, "\r\n\r\n", ec);
+		if (ec)
+			return false;
+
+		const std::string header { asio::buffers_begin (buf.data ()),
+				asio::buffers_begin (buf.data ()) + headerSize };
+		buf.consume (headerSize);
+
+		std::istringstream istr { header };
+		std::string line;
+		std::getline (istr, line);
+
+		std::istringstream statusLine { line };
+		std::string version;
+		statusLine >> version >> resp.Status_;
+		resp.Close_ = version != "HTTP/1.1";
+
+		while (std::getline (istr, line))
+		{
+			const auto colonPos = line.find (':');
+			if (colonPos == std::string::npos)
+				continue;
+
+			const auto& name = ToLower (line.substr (0, colonPos));
+			const auto& value = ToLower (line.substr (colonPos + 1));
+			if (name == "content-length")
+				resp.ContentLength_ = std::atoll (value.c_str ());
+			else if (name == "connection")
+			{
+				if (value.find ("close") != std::string::npos)
+					resp.Close_ = true;
+				else if (value.find ("keep-alive") != std::string::npos)
+					resp.Close_ = false;
+			}
+		}
+
+		if (head)
+			return true;
+
+		const auto length = static_cast<size_t> (resp.ContentLength_);
+		if (buf.size () < length)
+			asio::read (sock, buf, asio::transfer_exactly (length - buf.size ()), ec);
+		if (ec)
+			return false;
+
+		buf.consume (length);
+		return true;
+	}
+
+	std::string MakeRequest (const Options& opts, const std::string& verb,
+			const std::string& path, const std::string& range)
+	{
+		std::string result = verb + " " + path + " HTTP/1.1\r\n";
+		result += "Host: " + opts.Host_ + ":" + opts.Port_ + "\r\n";
+		if (!range.empty ())
+			result += "Range: bytes=" + range + "\r\n";
+		if (!opts.KeepAlive_)
+			result += "Connection: close\r\n";
+		result += "\r\n";
+		return result;
+	}
+
+	bool Connect (asio::io_service& io, tcp::socket& sock, const Options& opts)
+	{
+		boost::system::error_code ec;
+		sock.close (ec);
+
+		tcp::resolver resolver { io };
+		const auto& endpoints = resolver.resolve ({ opts.Host_, opts.Port_ }, ec);
+		if (ec)
+			return false;
+
+		asio::connect (sock, endpoints, ec);
+		if (ec)
+			return false;
+
+		sock.set_option (tcp::no_delay { true }, ec);
+		return true;
+	}
+
+	std::vector<Target> ResolveTargets (const Options& opts)
+	{
+		std::vector<Target> result;
+
+		asio::io_service io;
+		tcp::socket sock { io };
+		asio::streambuf buf;
+
+		for (const auto& path : opts.Paths_)
+		{
+			if (!Connect (io, sock, opts))
+				throw std::runtime_error { "cannot connect to " + opts.Host_ + ":" + opts.Port_ };
+
+			asio::write (sock, asio::buffer (MakeRequest (opts, "HEAD", path, {})));
+
+			Response resp;
+			if (!ReadResponse (sock, buf, true, resp) || resp.Status_ != 200)
+				throw std::runtime_error { "cannot query " + path };
+
+			result.push_back ({ path, resp.ContentLength_ });
+			buf.consume (buf.size ());
+		}
+
+		return result;
+	}
+
+	void RunWorker (const Options& opts, const std::vector<Target>& targets, unsigned seed, Stats& stats)
+	{
+		asio::io_service io;
+		tcp::socket sock { io };
+		asio::streambuf buf;
+		std::mt19937_64 rng { seed };
+
+		bool connected = false;
+		int servedOnConnection = 0;
+		size_t next = seed;
+
+		for (int remaining = opts.Requests_; remaining > 0; )
+		{
+			if (!connected)
+			{
+				buf.consume (buf.size ());
+				if (!Connect (io, sock, opts))
+				{
+					++stats.Errors_;
+					--remaining;
+					continue;
+				}
+				connected = true;
+				servedOnConnection = 0;
+				++stats.Connects_;
+			}
+
+			const int batch = opts.KeepAlive_ ? std::min (opts.Depth_, remaining) : 1;
+
+			std::string out;
+			for (int i = 0; i < batch; ++i)
+			{
+				const auto& target = targets [next++ % targets.size ()];
+
+				std::string range;
+				if (opts.RangeSize_ && target.Size_ > opts.RangeSize_)
+				{
+					std::uniform_int_distribution<long long> dist { 0, target.Size_ - opts.RangeSize_ };
+					const auto start = dist (rng);
+					range = std::to_string (start) + "-" + std::to_string (start + opts.RangeSize_ - 1);
+				}
+
+				out += MakeRequest (opts, "GET", target.Path_, range);
+			}
+
+			const auto start = Clock_t::now ();
+
+			boost::system::error_code ec;
+			asio::write (sock, asio::buffer (out), ec);
+			if (ec)
+			{
+				stats.Errors_ += batch;
+				remaining -= batch;
+				connected = false;
+				continue;
+			}
+
+			for (int i = 0; i < batch; ++i)
+			{
+				Response resp;
+				if (!ReadResponse (sock, buf, false, resp))
+				{
+					// The server may close the connection after the last
+					// request it agreed to serve or after the connection
+					// has been idle for too long: the rest of the batch is
+					// resent over a new connection.
+					if (!i && !servedOnConnection)
+					{
+						++stats.Errors_;
+						--remaining;
+					}
+					connected = false;
+					break;
+				}
+
+				const std::chrono::duration<double, std::milli> latency = Clock_t::now () - start;
+				stats.Latencies_.push_back (latency.count ());
+				stats.Bytes_ += resp.ContentLength_;
+				if (resp.Status_ < 200 || resp.Status_ >= 300)
+					++stats.Errors_;
+				--remaining;
+				++servedOnConnection;
+
+				if (resp.Close_ || !opts.KeepAlive_)
+				{
+					connected = false;
+					break;
+				}
+			}
+		}
+	}
+
+	void PrintUsage (const char *name)
+	{
+		std::cerr << "Usage: " << name << " [options] path [path ...]\n"
+				<< "\t-h host\tthe server host (default 127.0.0.1)\n"
+				<< "\t-P port\tthe server port (default 14801)\n"
+				<< "\t-c num\tthe number of concurrent connections (default 8)\n"
+				<< "\t-n num\tthe number of requests per connection (default 1000)\n"
+				<< "\t-p num\tthe number of pipelined requests (default 1)\n"
+				<< "\t-r size\trequest random ranges of the given size\n"
+				<< "\t-C\tdon't use persistent connections\n";
+	}
+
+	bool ParseOptions (int argc, char **argv, Options& opts)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg { argv [i] };
+			const bool hasValue = i + 1 < argc;
+
+			if (arg == "-h" && hasValue)
+				opts.Host_ = argv [++i];
+			else if (arg == "-P" && hasValue)
+				opts.Port_ = argv [++i];
+			else if (arg == "-c" && hasValue)
+				opts.Connections_ = std::atoi (argv [++i]);
+			else if (arg == "-n" && hasValue)
+				opts.Requests_ = std::atoi (argv [++i]);
+			else if (arg == "-p" && hasValue)
+				opts.Depth_ = std::atoi (argv [++i]);
+			else if (arg == "-r" && hasValue)
+				opts.RangeSize_ = std::atoll (argv [++i]);
+			else if (arg == "-C")
+				opts.KeepAlive_ = false;
+			else if (!arg.empty () && arg [0] == '/')
+				opts.Paths_.push_back (arg);
+			else
+				return false;
+		}
+
+		return !opts.Paths_.empty () &&
+				opts.Connections_ > 0 &&
+				opts.Requests_ > 0 &&
+				opts.Depth_ > 0 &&
+				opts.RangeSize_ >= 0;
+	}
+
+	double Percentile (const std::vector<double>& sorted, double p)
+	{
+		if (sorted.empty ())
+			return 0;
+
+		const auto idx = static_cast<size_t> (std::ceil (p * sorted.size ())) - 1;
+		return sorted [std::min (idx, sorted.size () - 1)];
+	}
+}
+}
+}
+
+int main (int argc, char **argv)
+{
+	using namespace LeechCraft::HttHare::LoadTest;
+
+	Options opts;
+	if (!ParseOptions (argc, argv, opts))
+	{
+		PrintUsage (argv [0]);
+		return 1;
+	}
+
+	std::vector<Target> targets;
+	try
+	{
+		targets = ResolveTargets (opts);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what () << std::endl;
+		return 1;
+	}
+
+	std::vector<Stats> stats (opts.Connections_);
+	std::vector<std::thread> threads;
+
+	const auto start = Clock_t::now ();
+	for (int i = 0; i < opts.Connections_; ++i)
+		threads.emplace_back ([&opts, &targets, &stats, i]
+				{ RunWorker (opts, targets, i, stats [i]); });
+	for (auto& thread : threads)
+		thread.join ();
+	const std::chrono::duration<double> elapsed = Clock_t::now () - start;
+
+	Stats total;
+	for (const auto& s : stats)
+	{
+		total.Latencies_.insert (total.Latencies_.end (), s.Latencies_.begin (), s.Latencies_.end ());
+		total.Errors_ += s.Errors_;
+		total.Connects_ += s.Connects_;
+		total.Bytes_ += s.Bytes_;
+	}
+	std::sort (total.Latencies_.begin (), total.Latencies_.end ());
+
+	const auto secs = elapsed.count ();
+	std::cout << std::fixed << std::setprecision (2)
+			<< "workload:    " << (opts.RangeSize_ ? "ranges of " + std::to_string (opts.RangeSize_) + " bytes" : "whole files")
+					<< ", " << opts.Connections_ << " clients"
+					<< ", pipeline depth " << opts.Depth_
+					<< (opts.KeepAlive_ ? "" : ", no keep-alive") << "\n"
+			<< "requests:    " << total.Latencies_.size ()
+					<< " (" << total.Errors_ << " errors, "
+					<< total.Connects_ << " connections)\n"
+			<< "elapsed:     " << secs << " s\n"
+			<< "throughput:  " << total.Latencies_.size () / secs << " req/s, "
+					<< total.Bytes_ / secs / (1024 * 1024) << " MiB/s\n"
+			<< "latency:     p50 " << Percentile (total.Latencies_, 0.5)
+					<< " ms, p99 " << Percentile (total.Latencies_, 0.99)
+					<< " ms, max " << (total.Latencies_.empty () ? 0 : total.Latencies_.back ())
+					<< " ms" << std::endl;
+
+	return total.Errors_ ? 2 : 0;
+}
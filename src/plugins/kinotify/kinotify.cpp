@@ -238,6 +238,11 @@ namespace Kinotify
 		return SettingsDialog_;
 	}
 
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/notification" }, {}, {} };
+	}
+
 	void Plugin::pushNotification ()
 	{
 		if (!ActiveNotifications_.size ())
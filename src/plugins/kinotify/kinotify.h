@@ -32,6 +32,7 @@
 #include <QObject>
 #include <interfaces/iinfo.h>
 #include <interfaces/ientityhandler.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 #include <interfaces/ihavesettings.h>
 #include <xmlsettingsdialog/xmlsettingsdialog.h>
 
@@ -51,9 +52,10 @@ namespace Kinotify
 					, public IInfo
 					, public IEntityHandler
 					, public IHaveSettings
+					, public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo IEntityHandler IHaveSettings)
+		Q_INTERFACES (IInfo IEntityHandler IHaveSettings IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.Kinotify")
 
@@ -77,6 +79,8 @@ namespace Kinotify
 		void Handle (Entity);
 
 		Util::XmlSettingsDialog_ptr GetSettingsDialog () const;
+
+		EntityRoutingKeys GetEntityRoutingKeys () const;
 	public slots:
 		void pushNotification ();
 	private slots:
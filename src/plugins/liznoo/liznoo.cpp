@@ -184,6 +184,11 @@ namespace Liznoo
 		}
 	}
 
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/power-management" }, {}, {} };
+	}
+
 	QList<QAction*> Plugin::GetActions (ActionsEmbedPlace place) const
 	{
 		QList<QAction*> result;
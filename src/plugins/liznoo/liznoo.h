@@ -35,6 +35,7 @@
 #include <interfaces/ihavesettings.h>
 #include <interfaces/ientityhandler.h>
 #include <interfaces/iactionsexporter.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 #include "batteryhistory.h"
 #include "batteryinfo.h"
 #include "platform/poweractions/platform.h"
@@ -61,9 +62,10 @@ namespace Liznoo
 				 , public IHaveSettings
 				 , public IEntityHandler
 				 , public IActionsExporter
+				 , public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo IHaveSettings IEntityHandler IActionsExporter)
+		Q_INTERFACES (IInfo IHaveSettings IEntityHandler IActionsExporter IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.Liznoo")
 
@@ -96,6 +98,8 @@ namespace Liznoo
 		EntityTestHandleResult CouldHandle (const Entity& entity) const;
 		void Handle (Entity entity);
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 		QList<QAction*> GetActions (ActionsEmbedPlace) const;
 		QMap<QString, QList<QAction*>> GetMenuActions () const;
 	private:
@@ -31,7 +31,7 @@
 
 #include <QtPlugin>
 
-class QMutex;
+class QReadWriteLock;
 
 namespace TagLib
 {
@@ -51,7 +51,7 @@ namespace LMP
 
 		virtual TagLib::FileRef GetFileRef (const QString&) const = 0;
 		virtual MediaInfo ResolveInfo (const QString&) = 0;
-		virtual QMutex& GetMutex () = 0;
+		virtual QReadWriteLock& GetTagLock () = 0;
 	};
 }
 }
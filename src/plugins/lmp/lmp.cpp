@@ -365,6 +365,20 @@ namespace LMP
 			player->AddToOneShotQueue (url);
 	}
 
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		/* Besides the listed MIME types, local files are passed either
+		 * as file URLs or as plain paths.
+		 */
+		return
+		{
+			{ "x-leechcraft/power-state-changed", "x-leechcraft/data-filter-request" },
+			{ "file" },
+			{ "Action" },
+			{ "QString" }
+		};
+	}
+
 	QList<QAction*> Plugin::GetActions (ActionsEmbedPlace) const
 	{
 		return QList<QAction*> ();
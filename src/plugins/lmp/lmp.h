@@ -41,6 +41,7 @@
 #include <interfaces/ijobholder.h>
 #include <interfaces/idatafilter.h>
 #include <interfaces/ihavediaginfo.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 
 namespace LeechCraft
 {
@@ -61,6 +62,7 @@ namespace LMP
 				 , public IJobHolder
 				 , public IDataFilter
 				 , public IHaveDiagInfo
+				 , public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
 		Q_INTERFACES (IInfo
@@ -73,7 +75,8 @@ namespace LMP
 				IPluginReady
 				IJobHolder
 				IDataFilter
-				IHaveDiagInfo)
+				IHaveDiagInfo
+				IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.LMP")
 
@@ -108,6 +111,8 @@ namespace LMP
 		EntityTestHandleResult CouldHandle (const Entity&) const;
 		void Handle (Entity);
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 		QList<QAction*> GetActions (ActionsEmbedPlace area) const;
 		QMap<QString, QList<QAction*>> GetMenuActions () const;
 
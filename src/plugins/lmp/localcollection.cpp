@@ -73,7 +73,7 @@ namespace LMP
 		connect (Watcher_,
 				SIGNAL (progressValueChanged (int)),
 				this,
-				SIGNAL (scanProgressChanged (int)));
+				SLOT (handleScanProgress (int)));
 
 		auto loadWatcher = new QFutureWatcher<LocalCollectionStorage::LoadResult> (this);
 		connect (loadWatcher,
@@ -93,6 +93,8 @@ namespace LMP
 				this,
 				SLOT (saveRootPaths ()));
 
+		xsd.RegisterObject ("AccurateTagScan", this, "handleAccurateTagScanChanged");
+
 		Sorter_->setSourceModel (CollectionModel_);
 		Sorter_->setDynamicSortFilter (true);
 		Sorter_->sort (0);
@@ -149,73 +151,85 @@ namespace LMP
 	{
 		struct IterateResult
 		{
-			QSet<QString> UnchangedFiles_;
 			QSet<QString> ChangedFiles_;
+			QStringList RemovedFiles_;
 		};
 	}
 
-	void LocalCollection::Scan (const QString& path, bool root)
+	void LocalCollection::Scan (const QString& path, bool root, bool force)
 	{
 		auto watcher = new QFutureWatcher<IterateResult> (this);
 		connect (watcher,
 				SIGNAL (finished ()),
 				this,
 				SLOT (handleIterateFinished ()));
-		watcher->setProperty ("Path", path);
 
 		if (root)
 			AddRootPaths ({ path });
 
 		const bool symLinks = XmlSettingsManager::Instance ()
 				.property ("FollowSymLinks").toBool ();
-		auto worker = [path, symLinks] () -> IterateResult
+		auto worker = [path, symLinks, force] () -> IterateResult
 		{
 			IterateResult result;
 
 			LocalCollectionStorage storage;
 
-			const auto& paths = storage.GetTracksPaths ();
+			QHash<QString, QDateTime> known;
+			try
+			{
+				known = storage.GetMTimes ();
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error getting mtimes"
+						<< e.what ();
+			}
+
+			QHash<QString, QDateTime> updated;
 
 			const auto& allInfos = RecIterateInfo (path, symLinks);
 			for (const auto& info : allInfos)
 			{
 				const auto& trackPath = info.absoluteFilePath ();
 				const auto& mtime = info.lastModified ();
-				try
-				{
-					const auto& storedDt = storage.GetMTime (trackPath);
-					if (storedDt.isValid () &&
-							std::abs (storedDt.msecsTo (mtime)) < 1500)
-					{
-						result.UnchangedFiles_ << trackPath;
-						continue;
-					}
-				}
-				catch (const std::exception& e)
-				{
-					qWarning () << Q_FUNC_INFO
-							<< "error getting mtime"
-							<< trackPath
-							<< e.what ();
-				}
 
-				if (paths.contains (trackPath))
+				const auto pos = known.find (trackPath);
+				if (pos == known.end ())
 				{
-					try
-					{
-						storage.SetMTime (trackPath, mtime);
-					}
-					catch (const std::exception& e)
-					{
-						qWarning () << Q_FUNC_INFO
-								<< "error setting mtime"
-								<< trackPath
-								<< e.what ();
-					}
+					result.ChangedFiles_ << trackPath;
+					continue;
 				}
+
+				const auto storedDt = *pos;
+				known.erase (pos);
+
+				if (!force &&
+						storedDt.isValid () &&
+						std::abs (storedDt.msecsTo (mtime)) < 1500)
+					continue;
+
+				updated [trackPath] = mtime;
 				result.ChangedFiles_ << trackPath;
 			}
 
+			const auto& dirPrefix = path.endsWith ('/') ? path : path + '/';
+			for (auto i = known.begin (), end = known.end (); i != end; ++i)
+				if (i.key () == path || i.key ().startsWith (dirPrefix))
+					result.RemovedFiles_ << i.key ();
+
+			try
+			{
+				storage.SetMTimes (updated);
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error setting mtimes"
+						<< e.what ();
+			}
+
 			return result;
 		};
 		watcher->setFuture (QtConcurrent::run (worker));
@@ -462,6 +476,7 @@ namespace LMP
 					trackAlbum->Year_ == info.Year_ &&
 					track.Number_ == info.TrackNumber_ &&
 					track.Name_ == info.Title_ &&
+					track.Length_ == info.Length_ &&
 					track.Genres_ == info.Genres_)
 				continue;
 
@@ -669,33 +684,36 @@ namespace LMP
 			emit rootPathsChanged (RootPaths_);
 	}
 
-	void LocalCollection::CheckRemovedFiles (const QSet<QString>& scanned, const QString& rootPath)
+	namespace
 	{
-		auto toRemove = PresentPaths_;
-		toRemove.subtract (scanned);
-
-		for (auto pos = toRemove.begin (); pos != toRemove.end (); )
-		{
-			if (pos->startsWith (rootPath))
-				++pos;
-			else
-				pos = toRemove.erase (pos);
-		}
-
-		Q_FOREACH (const auto& path, toRemove)
-			RemoveTrack (path);
+		const int ScanBatchSize = 500;
 	}
 
 	void LocalCollection::InitiateScan (const QSet<QString>& newPaths)
 	{
-		auto resolver = Core::Instance ().GetLocalFileResolver ();
+		ScanQueue_ = newPaths.toList ();
+		ScanDone_ = 0;
+		ScanReadStyle_ = XmlSettingsManager::Instance ().property ("AccurateTagScan").toBool () ?
+				TagLib::AudioProperties::Accurate :
+				TagLib::AudioProperties::Fast;
 
 		emit scanStarted (newPaths.size ());
-		auto worker = [resolver] (const QString& path) -> MediaInfo
+		ScanNextBatch ();
+	}
+
+	void LocalCollection::ScanNextBatch ()
+	{
+		const auto& batch = ScanQueue_.mid (0, ScanBatchSize);
+		ScanQueue_.erase (ScanQueue_.begin (), ScanQueue_.begin () + batch.size ());
+		ScanBatchSize_ = batch.size ();
+
+		auto resolver = Core::Instance ().GetLocalFileResolver ();
+		const auto style = ScanReadStyle_;
+		auto worker = [resolver, style] (const QString& path) -> MediaInfo
 		{
 			try
 			{
-				return resolver->ResolveInfo (path);
+				return resolver->ReadInfo (path, style);
 			}
 			catch (const ResolveError& error)
 			{
@@ -706,7 +724,7 @@ namespace LMP
 				return MediaInfo ();
 			}
 		};
-		const auto& future = QtConcurrent::mapped (newPaths,
+		const auto& future = QtConcurrent::mapped (batch,
 				std::function<MediaInfo (const QString&)> (worker));
 		Watcher_->setFuture (future);
 	}
@@ -730,8 +748,30 @@ namespace LMP
 
 	void LocalCollection::rescanOnLoad ()
 	{
+		const auto force = ForceRescanOnLoad_;
+		ForceRescanOnLoad_ = false;
+
 		Q_FOREACH (const auto& rootPath, RootPaths_)
-			Scan (rootPath, true);
+			Scan (rootPath, true, force);
+	}
+
+	/* The tracks already in the collection have been read with the fast
+	 * audio properties, and their files won't change, so a forced rescan
+	 * is the only way to get their exact lengths.
+	 */
+	void LocalCollection::handleAccurateTagScanChanged ()
+	{
+		if (!XmlSettingsManager::Instance ().property ("AccurateTagScan").toBool ())
+			return;
+
+		if (!IsReady_)
+		{
+			ForceRescanOnLoad_ = true;
+			return;
+		}
+
+		for (const auto& rootPath : RootPaths_)
+			Scan (rootPath, false, true);
 	}
 
 	void LocalCollection::handleLoadFinished ()
@@ -756,19 +796,23 @@ namespace LMP
 	{
 		sender ()->deleteLater ();
 
-		const auto& path = sender ()->property ("Path").toString ();
-
 		auto watcher = dynamic_cast<QFutureWatcher<IterateResult>*> (sender ());
 		const auto& result = watcher->result ();
 
-		CheckRemovedFiles (result.ChangedFiles_ + result.UnchangedFiles_, path);
+		for (const auto& path : result.RemovedFiles_)
+			RemoveTrack (path);
 
-		if (Watcher_->isRunning ())
+		if (Watcher_->isRunning () || !ScanQueue_.isEmpty ())
 			NewPathsQueue_ << result.ChangedFiles_;
 		else
 			InitiateScan (result.ChangedFiles_);
 	}
 
+	void LocalCollection::handleScanProgress (int progress)
+	{
+		emit scanProgressChanged (ScanDone_ + progress);
+	}
+
 	void LocalCollection::handleScanFinished ()
 	{
 		auto future = Watcher_->future ();
@@ -788,6 +832,17 @@ namespace LMP
 			}
 		}
 
+		ScanDone_ += ScanBatchSize_;
+
+		if (!ScanQueue_.isEmpty ())
+		{
+			ScanNextBatch ();
+
+			HandleNewArtists (Storage_->AddToCollection (newInfos));
+			HandleExistingInfos (existingInfos);
+			return;
+		}
+
 		emit scanFinished ();
 
 		auto newArts = Storage_->AddToCollection (newInfos);
@@ -34,6 +34,7 @@
 #include <QSet>
 #include <QFutureWatcher>
 #include <QIcon>
+#include <taglib/audioproperties.h>
 #include "interfaces/lmp/collectiontypes.h"
 #include "interfaces/lmp/ilocalcollection.h"
 #include "mediainfo.h"
@@ -85,6 +86,12 @@ namespace LMP
 		QFutureWatcher<MediaInfo> *Watcher_;
 		QList<QSet<QString>> NewPathsQueue_;
 
+		QStringList ScanQueue_;
+		int ScanBatchSize_ = 0;
+		int ScanDone_ = 0;
+		TagLib::AudioProperties::ReadStyle ScanReadStyle_ = TagLib::AudioProperties::Fast;
+		bool ForceRescanOnLoad_ = false;
+
 		int UpdateNewArtists_;
 		int UpdateNewAlbums_;
 		int UpdateNewTracks_;
@@ -122,7 +129,12 @@ namespace LMP
 
 		void Clear ();
 
-		void Scan (const QString&, bool root = true);
+		/** Scans the given path for the tracks to add or update.
+		 *
+		 * Only the files whose mtime has changed since the previous
+		 * scan are read unless force is true.
+		 */
+		void Scan (const QString&, bool root = true, bool force = false);
 		void Unscan (const QString&);
 		void Rescan ();
 
@@ -160,15 +172,16 @@ namespace LMP
 		void AddRootPaths (QStringList);
 		void RemoveRootPaths (const QStringList&);
 
-		void CheckRemovedFiles (const QSet<QString>& scanned, const QString& root);
-
 		void InitiateScan (const QSet<QString>&);
+		void ScanNextBatch ();
 	public slots:
 		void recordPlayedTrack (const QString&);
 	private slots:
 		void rescanOnLoad ();
+		void handleAccurateTagScanChanged ();
 		void handleLoadFinished ();
 		void handleIterateFinished ();
+		void handleScanProgress (int);
 		void handleScanFinished ();
 		void saveRootPaths ();
 	signals:
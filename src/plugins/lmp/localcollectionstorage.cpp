@@ -231,24 +231,6 @@ namespace LMP
 		PresentArtists_ = result.PresentArtists_;
 	}
 
-	QStringList LocalCollectionStorage::GetTracksPaths ()
-	{
-		if (!GetAllTracks_.exec ())
-		{
-			Util::DBLock::DumpError (GetAllTracks_);
-			throw std::runtime_error ("cannot get all tracks");
-		}
-
-		QStringList result;
-		result.reserve (GetAllTracks_.size ());
-		while (GetAllTracks_.next ())
-			result << GetAllTracks_.value (1).toString ();
-
-		GetAllTracks_.finish ();
-
-		return result;
-	}
-
 	void LocalCollectionStorage::RemoveTrack (int id)
 	{
 		RemoveTrack_.bindValue (":track_id", id);
@@ -357,19 +339,20 @@ namespace LMP
 		}
 	}
 
-	QDateTime LocalCollectionStorage::GetMTime (const QString& filepath)
+	QHash<QString, QDateTime> LocalCollectionStorage::GetMTimes ()
 	{
-		GetFileMTime_.bindValue (":filepath", filepath);
-		if (!GetFileMTime_.exec ())
+		if (!GetAllMTimes_.exec ())
 		{
-			Util::DBLock::DumpError (GetFileMTime_);
-			throw std::runtime_error ("cannot get file mtime");
+			Util::DBLock::DumpError (GetAllMTimes_);
+			throw std::runtime_error ("cannot get tracks mtimes");
 		}
 
-		const auto& result = GetFileMTime_.next () ?
-				GetFileMTime_.value (0).toDateTime () :
-				QDateTime ();
-		GetFileMTime_.finish ();
+		QHash<QString, QDateTime> result;
+		while (GetAllMTimes_.next ())
+			result [GetAllMTimes_.value (0).toString ()] = GetAllMTimes_.value (1).toDateTime ();
+
+		GetAllMTimes_.finish ();
+
 		return result;
 	}
 
@@ -384,6 +367,20 @@ namespace LMP
 		}
 	}
 
+	void LocalCollectionStorage::SetMTimes (const QHash<QString, QDateTime>& mtimes)
+	{
+		if (mtimes.isEmpty ())
+			return;
+
+		Util::DBLock lock (DB_);
+		lock.Init ();
+
+		for (auto i = mtimes.begin (), end = mtimes.end (); i != end; ++i)
+			SetMTime (i.key (), i.value ());
+
+		lock.Good ();
+	}
+
 	const int LovedStateID = 1;
 	const int BannedStateID = 2;
 
@@ -702,8 +699,8 @@ namespace LMP
 		GetAlbums_ = QSqlQuery (DB_);
 		GetAlbums_.prepare ("SELECT Id, Name, Year, CoverPath FROM albums;");
 
-		GetAllTracks_ = QSqlQuery (DB_);
-		GetAllTracks_.prepare ("SELECT Id, Path FROM tracks;");
+		GetAllMTimes_ = QSqlQuery (DB_);
+		GetAllMTimes_.prepare ("SELECT tracks.Path, fileTimes.MTime FROM tracks LEFT OUTER JOIN fileTimes ON tracks.Id = fileTimes.TrackID;");
 
 		AddArtist_ = QSqlQuery (DB_);
 		AddArtist_.prepare ("INSERT INTO artists (Name) VALUES (:name);");
@@ -752,9 +749,6 @@ namespace LMP
 		GetFileIdMTime_ = QSqlQuery (DB_);
 		GetFileIdMTime_.prepare ("SELECT MTime FROM fileTimes WHERE fileTimes.TrackID = :track_id;");
 
-		GetFileMTime_ = QSqlQuery (DB_);
-		GetFileMTime_.prepare ("SELECT MTime FROM fileTimes, tracks WHERE tracks.Path = :filepath AND tracks.Id = fileTimes.TrackID;");
-
 		SetFileMTime_ = QSqlQuery (DB_);
 		SetFileMTime_.prepare ("INSERT OR REPLACE INTO fileTimes (TrackID, MTime) VALUES ((SELECT Id FROM tracks WHERE Path = :filepath), :mtime);");
 
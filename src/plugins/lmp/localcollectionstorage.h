@@ -53,7 +53,7 @@ namespace LMP
 
 		QSqlQuery GetArtists_;
 		QSqlQuery GetAlbums_;
-		QSqlQuery GetAllTracks_;
+		QSqlQuery GetAllMTimes_;
 
 		QSqlQuery AddArtist_;
 		QSqlQuery AddAlbum_;
@@ -72,7 +72,6 @@ namespace LMP
 		QSqlQuery UpdateTrackStats_;
 
 		QSqlQuery GetFileIdMTime_;
-		QSqlQuery GetFileMTime_;
 		QSqlQuery SetFileMTime_;
 
 		// 1 is loved, 2 is banned
@@ -102,8 +101,6 @@ namespace LMP
 		LoadResult Load ();
 		void Load (const LoadResult&);
 
-		QStringList GetTracksPaths ();
-
 		void RemoveTrack (int);
 		void RemoveAlbum (int);
 		void RemoveArtist (int);
@@ -114,8 +111,13 @@ namespace LMP
 		void SetTrackStats (const Collection::TrackStats&);
 		void RecordTrackPlayed (int);
 
-		QDateTime GetMTime (const QString&);
+		/** Returns the paths of all tracks in the collection mapped to
+		 * their recorded modification times, which are invalid for
+		 * tracks without one.
+		 */
+		QHash<QString, QDateTime> GetMTimes ();
 		void SetMTime (const QString&, const QDateTime&);
+		void SetMTimes (const QHash<QString, QDateTime>&);
 
 		void SetTrackLoved (int);
 		void SetTrackBanned (int);
@@ -59,10 +59,16 @@ namespace LMP
 
 	TagLib::FileRef LocalFileResolver::GetFileRef (const QString& file) const
 	{
+		return GetFileRef (file, TagLib::AudioProperties::Accurate);
+	}
+
+	TagLib::FileRef LocalFileResolver::GetFileRef (const QString& file,
+			TagLib::AudioProperties::ReadStyle style) const
+	{
 #ifdef Q_OS_WIN32
-		return TagLib::FileRef (reinterpret_cast<const wchar_t*> (file.utf16 ()));
+		return TagLib::FileRef (reinterpret_cast<const wchar_t*> (file.utf16 ()), true, style);
 #else
-		return TagLib::FileRef (file.toUtf8 ().constData (), true, TagLib::AudioProperties::Accurate);
+		return TagLib::FileRef (file.toUtf8 ().constData (), true, style);
 #endif
 	}
 
@@ -79,9 +85,22 @@ namespace LMP
 			}
 		}
 
-		QMutexLocker tlLocker (&TaglibMutex_);
+		const auto& info = ReadInfo (file, TagLib::AudioProperties::Accurate);
+		{
+			QWriteLocker locker (&CacheLock_);
+			if (Cache_.size () > 200)
+				Cache_.clear ();
+			Cache_ [file] = qMakePair (modified, info);
+		}
+		return info;
+	}
+
+	MediaInfo LocalFileResolver::ReadInfo (const QString& file,
+			TagLib::AudioProperties::ReadStyle style) const
+	{
+		QReadLocker locker (&TaglibLock_);
 
-		auto r = GetFileRef (file);
+		auto r = GetFileRef (file, style);
 		auto tag = r.tag ();
 		if (!tag)
 			throw ResolveError (file, "failed to get file tags");
@@ -104,18 +123,12 @@ namespace LMP
 			static_cast<qint32> (tag->year ()),
 			static_cast<qint32> (tag->track ())
 		};
-		{
-			QWriteLocker locker (&CacheLock_);
-			if (Cache_.size () > 200)
-				Cache_.clear ();
-			Cache_ [file] = qMakePair (modified, info);
-		}
 		return info;
 	}
 
-	QMutex& LocalFileResolver::GetMutex ()
+	QReadWriteLock& LocalFileResolver::GetTagLock ()
 	{
-		return TaglibMutex_;
+		return TaglibLock_;
 	}
 }
 }
@@ -33,7 +33,6 @@
 #include <QObject>
 #include <QHash>
 #include <QReadWriteLock>
-#include <QMutex>
 #include <QDateTime>
 #include <taglib/fileref.h>
 #include "interfaces/lmp/itagresolver.h"
@@ -59,15 +58,35 @@ namespace LMP
 		Q_OBJECT
 		Q_INTERFACES (LeechCraft::LMP::ITagResolver)
 
-		QMutex TaglibMutex_;
+		QReadWriteLock TaglibLock_;
 		QReadWriteLock CacheLock_;
 		QHash<QString, QPair<QDateTime, MediaInfo>> Cache_;
 	public:
 		LocalFileResolver (QObject* = 0);
 
 		TagLib::FileRef GetFileRef (const QString&) const;
+		TagLib::FileRef GetFileRef (const QString&, TagLib::AudioProperties::ReadStyle) const;
+
 		MediaInfo ResolveInfo (const QString&);
-		QMutex& GetMutex ();
+
+		/** Reads the tags of the given file bypassing the cache.
+		 *
+		 * TagLib is safe to use concurrently as long as each thread has
+		 * its own FileRef, so this method only takes the tag lock for
+		 * reading and is intended to be called from many worker threads
+		 * at once, as collection scans do.
+		 *
+		 * @throws ResolveError if the file has no readable tags.
+		 */
+		MediaInfo ReadInfo (const QString&, TagLib::AudioProperties::ReadStyle) const;
+
+		/** Returns the lock guarding tags against concurrent writes.
+		 *
+		 * Code reading the tags should lock it for reading, so that any
+		 * number of readers may proceed at once, while code modifying
+		 * the tags should lock it for writing.
+		 */
+		QReadWriteLock& GetTagLock ();
 	};
 }
 }
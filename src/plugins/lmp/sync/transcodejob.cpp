@@ -33,6 +33,7 @@
 #include <QMap>
 #include <QDir>
 #include <QUuid>
+#include <QWriteLocker>
 #include <QtDebug>
 #include <taglib/tag.h>
 #include "transcodingparams.h"
@@ -140,7 +141,7 @@ namespace LMP
 		{
 			const auto resolver = Core::Instance ().GetLocalFileResolver ();
 
-			QMutexLocker locker (&resolver->GetMutex ());
+			QWriteLocker locker (&resolver->GetTagLock ());
 
 			auto fromRef = resolver->GetFileRef (from);
 			auto toRef = resolver->GetFileRef (to);
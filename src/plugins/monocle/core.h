@@ -44,6 +44,7 @@ namespace Monocle
 {
 	class RecentlyOpenedManager;
 	class PixmapCacheManager;
+	class RenderScheduler;
 	class DefaultBackendManager;
 	class DocStateManager;
 	class BookmarksManager;
@@ -57,6 +58,7 @@ namespace Monocle
 		QList<QObject*> Backends_;
 
 		PixmapCacheManager *CacheManager_;
+		RenderScheduler *RenderScheduler_;
 		RecentlyOpenedManager *ROManager_;
 		DefaultBackendManager *DefaultBackendManager_;
 		DocStateManager *DocStateManager_;
@@ -78,6 +80,7 @@ namespace Monocle
 		CoreLoadProxy* LoadDocument (const QString&);
 
 		PixmapCacheManager* GetPixmapCacheManager () const;
+		RenderScheduler* GetRenderScheduler () const;
 		RecentlyOpenedManager* GetROManager () const;
 		DefaultBackendManager* GetDefaultBackendManager () const;
 		DocStateManager* GetDocStateManager () const;
@@ -0,0 +1,83 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QImage>
+
+class QRect;
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	/** @brief Interface for documents that can render parts of a page.
+	 *
+	 * This interface should be implemented by IDocument objects that can
+	 * render a rectangular part of a page considerably faster than
+	 * rendering the whole page with IDocument::RenderPage() and cropping
+	 * the result.
+	 *
+	 * Monocle uses this interface to split large pages into tiles, and
+	 * only renders the tiles that are (or are about to become) visible.
+	 *
+	 * If the backend is threaded (see IBackendPlugin::IsThreaded()), the
+	 * RenderPageRect() method may be called for different rects of the
+	 * same page concurrently from several threads.
+	 *
+	 * @sa IDocument
+	 */
+	class ISupportRectRendering
+	{
+	public:
+		virtual ~ISupportRectRendering () {}
+
+		/** @brief Renders the given \em rect of the given \em page.
+		 *
+		 * The \em rect is given in the coordinates of the page rendered
+		 * at the given \em xScale and \em yScale. That is, the result
+		 * should be equal to the following:
+		 * \code
+			RenderPage (page, xScale, yScale).copy (rect);\endcode
+		 *
+		 * @param[in] page The index of the page to render.
+		 * @param[in] xScale The scale of the <em>x</em> axis.
+		 * @param[in] yScale The scale of the <em>y</em> axis.
+		 * @param[in] rect The part of the scaled page to render.
+		 * @return The rendering of the given part of the page.
+		 *
+		 * @sa IDocument::RenderPage()
+		 */
+		virtual QImage RenderPageRect (int page, double xScale, double yScale, const QRect& rect) = 0;
+	};
+}
+}
+
+Q_DECLARE_INTERFACE (LeechCraft::Monocle::ISupportRectRendering,
+		"org.LeechCraft.Monocle.ISupportRectRendering/1.0");
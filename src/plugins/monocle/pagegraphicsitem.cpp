@@ -28,11 +28,12 @@
  **********************************************************************/
 
 #include "pagegraphicsitem.h"
+#include <algorithm>
 #include <limits>
 #include <cmath>
 #include <QtDebug>
-#include <QtConcurrentRun>
-#include <QFutureWatcher>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
 #include <QGraphicsSceneMouseEvent>
 #include <QCursor>
 #include <QApplication>
@@ -40,6 +41,7 @@
 #include <QGraphicsView>
 #include <QMenu>
 #include <QWidgetAction>
+#include "interfaces/monocle/isupportrectrendering.h"
 #include "core.h"
 #include "pixmapcachemanager.h"
 #include "arbitraryrotationwidget.h"
@@ -49,26 +51,32 @@ namespace LeechCraft
 {
 namespace Monocle
 {
+	namespace
+	{
+		const int TileSize = 512;
+		const int PreviewSize = 256;
+
+		// About 48 MiB of 32-bit tiles.
+		const int MaxTilesPerPage = 48;
+	}
+
 	PageGraphicsItem::PageGraphicsItem (IDocument_ptr doc, int page, QGraphicsItem *parent)
-	: QGraphicsPixmapItem (parent)
+	: QGraphicsItem (parent)
 	, Doc_ (doc)
 	, PageNum_ (page)
+	, SupportsRectRendering_ (qobject_cast<ISupportRectRendering*> (doc->GetQObject ()))
 	, XScale_ (1)
 	, YScale_ (1)
-	, Invalid_ (true)
 	, LayoutManager_ (0)
 	{
-		setTransformationMode (Qt::SmoothTransformation);
-		setPixmap (QPixmap (Doc_->GetPageSize (page)));
+		setFlag (ItemUsesExtendedStyleOption);
 		setAcceptHoverEvents (true);
 	}
 
 	PageGraphicsItem::~PageGraphicsItem ()
 	{
 		Core::Instance ().GetPixmapCacheManager ()->PixmapDeleted (this);
-
-		if (RenderFuture_)
-			RenderFuture_->waitForFinished ();
+		Core::Instance ().GetRenderScheduler ()->Cancel (this);
 	}
 
 	void PageGraphicsItem::SetLayoutManager (PagesLayoutManager *manager)
@@ -87,18 +95,20 @@ namespace Monocle
 			std::abs (ys - YScale_) < std::numeric_limits<double>::epsilon ())
 			return;
 
+		prepareGeometryChange ();
+
 		XScale_ = xs;
 		YScale_ = ys;
 
-		auto size = Doc_->GetPageSize (PageNum_);
-		size.rwidth () *= xs;
-		size.rheight () *= ys;
-		setPixmap (QPixmap (size));
-
-		Invalid_ = true;
+		// The preview is kept and stretched until the tiles for the new
+		// scale are rendered.
+		if (!Tiles_.isEmpty ())
+		{
+			Tiles_.clear ();
+			Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+		}
 
-		if (IsDisplayed ())
-			update ();
+		Invalidate ();
 
 		for (auto i = Item2RectInfo_.begin (); i != Item2RectInfo_.end (); ++i)
 		{
@@ -148,50 +158,63 @@ namespace Monocle
 
 	void PageGraphicsItem::ClearPixmap ()
 	{
-		auto size = Doc_->GetPageSize (PageNum_);
-		size.rwidth () *= XScale_;
-		size.rheight () *= YScale_;
-		setPixmap (QPixmap (size));
-
-		Invalid_ = true;
+		Tiles_.clear ();
+		Preview_ = QPixmap ();
 	}
 
 	void PageGraphicsItem::UpdatePixmap ()
 	{
-		Invalid_ = true;
-		if (IsDisplayed ())
-			update ();
+		// Outdated tiles and preview are still painted until they are
+		// replaced to avoid flicker.
+		++ContentGeneration_;
+		PreviewOutdated_ = true;
+
+		Invalidate ();
+	}
+
+	QList<QPixmap> PageGraphicsItem::GetPixmaps () const
+	{
+		QList<QPixmap> result;
+		if (!Preview_.isNull ())
+			result << Preview_;
+		for (const auto& tile : Tiles_)
+			result << tile.Pixmap_;
+		return result;
+	}
+
+	QRectF PageGraphicsItem::boundingRect () const
+	{
+		return { { 0, 0 }, GetScaledSize () };
 	}
 
 	void PageGraphicsItem::paint (QPainter *painter,
-			const QStyleOptionGraphicsItem *option, QWidget *w)
+			const QStyleOptionGraphicsItem *option, QWidget*)
 	{
-		if (Invalid_ && IsDisplayed ())
+		const auto& bounding = boundingRect ();
+		const auto& exposed = option->exposedRect.intersected (bounding);
+
+		painter->fillRect (exposed, Qt::white);
+
+		if (!Preview_.isNull ())
 		{
-			auto backendObj = Doc_->GetBackendPlugin ();
-			if (qobject_cast<IBackendPlugin*> (backendObj)->IsThreaded ())
-			{
-				if (!RenderFuture_)
-					RequestThreadedRender ();
-
-				auto size = Doc_->GetPageSize (PageNum_);
-				size.rwidth () *= XScale_;
-				size.rheight () *= YScale_;
-				QPixmap px (size);
-				px.fill ();
-				setPixmap (px);
-			}
-			else
-			{
-				const auto& img = Doc_->RenderPage (PageNum_, XScale_, YScale_);
-				setPixmap (QPixmap::fromImage (img));
-			}
-			Invalid_ = false;
+			painter->save ();
+			painter->setRenderHint (QPainter::SmoothPixmapTransform);
+			painter->drawPixmap (bounding, Preview_, Preview_.rect ());
+			painter->restore ();
+		}
 
-			Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+		for (const auto& idx : GetTiles (exposed))
+		{
+			const auto pos = Tiles_.find (idx);
+			if (pos != Tiles_.end ())
+				painter->drawPixmap (GetTileRect (idx).topLeft (), pos->Pixmap_);
 		}
 
-		QGraphicsPixmapItem::paint (painter, option, w);
+		RequestPreview ();
+		RequestTiles (GetViewRect (false), RenderPriority::Visible);
+		RequestTiles (GetViewRect (true), RenderPriority::Prefetch);
+		PrefetchNeighbours ();
+
 		Core::Instance ().GetPixmapCacheManager ()->PixmapPainted (this);
 	}
 
@@ -244,93 +267,258 @@ namespace Monocle
 		rotateMenu.exec (event->screenPos ());
 	}
 
-	void PageGraphicsItem::RequestThreadedRender ()
+	QSize PageGraphicsItem::GetScaledSize () const
 	{
-		RenderFuture_.reset (new QFutureWatcher<RenderInfo>,
-				[this] (QFutureWatcher<RenderInfo> *watcher)
-				{
-					disconnect (watcher, 0, this, 0);
-					watcher->deleteLater ();
-				});
-		connect (RenderFuture_.get (),
-				SIGNAL (finished ()),
-				this,
-				SLOT (handlePixmapRendered ()));
+		auto size = Doc_->GetPageSize (PageNum_);
+		size.rwidth () *= XScale_;
+		size.rheight () *= YScale_;
+		return size;
+	}
 
-		// C++14
-		auto xscale = XScale_;
-		auto yscale = YScale_;
-		RenderFuture_->setFuture (QtConcurrent::run ([this, xscale, yscale]
-				{
-					return RenderInfo
-					{
-						Doc_->RenderPage (PageNum_, yscale, yscale),
-						xscale,
-						yscale
-					};
-				}));
+	QRect PageGraphicsItem::GetTileRect (const TileIndex_t& idx) const
+	{
+		const QRect pageRect { { 0, 0 }, GetScaledSize () };
+		if (!SupportsRectRendering_)
+			return pageRect;
+
+		return QRect { idx.first * TileSize, idx.second * TileSize, TileSize, TileSize }
+				.intersected (pageRect);
 	}
 
-	bool PageGraphicsItem::IsDisplayed () const
+	auto PageGraphicsItem::GetTiles (const QRectF& rect) const -> QList<TileIndex_t>
 	{
-		const auto& thisMapped = mapToScene (boundingRect ()).boundingRect ();
+		const auto& area = rect.intersected (boundingRect ());
+		if (area.isEmpty ())
+			return {};
+
+		if (!SupportsRectRendering_)
+			return { { 0, 0 } };
+
+		const int left = area.left () / TileSize;
+		const int top = area.top () / TileSize;
+		const int right = std::max<int> (std::ceil (area.right () / TileSize) - 1, left);
+		const int bottom = std::max<int> (std::ceil (area.bottom () / TileSize) - 1, top);
+
+		QList<TileIndex_t> result;
+		for (int y = top; y <= bottom; ++y)
+			for (int x = left; x <= right; ++x)
+				result.append ({ x, y });
+		return result;
+	}
+
+	QRectF PageGraphicsItem::GetViewRect (bool withPrefetch) const
+	{
+		QRectF result;
+		if (!scene ())
+			return result;
 
 		for (auto view : scene ()->views ())
 		{
 			const auto& rect = view->viewport ()->rect ();
-			const auto& mapped = view->mapToScene (rect).boundingRect ();
+			auto mapped = view->mapToScene (rect).boundingRect ();
+			if (withPrefetch)
+				mapped.adjust (-TileSize, -mapped.height (), TileSize, mapped.height ());
 
-			if (mapped.intersects (thisMapped))
-				return true;
+			result |= mapFromScene (mapped).boundingRect ();
 		}
 
-		return false;
+		return result.intersected (boundingRect ());
 	}
 
-	void PageGraphicsItem::rotateCCW ()
+	void PageGraphicsItem::RequestTiles (const QRectF& rect, RenderPriority priority)
 	{
-		LayoutManager_->AddRotation (-90, PageNum_);
+		const auto generation = Generation_;
+		for (const auto& idx : GetTiles (rect))
+		{
+			if (PendingTiles_.contains (idx))
+				continue;
+
+			const auto pos = Tiles_.find (idx);
+			if (pos != Tiles_.end () && pos->Generation_ == generation)
+				continue;
+
+			PendingTiles_ << idx;
+
+			const auto& tileRect = GetTileRect (idx);
+			const RenderJob job
+			{
+				Doc_,
+				PageNum_,
+				XScale_,
+				YScale_,
+				SupportsRectRendering_ ? tileRect : QRect {},
+				priority,
+				this,
+				[this, tileRect, generation]
+				{
+					return generation == Generation_ &&
+							GetViewRect (true).intersects (tileRect);
+				},
+				[this, idx, generation] (const QImage& image)
+					{ HandleTileRendered (idx, generation, image); }
+			};
+			Core::Instance ().GetRenderScheduler ()->Schedule (job);
+		}
 	}
 
-	void PageGraphicsItem::rotateCW ()
+	void PageGraphicsItem::RequestPreview ()
 	{
-		LayoutManager_->AddRotation (90, PageNum_);
+		if (PreviewPending_ || (!Preview_.isNull () && !PreviewOutdated_))
+			return;
+
+		const auto& pageSize = Doc_->GetPageSize (PageNum_);
+		const auto maxDim = std::max (pageSize.width (), pageSize.height ());
+		if (maxDim <= 0)
+			return;
+
+		// Small pages are rendered quickly enough on their own.
+		const auto scale = static_cast<double> (PreviewSize) / maxDim;
+		if (scale * 2 > std::min (XScale_, YScale_))
+			return;
+
+		PreviewPending_ = true;
+
+		const auto generation = ContentGeneration_;
+		const RenderJob job
+		{
+			Doc_,
+			PageNum_,
+			scale,
+			scale,
+			{},
+			RenderPriority::Preview,
+			this,
+			[this, generation]
+			{
+				return generation == ContentGeneration_ &&
+						!GetViewRect (true).isEmpty ();
+			},
+			[this, generation] (const QImage& image)
+				{ HandlePreviewRendered (generation, image); }
+		};
+		Core::Instance ().GetRenderScheduler ()->Schedule (job);
 	}
 
-	void PageGraphicsItem::requestRotation (double rotation)
+	void PageGraphicsItem::Prefetch ()
 	{
-		LayoutManager_->SetRotation (rotation, PageNum_);
+		RequestPreview ();
+		RequestTiles (GetViewRect (true), RenderPriority::Prefetch);
 	}
 
-	void PageGraphicsItem::updateRotation (double rotation, int page)
+	void PageGraphicsItem::PrefetchNeighbours ()
 	{
-		if (page != PageNum_)
+		if (!LayoutManager_)
 			return;
 
-		if (!ArbWidget_)
+		const auto& pages = LayoutManager_->GetPages ();
+		for (auto num : { PageNum_ - 1, PageNum_ + 1 })
+			if (const auto page = pages.value (num))
+				page->Prefetch ();
+	}
+
+	void PageGraphicsItem::HandleTileRendered (const TileIndex_t& idx,
+			quint64 generation, const QImage& image)
+	{
+		if (generation != Generation_)
 			return;
 
-		ArbWidget_->setValue (rotation + LayoutManager_->GetRotation ());
+		PendingTiles_.remove (idx);
+		if (image.isNull ())
+			return;
+
+		Tiles_ [idx] = { QPixmap::fromImage (image), generation };
+		update (GetTileRect (idx));
+
+		EvictTiles ();
+
+		Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
 	}
 
-	void PageGraphicsItem::handlePixmapRendered ()
+	void PageGraphicsItem::HandlePreviewRendered (quint64 generation, const QImage& image)
 	{
-		if (sender () != RenderFuture_.get ())
+		if (generation != ContentGeneration_)
 			return;
 
-		const auto& result = RenderFuture_->result ();
-		RenderFuture_.reset ();
+		PreviewPending_ = false;
+		if (image.isNull ())
+			return;
 
-		setPixmap (QPixmap::fromImage (result.Result_));
+		Preview_ = QPixmap::fromImage (image);
+		PreviewOutdated_ = false;
+		update ();
 
-		if (std::abs (result.XScale_ - XScale_) > std::numeric_limits<double>::epsilon () * XScale_ ||
-			std::abs (result.YScale_ - YScale_) > std::numeric_limits<double>::epsilon () * YScale_)
-		{
-			UpdatePixmap ();
+		Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+	}
+
+	void PageGraphicsItem::EvictTiles ()
+	{
+		if (Tiles_.size () <= MaxTilesPerPage)
 			return;
+
+		const auto& viewRect = GetViewRect (false);
+		const auto& center = viewRect.isEmpty () ?
+				boundingRect ().center () :
+				viewRect.center ();
+		const auto& prefetchRect = GetViewRect (true);
+
+		QList<QPair<qreal, TileIndex_t>> candidates;
+		for (auto i = Tiles_.begin (); i != Tiles_.end (); ++i)
+		{
+			const auto& tileRect = GetTileRect (i.key ());
+			if (prefetchRect.intersects (tileRect))
+				continue;
+
+			const auto& diff = QRectF { tileRect }.center () - center;
+			candidates.append ({ diff.x () * diff.x () + diff.y () * diff.y (), i.key () });
 		}
 
-		Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+		std::sort (candidates.begin (), candidates.end (),
+				[] (const QPair<qreal, TileIndex_t>& l, const QPair<qreal, TileIndex_t>& r)
+					{ return l.first > r.first; });
+
+		for (const auto& candidate : candidates)
+		{
+			if (Tiles_.size () <= MaxTilesPerPage)
+				break;
+
+			Tiles_.remove (candidate.second);
+		}
+	}
+
+	void PageGraphicsItem::Invalidate ()
+	{
+		++Generation_;
+		PendingTiles_.clear ();
+		PreviewPending_ = false;
+		Core::Instance ().GetRenderScheduler ()->Cancel (this);
+
+		update ();
+	}
+
+	void PageGraphicsItem::rotateCCW ()
+	{
+		LayoutManager_->AddRotation (-90, PageNum_);
+	}
+
+	void PageGraphicsItem::rotateCW ()
+	{
+		LayoutManager_->AddRotation (90, PageNum_);
+	}
+
+	void PageGraphicsItem::requestRotation (double rotation)
+	{
+		LayoutManager_->SetRotation (rotation, PageNum_);
+	}
+
+	void PageGraphicsItem::updateRotation (double rotation, int page)
+	{
+		if (page != PageNum_)
+			return;
+
+		if (!ArbWidget_)
+			return;
+
+		ArbWidget_->setValue (rotation + LayoutManager_->GetRotation ());
 	}
 }
 }
@@ -31,12 +31,13 @@
 
 #include <functional>
 #include <memory>
-#include <QGraphicsPixmapItem>
+#include <QGraphicsItem>
 #include <QPointer>
+#include <QPixmap>
+#include <QHash>
+#include <QSet>
 #include "interfaces/monocle/idocument.h"
-
-template<typename T>
-class QFutureWatcher;
+#include "renderscheduler.h"
 
 namespace LeechCraft
 {
@@ -46,31 +47,44 @@ namespace Monocle
 	class ArbitraryRotationWidget;
 
 	class PageGraphicsItem : public QObject
-						   , public QGraphicsPixmapItem
+						   , public QGraphicsItem
 	{
 		Q_OBJECT
 
 		IDocument_ptr Doc_;
 		const int PageNum_;
+		const bool SupportsRectRendering_;
 
 		double XScale_;
 		double YScale_;
 
-		bool Invalid_;
-
 		std::function<void (int, QPointF)> ReleaseHandler_;
 
 		PagesLayoutManager *LayoutManager_;
 
 		QPointer<ArbitraryRotationWidget> ArbWidget_;
 
-		struct RenderInfo
+		/** Bumped whenever the rendered tiles become outdated, that is,
+		 * on scale change and on page contents change.
+		 */
+		quint64 Generation_ = 0;
+		/** Bumped on page contents change only, since the preview
+		 * doesn't depend on the scale.
+		 */
+		quint64 ContentGeneration_ = 0;
+
+		typedef QPair<int, int> TileIndex_t;
+		struct Tile
 		{
-			QImage Result_;
-			double XScale_;
-			double YScale_;
+			QPixmap Pixmap_;
+			quint64 Generation_;
 		};
-		std::shared_ptr<QFutureWatcher<RenderInfo>> RenderFuture_;
+		QHash<TileIndex_t, Tile> Tiles_;
+		QSet<TileIndex_t> PendingTiles_;
+
+		QPixmap Preview_;
+		bool PreviewOutdated_ = false;
+		bool PreviewPending_ = false;
 	public:
 		typedef std::function<void (QRectF)> RectSetter_f;
 	private:
@@ -99,22 +113,43 @@ namespace Monocle
 
 		void ClearPixmap ();
 		void UpdatePixmap ();
+
+		QList<QPixmap> GetPixmaps () const;
+
+		QRectF boundingRect () const;
 	protected:
 		void paint (QPainter*, const QStyleOptionGraphicsItem*, QWidget*);
 		void mousePressEvent (QGraphicsSceneMouseEvent*);
 		void mouseReleaseEvent (QGraphicsSceneMouseEvent*);
 		void contextMenuEvent (QGraphicsSceneContextMenuEvent*);
 	private:
-		void RequestThreadedRender ();
-		bool IsDisplayed () const;
+		QSize GetScaledSize () const;
+
+		QRect GetTileRect (const TileIndex_t&) const;
+		QList<TileIndex_t> GetTiles (const QRectF&) const;
+		QRectF GetViewRect (bool withPrefetch) const;
+
+		void RequestTiles (const QRectF&, RenderPriority);
+		void RequestPreview ();
+		void Prefetch ();
+		void PrefetchNeighbours ();
+
+		void HandleTileRendered (const TileIndex_t&, quint64, const QImage&);
+		void HandlePreviewRendered (quint64, const QImage&);
+
+		/** Drops the tiles furthest from the viewport so that no more
+		 * than MaxTilesPerPage are kept, unless more are needed to
+		 * cover the prefetched area.
+		 */
+		void EvictTiles ();
+
+		void Invalidate ();
 	private slots:
 		void rotateCCW ();
 		void rotateCW ();
 		void requestRotation (double);
 
 		void updateRotation (double, int);
-
-		void handlePixmapRendered ();
 	signals:
 		void rotateRequested (double);
 	};
@@ -53,6 +53,14 @@ namespace Monocle
 		{
 			return px.width () * px.height () * px.defaultDepth () / 8 * 1.5;
 		}
+
+		quint64 GetPixmapSize (const PageGraphicsItem *item)
+		{
+			quint64 result = 0;
+			for (const auto& px : item->GetPixmaps ())
+				result += GetPixmapSize (px);
+			return result;
+		}
 	}
 
 	void PixmapCacheManager::PixmapPainted (PageGraphicsItem *item)
@@ -66,16 +74,16 @@ namespace Monocle
 		if (RecentlyUsed_.removeAll (item))
 			CurrentSize_ = std::accumulate (RecentlyUsed_.begin (), RecentlyUsed_.end (), 0,
 					[] (qint64 size, decltype (RecentlyUsed_.front ()) item)
-						{ return size + GetPixmapSize (item->pixmap ()); });
+						{ return size + GetPixmapSize (item); });
 
 		RecentlyUsed_ << item;
-		CurrentSize_ += GetPixmapSize (item->pixmap ());
+		CurrentSize_ += GetPixmapSize (item);
 		CheckCache ();
 	}
 
 	void PixmapCacheManager::PixmapDeleted (PageGraphicsItem *item)
 	{
-		CurrentSize_ -= GetPixmapSize (item->pixmap ());
+		CurrentSize_ -= GetPixmapSize (item);
 		RecentlyUsed_.removeAll (item);
 	}
 
@@ -84,7 +92,7 @@ namespace Monocle
 		while (MaxSize_ < CurrentSize_ && RecentlyUsed_.size () > 2)
 		{
 			auto page = RecentlyUsed_.takeFirst ();
-			const quint64 pxSize = GetPixmapSize (page->pixmap ());
+			const quint64 pxSize = GetPixmapSize (page);
 			CurrentSize_ -= pxSize;
 			page->ClearPixmap ();
 		}
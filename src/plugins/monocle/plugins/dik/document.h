@@ -48,7 +48,8 @@ namespace Dik
 		Q_OBJECT
 		Q_INTERFACES (LeechCraft::Monocle::IDocument
 				LeechCraft::Monocle::ISearchableDocument
-				LeechCraft::Monocle::ISupportPainting)
+				LeechCraft::Monocle::ISupportPainting
+				LeechCraft::Monocle::ISupportRectRendering)
 
 		DocumentInfo Info_;
 		QUrl DocURL_;
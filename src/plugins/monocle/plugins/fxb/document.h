@@ -48,7 +48,8 @@ namespace FXB
 		Q_INTERFACES (LeechCraft::Monocle::IDocument
 				LeechCraft::Monocle::IHaveTOC
 				LeechCraft::Monocle::ISearchableDocument
-				LeechCraft::Monocle::ISupportPainting)
+				LeechCraft::Monocle::ISupportPainting
+				LeechCraft::Monocle::ISupportRectRendering)
 
 		DocumentInfo Info_;
 		TOCEntryLevel_t TOC_;
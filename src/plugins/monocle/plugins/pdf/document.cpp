@@ -236,6 +236,16 @@ namespace PDF
 		page->renderToPainter (painter, 72 * xScale, 72 * yScale);
 	}
 
+	QImage Document::RenderPageRect (int num, double xScale, double yScale, const QRect& rect)
+	{
+		std::unique_ptr<Poppler::Page> page (PDocument_->page (num));
+		if (!page)
+			return QImage ();
+
+		return page->renderToImage (72 * xScale, 72 * yScale,
+				rect.x (), rect.y (), rect.width (), rect.height ());
+	}
+
 	QMap<int, QList<QRectF>> Document::GetTextPositions (const QString& text, Qt::CaseSensitivity cs)
 	{
 		typedef QMap<int, QList<QRectF>> Result_t;
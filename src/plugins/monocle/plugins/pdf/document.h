@@ -41,6 +41,7 @@
 #include <interfaces/monocle/isearchabledocument.h>
 #include <interfaces/monocle/isaveabledocument.h>
 #include <interfaces/monocle/isupportpainting.h>
+#include <interfaces/monocle/isupportrectrendering.h>
 
 namespace Poppler
 {
@@ -63,6 +64,7 @@ namespace PDF
 				   , public ISupportAnnotations
 				   , public ISupportForms
 				   , public ISupportPainting
+				   , public ISupportRectRendering
 				   , public ISearchableDocument
 				   , public ISaveableDocument
 	{
@@ -74,6 +76,7 @@ namespace PDF
 				LeechCraft::Monocle::ISupportAnnotations
 				LeechCraft::Monocle::ISupportForms
 				LeechCraft::Monocle::ISupportPainting
+				LeechCraft::Monocle::ISupportRectRendering
 				LeechCraft::Monocle::ISearchableDocument
 				LeechCraft::Monocle::ISaveableDocument)
 
@@ -107,6 +110,8 @@ namespace PDF
 
 		void PaintPage (QPainter*, int, double, double);
 
+		QImage RenderPageRect (int, double, double, const QRect&);
+
 		QMap<int, QList<QRectF>> GetTextPositions (const QString&, Qt::CaseSensitivity);
 
 		SaveQueryResult CanSave () const;
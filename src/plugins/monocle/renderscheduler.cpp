@@ -0,0 +1,170 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "renderscheduler.h"
+#include <algorithm>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrentRun>
+#include <QFutureWatcher>
+#include <QtDebug>
+#include "interfaces/monocle/ibackendplugin.h"
+#include "interfaces/monocle/isupportrectrendering.h"
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	RenderScheduler::RenderScheduler (QObject *parent)
+	: QObject { parent }
+	, MaxRunning_ { std::max (QThread::idealThreadCount (), 1) }
+	{
+	}
+
+	void RenderScheduler::Schedule (const RenderJob& job)
+	{
+		const auto pos = std::upper_bound (Pending_.begin (), Pending_.end (), job,
+				[] (const RenderJob& left, const RenderJob& right)
+					{ return left.Priority_ < right.Priority_; });
+		Pending_.insert (pos, job);
+
+		ScheduleDispatch ();
+	}
+
+	void RenderScheduler::Cancel (QObject *owner)
+	{
+		const auto pos = std::remove_if (Pending_.begin (), Pending_.end (),
+				[owner] (const RenderJob& job) { return job.Owner_ == owner; });
+		Pending_.erase (pos, Pending_.end ());
+	}
+
+	void RenderScheduler::ScheduleDispatch ()
+	{
+		if (DispatchScheduled_)
+			return;
+
+		DispatchScheduled_ = true;
+		QTimer::singleShot (0,
+				this,
+				SLOT (dispatch ()));
+	}
+
+	namespace
+	{
+		QImage Render (const IDocument_ptr& doc, int page, double xScale, double yScale, const QRect& rect)
+		{
+			if (rect.isNull ())
+				return doc->RenderPage (page, xScale, yScale);
+
+			if (const auto irr = qobject_cast<ISupportRectRendering*> (doc->GetQObject ()))
+				return irr->RenderPageRect (page, xScale, yScale, rect);
+
+			return doc->RenderPage (page, xScale, yScale).copy (rect);
+		}
+
+		QImage Render (const RenderJob& job)
+		{
+			return Render (job.Doc_, job.Page_, job.XScale_, job.YScale_, job.Rect_);
+		}
+
+		bool IsThreaded (const IDocument_ptr& doc)
+		{
+			const auto backend = qobject_cast<IBackendPlugin*> (doc->GetBackendPlugin ());
+			return backend && backend->IsThreaded ();
+		}
+
+		bool IsWanted (const RenderJob& job)
+		{
+			return job.Owner_ && (!job.IsWanted_ || job.IsWanted_ ());
+		}
+	}
+
+	void RenderScheduler::StartThreaded (const RenderJob& job)
+	{
+		auto watcher = new QFutureWatcher<QImage> (this);
+		connect (watcher,
+				SIGNAL (finished ()),
+				this,
+				SLOT (handleRendered ()));
+		Running_ [watcher] = job;
+
+		const auto doc = job.Doc_;
+		const auto page = job.Page_;
+		const auto xScale = job.XScale_;
+		const auto yScale = job.YScale_;
+		const auto rect = job.Rect_;
+		watcher->setFuture (QtConcurrent::run ([doc, page, xScale, yScale, rect]
+					{ return Render (doc, page, xScale, yScale, rect); }));
+	}
+
+	void RenderScheduler::dispatch ()
+	{
+		DispatchScheduled_ = false;
+
+		while (!Pending_.isEmpty () && Running_.size () < MaxRunning_)
+		{
+			const auto job = Pending_.takeFirst ();
+			if (!IsWanted (job))
+			{
+				if (job.Owner_)
+					job.Handler_ ({});
+				continue;
+			}
+
+			if (IsThreaded (job.Doc_))
+			{
+				StartThreaded (job);
+				continue;
+			}
+
+			// Non-threaded backends render in this thread, one job per
+			// event loop iteration so that the UI stays responsive.
+			const auto& image = Render (job);
+			if (job.Owner_)
+				job.Handler_ (image);
+
+			if (!Pending_.isEmpty ())
+				ScheduleDispatch ();
+			return;
+		}
+	}
+
+	void RenderScheduler::handleRendered ()
+	{
+		const auto watcher = static_cast<QFutureWatcher<QImage>*> (sender ());
+		watcher->deleteLater ();
+
+		const auto job = Running_.take (watcher);
+		if (job.Owner_)
+			job.Handler_ (watcher->result ());
+
+		dispatch ();
+	}
+}
+}
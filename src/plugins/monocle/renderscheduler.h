@@ -0,0 +1,106 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QImage>
+#include "interfaces/monocle/idocument.h"
+
+template<typename T>
+class QFutureWatcher;
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	enum class RenderPriority
+	{
+		Preview,
+		Visible,
+		Prefetch
+	};
+
+	struct RenderJob
+	{
+		IDocument_ptr Doc_;
+		int Page_;
+		double XScale_;
+		double YScale_;
+
+		/** The part of the scaled page to render, or a null rect to
+		 * render the whole page.
+		 */
+		QRect Rect_;
+
+		RenderPriority Priority_;
+
+		/** Pending jobs are dropped once their owner is destroyed or
+		 * passed to RenderScheduler::Cancel().
+		 */
+		QPointer<QObject> Owner_;
+
+		/** Checked right before the job is started, so that the jobs
+		 * that are no longer interesting (say, scrolled out of view) are
+		 * dropped without being rendered. May be empty.
+		 */
+		std::function<bool ()> IsWanted_;
+
+		/** Called with the rendered image, or with a null image if the
+		 * job has been dropped as no longer wanted.
+		 */
+		std::function<void (QImage)> Handler_;
+	};
+
+	class RenderScheduler : public QObject
+	{
+		Q_OBJECT
+
+		QList<RenderJob> Pending_;
+		QHash<QFutureWatcher<QImage>*, RenderJob> Running_;
+		const int MaxRunning_;
+
+		bool DispatchScheduled_ = false;
+	public:
+		RenderScheduler (QObject* = 0);
+
+		void Schedule (const RenderJob&);
+		void Cancel (QObject*);
+	private:
+		void ScheduleDispatch ();
+		void StartThreaded (const RenderJob&);
+	private slots:
+		void dispatch ();
+		void handleRendered ();
+	};
+}
+}
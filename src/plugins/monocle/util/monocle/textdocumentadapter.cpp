@@ -63,23 +63,38 @@ namespace Monocle
 
 	QImage TextDocumentAdapter::RenderPage (int page, double xScale, double yScale)
 	{
-		const auto& size = Doc_->pageSize ();
-
-		auto imgSize = size.toSize ();
+		auto imgSize = Doc_->pageSize ().toSize ();
 		imgSize.rwidth () *= xScale;
 		imgSize.rheight () *= yScale;
-		QImage image (imgSize, QImage::Format_ARGB32);
+
+		return RenderPageRect (page, xScale, yScale, { { 0, 0 }, imgSize });
+	}
+
+	QImage TextDocumentAdapter::RenderPageRect (int page, double xScale, double yScale, const QRect& target)
+	{
+		const auto& size = Doc_->pageSize ();
+
+		QImage image (target.size (), QImage::Format_ARGB32);
 		image.fill (Qt::white);
 
 		QRectF rect (QPointF (0, 0), size);
 		rect.moveTop (rect.height () * page);
 
+		const QRectF clip
+		{
+			target.x () / xScale,
+			rect.top () + target.y () / yScale,
+			target.width () / xScale,
+			target.height () / yScale
+		};
+
 		QPainter painter;
 		painter.begin (&image);
 		painter.setRenderHints (Hints_);
+		painter.translate (-target.topLeft ());
 		painter.scale (xScale, yScale);
 		painter.translate (0, rect.height () * (-page));
-		Doc_->drawContents (&painter, rect);
+		Doc_->drawContents (&painter, clip.intersected (rect));
 		painter.end ();
 
 		return image;
@@ -33,6 +33,7 @@
 #include <QPainter>
 #include <interfaces/monocle/idocument.h>
 #include <interfaces/monocle/isupportpainting.h>
+#include <interfaces/monocle/isupportrectrendering.h>
 #include <interfaces/monocle/isearchabledocument.h>
 
 class QTextDocument;
@@ -53,6 +54,7 @@ namespace Monocle
 	 */
 	class TextDocumentAdapter : public IDocument
 							  , public ISupportPainting
+							  , public ISupportRectRendering
 							  , public ISearchableDocument
 	{
 	protected:
@@ -110,6 +112,25 @@ namespace Monocle
 		 */
 		QImage RenderPage (int page, double xScale, double yScale);
 
+		/** @brief Renders the given \em rect of the given \em page.
+		 *
+		 * Only the part of the document intersecting the \em rect is
+		 * drawn. The hints set via SetRenderHint() are used during
+		 * rendering.
+		 *
+		 * @note If IsValid() returns false, the behavior is undefined.
+		 *
+		 * @param[in] page The index of the page to render.
+		 * @param[in] xScale The scale in the X dimension.
+		 * @param[in] yScale The scale in the Y dimension.
+		 * @param[in] rect The part of the scaled page to render.
+		 *
+		 * @return The rendered image of the given part of the page.
+		 *
+		 * @sa RenderPage(), SetRenderHint()
+		 */
+		QImage RenderPageRect (int page, double xScale, double yScale, const QRect& rect);
+
 		/** @brief Returns the links found on the given \em page.
 		 *
 		 * The implementation currently always returns an empty list.
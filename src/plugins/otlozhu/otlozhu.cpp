@@ -160,6 +160,11 @@ namespace Otlozhu
 		mgr->GetTodoStorage ()->AddItem (item);
 	}
 
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/todo-item" }, {}, {} };
+	}
+
 	Util::XmlSettingsDialog_ptr Plugin::GetSettingsDialog () const
 	{
 		return XSD_;
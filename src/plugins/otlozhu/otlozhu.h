@@ -39,6 +39,7 @@
 
 #include <interfaces/ientityhandler.h>
 #include <interfaces/ihavesettings.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 
 namespace LeechCraft
 {
@@ -51,12 +52,13 @@ namespace Otlozhu
 					, public IHaveTabs
 					, public IHaveSettings
 					, public IEntityHandler
+					, public IHaveEntityRoutingKeys
 #ifndef DISABLE_SYNC
 					, public ISyncable
 #endif
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo IHaveTabs IEntityHandler IHaveSettings)
+		Q_INTERFACES (IInfo IHaveTabs IEntityHandler IHaveSettings IHaveEntityRoutingKeys)
 #ifndef DISABLE_SYNC
 		Q_INTERFACES (ISyncable)
 #endif
@@ -85,6 +87,8 @@ namespace Otlozhu
 		EntityTestHandleResult CouldHandle (const Entity&) const;
 		void Handle (Entity);
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 		Util::XmlSettingsDialog_ptr GetSettingsDialog () const;
 
 #ifndef DISABLE_SYNC
@@ -75,34 +75,7 @@ namespace Poleemery
 				RatesFromUSD_ [cur] = settings.value (cur).toDouble ();
 		settings.endGroup ();
 
-		struct CurInfo
-		{
-			QString Code_;
-			QString Name_;
-		};
-		QSet<QString> knownCodes;
-		QList<CurInfo> currencies;
-		for (auto language = 2; language < 214; ++language)
-			for (auto country = 0; country < 247; ++country)
-			{
-				const QLocale loc (static_cast<QLocale::Language> (language),
-						static_cast<QLocale::Country> (country));
-
-				const auto& code = loc.currencySymbol (QLocale::CurrencyIsoCode);
-				if (code.isEmpty ())
-					continue;
-
-				if (knownCodes.contains (code))
-					continue;
-
-				knownCodes << code;
-				currencies.push_back ({ code, loc.currencySymbol (QLocale::CurrencyDisplayName) });
-			}
-
-		std::sort (currencies.begin (), currencies.end (),
-				[] (const CurInfo& l, const CurInfo& r) { return l.Code_ < r.Code_; });
-
-		for (const auto& cur : currencies)
+		for (const auto& cur : GetKnownCurrencies ())
 		{
 			Currencies_ << cur.Code_;
 
@@ -127,6 +100,36 @@ namespace Poleemery
 		timer->start (10 * 60 * 1000);
 	}
 
+	const QList<CurrenciesManager::CurrencyInfo>& CurrenciesManager::GetKnownCurrencies ()
+	{
+		static const auto currencies = [] () -> QList<CurrencyInfo>
+		{
+			QSet<QString> knownCodes;
+			QList<CurrencyInfo> result;
+			for (auto language = 2; language < 214; ++language)
+				for (auto country = 0; country < 247; ++country)
+				{
+					const QLocale loc (static_cast<QLocale::Language> (language),
+							static_cast<QLocale::Country> (country));
+
+					const auto& code = loc.currencySymbol (QLocale::CurrencyIsoCode);
+					if (code.isEmpty ())
+						continue;
+
+					if (knownCodes.contains (code))
+						continue;
+
+					knownCodes << code;
+					result.push_back ({ code, loc.currencySymbol (QLocale::CurrencyDisplayName) });
+				}
+
+			std::sort (result.begin (), result.end (),
+					[] (const CurrencyInfo& l, const CurrencyInfo& r) { return l.Code_ < r.Code_; });
+			return result;
+		} ();
+		return currencies;
+	}
+
 	void CurrenciesManager::Load ()
 	{
 		Enabled_.sort ();
@@ -57,8 +57,20 @@ namespace Poleemery
 
 		QDateTime LastFetch_;
 	public:
+		struct CurrencyInfo
+		{
+			QString Code_;
+			QString Name_;
+		};
+
 		CurrenciesManager (QObject* = 0);
 
+		/** Returns the list of currencies known to QLocale, sorted by
+		 * their ISO codes. The list is built on the first call, which
+		 * walks all the locales, and is thread-safe.
+		 */
+		static const QList<CurrencyInfo>& GetKnownCurrencies ();
+
 		void Load ();
 
 		const QStringList& GetEnabledCurrencies () const;
@@ -41,6 +41,11 @@ namespace LeechCraft
 {
 namespace Poleemery
 {
+	void Plugin::BackgroundInit ()
+	{
+		CurrenciesManager::GetKnownCurrencies ();
+	}
+
 	void Plugin::Init (ICoreProxy_ptr proxy)
 	{
 		XSD_.reset (new Util::XmlSettingsDialog);
@@ -33,6 +33,7 @@
 #include <QObject>
 #include <QList>
 #include <interfaces/iinfo.h>
+#include <interfaces/ihavebackgroundinit.h>
 #include <interfaces/ihavetabs.h>
 #include <interfaces/ihavesettings.h>
 
@@ -42,17 +43,19 @@ namespace Poleemery
 {
 	class Plugin : public QObject
 				 , public IInfo
+				 , public IHaveBackgroundInit
 				 , public IHaveTabs
 				 , public IHaveSettings
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo IHaveTabs IHaveSettings)
+		Q_INTERFACES (IInfo IHaveBackgroundInit IHaveTabs IHaveSettings)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.Poleemery")
 
 		QList<QPair<TabClassInfo, std::function<void (TabClassInfo)>>> TabClasses_;
 		Util::XmlSettingsDialog_ptr XSD_;
 	public:
+		void BackgroundInit ();
 		void Init (ICoreProxy_ptr);
 		void SecondInit ();
 		QByteArray GetUniqueID () const;
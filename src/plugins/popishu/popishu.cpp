@@ -126,6 +126,11 @@ namespace Popishu
 		AnnouncePage (page);
 	}
 
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/plain-text-document" }, {}, {} };
+	}
+
 	std::shared_ptr<Util::XmlSettingsDialog> Plugin::GetSettingsDialog () const
 	{
 		return XmlSettingsDialog_;
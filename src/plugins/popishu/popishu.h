@@ -35,6 +35,7 @@
 #include <interfaces/ientityhandler.h>
 #include <interfaces/ihavesettings.h>
 #include <interfaces/ihaverecoverabletabs.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 
 class QTranslator;
 
@@ -50,9 +51,10 @@ namespace Popishu
 				 , public IEntityHandler
 				 , public IHaveSettings
 				 , public IHaveRecoverableTabs
+				 , public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo IHaveTabs IEntityHandler IHaveSettings IHaveRecoverableTabs)
+		Q_INTERFACES (IInfo IHaveTabs IEntityHandler IHaveSettings IHaveRecoverableTabs IHaveEntityRoutingKeys)
 
 		TabClassInfo TabClass_;
 		ICoreProxy_ptr Proxy_;
@@ -72,6 +74,8 @@ namespace Popishu
 		EntityTestHandleResult CouldHandle (const Entity&) const;
 		void Handle (Entity);
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 		std::shared_ptr<Util::XmlSettingsDialog> GetSettingsDialog () const;
 
 		void RecoverTabs (const QList<TabRecoverInfo>&);
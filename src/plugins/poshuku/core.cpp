@@ -145,6 +145,10 @@ namespace Poshuku
 				SIGNAL (added (const HistoryItem&)),
 				HistoryModel_.get (),
 				SLOT (handleItemAdded (const HistoryItem&)));
+		connect (StorageBackend_.get (),
+				SIGNAL (historyRemoved (const QDateTime&)),
+				HistoryModel_.get (),
+				SLOT (handleHistoryRemoved (const QDateTime&)));
 
 		PluginManager_->RegisterHookable (HistoryModel_.get ());
 
@@ -152,6 +156,14 @@ namespace Poshuku
 				SIGNAL (added (const HistoryItem&)),
 				URLCompletionModel_.get (),
 				SLOT (handleItemAdded (const HistoryItem&)));
+		connect (HistoryModel_.get (),
+				SIGNAL (historyLoaded (const history_items_t&)),
+				URLCompletionModel_.get (),
+				SLOT (handleHistoryLoaded (const history_items_t&)));
+		connect (StorageBackend_.get (),
+				SIGNAL (historyRemoved (const QDateTime&)),
+				URLCompletionModel_.get (),
+				SLOT (handleHistoryRemoved (const QDateTime&)));
 
 		FavoritesModel_.reset (new FavoritesModel (this));
 		connect (StorageBackend_.get (),
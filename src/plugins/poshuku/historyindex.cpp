@@ -0,0 +1,271 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "historyindex.h"
+#include <algorithm>
+#include <numeric>
+#include <QRegExp>
+#include <QSet>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+	namespace
+	{
+		QStringList Tokenize (const QString& str)
+		{
+			return str.toLower ().split (QRegExp { "\\W+" }, QString::SkipEmptyParts);
+		}
+
+		/* The score is computed once, when the visit is indexed, so it
+		 * slowly drifts from the actual one as the time goes by. This
+		 * is fine for ranking, and the index is rebuilt on restart.
+		 */
+		double VisitWeight (const QDateTime& date, const QDateTime& now)
+		{
+			const auto days = date.daysTo (now);
+			if (days < 4)
+				return 100;
+			if (days < 14)
+				return 70;
+			if (days < 31)
+				return 50;
+			if (days < 90)
+				return 30;
+			return 10;
+		}
+
+		bool HasTokenWithPrefix (const QStringList& tokens, const QString& prefix)
+		{
+			return std::any_of (tokens.begin (), tokens.end (),
+					[&prefix] (const QString& token) { return token.startsWith (prefix); });
+		}
+	}
+
+	void HistoryIndex::Add (const history_items_t& items)
+	{
+		QMutexLocker locker { &PendingMutex_ };
+		Pending_ += items;
+	}
+
+	void HistoryIndex::Add (const HistoryItem& item)
+	{
+		QMutexLocker locker { &PendingMutex_ };
+		Pending_ << item;
+	}
+
+	void HistoryIndex::Clear ()
+	{
+		QMutexLocker locker { &PendingMutex_ };
+		Pending_.clear ();
+		ClearPending_ = true;
+	}
+
+	void HistoryIndex::Prune (const QDateTime& oldest)
+	{
+		QMutexLocker locker { &PendingMutex_ };
+		Pending_.erase (std::remove_if (Pending_.begin (), Pending_.end (),
+					[&oldest] (const HistoryItem& item) { return item.DateTime_ < oldest; }),
+				Pending_.end ());
+		if (!PruneBefore_.isValid () || PruneBefore_ < oldest)
+			PruneBefore_ = oldest;
+	}
+
+	history_items_t HistoryIndex::Find (const QString& base, int limit, const IsCancelled_f& isCancelled)
+	{
+		QMutexLocker locker { &IndexMutex_ };
+
+		IndexPending ();
+
+		const auto& query = Tokenize (base);
+
+		std::vector<int> matching;
+		if (query.isEmpty ())
+		{
+			matching.resize (Entries_.size ());
+			std::iota (matching.begin (), matching.end (), 0);
+		}
+		else
+		{
+			// The longest word is likely to be the most selective one.
+			const auto& key = *std::max_element (query.begin (), query.end (),
+					[] (const QString& left, const QString& right)
+						{ return left.size () < right.size (); });
+
+			QSet<int> candidates;
+			for (auto i = Token2Entries_.lowerBound (key);
+					i != Token2Entries_.end () && i.key ().startsWith (key); ++i)
+			{
+				if (isCancelled ())
+					return {};
+
+				for (const auto idx : *i)
+					candidates << idx;
+			}
+
+			for (const auto idx : candidates)
+			{
+				const auto& tokens = Entries_ [idx].Tokens_;
+				if (std::all_of (query.begin (), query.end (),
+						[&tokens] (const QString& word) { return HasTokenWithPrefix (tokens, word); }))
+					matching.push_back (idx);
+			}
+		}
+
+		if (isCancelled ())
+			return {};
+
+		const auto count = std::min<size_t> (limit, matching.size ());
+		std::partial_sort (matching.begin (), matching.begin () + count, matching.end (),
+				[this] (int left, int right)
+				{
+					const auto& l = Entries_ [left];
+					const auto& r = Entries_ [right];
+					return l.Score_ != r.Score_ ?
+							l.Score_ > r.Score_ :
+							l.LastVisit_ > r.LastVisit_;
+				});
+
+		history_items_t result;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const auto& entry = Entries_ [matching [i]];
+			result.push_back ({ entry.Title_, entry.LastVisit_, entry.URL_ });
+		}
+		return result;
+	}
+
+	void HistoryIndex::IndexPending ()
+	{
+		history_items_t pending;
+		bool clear = false;
+		QDateTime pruneBefore;
+		{
+			QMutexLocker locker { &PendingMutex_ };
+			std::swap (pending, Pending_);
+			std::swap (clear, ClearPending_);
+			std::swap (pruneBefore, PruneBefore_);
+		}
+
+		if (clear)
+		{
+			Entries_.clear ();
+			URL2Entry_.clear ();
+			Token2Entries_.clear ();
+		}
+		else if (pruneBefore.isValid ())
+			RemoveOlderThan (pruneBefore);
+
+		const auto& now = QDateTime::currentDateTime ();
+		for (const auto& item : pending)
+			Index (item, now);
+	}
+
+	void HistoryIndex::RemoveOlderThan (const QDateTime& oldest)
+	{
+		const auto isExpired = [&oldest] (const Entry& entry) { return entry.LastVisit_ < oldest; };
+		if (std::none_of (Entries_.begin (), Entries_.end (), isExpired))
+			return;
+
+		std::vector<int> old2new (Entries_.size (), -1);
+		std::vector<Entry> kept;
+		for (size_t i = 0; i < Entries_.size (); ++i)
+			if (!isExpired (Entries_ [i]))
+			{
+				old2new [i] = kept.size ();
+				kept.push_back (std::move (Entries_ [i]));
+			}
+		std::swap (Entries_, kept);
+
+		URL2Entry_.clear ();
+		for (size_t i = 0; i < Entries_.size (); ++i)
+			URL2Entry_ [Entries_ [i].URL_] = i;
+
+		for (auto i = Token2Entries_.begin (); i != Token2Entries_.end (); )
+		{
+			QVector<int> indexes;
+			for (const auto idx : *i)
+				if (old2new [idx] >= 0)
+					indexes << old2new [idx];
+
+			if (indexes.isEmpty ())
+				i = Token2Entries_.erase (i);
+			else
+			{
+				*i = indexes;
+				++i;
+			}
+		}
+	}
+
+	void HistoryIndex::Index (const HistoryItem& item, const QDateTime& now)
+	{
+		const auto weight = VisitWeight (item.DateTime_, now);
+
+		const auto pos = URL2Entry_.find (item.URL_);
+		if (pos == URL2Entry_.end ())
+		{
+			const int idx = Entries_.size ();
+			Entries_.push_back ({ item.URL_, item.Title_, item.DateTime_, weight, {} });
+			URL2Entry_ [item.URL_] = idx;
+
+			auto& entry = Entries_.back ();
+			entry.Tokens_ = Tokenize (item.URL_) + Tokenize (item.Title_);
+			entry.Tokens_.removeDuplicates ();
+			for (const auto& token : entry.Tokens_)
+				Token2Entries_ [token] << idx;
+			return;
+		}
+
+		auto& entry = Entries_ [*pos];
+		entry.Score_ += weight;
+
+		// The history is loaded newest first, so only a newer visit
+		// may update the title.
+		if (item.DateTime_ <= entry.LastVisit_)
+			return;
+
+		entry.LastVisit_ = item.DateTime_;
+		if (item.Title_ == entry.Title_)
+			return;
+
+		entry.Title_ = item.Title_;
+
+		// Stale tokens of the old title are left in Token2Entries_, but
+		// Find() checks the candidates against the entries' own tokens.
+		const auto oldTokens = entry.Tokens_;
+		entry.Tokens_ = Tokenize (item.URL_) + Tokenize (item.Title_);
+		entry.Tokens_.removeDuplicates ();
+		for (const auto& token : entry.Tokens_)
+			if (!oldTokens.contains (token))
+				Token2Entries_ [token] << *pos;
+	}
+}
+}
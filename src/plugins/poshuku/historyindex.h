@@ -0,0 +1,121 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <QHash>
+#include <QMap>
+#include <QDateTime>
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+#include <interfaces/poshuku/poshukutypes.h>
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+	/** @brief In-memory token index of the visited pages.
+	 *
+	 * Every distinct URL is indexed once by the lowercased words of its
+	 * URL and title, and has a frecency score built from the number and
+	 * the age of its visits.
+	 *
+	 * Adding items is cheap and is intended to be done from the GUI
+	 * thread: the items are just queued and get indexed by the next
+	 * Find() call, which is intended to be run in a worker thread.
+	 * Clearing and pruning the index is deferred to the next Find()
+	 * call as well.
+	 */
+	class HistoryIndex
+	{
+		struct Entry
+		{
+			QString URL_;
+			QString Title_;
+			QDateTime LastVisit_;
+			double Score_;
+			QStringList Tokens_;
+		};
+
+		QMutex PendingMutex_;
+		history_items_t Pending_;
+		bool ClearPending_ = false;
+		QDateTime PruneBefore_;
+
+		QMutex IndexMutex_;
+		std::vector<Entry> Entries_;
+		QHash<QString, int> URL2Entry_;
+		QMap<QString, QVector<int>> Token2Entries_;
+	public:
+		typedef std::function<bool ()> IsCancelled_f;
+
+		HistoryIndex () = default;
+		HistoryIndex (const HistoryIndex&) = delete;
+		HistoryIndex& operator= (const HistoryIndex&) = delete;
+
+		void Add (const history_items_t&);
+		void Add (const HistoryItem&);
+
+		/** @brief Drops all the pages added so far.
+		 *
+		 * This should be called when the items are removed from the
+		 * history, followed by adding the remaining ones back.
+		 */
+		void Clear ();
+
+		/** @brief Drops the pages not visited since the given date.
+		 *
+		 * This should be called when the visits older than oldest are
+		 * removed from the history. The scores of the remaining pages
+		 * still account for their removed visits.
+		 */
+		void Prune (const QDateTime& oldest);
+
+		/** @brief Finds the pages resembling the given string.
+		 *
+		 * A page resembles the string if each word of the string is a
+		 * prefix of some word of the page's title or URL. The pages are
+		 * returned in the order of decreasing frecency.
+		 *
+		 * The search is aborted as soon as isCancelled returns true, in
+		 * which case the result is meaningless.
+		 *
+		 * This function is thread-safe.
+		 */
+		history_items_t Find (const QString& base, int limit, const IsCancelled_f& isCancelled);
+	private:
+		void IndexPending ();
+		void RemoveOlderThan (const QDateTime&);
+		void Index (const HistoryItem&, const QDateTime&);
+	};
+}
+}
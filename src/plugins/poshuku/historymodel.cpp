@@ -46,6 +46,8 @@ namespace Poshuku
 {
 	namespace
 	{
+		const int DateRole = Qt::UserRole + 1;
+
 		/** Returns the number of the section for the given date.
 			*
 			* - Today
@@ -192,6 +194,7 @@ namespace Poshuku
 		};
 		for (const auto item : items)
 			item->setEditable (false);
+		items.at (ColumnDate)->setData (histItem.DateTime_, DateRole);
 		item (section)->appendRow (items);
 	}
 
@@ -199,11 +202,9 @@ namespace Poshuku
 	{
 		collectGarbage ();
 
-		if (const auto rc = rowCount ())
-			removeRows (0, rc);
-
 		Items_.clear ();
 		Core::Instance ().GetStorageBackend ()->LoadHistory (Items_);
+		emit historyLoaded (Items_);
 
 		QSet<QString> urls;
 		for (auto i = Items_.begin (); i != Items_.end (); )
@@ -228,6 +229,33 @@ namespace Poshuku
 		Add (item, SectionNumber (item.DateTime_));
 	}
 
+	void HistoryModel::handleHistoryRemoved (const QDateTime& oldest)
+	{
+		Items_.erase (std::remove_if (Items_.begin (), Items_.end (),
+					[&oldest] (const HistoryItem& item) { return item.DateTime_ < oldest; }),
+				Items_.end ());
+
+		for (int i = 0; i < rowCount (); ++i)
+		{
+			const auto section = item (i);
+
+			// Removing the contiguous runs of expired rows at once.
+			int runEnd = -1;
+			for (int row = section->rowCount () - 1; row >= -1; --row)
+			{
+				const bool expired = row >= 0 &&
+						section->child (row, ColumnDate)->data (DateRole).toDateTime () < oldest;
+				if (expired && runEnd < 0)
+					runEnd = row;
+				else if (!expired && runEnd >= 0)
+				{
+					section->removeRows (row + 1, runEnd - row);
+					runEnd = -1;
+				}
+			}
+		}
+	}
+
 	void HistoryModel::collectGarbage ()
 	{
 		int age = XmlSettingsManager::Instance ()->
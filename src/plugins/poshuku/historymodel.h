@@ -69,7 +69,15 @@ namespace Poshuku
 		void loadData ();
 		void collectGarbage ();
 		void handleItemAdded (const HistoryItem&);
+		void handleHistoryRemoved (const QDateTime&);
 	signals:
+		/** @brief Emitted when the history is loaded.
+		 *
+		 * The items contain every stored visit, including the repeated
+		 * visits to the same URL, newest first.
+		 */
+		void historyLoaded (const history_items_t& items);
+
 		// Hook support signals
 		/** @brief Called when an entry is going to be added to
 			* history.
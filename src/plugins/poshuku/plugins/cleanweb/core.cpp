@@ -39,12 +39,12 @@
 #include <QTextCodec>
 #include <QMessageBox>
 #include <QDir>
+#include <QCryptographicHash>
 #include <qwebframe.h>
 #include <qwebpage.h>
 #include <qwebelement.h>
 #include <QCoreApplication>
 #include <QtConcurrentRun>
-#include <QtConcurrentMap>
 #include <QFutureWatcher>
 #include <QMenu>
 #include <QMainWindow>
@@ -64,6 +64,8 @@
 #include "flashonclickwhitelist.h"
 #include "userfiltersmodel.h"
 #include "lineparser.h"
+#include "filtermatcher.h"
+#include "filtercache.h"
 
 Q_DECLARE_METATYPE (QNetworkReply*);
 Q_DECLARE_METATYPE (QWebFrame*);
@@ -157,19 +159,28 @@ namespace CleanWeb
 					continue;
 				}
 
-				const auto& data = QString::fromUtf8 (file.readAll ());
-				QStringList rawLines = data.split ('\n', QString::SkipEmptyParts);
-				if (rawLines.size ())
-					rawLines.removeAt (0);
-				QStringList lines;
-				std::transform (rawLines.begin (), rawLines.end (),
-						std::back_inserter (lines),
-						[] (const QString& t) { return t.trimmed (); });
+				const auto& rawData = file.readAll ();
+				const auto& hash = QCryptographicHash::hash (rawData, QCryptographicHash::Sha1);
+				const auto& fileName = QFileInfo (filePath).fileName ();
 
 				Filter f;
-				std::for_each (lines.begin (), lines.end (), LineParser (&f));
+				if (!LoadCachedFilter (fileName, hash, f))
+				{
+					const auto& data = QString::fromUtf8 (rawData);
+					QStringList rawLines = data.split ('\n', QString::SkipEmptyParts);
+					if (rawLines.size ())
+						rawLines.removeAt (0);
+					QStringList lines;
+					std::transform (rawLines.begin (), rawLines.end (),
+							std::back_inserter (lines),
+							[] (const QString& t) { return t.trimmed (); });
+
+					std::for_each (lines.begin (), lines.end (), LineParser (&f));
+
+					SaveCachedFilter (fileName, hash, f);
+				}
 
-				f.SD_.Filename_ = QFileInfo (filePath).fileName ();
+				f.SD_.Filename_ = fileName;
 
 				result << f;
 			}
@@ -177,10 +188,23 @@ namespace CleanWeb
 		}
 	};
 
+	bool operator== (const DecisionCacheKey& k1, const DecisionCacheKey& k2)
+	{
+		return k1.Objects_ == k2.Objects_ &&
+				k1.URL_ == k2.URL_ &&
+				k1.RefererHost_ == k2.RefererHost_;
+	}
+
+	uint qHash (const DecisionCacheKey& key)
+	{
+		return qHash (key.URL_) ^ (qHash (key.RefererHost_) << 1) ^ key.Objects_;
+	}
+
 	Core::Core ()
 	: FlashOnClickPlugin_ (0)
 	, FlashOnClickWhitelist_ (new FlashOnClickWhitelist ())
 	, UserFilters_ (new UserFiltersModel (this))
+	, DecisionsCache_ (4096)
 	{
 		qRegisterMetaType<QWebFrame*> ("QWebFrame*");
 		qRegisterMetaType<QPointer<QWebFrame>> ("QPointer<QWebFrame>");
@@ -359,14 +383,6 @@ namespace CleanWeb
 		Remove (Filters_ [index.row ()].SD_.Filename_);
 	}
 
-	namespace
-	{
-		void RemoveElem (QWebElement elem)
-		{
-			elem.setStyleProperty ("visibility", "hidden !important");
-		}
-	}
-
 	void Core::HandleInitialLayout (QWebPage*, QWebFrame *frame)
 	{
 		QMetaObject::invokeMethod (this,
@@ -466,130 +482,6 @@ namespace CleanWeb
 		return FlashOnClickWhitelist_;
 	}
 
-	namespace
-	{
-#if defined (Q_OS_WIN32) || defined (Q_OS_MAC)
-		// Thanks for this goes to http://www.codeproject.com/KB/string/patmatch.aspx
-		bool WildcardMatches (const char *pattern, const char *str)
-		{
-			enum State {
-				Exact,        // exact match
-				Any,        // ?
-				AnyRepeat    // *
-			};
-
-			const char *s = str;
-			const char *p = pattern;
-			const char *q = 0;
-			int state = 0;
-
-			bool match = true;
-			while (match && *p) {
-				if (*p == '*') {
-					state = AnyRepeat;
-					q = p+1;
-				} else if (*p == '?') state = Any;
-				else state = Exact;
-
-				if (*s == 0) break;
-
-				switch (state) {
-					case Exact:
-						match = *s == *p;
-						s++;
-						p++;
-						break;
-
-					case Any:
-						match = true;
-						s++;
-						p++;
-						break;
-
-					case AnyRepeat:
-						match = true;
-						s++;
-
-						if (*s == *q) p++;
-						break;
-				}
-			}
-
-			if (state == AnyRepeat) return (*s == *q);
-			else if (state == Any) return (*s == *p);
-			else return match && (*s == *p);
-		}
-#else
-#include <fnmatch.h>
-
-		bool WildcardMatches (const char *pat, const char *str)
-		{
-			return !fnmatch (pat, str, 0);
-		}
-#endif
-
-		bool Matches (const FilterItem_ptr& item,
-				const QString& urlStr, const QByteArray& urlUtf8, const QString& domain)
-		{
-			const auto& opt = item->Option_;
-			if (opt.MatchObjects_ != FilterOption::MatchObject::All)
-			{
-				if (!(opt.MatchObjects_ & FilterOption::MatchObject::CSS) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Image) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Script) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::Object) &&
-						!(opt.MatchObjects_ & FilterOption::MatchObject::ObjSubrequest))
-					return false;
-			}
-
-			if (!opt.NotDomains_.isEmpty ())
-			{
-				for (const auto& notDomain : opt.NotDomains_)
-					if (domain.endsWith (notDomain, opt.Case_))
-						return false;
-			}
-
-			if (!opt.Domains_.isEmpty ())
-			{
-				bool shouldFurther = false;
-				for (const auto& doDomain : opt.Domains_)
-					if (domain.endsWith (doDomain, opt.Case_))
-					{
-						shouldFurther = true;
-						break;
-					}
-
-				if (!shouldFurther)
-					return false;
-			}
-
-			switch (opt.MatchType_)
-			{
-			case FilterOption::MTRegexp:
-				return item->RegExp_.Matches (urlStr);
-			case FilterOption::MTWildcard:
-				return WildcardMatches (item->PlainMatcher_.constData (), urlUtf8.constData ());
-			case FilterOption::MTPlain:
-				return urlUtf8.indexOf (item->PlainMatcher_) >= 0;
-			case FilterOption::MTBegin:
-				return urlStr.startsWith (QString::fromUtf8 (item->PlainMatcher_));
-			case FilterOption::MTEnd:
-				return urlStr.endsWith (QString::fromUtf8 (item->PlainMatcher_));
-			}
-
-			return false;
-		}
-	}
-
-	namespace
-	{
-		void DumbReductor (bool& res, bool value)
-		{
-			if (value)
-				res = true;
-		}
-	}
-
 	/** We test each filter until we know that we should reject it or until
 	 * it gets whitelisted.
 	 *
@@ -610,6 +502,14 @@ namespace CleanWeb
 	 *   that the '*' is prepended by the filter parsing code, not this one.
 	 *
 	 * The same is applied to the filter strings.
+	 *
+	 * Both lists are compiled into FilterMatcher objects, so only the
+	 * entries sharing a literal substring with the URL (and the ones
+	 * that can't be indexed at all) are actually checked.
+	 *
+	 * The decisions are cached by the URL, the referer host and the
+	 * requested object types, since pages keep requesting the same
+	 * resources over and over.
 	 */
 	bool Core::ShouldReject (const QNetworkRequest& req) const
 	{
@@ -641,49 +541,19 @@ namespace CleanWeb
 		}
 
 		const QUrl& url = req.url ();
-		const QString& urlStr = url.toString ();
-		const auto& urlUtf8 = urlStr.toUtf8 ();
-		const QString& cinUrlStr = urlStr.toLower ();
-		const auto& cinUrlUtf8 = cinUrlStr.toUtf8 ();
+		const auto& refererHost = QUrl::fromEncoded (req.rawHeader ("Referer")).host ();
 
-		const QString& domain = url.host ();
-		const auto& domainUtf8 = domain.toUtf8 ();
-		const bool isForeign = !req.rawHeader ("Referer").contains (domainUtf8);
+		const DecisionCacheKey key { url.toString (), refererHost, static_cast<int> (objs) };
+		if (DecisionsCache_.contains (key))
+			return DecisionsCache_ [key];
 
-		auto matches = [=] (const QList<QList<FilterItem_ptr>>& chunks) -> bool
-			{
-				return QtConcurrent::blockingMappedReduced (chunks.begin (), chunks.end (),
-						std::function<bool (const QList<FilterItem_ptr>&)>
-						{
-							[=] (const QList<FilterItem_ptr>& items) -> bool
-							{
-								for (const auto& item : items)
-								{
-									const auto& opt = item->Option_;
-									if (opt.AbortForeign_ && isForeign)
-										continue;
-
-									if (opt.MatchObjects_ != FilterOption::MatchObject::All &&
-											objs != FilterOption::MatchObject::All &&
-											!(objs & opt.MatchObjects_))
-										continue;
-
-									const auto& url = item->Option_.Case_ == Qt::CaseSensitive ? urlStr : cinUrlStr;
-									const auto& utf8 = item->Option_.Case_ == Qt::CaseSensitive ? urlUtf8 : cinUrlUtf8;
-									if (Matches (item, url, utf8, domain))
-										return true;
-								}
-
-								return false;
-							}
-						}, DumbReductor);
-			};
-		if (matches (ExceptionsCache_))
-			return false;
-		if (matches (FilterItemsCache_))
-			return true;
+		const bool isForeign = !refererHost.contains (url.host ());
 
-		return false;
+		const FilterMatcher::Request matcherReq { url, isForeign, objs };
+		const bool reject = !ExceptionsMatcher_.Matches (matcherReq) &&
+				FiltersMatcher_.Matches (matcherReq);
+		DecisionsCache_ [key] = reject;
+		return reject;
 	}
 
 	void Core::HandleProvider (QObject *provider)
@@ -816,6 +686,7 @@ namespace CleanWeb
 		home.cd (".leechcraft");
 		home.cd ("cleanweb");
 		home.remove (fileName);
+		RemoveCachedFilter (fileName);
 
 		QList<Filter>::iterator pos = std::find_if (Filters_.begin (), Filters_.end (),
 				FilterFinder<FTFilename_> (fileName));
@@ -956,24 +827,29 @@ namespace CleanWeb
 		PendingJobs_.remove (id);
 	}
 
-	void Core::handleFrameLayout (QPointer<QWebFrame> frame)
+	void Core::HideElements (QWebFrame *frame, HidingPass pass, const AppliedSelectors_ptr& applied)
 	{
-		if (!frame)
+		if (!HidingIndex_)
 			return;
 
 		const QUrl& frameUrl = frame->url ().isEmpty () ?
 				frame->baseUrl () :
 				frame->url ();
 		qDebug () << Q_FUNC_INFO << frame << frameUrl;
-		const QString& urlStr = frameUrl.toString ();
-		const auto& urlUtf8 = urlStr.toUtf8 ();
-		const QString& cinUrlStr = urlStr.toLower ();
-		const auto& cinUrlUtf8 = cinUrlStr.toUtf8 ();
 
-		const QString& domain = frameUrl.host ();
+		QSet<QString> ids;
+		QSet<QString> classes;
+		for (const auto& elem : frame->findAllElements ("[id], [class]"))
+		{
+			const auto& id = elem.attribute ("id");
+			if (!id.isEmpty ())
+				ids << id;
+			for (const auto& cls : elem.classes ())
+				classes << cls;
+		}
 
-		QList<Filter> allFilters = Filters_;
-		allFilters << UserFilters_->GetFilter ();
+		const auto index = HidingIndex_;
+		const QPointer<QWebFrame> framePtr { frame };
 
 		auto watcher = new QFutureWatcher<HidingWorkerResult> (this);
 		connect (watcher,
@@ -982,28 +858,40 @@ namespace CleanWeb
 				SLOT (hidingElementsFound ()));
 		watcher->setFuture (QtConcurrent::run ([=] () -> HidingWorkerResult
 					{
-						QStringList sels;
-						for (const Filter& filter : allFilters)
-							for (const auto& item : filter.Filters_)
-							{
-								if (item->Option_.HideSelector_.isEmpty ())
-									continue;
-
-								const auto& opt = item->Option_;
-								const auto& url = opt.Case_ == Qt::CaseSensitive ? urlStr : cinUrlStr;
-								const auto& utf8 = opt.Case_ == Qt::CaseSensitive ? urlUtf8 : cinUrlUtf8;
-								if (!Matches (item, url, utf8, domain))
-									continue;
-
-								sels << item->Option_.HideSelector_;
-							}
-						return { frame, 0, sels };
+						auto selectors = index->GetSelectors (ids, classes);
+						if (pass == HidingPass::Initial)
+							selectors += index->GetSelectors (frameUrl);
+
+						// The passes may run concurrently, so the
+						// selectors are claimed under the lock.
+						QStringList fresh;
+						{
+							QMutexLocker locker { &applied->Mutex_ };
+							for (const auto& selector : selectors)
+								if (!applied->Selectors_.contains (selector))
+								{
+									applied->Selectors_ << selector;
+									fresh << selector;
+								}
+						}
+						return { framePtr, ElementHidingIndex::MakeStylesheet (fresh) };
 					}));
+	}
+
+	void Core::handleFrameLayout (QPointer<QWebFrame> frame)
+	{
+		if (!frame)
+			return;
+
+		const auto applied = std::make_shared<AppliedSelectors> ();
+		HideElements (frame, HidingPass::Initial, applied);
 
 		new Util::SlotClosure<Util::DeleteLaterPolicy>
 		{
-			[this, frame] () -> void
+			[this, frame, applied] () -> void
 			{
+				HideElements (frame, HidingPass::Loaded, applied);
+
 				for (auto childFrame : frame->childFrames ())
 					handleFrameLayout (childFrame);
 			},
@@ -1018,39 +906,19 @@ namespace CleanWeb
 		auto watcher = dynamic_cast<QFutureWatcher<HidingWorkerResult>*> (sender ());
 		watcher->deleteLater ();
 
-		hideElementsChunk (watcher->result ());
-
-	}
-
-	void Core::hideElementsChunk (HidingWorkerResult result)
-	{
-		if (!result.Frame_)
+		const auto& result = watcher->result ();
+		if (!result.Frame_ || result.Stylesheet_.isEmpty ())
 			return;
 
-		const int chunkSize = 100;
+		const auto& doc = result.Frame_->documentElement ();
+		if (doc.isNull ())
+			return;
 
-		auto& i = result.CurrentPos_;
-		for (auto end = std::min (i + chunkSize, result.Selectors_.size ()); i < end; ++i)
-		{
-			const auto& selector = result.Selectors_.value (i);
-
-			const auto& matchingElems = result.Frame_->findAllElements (selector);
-			if (matchingElems.count ())
-				qDebug () << "removing"
-						<< matchingElems.count ()
-						<< "elems for"
-						<< selector
-						<< result.Frame_->url ();
-
-			for (int i = matchingElems.count () - 1; i >= 0; --i)
-				RemoveElem (matchingElems.at (i));
-		}
+		auto target = doc.findFirst ("head");
+		if (target.isNull ())
+			target = doc;
 
-		if (result.CurrentPos_ < result.Selectors_.size ())
-			QMetaObject::invokeMethod (this,
-					"hideElementsChunk",
-					Qt::QueuedConnection,
-					Q_ARG (HidingWorkerResult, result));
+		target.appendInside ("<style type=\"text/css\">" + result.Stylesheet_ + "</style>");
 	}
 
 	namespace
@@ -1059,7 +927,7 @@ namespace CleanWeb
 		{
 			const auto& baseUrl = frame->baseUrl ();
 
-			const auto& elems = frame->findAllElements ("img,script,iframe,applet,object");
+			const auto& elems = frame->findAllElements ("img[src],script[src],iframe[src],applet[src],object[src]");
 
 			bool removed = false;
 			for (int i = elems.count () - 1; i >= 0; --i)
@@ -1115,61 +983,28 @@ namespace CleanWeb
 
 	void Core::regenFilterCaches ()
 	{
-		ExceptionsCache_.clear ();
-		FilterItemsCache_.clear ();
-
 		QList<Filter> allFilters = Filters_;
 		allFilters << UserFilters_->GetFilter ();
 
-		int exceptionsCount = 0;
-		int filtersCount = 0;
+		QList<FilterItem_ptr> exceptions;
+		QList<FilterItem_ptr> filters;
 		for (const Filter& filter : allFilters)
 		{
-			exceptionsCount += filter.Exceptions_.size ();
-			filtersCount += filter.Filters_.size ();
-		}
-
-		auto idealThreads = std::max (QThread::idealThreadCount (), 2);
-
-		const int exChunkSize = std::max (exceptionsCount / idealThreads / 4, 200);
-		const int fChunkSize = std::max (filtersCount / idealThreads / 4, 200);
-		qDebug () << Q_FUNC_INFO << exceptionsCount << filtersCount << exChunkSize << fChunkSize;
-
-		QList<FilterItem_ptr> lastItemsChunk, lastExceptionsChunk;
-		lastItemsChunk.reserve (fChunkSize);
-		lastExceptionsChunk.reserve (exChunkSize);
-
-		for (const Filter& filter : allFilters)
-		{
-			for (const auto& item : filter.Exceptions_)
-				if (item->Option_.HideSelector_.isEmpty ())
-				{
-					lastExceptionsChunk << item;
-					if (lastExceptionsChunk.size () >= exChunkSize)
-					{
-						ExceptionsCache_ << lastExceptionsChunk;
-						lastExceptionsChunk.clear ();
-					}
-				}
-
-			for (const auto& item : filter.Filters_)
-			{
-				if (!item->Option_.HideSelector_.isEmpty ())
-					continue;
-
-				lastItemsChunk << item;
-				if (lastItemsChunk.size () >= fChunkSize)
-				{
-					FilterItemsCache_ << lastItemsChunk;
-					lastItemsChunk.clear ();
-				}
-			}
+			exceptions << filter.Exceptions_;
+			filters << filter.Filters_;
 		}
 
-		if (!lastItemsChunk.isEmpty ())
-			ExceptionsCache_ << lastItemsChunk;
-		if (!lastExceptionsChunk.isEmpty ())
-			FilterItemsCache_ << lastExceptionsChunk;
+		ExceptionsMatcher_ = FilterMatcher { exceptions };
+		FiltersMatcher_ = FilterMatcher { filters };
+		DecisionsCache_.clear ();
+		HidingIndex_ = std::make_shared<ElementHidingIndex> (filters);
+
+		qDebug () << Q_FUNC_INFO
+				<< ExceptionsMatcher_.GetItemsCount ()
+				<< ExceptionsMatcher_.GetGenericItemsCount ()
+				<< FiltersMatcher_.GetItemsCount ()
+				<< FiltersMatcher_.GetGenericItemsCount ()
+				<< HidingIndex_->GetGenericCount ();
 	}
 }
 }
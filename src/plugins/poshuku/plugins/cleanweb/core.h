@@ -29,8 +29,11 @@
 
 #pragma once
 
+#include <memory>
 #include <QAbstractItemModel>
 #include <QHash>
+#include <QSet>
+#include <QMutex>
 #include <QStringList>
 #include <QNetworkReply>
 #include <QDateTime>
@@ -39,7 +42,10 @@
 #include <interfaces/idownload.h>
 #include <interfaces/poshuku/poshukutypes.h>
 #include <interfaces/core/ihookproxy.h>
+#include <util/sll/assoccache.h>
 #include "filter.h"
+#include "filtermatcher.h"
+#include "elementhidingindex.h"
 
 class QNetworkRequest;
 class QWebPage;
@@ -57,12 +63,31 @@ namespace CleanWeb
 	class UserFiltersModel;
 
 
+	struct DecisionCacheKey
+	{
+		QString URL_;
+		QString RefererHost_;
+		int Objects_;
+	};
+
+	bool operator== (const DecisionCacheKey&, const DecisionCacheKey&);
+	uint qHash (const DecisionCacheKey&);
+
 	struct HidingWorkerResult
 	{
 		QPointer<QWebFrame> Frame_;
-		int CurrentPos_;
-		QStringList Selectors_;
+		QString Stylesheet_;
+	};
+
+	/** The selectors already injected into a frame by the earlier hiding
+	 * passes over the same document, shared by the passes' workers.
+	 */
+	struct AppliedSelectors
+	{
+		QMutex Mutex_;
+		QSet<QString> Selectors_;
 	};
+	typedef std::shared_ptr<AppliedSelectors> AppliedSelectors_ptr;
 
 	class Core : public QAbstractItemModel
 	{
@@ -74,8 +99,12 @@ namespace CleanWeb
 
 		QList<Filter> Filters_;
 
-		QList<QList<FilterItem_ptr>> ExceptionsCache_;
-		QList<QList<FilterItem_ptr>> FilterItemsCache_;
+		FilterMatcher ExceptionsMatcher_;
+		FilterMatcher FiltersMatcher_;
+
+		mutable Util::AssocCache<DecisionCacheKey, bool> DecisionsCache_;
+
+		std::shared_ptr<const ElementHidingIndex> HidingIndex_;
 
 		QObjectList Downloaders_;
 		QStringList HeaderLabels_;
@@ -179,6 +208,13 @@ namespace CleanWeb
 		void WriteSettings ();
 		void ReadSettings ();
 		bool AssignSD (const SubscriptionData&);
+
+		enum class HidingPass
+		{
+			Initial,
+			Loaded
+		};
+		void HideElements (QWebFrame*, HidingPass, const AppliedSelectors_ptr&);
 	private slots:
 		void handleParsed ();
 		void update ();
@@ -186,7 +222,6 @@ namespace CleanWeb
 		void handleJobError (int, IDownload::Error);
 		void handleFrameLayout (QPointer<QWebFrame>);
 		void hidingElementsFound ();
-		void hideElementsChunk (HidingWorkerResult);
 		void delayedRemoveElements (QPointer<QWebFrame>, const QUrl&);
 		void moreDelayedRemoveElements ();
 		void handleFrameDestroyed ();
@@ -0,0 +1,244 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "elementhidingindex.h"
+#include <QUrl>
+#include "filtermatcher.h"
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+		bool IsIdentChar (QChar c)
+		{
+			return c.isLetterOrNumber () || c == '-' || c == '_';
+		}
+
+		bool IsPlainDomain (const QString& str)
+		{
+			if (str.isEmpty () || !str.contains ('.'))
+				return false;
+
+			for (const auto c : str)
+				if (!IsIdentChar (c) && c != '.')
+					return false;
+
+			return true;
+		}
+
+		QStringList GetPlainDomains (const FilterItem_ptr& item)
+		{
+			const auto& opt = item->Option_;
+			if (opt.MatchType_ != FilterOption::MTPlain ||
+					!opt.Domains_.isEmpty () ||
+					!opt.NotDomains_.isEmpty ())
+				return {};
+
+			const auto& domains = QString::fromUtf8 (item->PlainMatcher_).toLower ().split (',');
+			for (const auto& domain : domains)
+				if (!IsPlainDomain (domain))
+					return {};
+
+			return domains;
+		}
+
+		bool IsGeneric (const FilterItem_ptr& item)
+		{
+			const auto& opt = item->Option_;
+			return opt.MatchType_ == FilterOption::MTPlain &&
+					item->PlainMatcher_.isEmpty () &&
+					opt.Domains_.isEmpty () &&
+					opt.NotDomains_.isEmpty ();
+		}
+
+		enum class KeyType
+		{
+			None,
+			Id,
+			Class
+		};
+
+		/* Extracts the id or class the leading compound selector starts
+		 * with after an optional type selector, like "ad" in "div.ad > a".
+		 * Selector lists and escaped identifiers aren't handled.
+		 */
+		KeyType GetSelectorKey (const QString& selector, QString& key)
+		{
+			if (selector.contains (',') || selector.contains ('\\'))
+				return KeyType::None;
+
+			int pos = 0;
+			while (pos < selector.size () && IsIdentChar (selector.at (pos)))
+				++pos;
+
+			if (pos >= selector.size ())
+				return KeyType::None;
+
+			const auto marker = selector.at (pos);
+			if (marker != '#' && marker != '.')
+				return KeyType::None;
+
+			const auto start = ++pos;
+			while (pos < selector.size () && IsIdentChar (selector.at (pos)))
+				++pos;
+
+			if (pos == start)
+				return KeyType::None;
+
+			key = selector.mid (start, pos - start);
+			return marker == '#' ? KeyType::Id : KeyType::Class;
+		}
+	}
+
+	ElementHidingIndex::ElementHidingIndex (const QList<FilterItem_ptr>& items)
+	{
+		for (const auto& item : items)
+		{
+			const auto& selector = item->Option_.HideSelector_.trimmed ();
+			if (selector.isEmpty ())
+				continue;
+
+			const auto& domains = GetPlainDomains (item);
+			if (!domains.isEmpty ())
+			{
+				for (const auto& domain : domains)
+					ByDomain_ [domain] << selector;
+				continue;
+			}
+
+			if (!IsGeneric (item))
+			{
+				Others_ << item;
+				continue;
+			}
+
+			QString key;
+			switch (GetSelectorKey (selector, key))
+			{
+			case KeyType::Id:
+				ById_ [key] << selector;
+				break;
+			case KeyType::Class:
+				ByClass_ [key] << selector;
+				break;
+			case KeyType::None:
+				Generic_ << selector;
+				break;
+			}
+		}
+	}
+
+	QStringList ElementHidingIndex::GetSelectors (const QUrl& url) const
+	{
+		auto result = Generic_;
+
+		const auto& host = url.host ().toLower ();
+		for (int pos = 0; pos >= 0 && pos < host.size (); )
+		{
+			const auto& suffix = host.mid (pos);
+			const auto domainPos = ByDomain_.find (suffix);
+			if (domainPos != ByDomain_.end ())
+				result += *domainPos;
+
+			pos = host.indexOf ('.', pos);
+			if (pos >= 0)
+				++pos;
+		}
+
+		if (Others_.isEmpty ())
+			return result;
+
+		const auto& urlStr = url.toString ();
+		const auto& urlUtf8 = urlStr.toUtf8 ();
+		const auto& cinUrlStr = urlStr.toLower ();
+		const auto& cinUrlUtf8 = cinUrlStr.toUtf8 ();
+		const auto& domain = url.host ();
+		for (const auto& item : Others_)
+		{
+			const auto isCs = item->Option_.Case_ == Qt::CaseSensitive;
+			if (Matches (item, isCs ? urlStr : cinUrlStr, isCs ? urlUtf8 : cinUrlUtf8, domain))
+				result << item->Option_.HideSelector_.trimmed ();
+		}
+
+		return result;
+	}
+
+	QStringList ElementHidingIndex::GetSelectors (const QSet<QString>& ids, const QSet<QString>& classes) const
+	{
+		QStringList result;
+
+		auto collect = [&result] (const QHash<QString, QStringList>& index, const QSet<QString>& keys)
+		{
+			if (index.size () < keys.size ())
+			{
+				for (auto i = index.begin (), end = index.end (); i != end; ++i)
+					if (keys.contains (i.key ()))
+						result += i.value ();
+			}
+			else
+				for (const auto& key : keys)
+				{
+					const auto pos = index.find (key);
+					if (pos != index.end ())
+						result += *pos;
+				}
+		};
+		collect (ById_, ids);
+		collect (ByClass_, classes);
+
+		return result;
+	}
+
+	int ElementHidingIndex::GetGenericCount () const
+	{
+		return Generic_.size () + Others_.size ();
+	}
+
+	QString ElementHidingIndex::MakeStylesheet (const QStringList& selectors)
+	{
+		QString result;
+		for (const auto& selector : selectors)
+		{
+			if (selector.contains ('{') ||
+					selector.contains ('}') ||
+					selector.contains ('<'))
+				continue;
+
+			result += selector;
+			result += " { visibility: hidden !important; }\n";
+		}
+		return result;
+	}
+}
+}
+}
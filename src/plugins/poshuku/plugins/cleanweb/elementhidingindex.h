@@ -0,0 +1,115 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include "filter.h"
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	/** @brief An index of the element hiding rules.
+	 *
+	 * Hiding rules bound to plain domains (like in
+	 * <code>example.com##.banner</code>) are indexed by those domains,
+	 * so only the rules for the suffixes of the page host are looked
+	 * at. Generic rules whose selector starts with an id or a class
+	 * (like in <code>##.banner > img</code>) are indexed by that id or
+	 * class, so they are only used if the page has an element with it.
+	 *
+	 * The rest of the hiding rules (bound to URL patterns or domain
+	 * options, or having selectors of other kinds) are checked for each
+	 * page as before.
+	 *
+	 * This class is immutable once constructed and thus may be freely
+	 * used from multiple threads.
+	 */
+	class ElementHidingIndex
+	{
+		QHash<QString, QStringList> ByDomain_;
+		QHash<QString, QStringList> ById_;
+		QHash<QString, QStringList> ByClass_;
+		QStringList Generic_;
+		QVector<FilterItem_ptr> Others_;
+	public:
+		ElementHidingIndex () = default;
+
+		/** @brief Indexes the given filter items.
+		 *
+		 * Items without element hiding selectors are ignored.
+		 *
+		 * @param[in] items The filter items to index.
+		 */
+		explicit ElementHidingIndex (const QList<FilterItem_ptr>& items);
+
+		/** @brief Returns the selectors not depending on the page contents.
+		 *
+		 * These are the selectors of the rules for the given URL
+		 * (including the generic rules) that are not indexed by an id or
+		 * a class.
+		 *
+		 * @param[in] url The URL of the page.
+		 * @return The list of the selectors to hide.
+		 */
+		QStringList GetSelectors (const QUrl& url) const;
+
+		/** @brief Returns the generic selectors for the given ids and
+		 * classes.
+		 *
+		 * @param[in] ids The ids of the elements on the page.
+		 * @param[in] classes The classes of the elements on the page.
+		 * @return The list of the selectors to hide.
+		 */
+		QStringList GetSelectors (const QSet<QString>& ids, const QSet<QString>& classes) const;
+
+		/** @brief Returns the number of selectors always used.
+		 */
+		int GetGenericCount () const;
+
+		/** @brief Combines the selectors into a single stylesheet.
+		 *
+		 * Each selector gets a rule of its own, so that an invalid
+		 * selector doesn't affect the others. Selectors that could break
+		 * the stylesheet are skipped.
+		 *
+		 * @param[in] selectors The selectors to combine.
+		 * @return The stylesheet hiding the elements.
+		 */
+		static QString MakeStylesheet (const QStringList& selectors);
+	};
+}
+}
+}
@@ -0,0 +1,209 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filtercache.h"
+#include <stdexcept>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QtDebug>
+#include <util/sys/paths.h>
+#include "filter.h"
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+		const quint32 CacheMagic = 0x4c435746;
+		const quint32 CacheVersion = 1;
+
+		QString GetCachePath (const QString& filename)
+		{
+			try
+			{
+				return Util::GetUserDir (Util::UserDir::Cache, "poshuku/cleanweb")
+						.absoluteFilePath (filename + ".cache");
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< e.what ();
+				return {};
+			}
+		}
+
+		void WriteItems (QDataStream& out, const QList<FilterItem_ptr>& items)
+		{
+			out << static_cast<quint32> (items.size ());
+			for (const auto& item : items)
+			{
+				const auto& opt = item->Option_;
+				out << item->PlainMatcher_
+					<< item->RegExp_.GetPattern ()
+					<< static_cast<quint8> (opt.Case_)
+					<< static_cast<quint8> (opt.MatchType_)
+					<< static_cast<quint16> (opt.MatchObjects_)
+					<< opt.Domains_
+					<< opt.NotDomains_
+					<< opt.HideSelector_
+					<< opt.AbortForeign_;
+			}
+		}
+
+		bool ReadItems (QDataStream& in, QList<FilterItem_ptr>& items)
+		{
+			quint32 count = 0;
+			in >> count;
+			if (in.status () != QDataStream::Ok)
+				return false;
+
+			items.reserve (count);
+			for (quint32 i = 0; i < count; ++i)
+			{
+				QByteArray plain;
+				QString rxPattern;
+				quint8 cs = 0;
+				quint8 matchType = 0;
+				quint16 objects = 0;
+				FilterOption opt;
+				in >> plain
+					>> rxPattern
+					>> cs
+					>> matchType
+					>> objects
+					>> opt.Domains_
+					>> opt.NotDomains_
+					>> opt.HideSelector_
+					>> opt.AbortForeign_;
+				if (in.status () != QDataStream::Ok)
+					return false;
+
+				opt.Case_ = static_cast<Qt::CaseSensitivity> (cs);
+				opt.MatchType_ = static_cast<FilterOption::MatchType> (matchType);
+				opt.MatchObjects_ = FilterOption::MatchObjects (objects);
+
+				const auto& rx = opt.MatchType_ == FilterOption::MTRegexp ?
+						Util::RegExp (rxPattern, opt.Case_) :
+						Util::RegExp ();
+				items << FilterItem_ptr (new FilterItem { rx, plain, opt });
+			}
+
+			return true;
+		}
+	}
+
+	bool LoadCachedFilter (const QString& filename, const QByteArray& contentsHash, Filter& filter)
+	{
+		const auto& path = GetCachePath (filename);
+		if (path.isEmpty ())
+			return false;
+
+		QFile file (path);
+		if (!file.exists () || !file.open (QIODevice::ReadOnly))
+			return false;
+
+		const auto size = file.size ();
+		const auto mapped = file.map (0, size);
+		if (!mapped)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to map"
+					<< path
+					<< file.errorString ();
+			return false;
+		}
+
+		const auto& data = QByteArray::fromRawData (reinterpret_cast<const char*> (mapped), size);
+		QDataStream in (data);
+
+		quint32 magic = 0;
+		quint32 version = 0;
+		bool fastRx = false;
+		QByteArray hash;
+		in >> magic >> version;
+		if (magic != CacheMagic || version != CacheVersion)
+			return false;
+
+		in.setVersion (QDataStream::Qt_4_8);
+		in >> fastRx >> hash;
+		if (fastRx != Util::RegExp::IsFast () || hash != contentsHash)
+			return false;
+
+		Filter result;
+		if (!ReadItems (in, result.Filters_) ||
+				!ReadItems (in, result.Exceptions_))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "corrupted cache"
+					<< path;
+			return false;
+		}
+
+		filter.Filters_ = result.Filters_;
+		filter.Exceptions_ = result.Exceptions_;
+		return true;
+	}
+
+	void SaveCachedFilter (const QString& filename, const QByteArray& contentsHash, const Filter& filter)
+	{
+		const auto& path = GetCachePath (filename);
+		if (path.isEmpty ())
+			return;
+
+		QFile file (path);
+		if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< path
+					<< file.errorString ();
+			return;
+		}
+
+		QDataStream out (&file);
+		out << CacheMagic << CacheVersion;
+		out.setVersion (QDataStream::Qt_4_8);
+		out << Util::RegExp::IsFast () << contentsHash;
+		WriteItems (out, filter.Filters_);
+		WriteItems (out, filter.Exceptions_);
+	}
+
+	void RemoveCachedFilter (const QString& filename)
+	{
+		const auto& path = GetCachePath (filename);
+		if (!path.isEmpty ())
+			QFile::remove (path);
+	}
+}
+}
+}
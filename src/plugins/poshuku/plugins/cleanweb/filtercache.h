@@ -0,0 +1,81 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+class QString;
+class QByteArray;
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	struct Filter;
+
+	/** @brief Loads the precompiled filter for the subscription file.
+	 *
+	 * The precompiled filters are kept in a versioned binary format in
+	 * the cache directory, one file per subscription, and are mapped
+	 * into memory for loading.
+	 *
+	 * The cached filter is only used if it has been saved for the same
+	 * subscription file contents (as identified by the contentsHash),
+	 * with the same cache format version and the same regexp engine.
+	 *
+	 * The subscription data of the filter is not restored.
+	 *
+	 * @param[in] filename The name of the subscription file.
+	 * @param[in] contentsHash The hash of the subscription file contents.
+	 * @param[out] filter The filter to load the items to.
+	 * @return Whether the filter has been loaded successfully.
+	 *
+	 * @sa SaveCachedFilter()
+	 */
+	bool LoadCachedFilter (const QString& filename, const QByteArray& contentsHash, Filter& filter);
+
+	/** @brief Saves the precompiled filter for the subscription file.
+	 *
+	 * @param[in] filename The name of the subscription file.
+	 * @param[in] contentsHash The hash of the subscription file contents.
+	 * @param[in] filter The filter parsed from the subscription file.
+	 *
+	 * @sa LoadCachedFilter()
+	 */
+	void SaveCachedFilter (const QString& filename, const QByteArray& contentsHash, const Filter& filter);
+
+	/** @brief Removes the precompiled filter for the subscription file.
+	 *
+	 * @param[in] filename The name of the subscription file.
+	 */
+	void RemoveCachedFilter (const QString& filename);
+}
+}
+}
@@ -0,0 +1,470 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filtermatcher.h"
+#include <algorithm>
+#include <QUrl>
+
+#if !defined (Q_OS_WIN32) && !defined (Q_OS_MAC)
+#include <fnmatch.h>
+#endif
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+#if defined (Q_OS_WIN32) || defined (Q_OS_MAC)
+		// Thanks for this goes to http://www.codeproject.com/KB/string/patmatch.aspx
+		bool WildcardMatches (const char *pattern, const char *str)
+		{
+			enum State {
+				Exact,        // exact match
+				Any,        // ?
+				AnyRepeat    // *
+			};
+
+			const char *s = str;
+			const char *p = pattern;
+			const char *q = 0;
+			int state = 0;
+
+			bool match = true;
+			while (match && *p) {
+				if (*p == '*') {
+					state = AnyRepeat;
+					q = p+1;
+				} else if (*p == '?') state = Any;
+				else state = Exact;
+
+				if (*s == 0) break;
+
+				switch (state) {
+					case Exact:
+						match = *s == *p;
+						s++;
+						p++;
+						break;
+
+					case Any:
+						match = true;
+						s++;
+						p++;
+						break;
+
+					case AnyRepeat:
+						match = true;
+						s++;
+
+						if (*s == *q) p++;
+						break;
+				}
+			}
+
+			if (state == AnyRepeat) return (*s == *q);
+			else if (state == Any) return (*s == *p);
+			else return match && (*s == *p);
+		}
+#else
+		bool WildcardMatches (const char *pat, const char *str)
+		{
+			return !fnmatch (pat, str, 0);
+		}
+#endif
+
+		bool IsSameOrSubdomain (const QString& domain, const QString& parent, Qt::CaseSensitivity cs)
+		{
+			if (!domain.endsWith (parent, cs))
+				return false;
+
+			const auto prefixLength = domain.size () - parent.size ();
+			return !prefixLength || domain.at (prefixLength - 1) == '.';
+		}
+	}
+
+	bool Matches (const FilterItem_ptr& item,
+			const QString& urlStr, const QByteArray& urlUtf8, const QString& domain)
+	{
+		const auto& opt = item->Option_;
+		if (opt.MatchObjects_ != FilterOption::MatchObject::All)
+		{
+			if (!(opt.MatchObjects_ & FilterOption::MatchObject::CSS) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Image) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Script) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::Object) &&
+					!(opt.MatchObjects_ & FilterOption::MatchObject::ObjSubrequest))
+				return false;
+		}
+
+		if (!opt.NotDomains_.isEmpty ())
+		{
+			for (const auto& notDomain : opt.NotDomains_)
+				if (IsSameOrSubdomain (domain, notDomain, opt.Case_))
+					return false;
+		}
+
+		if (!opt.Domains_.isEmpty ())
+		{
+			bool shouldFurther = false;
+			for (const auto& doDomain : opt.Domains_)
+				if (IsSameOrSubdomain (domain, doDomain, opt.Case_))
+				{
+					shouldFurther = true;
+					break;
+				}
+
+			if (!shouldFurther)
+				return false;
+		}
+
+		switch (opt.MatchType_)
+		{
+		case FilterOption::MTRegexp:
+			return item->RegExp_.Matches (urlStr);
+		case FilterOption::MTWildcard:
+			return WildcardMatches (item->PlainMatcher_.constData (), urlUtf8.constData ());
+		case FilterOption::MTPlain:
+			return urlUtf8.indexOf (item->PlainMatcher_) >= 0;
+		case FilterOption::MTBegin:
+			return urlStr.startsWith (QString::fromUtf8 (item->PlainMatcher_));
+		case FilterOption::MTEnd:
+			return urlStr.endsWith (QString::fromUtf8 (item->PlainMatcher_));
+		}
+
+		return false;
+	}
+
+	FilterMatcher::Request::Request (const QUrl& url, bool isForeign, FilterOption::MatchObjects objects)
+	: URL_ (url.toString ())
+	, URLUtf8_ (URL_.toUtf8 ())
+	, CinURL_ (URL_.toLower ())
+	, CinURLUtf8_ (CinURL_.toUtf8 ())
+	, Domain_ (url.host ())
+	, IsForeign_ (isForeign)
+	, Objects_ (objects)
+	{
+	}
+
+	namespace
+	{
+		const int GramSize = 4;
+
+		void AppendRun (QStringList& runs, QString& run)
+		{
+			if (run.size () >= GramSize)
+				runs << run;
+			run.clear ();
+		}
+
+		/* Returns the position of the ] closing the character class
+		 * opened at the given position, or the pattern size if there is
+		 * none. The text of the class is never literal, so it should
+		 * never end up in a run.
+		 */
+		int SkipClass (const QString& pattern, int pos)
+		{
+			++pos;
+			if (pos < pattern.size () && (pattern.at (pos) == '^' || pattern.at (pos) == '!'))
+				++pos;
+			if (pos < pattern.size () && pattern.at (pos) == ']')
+				++pos;
+
+			while (pos < pattern.size () && pattern.at (pos) != ']')
+			{
+				if (pattern.at (pos) == '\\')
+					++pos;
+				++pos;
+			}
+			return pos;
+		}
+
+		QStringList GetWildcardRuns (const QString& pattern)
+		{
+			QStringList runs;
+			QString run;
+			for (int i = 0; i < pattern.size (); ++i)
+				switch (pattern.at (i).unicode ())
+				{
+				case '[':
+					i = SkipClass (pattern, i);
+					AppendRun (runs, run);
+					break;
+				case '\\':
+					++i;
+					AppendRun (runs, run);
+					break;
+				case '*':
+				case '?':
+				case ']':
+					AppendRun (runs, run);
+					break;
+				default:
+					run += pattern.at (i);
+					break;
+				}
+			AppendRun (runs, run);
+			return runs;
+		}
+
+		/* Only the regexps generated by the LineParser from the
+		 * patterns containing the ^ separator are expected here, so
+		 * anything looking like alternation or grouping makes the
+		 * whole regexp unindexable.
+		 */
+		QStringList GetRegexpRuns (const QString& pattern)
+		{
+			static const QString unsupported { "|(){}" };
+			if (std::any_of (pattern.begin (), pattern.end (),
+					[] (QChar c) { return unsupported.contains (c); }))
+				return {};
+
+			QStringList runs;
+			QString run;
+			for (int i = 0; i < pattern.size (); ++i)
+				switch (pattern.at (i).unicode ())
+				{
+				case '*':
+				case '+':
+				case '?':
+					// The quantifier makes the previous char optional.
+					run.chop (1);
+					AppendRun (runs, run);
+					break;
+				case '[':
+					i = SkipClass (pattern, i);
+					AppendRun (runs, run);
+					break;
+				case '\\':
+					++i;
+					AppendRun (runs, run);
+					break;
+				case '.':
+				case '^':
+				case '$':
+					AppendRun (runs, run);
+					break;
+				default:
+					run += pattern.at (i);
+					break;
+				}
+			AppendRun (runs, run);
+			return runs;
+		}
+
+		QStringList GetLiteralRuns (const FilterItem& item)
+		{
+			if (item.PlainMatcher_.isEmpty ())
+				return {};
+
+			const auto& pattern = QString::fromUtf8 (item.PlainMatcher_);
+			switch (item.Option_.MatchType_)
+			{
+			case FilterOption::MTPlain:
+			case FilterOption::MTBegin:
+			case FilterOption::MTEnd:
+				return pattern.size () >= GramSize ? QStringList { pattern } : QStringList {};
+			case FilterOption::MTWildcard:
+				return GetWildcardRuns (pattern);
+			case FilterOption::MTRegexp:
+				return GetRegexpRuns (pattern);
+			}
+
+			return {};
+		}
+
+		QVector<quint64> GetGrams (const FilterItem& item)
+		{
+			QVector<quint64> grams;
+			for (const auto& run : GetLiteralRuns (item))
+			{
+				quint64 key = 0;
+				for (int i = 0; i < run.size (); ++i)
+				{
+					key = (key << 16) | run.at (i).unicode ();
+					if (i >= GramSize - 1)
+						grams << key;
+				}
+			}
+
+			std::sort (grams.begin (), grams.end ());
+			grams.erase (std::unique (grams.begin (), grams.end ()), grams.end ());
+			return grams;
+		}
+	}
+
+	FilterMatcher::FilterMatcher (const QList<FilterItem_ptr>& items)
+	{
+		QVector<QVector<quint64>> itemsGrams;
+		QHash<quint64, int> csCounts;
+		QHash<quint64, int> ciCounts;
+
+		for (const auto& item : items)
+		{
+			if (!item->Option_.HideSelector_.isEmpty ())
+				continue;
+
+			const auto& grams = GetGrams (*item);
+			auto& counts = item->Option_.Case_ == Qt::CaseSensitive ? csCounts : ciCounts;
+			for (const auto gram : grams)
+				++counts [gram];
+
+			Items_ << item;
+			itemsGrams << grams;
+		}
+
+		for (int i = 0; i < Items_.size (); ++i)
+		{
+			const auto& opt = Items_.at (i)->Option_;
+			const bool cs = opt.Case_ == Qt::CaseSensitive;
+			const auto& counts = cs ? csCounts : ciCounts;
+
+			const auto& grams = itemsGrams.at (i);
+			const auto rarest = grams.isEmpty () ?
+					0 :
+					*std::min_element (grams.begin (), grams.end (),
+						[&counts] (quint64 left, quint64 right)
+							{ return counts.value (left) < counts.value (right); });
+
+			auto addTo = [&] (Partition& partition)
+			{
+				auto& index = cs ? partition.CaseSensitive_ : partition.CaseInsensitive_;
+				if (grams.isEmpty ())
+					index.Generic_ << i;
+				else
+					index.Buckets_ [rarest] << i;
+			};
+
+			if (opt.Domains_.isEmpty ())
+				addTo (Global_);
+			else
+				for (const auto& domain : opt.Domains_)
+					addTo (ByDomain_ [domain.toLower ()]);
+		}
+	}
+
+	bool FilterMatcher::Matches (const Request& req) const
+	{
+		if (MatchesPartition (Global_, req))
+			return true;
+
+		if (ByDomain_.isEmpty ())
+			return false;
+
+		auto host = req.Domain_.toLower ();
+		while (!host.isEmpty ())
+		{
+			const auto pos = ByDomain_.find (host);
+			if (pos != ByDomain_.end () && MatchesPartition (*pos, req))
+				return true;
+
+			const auto dotPos = host.indexOf ('.');
+			if (dotPos == -1)
+				break;
+			host = host.mid (dotPos + 1);
+		}
+
+		return false;
+	}
+
+	int FilterMatcher::GetItemsCount () const
+	{
+		return Items_.size ();
+	}
+
+	int FilterMatcher::GetGenericItemsCount () const
+	{
+		auto count = [] (const Partition& part)
+		{
+			return part.CaseSensitive_.Generic_.size () + part.CaseInsensitive_.Generic_.size ();
+		};
+
+		int result = count (Global_);
+		for (const auto& part : ByDomain_)
+			result += count (part);
+		return result;
+	}
+
+	bool FilterMatcher::Check (int idx, const Request& req) const
+	{
+		const auto& item = Items_.at (idx);
+		const auto& opt = item->Option_;
+		if (opt.AbortForeign_ && req.IsForeign_)
+			return false;
+
+		if (opt.MatchObjects_ != FilterOption::MatchObject::All &&
+				req.Objects_ != FilterOption::MatchObject::All &&
+				!(req.Objects_ & opt.MatchObjects_))
+			return false;
+
+		const bool cs = opt.Case_ == Qt::CaseSensitive;
+		return CleanWeb::Matches (item,
+				cs ? req.URL_ : req.CinURL_,
+				cs ? req.URLUtf8_ : req.CinURLUtf8_,
+				req.Domain_);
+	}
+
+	bool FilterMatcher::MatchesPartition (const Partition& partition, const Request& req) const
+	{
+		return MatchesIndex (partition.CaseInsensitive_, req.CinURL_, req) ||
+				MatchesIndex (partition.CaseSensitive_, req.URL_, req);
+	}
+
+	bool FilterMatcher::MatchesIndex (const Index& index, const QString& url, const Request& req) const
+	{
+		for (const auto idx : index.Generic_)
+			if (Check (idx, req))
+				return true;
+
+		if (index.Buckets_.isEmpty ())
+			return false;
+
+		quint64 key = 0;
+		for (int i = 0; i < url.size (); ++i)
+		{
+			key = (key << 16) | url.at (i).unicode ();
+			if (i < GramSize - 1)
+				continue;
+
+			const auto pos = index.Buckets_.find (key);
+			if (pos == index.Buckets_.end ())
+				continue;
+
+			for (const auto idx : *pos)
+				if (Check (idx, req))
+					return true;
+		}
+
+		return false;
+	}
+}
+}
+}
@@ -0,0 +1,139 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QVector>
+#include "filter.h"
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	/** @brief Checks whether the single filter item matches the URL.
+	 *
+	 * The options of the item (domains, objects) are checked as well,
+	 * except the third-party flag and the request object types which are
+	 * checked by the FilterMatcher.
+	 *
+	 * @param[in] item The filter item to check.
+	 * @param[in] urlStr The URL, lowercased if the item is case
+	 * insensitive.
+	 * @param[in] urlUtf8 The UTF-8 representation of urlStr.
+	 * @param[in] domain The domain of the URL.
+	 * @return Whether the item matches.
+	 */
+	bool Matches (const FilterItem_ptr& item,
+			const QString& urlStr, const QByteArray& urlUtf8, const QString& domain);
+
+	/** @brief A compiled set of URL filter items.
+	 *
+	 * Instead of checking every filter item against every request, the
+	 * literal parts of the plain, begin, end and wildcard patterns (and
+	 * of the regexps generated from them by the LineParser) are indexed
+	 * by one of their 4-character substrings. Each item is indexed by
+	 * its substring that is the rarest among all the items in the set.
+	 *
+	 * When matching, each 4-character window of the URL is looked up in
+	 * the index, and only the items found this way are checked. Items
+	 * without long enough literal parts (including the user-supplied
+	 * regexps) are always checked.
+	 *
+	 * Items restricted to some domains are additionally partitioned by
+	 * those domains, so that only the partitions for the suffixes of
+	 * the request host (and the partition of the unrestricted items)
+	 * are looked at.
+	 */
+	class FilterMatcher
+	{
+	public:
+		struct Request
+		{
+			QString URL_;
+			QByteArray URLUtf8_;
+			QString CinURL_;
+			QByteArray CinURLUtf8_;
+
+			QString Domain_;
+			bool IsForeign_;
+			FilterOption::MatchObjects Objects_;
+
+			Request (const QUrl& url, bool isForeign, FilterOption::MatchObjects objects);
+		};
+	private:
+		QVector<FilterItem_ptr> Items_;
+
+		struct Index
+		{
+			QHash<quint64, QVector<int>> Buckets_;
+			QVector<int> Generic_;
+		};
+		struct Partition
+		{
+			Index CaseSensitive_;
+			Index CaseInsensitive_;
+		};
+		Partition Global_;
+		QHash<QString, Partition> ByDomain_;
+	public:
+		FilterMatcher () = default;
+
+		/** @brief Compiles the given filter items.
+		 *
+		 * Items with element hiding selectors are ignored.
+		 *
+		 * @param[in] items The filter items to compile.
+		 */
+		explicit FilterMatcher (const QList<FilterItem_ptr>& items);
+
+		/** @brief Checks whether any of the items matches the request.
+		 *
+		 * @param[in] req The request to check.
+		 * @return Whether any of the compiled items matches.
+		 */
+		bool Matches (const Request& req) const;
+
+		/** @brief Returns the number of compiled items.
+		 */
+		int GetItemsCount () const;
+
+		/** @brief Returns the number of items that are always checked.
+		 */
+		int GetGenericItemsCount () const;
+	private:
+		bool Check (int, const Request&) const;
+		bool MatchesPartition (const Partition&, const Request&) const;
+		bool MatchesIndex (const Index&, const QString&, const Request&) const;
+	};
+}
+}
+}
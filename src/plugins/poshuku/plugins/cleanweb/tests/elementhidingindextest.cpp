@@ -0,0 +1,113 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "elementhidingindextest.h"
+#include <algorithm>
+#include <QtTest>
+#include "elementhidingindex.h"
+#include "lineparser.h"
+
+QTEST_MAIN (LeechCraft::Poshuku::CleanWeb::ElementHidingIndexTest)
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+		ElementHidingIndex Compile (const QStringList& rules)
+		{
+			Filter f;
+			std::for_each (rules.begin (), rules.end (), LineParser (&f));
+			return ElementHidingIndex { f.Filters_ };
+		}
+
+		QSet<QString> Keys (const QStringList& list)
+		{
+			return list.toSet ();
+		}
+
+		QStringList Sorted (QStringList list)
+		{
+			list.sort ();
+			return list;
+		}
+	}
+
+	void ElementHidingIndexTest::testGeneric ()
+	{
+		const auto& index = Compile ({ "##div[id^=\"ad_\"]", "##table > tr.ad", "||ads.example.com^" });
+		QCOMPARE (Sorted (index.GetSelectors (QUrl { "http://example.com/" })),
+				(QStringList { "div[id^=\"ad_\"]", "table > tr.ad" }));
+		QCOMPARE (index.GetGenericCount (), 2);
+	}
+
+	void ElementHidingIndexTest::testDomains ()
+	{
+		const auto& index = Compile ({ "example.com##.banner", "example.org,example.net###top" });
+		QCOMPARE (index.GetSelectors (QUrl { "http://example.com/" }), QStringList { ".banner" });
+		QCOMPARE (index.GetSelectors (QUrl { "http://www.Example.com/page" }), QStringList { ".banner" });
+		QCOMPARE (index.GetSelectors (QUrl { "http://notexample.com/" }), QStringList {});
+		QCOMPARE (index.GetSelectors (QUrl { "http://example.net/" }), QStringList { "#top" });
+		QCOMPARE (index.GetSelectors (QUrl { "http://example.org/" }), QStringList { "#top" });
+		QCOMPARE (index.GetSelectors (Keys ({ "top" }), Keys ({ "banner" })), QStringList {});
+		QCOMPARE (index.GetGenericCount (), 0);
+	}
+
+	void ElementHidingIndexTest::testKeyed ()
+	{
+		const auto& index = Compile ({ "###ad_top", "##.advert", "##div.sponsored > a", "##a#promo" });
+		QCOMPARE (index.GetSelectors (QUrl { "http://example.com/" }), QStringList {});
+		QCOMPARE (index.GetGenericCount (), 0);
+
+		QCOMPARE (index.GetSelectors (Keys ({}), Keys ({})), QStringList {});
+		QCOMPARE (index.GetSelectors (Keys ({ "ad_top" }), Keys ({})), QStringList { "#ad_top" });
+		QCOMPARE (index.GetSelectors (Keys ({ "promo" }), Keys ({ "sponsored" })),
+				(QStringList { "a#promo", "div.sponsored > a" }));
+		QCOMPARE (index.GetSelectors (Keys ({ "advert" }), Keys ({ "ad_top" })), QStringList {});
+	}
+
+	void ElementHidingIndexTest::testUrlPatterns ()
+	{
+		const auto& index = Compile ({ "/forum/*##.signature" });
+		QCOMPARE (index.GetSelectors (QUrl { "http://example.com/forum/thread" }), QStringList { ".signature" });
+		QCOMPARE (index.GetSelectors (QUrl { "http://example.com/news/" }), QStringList {});
+		QCOMPARE (index.GetGenericCount (), 1);
+	}
+
+	void ElementHidingIndexTest::testStylesheet ()
+	{
+		const auto& css = ElementHidingIndex::MakeStylesheet ({ ".ad", "div } body {", "#top" });
+		QCOMPARE (css, QString { ".ad { visibility: hidden !important; }\n#top { visibility: hidden !important; }\n" });
+	}
+}
+}
+}
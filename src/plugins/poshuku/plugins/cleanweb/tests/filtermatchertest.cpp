@@ -0,0 +1,307 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "filtermatchertest.h"
+#include <algorithm>
+#include <QtTest>
+#include <QFile>
+#include <QElapsedTimer>
+#include "filtermatcher.h"
+#include "lineparser.h"
+
+QTEST_MAIN (LeechCraft::Poshuku::CleanWeb::FilterMatcherTest)
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+namespace CleanWeb
+{
+	namespace
+	{
+		FilterMatcher Compile (const QStringList& rules)
+		{
+			Filter f;
+			std::for_each (rules.begin (), rules.end (), LineParser (&f));
+			return FilterMatcher { f.Filters_ };
+		}
+
+		bool Matches (const FilterMatcher& matcher, const QString& url)
+		{
+			return matcher.Matches ({ QUrl { url }, false, FilterOption::MatchObject::All });
+		}
+
+		bool MatchesLinear (const QList<FilterItem_ptr>& items, const FilterMatcher::Request& req)
+		{
+			for (const auto& item : items)
+			{
+				const auto& opt = item->Option_;
+				if (!opt.HideSelector_.isEmpty ())
+					continue;
+				if (opt.AbortForeign_ && req.IsForeign_)
+					continue;
+
+				const bool cs = opt.Case_ == Qt::CaseSensitive;
+				if (CleanWeb::Matches (item,
+						cs ? req.URL_ : req.CinURL_,
+						cs ? req.URLUtf8_ : req.CinURLUtf8_,
+						req.Domain_))
+					return true;
+			}
+			return false;
+		}
+
+#if QT_VERSION < 0x050000
+#define SKIP_TEST(msg) QSKIP (msg, SkipSingle)
+#else
+#define SKIP_TEST(msg) QSKIP (msg)
+#endif
+
+		const QStringList TestUrls
+		{
+			"http://example.com/",
+			"http://example.com/index.html",
+			"http://ads.example.com/banner.gif",
+			"http://example.com/ads/banner.gif",
+			"http://example.com/images/advert_top.png",
+			"http://doubleclick.net/pixel?id=10",
+			"http://ad.doubleclick.net/adj/site;sz=728x90",
+			"http://notdoubleclick.net/",
+			"http://static.example.org/js/tracker.js",
+			"http://static.example.org/js/Tracker.js",
+			"http://cdn.example.org/widget/social-share.js?v=2",
+			"https://www.google-analytics.com/analytics.js",
+			"http://example.com/page.swf",
+			"http://example.com/page.swf.html",
+			"http://example.net/a/b/c/d/e/f/g/h/i/j/k/l/m/n/o/p",
+			"http://example.net/?utm_source=feed&utm_medium=rss"
+		};
+	}
+
+	void FilterMatcherTest::testPlain ()
+	{
+		const auto& matcher = Compile ({ "/ads/banner" });
+		QCOMPARE (Matches (matcher, "http://example.com/ads/banner.gif"), true);
+		QCOMPARE (Matches (matcher, "http://example.com/ads/other.gif"), false);
+		QCOMPARE (matcher.GetGenericItemsCount (), 0);
+	}
+
+	void FilterMatcherTest::testBeginEnd ()
+	{
+		const auto& matcher = Compile ({ "|http://ads.", ".swf|" });
+		QCOMPARE (Matches (matcher, "http://ads.example.com/banner.gif"), true);
+		QCOMPARE (Matches (matcher, "http://example.com/http://ads.x"), false);
+		QCOMPARE (Matches (matcher, "http://example.com/page.swf"), true);
+		QCOMPARE (Matches (matcher, "http://example.com/page.swf.html"), false);
+	}
+
+	void FilterMatcherTest::testWildcard ()
+	{
+		const auto& matcher = Compile ({ "/images/*advert" });
+		QCOMPARE (Matches (matcher, "http://example.com/images/top/advert.png"), true);
+		QCOMPARE (Matches (matcher, "http://example.com/img/advert.png"), false);
+		QCOMPARE (matcher.GetGenericItemsCount (), 0);
+	}
+
+	void FilterMatcherTest::testSeparator ()
+	{
+		if (!Util::RegExp::IsFast ())
+			SKIP_TEST ("separator rules are only supported with fast regexps");
+
+		const auto& matcher = Compile ({ "/pixel^" });
+		QCOMPARE (Matches (matcher, "http://doubleclick.net/pixel?id=10"), true);
+		QCOMPARE (Matches (matcher, "http://doubleclick.net/pixels"), false);
+	}
+
+	void FilterMatcherTest::testDomainAnchor ()
+	{
+		if (!Util::RegExp::IsFast ())
+			SKIP_TEST ("separator rules are only supported with fast regexps");
+
+		const auto& matcher = Compile ({ "||doubleclick.net^" });
+		QCOMPARE (Matches (matcher, "http://ad.doubleclick.net/adj/site"), true);
+		QCOMPARE (Matches (matcher, "http://doubleclick.net/pixel"), true);
+		QCOMPARE (Matches (matcher, "http://doubleclick.network/"), false);
+	}
+
+	void FilterMatcherTest::testCaseSensitivity ()
+	{
+		const auto& matcher = Compile ({ "/Tracker.js$match-case" });
+		QCOMPARE (Matches (matcher, "http://example.org/js/Tracker.js"), true);
+		QCOMPARE (Matches (matcher, "http://example.org/js/tracker.js"), false);
+
+		const auto& ciMatcher = Compile ({ "/Tracker.js" });
+		QCOMPARE (Matches (ciMatcher, "http://example.org/js/tracker.js"), true);
+	}
+
+	void FilterMatcherTest::testShortPatterns ()
+	{
+		const auto& matcher = Compile ({ "-ad", "?a=" });
+		QCOMPARE (matcher.GetGenericItemsCount (), 2);
+		QCOMPARE (Matches (matcher, "http://example.com/top-ad.png"), true);
+		QCOMPARE (Matches (matcher, "http://example.com/?a=1"), true);
+		QCOMPARE (Matches (matcher, "http://example.com/"), false);
+	}
+
+	void FilterMatcherTest::testUserRegexp ()
+	{
+		const auto& matcher = Compile ({ "/banner[0-9]+\\.gif/" });
+		QCOMPARE (matcher.GetGenericItemsCount (), 1);
+		QCOMPARE (Matches (matcher, "http://example.com/banner42.gif"), true);
+		QCOMPARE (Matches (matcher, "http://example.com/banner.gif"), false);
+	}
+
+	void FilterMatcherTest::testCharacterClass ()
+	{
+		// The classes are the only long enough runs of these rules.
+		const QStringList rules { "/ad[vwxyz]b*", "/ad[!abcd]c*" };
+
+		Filter f;
+		std::for_each (rules.begin (), rules.end (), LineParser (&f));
+		const FilterMatcher matcher { f.Filters_ };
+		QCOMPARE (matcher.GetGenericItemsCount (), 2);
+
+		const QStringList urls
+		{
+			"http://example.com/advbanner.png",
+			"http://example.com/adqbanner.png",
+			"http://example.com/vwxyzb.png",
+			"http://example.com/adxcounter.png",
+			"http://example.com/adacounter.png"
+		};
+		for (const auto& url : urls)
+		{
+			const FilterMatcher::Request req { QUrl { url }, false, FilterOption::MatchObject::All };
+			QCOMPARE (matcher.Matches (req), MatchesLinear (f.Filters_, req));
+		}
+
+#if !defined (Q_OS_WIN32) && !defined (Q_OS_MAC)
+		QCOMPARE (Matches (matcher, "http://example.com/advbanner.png"), true);
+		QCOMPARE (Matches (matcher, "http://example.com/adxcounter.png"), true);
+#endif
+	}
+
+	void FilterMatcherTest::testDomains ()
+	{
+		const auto& matcher = Compile ({ "/ads/$domain=example.com", "/banner/$domain=~example.com" });
+		QCOMPARE (Matches (matcher, "http://example.com/ads/top.png"), true);
+		QCOMPARE (Matches (matcher, "http://cdn.example.com/ads/top.png"), true);
+		QCOMPARE (Matches (matcher, "http://example.org/ads/top.png"), false);
+		QCOMPARE (Matches (matcher, "http://notexample.com/ads/top.png"), false);
+
+		QCOMPARE (Matches (matcher, "http://example.org/banner/top.png"), true);
+		QCOMPARE (Matches (matcher, "http://cdn.example.com/banner/top.png"), false);
+		QCOMPARE (Matches (matcher, "http://badexample.com/banner/top.png"), true);
+	}
+
+	void FilterMatcherTest::testSameAsLinear ()
+	{
+		const QStringList rules
+		{
+			"/ads/*",
+			"||doubleclick.net^",
+			"|http://ads.",
+			".swf|",
+			"/images/*advert",
+			"/Tracker.js$match-case",
+			"social-share.js?",
+			"google-analytics.com/analytics.js",
+			"/pixel^",
+			"-ad-",
+			"utm_source=",
+			"/banner[0-9]+\\.gif/",
+			"||example.net^*/m/n/",
+			"/js/$domain=example.org",
+			"/widget/$domain=~cdn.example.org"
+		};
+
+		Filter f;
+		std::for_each (rules.begin (), rules.end (), LineParser (&f));
+		const FilterMatcher matcher { f.Filters_ };
+
+		for (const auto& url : TestUrls)
+		{
+			const FilterMatcher::Request req { QUrl { url }, false, FilterOption::MatchObject::All };
+			QCOMPARE (matcher.Matches (req), MatchesLinear (f.Filters_, req));
+		}
+	}
+
+	/* Set the CLEANWEB_EASYLIST environment variable to the path of an
+	 * EasyList snapshot to run this benchmark.
+	 */
+	void FilterMatcherTest::benchmarkEasyList ()
+	{
+		const auto& path = QString::fromLocal8Bit (qgetenv ("CLEANWEB_EASYLIST"));
+		if (path.isEmpty ())
+			SKIP_TEST ("CLEANWEB_EASYLIST is not set");
+
+		QFile file { path };
+		if (!file.open (QIODevice::ReadOnly))
+			QFAIL (qPrintable (file.errorString ()));
+
+		auto lines = QString::fromUtf8 (file.readAll ()).split ('\n', QString::SkipEmptyParts);
+		if (!lines.isEmpty ())
+			lines.removeFirst ();
+
+		Filter f;
+		LineParser parser { &f };
+		for (const auto& line : lines)
+			parser (line.trimmed ());
+
+		QElapsedTimer compileTimer;
+		compileTimer.start ();
+		const FilterMatcher matcher { f.Filters_ };
+		qDebug () << "compiled"
+				<< matcher.GetItemsCount ()
+				<< "items in"
+				<< compileTimer.elapsed ()
+				<< "ms;"
+				<< matcher.GetGenericItemsCount ()
+				<< "are generic";
+
+		QList<FilterMatcher::Request> requests;
+		for (const auto& url : TestUrls)
+			requests.append ({ QUrl { url }, true, FilterOption::MatchObject::All });
+
+		int rounds = 0;
+		QElapsedTimer timer;
+		timer.start ();
+		QBENCHMARK
+		{
+			for (const auto& req : requests)
+				matcher.Matches (req);
+			++rounds;
+		}
+
+		const auto elapsed = std::max<qint64> (timer.elapsed (), 1);
+		qDebug () << rounds * requests.size () * 1000 / elapsed << "matches per second";
+	}
+}
+}
+}
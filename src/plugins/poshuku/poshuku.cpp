@@ -301,6 +301,11 @@ namespace Poshuku
 		Core::Instance ().Handle (e);
 	}
 
+	EntityRoutingKeys Poshuku::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/browser-import-data" }, { "http", "https" }, {}, {} };
+	}
+
 	void Poshuku::Open (const QString& link)
 	{
 		Core::Instance ().NewURL (link);
@@ -44,6 +44,7 @@
 #include <interfaces/ihaveshortcuts.h>
 #include <interfaces/ihavediaginfo.h>
 #include <interfaces/ihaverecoverabletabs.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 #include <xmlsettingsdialog/xmlsettingsdialog.h>
 #include "browserwidget.h"
 
@@ -62,6 +63,7 @@ namespace Poshuku
 					, public IWebBrowser
 					, public IActionsExporter
 					, public IHaveRecoverableTabs
+					, public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
 		Q_INTERFACES (IInfo
@@ -73,7 +75,8 @@ namespace Poshuku
 				IHaveShortcuts
 				IHaveDiagInfo
 				IActionsExporter
-				IHaveRecoverableTabs)
+				IHaveRecoverableTabs
+				IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.Poshuku")
 
@@ -110,6 +113,8 @@ namespace Poshuku
 		EntityTestHandleResult CouldHandle (const LeechCraft::Entity&) const;
 		void Handle (LeechCraft::Entity);
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 		void Open (const QString&);
 		IWebWidget* GetWidget () const;
 		QWebView* CreateWindow ();
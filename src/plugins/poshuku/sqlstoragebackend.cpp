@@ -227,6 +227,9 @@ namespace Poshuku
 				break;
 		}
 
+		HistoryOldestLoader_ = QSqlQuery (DB_);
+		HistoryOldestLoader_.prepare ("SELECT MIN(date) FROM history");
+
 		FavoritesLoader_ = QSqlQuery (DB_);
 		switch (Type_)
 		{
@@ -356,23 +359,49 @@ namespace Poshuku
 
 	void SQLStorageBackend::ClearOldHistory (int age, int items)
 	{
-		LeechCraft::Util::DBLock lock (DB_);
-		lock.Init ();
-		HistoryEraser_.bindValue (":age", age);
-		HistoryTruncater_.bindValue (":num", items);
-
-		if (!HistoryEraser_.exec ())
-		{
-			LeechCraft::Util::DBLock::DumpError (HistoryEraser_);
-			return;
-		}
-		if (!HistoryTruncater_.exec ())
+		bool removed = false;
+		QDateTime oldest;
 		{
-			LeechCraft::Util::DBLock::DumpError (HistoryTruncater_);
-			return;
+			LeechCraft::Util::DBLock lock (DB_);
+			lock.Init ();
+			HistoryEraser_.bindValue (":age", age);
+			HistoryTruncater_.bindValue (":num", items);
+
+			if (!HistoryEraser_.exec ())
+			{
+				LeechCraft::Util::DBLock::DumpError (HistoryEraser_);
+				return;
+			}
+			if (!HistoryTruncater_.exec ())
+			{
+				LeechCraft::Util::DBLock::DumpError (HistoryTruncater_);
+				return;
+			}
+
+			removed = HistoryEraser_.numRowsAffected () > 0 ||
+					HistoryTruncater_.numRowsAffected () > 0;
+			if (removed)
+			{
+				if (!HistoryOldestLoader_.exec ())
+				{
+					LeechCraft::Util::DBLock::DumpError (HistoryOldestLoader_);
+					return;
+				}
+
+				// Both queries remove everything older than the oldest
+				// kept visit, or the whole history if nothing is kept.
+				if (HistoryOldestLoader_.next ())
+					oldest = HistoryOldestLoader_.value (0).toDateTime ();
+				HistoryOldestLoader_.finish ();
+				if (!oldest.isValid ())
+					oldest = QDateTime::currentDateTime ();
+			}
+
+			lock.Good ();
 		}
 
-		lock.Good ();
+		if (removed)
+			emit historyRemoved (oldest);
 	}
 
 	void SQLStorageBackend::LoadFavorites (
@@ -73,6 +73,10 @@ namespace Poshuku
 					* - items
 					*/
 				HistoryTruncater_,
+				/** Returns:
+					* - date
+					*/
+				HistoryOldestLoader_,
 				/** Returns:
 					* - title
 					* - url
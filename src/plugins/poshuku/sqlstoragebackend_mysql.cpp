@@ -120,6 +120,9 @@ namespace Poshuku
 				"(SELECT date FROM history ORDER BY date DESC "
 				"LIMIT 10000 OFFSET ?)");
 
+		HistoryOldestLoader_ = QSqlQuery (DB_);
+		HistoryOldestLoader_.prepare ("SELECT MIN(date) FROM history");
+
 		FavoritesLoader_ = QSqlQuery (DB_);
 		FavoritesLoader_.prepare ("SELECT "
 				"title, "
@@ -232,23 +235,49 @@ namespace Poshuku
 
 	void SQLStorageBackendMysql::ClearOldHistory (int age, int items)
 	{
-		LeechCraft::Util::DBLock lock (DB_);
-		lock.Init ();
-		HistoryEraser_.bindValue (0, age);
-		HistoryTruncater_.bindValue (1, items);
-
-		if (!HistoryEraser_.exec ())
-		{
-			LeechCraft::Util::DBLock::DumpError (HistoryEraser_);
-			return;
-		}
-		if (!HistoryTruncater_.exec ())
+		bool removed = false;
+		QDateTime oldest;
 		{
-			LeechCraft::Util::DBLock::DumpError (HistoryTruncater_);
-			return;
+			LeechCraft::Util::DBLock lock (DB_);
+			lock.Init ();
+			HistoryEraser_.bindValue (0, age);
+			HistoryTruncater_.bindValue (1, items);
+
+			if (!HistoryEraser_.exec ())
+			{
+				LeechCraft::Util::DBLock::DumpError (HistoryEraser_);
+				return;
+			}
+			if (!HistoryTruncater_.exec ())
+			{
+				LeechCraft::Util::DBLock::DumpError (HistoryTruncater_);
+				return;
+			}
+
+			removed = HistoryEraser_.numRowsAffected () > 0 ||
+					HistoryTruncater_.numRowsAffected () > 0;
+			if (removed)
+			{
+				if (!HistoryOldestLoader_.exec ())
+				{
+					LeechCraft::Util::DBLock::DumpError (HistoryOldestLoader_);
+					return;
+				}
+
+				// Both queries remove everything older than the oldest
+				// kept visit, or the whole history if nothing is kept.
+				if (HistoryOldestLoader_.next ())
+					oldest = HistoryOldestLoader_.value (0).toDateTime ();
+				HistoryOldestLoader_.finish ();
+				if (!oldest.isValid ())
+					oldest = QDateTime::currentDateTime ();
+			}
+
+			lock.Good ();
 		}
 
-		lock.Good ();
+		if (removed)
+			emit historyRemoved (oldest);
 	}
 
 	void SQLStorageBackendMysql::LoadFavorites (
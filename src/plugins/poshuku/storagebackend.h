@@ -101,6 +101,10 @@ namespace Poshuku
 			*
 			* @param[in] days Maximum age of an item.
 			* @param[in] items How much items should be kept at most.
+			*
+			* Emits historyRemoved() with the date of the oldest kept item
+			* if some items have been removed: every item older than that
+			* date is gone then.
 			*/
 		virtual void ClearOldHistory (int days, int items) = 0;
 
@@ -157,6 +161,7 @@ namespace Poshuku
 		virtual bool GetFormsIgnored (const QString& url) const = 0;
 	signals:
 		void added (const HistoryItem&);
+		void historyRemoved (const QDateTime& oldest);
 		void added (const FavoritesModel::FavoritesItem&);
 		void updated (const FavoritesModel::FavoritesItem&);
 		void removed (const FavoritesModel::FavoritesItem&);
@@ -0,0 +1,208 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "historyindextest.h"
+#include <QtTest>
+#include "historyindex.h"
+
+QTEST_MAIN (LeechCraft::Poshuku::HistoryIndexTest)
+
+namespace LeechCraft
+{
+namespace Poshuku
+{
+	namespace
+	{
+		const auto Limit = 100;
+
+		history_items_t Find (HistoryIndex& index, const QString& base, int limit = Limit)
+		{
+			return index.Find (base, limit, [] { return false; });
+		}
+
+		QStringList URLs (const history_items_t& items)
+		{
+			QStringList result;
+			for (const auto& item : items)
+				result << item.URL_;
+			return result;
+		}
+
+		HistoryItem MakeItem (const QString& title, const QString& url, int daysAgo = 0)
+		{
+			return { title, QDateTime::currentDateTime ().addDays (-daysAgo), url };
+		}
+	}
+
+	void HistoryIndexTest::testPrefix ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("Kittens and puppies", "http://example.com/pets"));
+
+		QCOMPARE (URLs (Find (index, "kit")), QStringList { "http://example.com/pets" });
+		QCOMPARE (URLs (Find (index, "KITTENS")), QStringList { "http://example.com/pets" });
+		QCOMPARE (URLs (Find (index, "exam")), QStringList { "http://example.com/pets" });
+		QCOMPARE (Find (index, "ittens").size (), 0);
+		QCOMPARE (Find (index, "kittensx").size (), 0);
+	}
+
+	void HistoryIndexTest::testMultipleWords ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("Kittens and puppies", "http://example.com/pets"));
+		index.Add (MakeItem ("Kittens only", "http://example.org/cats"));
+
+		QCOMPARE (URLs (Find (index, "pup kit")), QStringList { "http://example.com/pets" });
+		QCOMPARE (URLs (Find (index, "kit cats")), QStringList { "http://example.org/cats" });
+		QCOMPARE (Find (index, "kit").size (), 2);
+		QCOMPARE (Find (index, "pup cats").size (), 0);
+	}
+
+	void HistoryIndexTest::testEmptyQuery ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("First", "http://example.com/1"));
+		index.Add (MakeItem ("Second", "http://example.com/2"));
+
+		QCOMPARE (Find (index, QString ()).size (), 2);
+	}
+
+	void HistoryIndexTest::testRanking ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("Rare page", "http://example.com/rare", 0));
+		index.Add (history_items_t {
+				MakeItem ("Frequent page", "http://example.com/frequent", 1),
+				MakeItem ("Frequent page", "http://example.com/frequent", 2),
+				MakeItem ("Frequent page", "http://example.com/frequent", 3)
+			});
+		index.Add (MakeItem ("Old page", "http://example.com/old", 200));
+
+		const QStringList expected
+		{
+			"http://example.com/frequent",
+			"http://example.com/rare",
+			"http://example.com/old"
+		};
+		QCOMPARE (URLs (Find (index, "page")), expected);
+	}
+
+	void HistoryIndexTest::testRecency ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("Older page", "http://example.com/older", 2));
+		index.Add (MakeItem ("Newer page", "http://example.com/newer", 1));
+
+		const QStringList expected
+		{
+			"http://example.com/newer",
+			"http://example.com/older"
+		};
+		QCOMPARE (URLs (Find (index, "page")), expected);
+	}
+
+	void HistoryIndexTest::testLimit ()
+	{
+		HistoryIndex index;
+		for (int i = 0; i < 10; ++i)
+			index.Add (MakeItem ("Page", QString ("http://example.com/%1").arg (i), i));
+
+		const auto& found = Find (index, "page", 3);
+		QCOMPARE (found.size (), 3);
+		QCOMPARE (found.at (0).URL_, QString ("http://example.com/0"));
+	}
+
+	void HistoryIndexTest::testTitleUpdate ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("Current title", "http://example.com/page", 1));
+		index.Add (MakeItem ("Stale title", "http://example.com/page", 5));
+
+		auto found = Find (index, "title");
+		QCOMPARE (found.size (), 1);
+		QCOMPARE (found.at (0).Title_, QString ("Current title"));
+		QCOMPARE (Find (index, "stale").size (), 0);
+
+		index.Add (MakeItem ("Renamed page", "http://example.com/page"));
+		found = Find (index, "renamed");
+		QCOMPARE (found.size (), 1);
+		QCOMPARE (found.at (0).Title_, QString ("Renamed page"));
+		QCOMPARE (Find (index, "current").size (), 0);
+	}
+
+	void HistoryIndexTest::testCancellation ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("Kittens", "http://example.com/pets"));
+
+		int checks = 0;
+		const auto& cancelled = index.Find ("kit", Limit,
+				[&checks] { ++checks; return true; });
+		QCOMPARE (cancelled.size (), 0);
+		QVERIFY (checks > 0);
+
+		QCOMPARE (Find (index, "kit").size (), 1);
+	}
+
+	void HistoryIndexTest::testClear ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("Expired page", "http://example.com/expired"));
+		QCOMPARE (Find (index, "page").size (), 1);
+
+		index.Add (MakeItem ("Pending page", "http://example.com/pending"));
+		index.Clear ();
+		index.Add (MakeItem ("Kept page", "http://example.com/kept"));
+
+		QCOMPARE (URLs (Find (index, "page")), QStringList { "http://example.com/kept" });
+	}
+
+	void HistoryIndexTest::testPrune ()
+	{
+		HistoryIndex index;
+		index.Add (MakeItem ("Recent page", "http://example.com/recent", 1));
+		index.Add (MakeItem ("Revisited page", "http://example.com/revisited", 2));
+		index.Add (MakeItem ("Revisited page", "http://example.com/revisited", 20));
+		index.Add (MakeItem ("Expired page", "http://example.com/expired", 20));
+		QCOMPARE (Find (index, "page").size (), 3);
+
+		index.Add (MakeItem ("Pending page", "http://example.com/pending", 30));
+		index.Prune (QDateTime::currentDateTime ().addDays (-10));
+
+		QCOMPARE (URLs (Find (index, "page")),
+				(QStringList { "http://example.com/revisited", "http://example.com/recent" }));
+		QCOMPARE (Find (index, "expired").size (), 0);
+		QCOMPARE (Find (index, "revisited").size (), 1);
+
+		index.Add (MakeItem ("Another recent page", "http://example.com/another"));
+		QCOMPARE (Find (index, "another").size (), 1);
+		QCOMPARE (Find (index, "page").size (), 3);
+	}
+}
+}
@@ -28,22 +28,31 @@
  **********************************************************************/
 
 #include "urlcompletionmodel.h"
-#include <stdexcept>
 #include <QUrl>
 #include <QTimer>
 #include <QApplication>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 #include <QtDebug>
 #include <util/xpc/defaulthookproxy.h>
 #include <interfaces/core/icoreproxy.h>
 #include "core.h"
+#include "historyindex.h"
 
 namespace LeechCraft
 {
 namespace Poshuku
 {
+	namespace
+	{
+		const auto MaxHistoryItems = 100;
+	}
+
 	URLCompletionModel::URLCompletionModel (QObject *parent)
 	: QAbstractItemModel { parent }
 	, ValidateTimer_ { new QTimer { this } }
+	, Index_ { std::make_shared<HistoryIndex> () }
+	, Generation_ { std::make_shared<std::atomic_int> (0) }
 	{
 		ValidateTimer_->setSingleShot (true);
 		connect (ValidateTimer_,
@@ -125,7 +134,7 @@ namespace Poshuku
 
 	void URLCompletionModel::setBase (const QString& str)
 	{
-		Valid_ = false;
+		++*Generation_;
 		Base_ = str;
 
 		ValidateTimer_->stop ();
@@ -134,8 +143,76 @@ namespace Poshuku
 
 	void URLCompletionModel::validate ()
 	{
-		PopulateNonHook ();
+		const int generation = ++*Generation_;
+
+		if (Base_.startsWith ('!'))
+		{
+			auto cats = Core::Instance ().GetProxy ()->GetSearchCategories ();
+			cats.sort ();
+
+			history_items_t items;
+			for (const auto& cat : cats)
+				items.push_back ({ cat, {}, "!" + cat });
+
+			PopulateNonHook (items);
+			RequestHookItems ();
+			return;
+		}
+
+		const auto watcher = new QFutureWatcher<history_items_t> { this };
+		watcher->setProperty ("Generation", generation);
+		connect (watcher,
+				SIGNAL (finished ()),
+				this,
+				SLOT (handleHistoryFound ()));
+
+		const auto index = Index_;
+		const auto counter = Generation_;
+		const auto base = Base_;
+		watcher->setFuture (QtConcurrent::run ([index, counter, generation, base]
+				{
+					return index->Find (base, MaxHistoryItems,
+							[counter, generation] { return *counter != generation; });
+				}));
+	}
+
+	void URLCompletionModel::handleHistoryFound ()
+	{
+		const auto watcher = dynamic_cast<QFutureWatcher<history_items_t>*> (sender ());
+		watcher->deleteLater ();
+
+		if (watcher->property ("Generation").toInt () != *Generation_)
+			return;
+
+		PopulateNonHook (watcher->result ());
+		RequestHookItems ();
+	}
+
+	void URLCompletionModel::handleItemAdded (const HistoryItem& item)
+	{
+		Index_->Add (item);
+	}
+
+	void URLCompletionModel::handleHistoryLoaded (const history_items_t& items)
+	{
+		Index_->Clear ();
+		Index_->Add (items);
+	}
+
+	void URLCompletionModel::handleHistoryRemoved (const QDateTime& oldest)
+	{
+		Index_->Prune (oldest);
+	}
+
+	void URLCompletionModel::PopulateNonHook (const history_items_t& items)
+	{
+		beginResetModel ();
+		Items_ = items;
+		endResetModel ();
+	}
 
+	void URLCompletionModel::RequestHookItems ()
+	{
 		Util::DefaultHookProxy_ptr proxy (new Util::DefaultHookProxy);
 		int size = Items_.size ();
 		emit hookURLCompletionNewStringRequested (proxy, this, Base_, size);
@@ -153,52 +230,6 @@ namespace Poshuku
 			Items_ = newItems;
 		}
 	}
-
-	void URLCompletionModel::handleItemAdded (const HistoryItem&)
-	{
-		Valid_ = false;
-	}
-
-	void URLCompletionModel::PopulateNonHook ()
-	{
-		if (Valid_)
-			return;
-
-		Valid_ = true;
-
-		int size = Items_.size () - 1;
-		if (size > 0)
-			beginRemoveRows ({}, 0, size);
-		Items_.clear ();
-		if (size > 0)
-			endRemoveRows ();
-
-		if (Base_.startsWith ('!'))
-		{
-			auto cats = Core::Instance ().GetProxy ()->GetSearchCategories ();
-			cats.sort ();
-			for (const auto& cat : cats)
-				Items_.push_back ({ cat, {}, "!" + cat });
-		}
-		else
-		{
-			try
-			{
-				Core::Instance ().GetStorageBackend ()->LoadResemblingHistory (Base_, Items_);
-			}
-			catch (const std::runtime_error& e)
-			{
-				qWarning () << Q_FUNC_INFO << e.what ();
-				Valid_ = false;
-			}
-		}
-
-		size = Items_.size () - 1;
-		if (size >= 0)
-		{
-			beginInsertRows ({}, 0, size);
-			endInsertRows ();
-		}
-	}
+}
 }
 }
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <memory>
+#include <atomic>
 #include <QAbstractItemModel>
 #include <interfaces/core/ihookproxy.h>
 #include <interfaces/poshuku/iurlcompletionmodel.h>
@@ -40,18 +42,26 @@ namespace LeechCraft
 {
 namespace Poshuku
 {
+	class HistoryIndex;
+
 	class URLCompletionModel : public QAbstractItemModel
 							 , public IURLCompletionModel
 	{
 		Q_OBJECT
 		Q_INTERFACES (LeechCraft::Poshuku::IURLCompletionModel)
 
-		mutable bool Valid_ = false;
 		mutable history_items_t Items_;
 
 		QString Base_;
 
 		QTimer * const ValidateTimer_;
+
+		const std::shared_ptr<HistoryIndex> Index_;
+
+		/** Incremented on each new completion request, so that the
+		 * superseded searches stop and their results are dropped.
+		 */
+		const std::shared_ptr<std::atomic_int> Generation_;
 	public:
 		enum
 		{
@@ -71,12 +81,16 @@ namespace Poshuku
 
 		void AddItem (const QString& title, const QString& url, size_t pos);
 	private:
-		void PopulateNonHook ();
+		void PopulateNonHook (const history_items_t&);
+		void RequestHookItems ();
 	private slots:
 		void validate ();
+		void handleHistoryFound ();
 	public slots:
 		void setBase (const QString&);
 		void handleItemAdded (const HistoryItem&);
+		void handleHistoryLoaded (const history_items_t&);
+		void handleHistoryRemoved (const QDateTime&);
 	signals:
 		// Plugin API
 		void hookURLCompletionNewStringRequested (LeechCraft::IHookProxy_ptr proxy,
@@ -84,6 +84,16 @@ namespace Sysnotify
 	{
 		Manager_->HandleNotification (e);
 	}
+
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/notification" }, {}, {} };
+	}
+
+	bool Plugin::IsInstantiationDeferrable () const
+	{
+		return true;
+	}
 }
 }
 
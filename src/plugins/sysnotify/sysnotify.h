@@ -32,6 +32,7 @@
 #include <QObject>
 #include <interfaces/iinfo.h>
 #include <interfaces/ientityhandler.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 
 namespace LeechCraft
 {
@@ -42,9 +43,10 @@ namespace Sysnotify
 	class Plugin : public QObject
 				 , public IInfo
 				 , public IEntityHandler
+				 , public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo IEntityHandler)
+		Q_INTERFACES (IInfo IEntityHandler IHaveEntityRoutingKeys)
 
 		LC_PLUGIN_METADATA ("org.LeechCraft.SysNotify")
 
@@ -60,6 +62,9 @@ namespace Sysnotify
 
 		EntityTestHandleResult CouldHandle (const Entity&) const;
 		void Handle (Entity);
+
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+		bool IsInstantiationDeferrable () const;
 	};
 }
 }
@@ -220,6 +220,11 @@ namespace vlc
 			for (int i = 0; i < Tabs_.size (); i++)
 				Tabs_ [i]->Sleep ();
 	}
+
+	EntityRoutingKeys Plugin::GetEntityRoutingKeys () const
+	{
+		return { { "x-leechcraft/power-state-changed" }, {}, {} };
+	}
 }
 }
 
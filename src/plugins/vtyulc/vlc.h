@@ -36,6 +36,7 @@
 #include <interfaces/ihavetabs.h>
 #include <interfaces/ihaveshortcuts.h>
 #include <interfaces/ihavesettings.h>
+#include <interfaces/ihaveentityroutingkeys.h>
 #include <xmlsettingsdialog/xmlsettingsdialog.h>
 #include "vlcwidget.h"
 #include "xmlsettingsmanager.h"
@@ -50,9 +51,10 @@ namespace vlc
 				 , public IHaveShortcuts
 				 , public IHaveSettings
 				 , public IEntityHandler
+				 , public IHaveEntityRoutingKeys
 	{
 		Q_OBJECT
-		Q_INTERFACES (IInfo IHaveTabs IHaveShortcuts IHaveSettings IEntityHandler)
+		Q_INTERFACES (IInfo IHaveTabs IHaveShortcuts IHaveSettings IEntityHandler IHaveEntityRoutingKeys)
 
 		ICoreProxy_ptr Proxy_;
 		Util::ShortcutManager *Manager_;
@@ -78,6 +80,8 @@ namespace vlc
 		EntityTestHandleResult CouldHandle (const Entity& entity) const;
 		void Handle (Entity entity);
 
+		EntityRoutingKeys GetEntityRoutingKeys () const;
+
 	signals:
 		void addNewTab (const QString&, QWidget*);
 		void removeTab (QWidget*);
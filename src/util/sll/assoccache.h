@@ -29,7 +29,7 @@
 
 #pragma once
 
-#include <algorithm>
+#include <list>
 #include <QHash>
 
 namespace LeechCraft
@@ -38,60 +38,71 @@ namespace Util
 {
 	namespace CacheStrat
 	{
+		/** @brief Evicts the least recently accessed elements first.
+		 *
+		 * The recency order is kept as a list, so both accessing and
+		 * evicting an element take constant time.
+		 */
 		class LRU
 		{
-			size_t Current_ = 0;
 		public:
-			struct ValueAddon
+			template<typename K>
+			class Order
 			{
-				size_t LastAccess_ = 0;
+				std::list<K> Keys_;
+			public:
+				typedef typename std::list<K>::iterator Pos_t;
 
-				ValueAddon () = default;
+				Pos_t Add (const K& key)
+				{
+					return Keys_.insert (Keys_.end (), key);
+				}
 
-				ValueAddon (size_t la)
-				: LastAccess_ { la }
+				void Touch (Pos_t pos)
 				{
+					Keys_.splice (Keys_.end (), Keys_, pos);
 				}
-			};
 
-			ValueAddon CreateInfo ()
-			{
-				return { ++Current_ };
-			}
+				void Remove (Pos_t pos)
+				{
+					Keys_.erase (pos);
+				}
 
-			void Clear ()
-			{
-				Current_ = 0;
-			}
+				bool IsEmpty () const
+				{
+					return Keys_.empty ();
+				}
 
-			void Touch (ValueAddon& add)
-			{
-				add.LastAccess_ = ++Current_;
-			}
-		};
+				const K& GetEvictee () const
+				{
+					return Keys_.front ();
+				}
 
-		inline bool operator< (const LRU::ValueAddon& v1, const LRU::ValueAddon& v2)
-		{
-			return v1.LastAccess_ < v2.LastAccess_;
-		}
+				void Clear ()
+				{
+					Keys_.clear ();
+				}
+			};
+		};
 	}
 
 	template<typename K, typename V, typename CS = CacheStrat::LRU>
 	class AssocCache
 	{
+		typedef typename CS::template Order<K> Order_t;
+		Order_t Order_;
+
 		struct ValueHolder
 		{
 			V V_;
 			size_t Cost_;
-			typename CS::ValueAddon CacheInfo_;
+			typename Order_t::Pos_t OrderPos_;
 		};
 
 		QHash<K, ValueHolder> Hash_;
 
 		size_t CurrentCost_ = 0;
 		const size_t MaxCost_;
-
-		CS CacheStratState_;
 	public:
 		AssocCache (size_t maxCost)
 		: MaxCost_ { maxCost }
@@ -117,7 +128,8 @@ namespace Util
 	void AssocCache<K, V, CS>::clear ()
 	{
 		Hash_.clear ();
-		CacheStratState_.Clear ();
+		Order_.Clear ();
+		CurrentCost_ = 0;
 	}
 
 	template<typename K, typename V, typename CS>
@@ -129,28 +141,29 @@ namespace Util
 	template<typename K, typename V, typename CS>
 	V& AssocCache<K, V, CS>::operator[] (const K& key)
 	{
-		if (!Hash_.contains (key))
+		auto pos = Hash_.find (key);
+		if (pos == Hash_.end ())
 		{
-			Hash_.insert (key, { {}, 1, CacheStratState_.CreateInfo () });
+			// Making room first, so that the new element is never the
+			// one to be evicted.
 			++CurrentCost_;
-
 			CheckShrink ();
+
+			return Hash_.insert (key, { {}, 1, Order_.Add (key) })->V_;
 		}
-		else
-			CacheStratState_.Touch (Hash_ [key].CacheInfo_);
 
-		return Hash_ [key].V_;
+		Order_.Touch (pos->OrderPos_);
+		return pos->V_;
 	}
 
 	template<typename K, typename V, typename CS>
 	void AssocCache<K, V, CS>::CheckShrink ()
 	{
-		while (CurrentCost_ > MaxCost_)
+		while (CurrentCost_ > MaxCost_ && !Order_.IsEmpty ())
 		{
-			const auto pos = std::min_element (Hash_.begin (), Hash_.end (),
-					[] (const ValueHolder& left, const ValueHolder& right)
-						{ return left.CacheInfo_ < right.CacheInfo_; });
+			const auto pos = Hash_.find (Order_.GetEvictee ());
 			CurrentCost_ -= pos->Cost_;
+			Order_.Remove (pos->OrderPos_);
 			Hash_.erase (pos);
 		}
 	}
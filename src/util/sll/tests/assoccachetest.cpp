@@ -0,0 +1,111 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include "assoccachetest.h"
+#include <QtTest>
+#include <assoccache.h>
+
+QTEST_MAIN (LeechCraft::Util::AssocCacheTest)
+
+namespace LeechCraft
+{
+namespace Util
+{
+	void AssocCacheTest::testInsert ()
+	{
+		AssocCache<QString, int> cache { 3 };
+		cache ["a"] = 1;
+		cache ["b"] = 2;
+
+		QCOMPARE (cache.size (), size_t { 2 });
+		QCOMPARE (cache.contains ("a"), true);
+		QCOMPARE (cache.contains ("c"), false);
+		QCOMPARE (cache ["b"], 2);
+	}
+
+	void AssocCacheTest::testEvictOldest ()
+	{
+		AssocCache<int, int> cache { 3 };
+		for (int i = 0; i < 5; ++i)
+			cache [i] = i;
+
+		QCOMPARE (cache.size (), size_t { 3 });
+		QCOMPARE (cache.contains (0), false);
+		QCOMPARE (cache.contains (1), false);
+		QCOMPARE (cache.contains (2), true);
+		QCOMPARE (cache.contains (4), true);
+	}
+
+	void AssocCacheTest::testTouchKeeps ()
+	{
+		AssocCache<int, int> cache { 3 };
+		cache [1] = 10;
+		cache [2] = 20;
+		cache [3] = 30;
+
+		cache [1];
+		cache [4] = 40;
+
+		QCOMPARE (cache.contains (1), true);
+		QCOMPARE (cache.contains (2), false);
+
+		cache [3];
+		cache [5] = 50;
+
+		QCOMPARE (cache.contains (1), false);
+		QCOMPARE (cache [3], 30);
+		QCOMPARE (cache [4], 40);
+	}
+
+	void AssocCacheTest::testClear ()
+	{
+		AssocCache<int, int> cache { 2 };
+		cache [1] = 1;
+		cache [2] = 2;
+		cache.clear ();
+
+		QCOMPARE (cache.size (), size_t { 0 });
+
+		cache [3] = 3;
+		cache [4] = 4;
+		QCOMPARE (cache.size (), size_t { 2 });
+		QCOMPARE (cache [3], 3);
+	}
+
+	void AssocCacheTest::testZeroCost ()
+	{
+		AssocCache<int, int> cache { 0 };
+		cache [1] = 1;
+		cache [2] = 2;
+
+		QCOMPARE (cache.size (), size_t { 1 });
+		QCOMPARE (cache [2], 2);
+	}
+}
+}
@@ -28,6 +28,7 @@
  **********************************************************************/
 
 #include "basehookinterconnector.h"
+#include <algorithm>
 #include <QMetaMethod>
 #include <QtDebug>
 
@@ -42,6 +43,23 @@ namespace Util
 
 	BaseHookInterconnector::~BaseHookInterconnector ()
 	{
+		for (const auto info : Infos_)
+		{
+			const auto& stats = info->Stats_;
+			if (stats.Calls_ || stats.Skipped_)
+				qDebug () << Q_FUNC_INFO
+						<< info->Signal_
+						<< "calls:"
+						<< stats.Calls_
+						<< "skipped:"
+						<< stats.Skipped_
+						<< "total us:"
+						<< stats.TotalUs_
+						<< "max us:"
+						<< stats.MaxUs_;
+		}
+
+		qDeleteAll (Infos_);
 	}
 
 	namespace
@@ -112,5 +130,69 @@ namespace Util
 	{
 		ConnectHookSignals (object, this, false);
 	}
+
+	bool BaseHookInterconnector::IsHookConnected (const char *signature)
+	{
+		return HasReceivers (GetHookInfo (signature));
+	}
+
+	QHash<QByteArray, BaseHookInterconnector::HookStats> BaseHookInterconnector::GetHookStats () const
+	{
+		QHash<QByteArray, HookStats> result;
+		for (const auto info : Infos_)
+			result [info->Signal_] = info->Stats_;
+		return result;
+	}
+
+	/* Hooks are identified by their normalized signatures, since the
+	 * same hook may be run from different translation units with
+	 * different string literals. Literal2Info_ just caches the lookups
+	 * for the literals already seen, sparing the normalization.
+	 */
+	BaseHookInterconnector::HookInfo* BaseHookInterconnector::GetHookInfo (const char *signature)
+	{
+		if (const auto info = Literal2Info_.value (signature))
+			return info;
+
+		const auto& normalized = QMetaObject::normalizedSignature (signature);
+		auto info = Signature2Info_.value (normalized);
+		if (!info)
+		{
+			const auto index = metaObject ()->indexOfSignal (normalized.constData ());
+			if (index == -1)
+				qWarning () << Q_FUNC_INFO
+						<< "unknown hook"
+						<< signature
+						<< "in"
+						<< this;
+
+			info = new HookInfo { normalized, LC_TOSIGNAL (normalized), index, {} };
+			Infos_ << info;
+			Signature2Info_ [normalized] = info;
+		}
+
+		Literal2Info_ [signature] = info;
+		return info;
+	}
+
+	bool BaseHookInterconnector::HasReceivers (const HookInfo *info)
+	{
+		if (info->Index_ == -1)
+			return true;
+
+#if QT_VERSION >= 0x050000
+		return isSignalConnected (metaObject ()->method (info->Index_));
+#else
+		return receivers (info->SignalSpec_.constData ()) > 0;
+#endif
+	}
+
+	void BaseHookInterconnector::RecordHookCall (HookInfo *info, qint64 us)
+	{
+		auto& stats = info->Stats_;
+		++stats.Calls_;
+		stats.TotalUs_ += us;
+		stats.MaxUs_ = std::max (stats.MaxUs_, us);
+	}
 }
 }
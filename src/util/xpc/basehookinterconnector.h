@@ -31,7 +31,10 @@
 
 #include <QObject>
 #include <QList>
+#include <QHash>
+#include <QElapsedTimer>
 #include "xpcconfig.h"
+#include "defaulthookproxy.h"
 
 namespace LeechCraft
 {
@@ -62,10 +65,52 @@ namespace Util
 	 *
 	 * Please note that second and third steps can be done in arbitrary
 	 * order and even be interleaved.
+	 *
+	 * Hooks emitted often may be emitted via RunHook() instead, which
+	 * doesn't create the hook proxy at all if nobody listens to the
+	 * hook and records per-hook invocation counters otherwise.
 	 */
 	class UTIL_XPC_API BaseHookInterconnector : public QObject
 	{
 		Q_OBJECT
+	public:
+		/** @brief Invocation counters of a single hook.
+		 *
+		 * @sa GetHookStats()
+		 */
+		struct HookStats
+		{
+			/** @brief The number of times the hook has been emitted.
+			 */
+			quint64 Calls_ = 0;
+
+			/** @brief The number of times emitting the hook has been
+			 * skipped since nobody listened to it.
+			 */
+			quint64 Skipped_ = 0;
+
+			/** @brief The total time spent in the hook handlers, in
+			 * microseconds.
+			 */
+			qint64 TotalUs_ = 0;
+
+			/** @brief The maximum time spent in the hook handlers
+			 * during a single call, in microseconds.
+			 */
+			qint64 MaxUs_ = 0;
+		};
+	private:
+		struct HookInfo
+		{
+			QByteArray Signal_;
+			QByteArray SignalSpec_;
+			int Index_;
+			HookStats Stats_;
+		};
+
+		QHash<QByteArray, HookInfo*> Signature2Info_;
+		QHash<const char*, HookInfo*> Literal2Info_;
+		QList<HookInfo*> Infos_;
 	protected:
 		QList<QObject*> Plugins_;
 	public:
@@ -109,6 +154,87 @@ namespace Util
 		 * @sa AddPlugin()
 		 */
 		void RegisterHookable (QObject *hookable);
+
+		/** @brief Checks whether anything is connected to the given hook.
+		 *
+		 * The \em signature is the normalized signature of the hook
+		 * signal of this object, like
+		 * <code>hookGotMessage(LeechCraft::IHookProxy_ptr,QObject*)</code>.
+		 * It is cached by its address, so a string literal should be
+		 * passed here.
+		 *
+		 * If there is no such signal in this object, this function
+		 * returns <code>true</code>.
+		 *
+		 * @param[in] signature The normalized signature of the hook.
+		 * @return Whether any slot or signal is connected to the hook.
+		 *
+		 * @sa RunHook()
+		 */
+		bool IsHookConnected (const char *signature);
+
+		/** @brief Emits the given hook if anything listens to it.
+		 *
+		 * If IsHookConnected() returns <code>false</code> for the
+		 * \em signature, this function just returns a null pointer
+		 * without allocating anything. Otherwise, it creates a new
+		 * DefaultHookProxy, invokes \em emitter with it, records the
+		 * time spent in \em emitter in the statistics of the hook and
+		 * returns the proxy.
+		 *
+		 * The \em emitter is expected to emit a signal relayed to the
+		 * hook signal of this interconnector, like:
+		 * @code
+		 * const auto& proxy = ic->RunHook ("hookGotMessage(LeechCraft::IHookProxy_ptr,QObject*)",
+		 * 		[&] (const IHookProxy_ptr& proxy) { emit hookGotMessage (proxy, msgObj); });
+		 * if (proxy && proxy->IsCancelled ())
+		 * 	return;
+		 * @endcode
+		 *
+		 * Please note that the hook is skipped if only the hookable
+		 * signal has receivers other than this interconnector, so this
+		 * function shouldn't be used for such signals.
+		 *
+		 * @param[in] signature The normalized signature of the hook.
+		 * @param[in] emitter The function emitting the hook.
+		 * @return The proxy the hook has been emitted with, or a null
+		 * pointer if it hasn't been emitted.
+		 *
+		 * @sa IsHookConnected(), GetHookStats()
+		 */
+		template<typename F>
+		DefaultHookProxy_ptr RunHook (const char *signature, F&& emitter)
+		{
+			const auto info = GetHookInfo (signature);
+			if (!HasReceivers (info))
+			{
+				++info->Stats_.Skipped_;
+				return {};
+			}
+
+			const auto& proxy = std::make_shared<DefaultHookProxy> ();
+
+			QElapsedTimer timer;
+			timer.start ();
+			emitter (proxy);
+			RecordHookCall (info, timer.nsecsElapsed () / 1000);
+
+			return proxy;
+		}
+
+		/** @brief Returns the invocation counters of the hooks.
+		 *
+		 * Only the hooks run via RunHook() are counted.
+		 *
+		 * @return The map from the hook signature to its counters.
+		 *
+		 * @sa RunHook()
+		 */
+		QHash<QByteArray, HookStats> GetHookStats () const;
+	private:
+		HookInfo* GetHookInfo (const char*);
+		bool HasReceivers (const HookInfo*);
+		void RecordHookCall (HookInfo*, qint64);
 	};
 }
 }
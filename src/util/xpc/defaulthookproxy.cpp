@@ -60,12 +60,25 @@ namespace Util
 
 	QVariant DefaultHookProxy::GetValue (const QByteArray& name) const
 	{
-		return Name2NewVal_.value (name);
+		const auto pos = FindValue (name);
+		return pos == -1 ? QVariant {} : Name2NewVal_.at (pos).second;
 	}
 
 	void DefaultHookProxy::SetValue (const QByteArray& name, const QVariant& val)
 	{
-		Name2NewVal_ [name] = val;
+		const auto pos = FindValue (name);
+		if (pos == -1)
+			Name2NewVal_.append (qMakePair (name, val));
+		else
+			Name2NewVal_ [pos].second = val;
+	}
+
+	int DefaultHookProxy::FindValue (const QByteArray& name) const
+	{
+		for (int i = 0; i < Name2NewVal_.size (); ++i)
+			if (Name2NewVal_.at (i).first == name)
+				return i;
+		return -1;
 	}
 }
 }
@@ -29,7 +29,8 @@
 
 #pragma once
 
-#include <QMap>
+#include <QPair>
+#include <QVarLengthArray>
 #include "xpcconfig.h"
 #include "interfaces/iinfo.h"
 #include "interfaces/core/ihookproxy.h"
@@ -50,7 +51,10 @@ namespace Util
 		bool Cancelled_;
 		QVariant ReturnValue_;
 
-		QMap<QByteArray, QVariant> Name2NewVal_;
+		/* Hooks rarely override more than a couple of values, so a
+		 * linear search over a small inline array is cheaper than a map.
+		 */
+		QVarLengthArray<QPair<QByteArray, QVariant>, 4> Name2NewVal_;
 	public:
 		/** @brief Creates a new hook proxy.
 		 */
@@ -95,10 +99,11 @@ namespace Util
 		template<typename T>
 		void FillValue (const QByteArray& name, T& val)
 		{
-			if (!Name2NewVal_.contains (name))
+			const auto pos = FindValue (name);
+			if (pos == -1)
 				return;
 
-			const QVariant& newVal = Name2NewVal_ [name];
+			const QVariant& newVal = Name2NewVal_.at (pos).second;
 			if (!newVal.isValid ())
 				return;
 
@@ -112,6 +117,8 @@ namespace Util
 		/** @brief Reimplemented from IHookProxy::SetValue().
 		 */
 		void SetValue (const QByteArray&, const QVariant&);
+	private:
+		int FindValue (const QByteArray&) const;
 	};
 
 	typedef std::shared_ptr<DefaultHookProxy> DefaultHookProxy_ptr;